@@ -0,0 +1,173 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Synthetic group implementation.
+ */
+#include "benchgroup.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "epid/common/src/epid2params.h"
+#include "epid/common/math/finitefield.h"
+#include "epid/common/math/ecgroup.h"
+
+/// Handle SDK Error with Break
+#define BREAK_ON_EPID_ERROR(ret) \
+  if (kEpidNoErr != (ret)) {     \
+    break;                       \
+  }
+
+/// Write a 32 bit integer in big-endian order
+static void WriteOctStr32(uint32_t value, OctStr32* str) {
+  str->data[0] = (unsigned char)(value >> 24);
+  str->data[1] = (unsigned char)(value >> 16);
+  str->data[2] = (unsigned char)(value >> 8);
+  str->data[3] = (unsigned char)value;
+}
+
+EpidStatus CreateBenchGroup(BitSupplier rnd_func, void* rnd_param,
+                            GroupPubKey* gpk, IPrivKey* isk) {
+  EpidStatus sts = kEpidErr;
+  Epid2Params_* params = NULL;
+  EcPoint* h_pt = NULL;
+  EcPoint* w_pt = NULL;
+  FfElement* gamma_el = NULL;
+  static const BigNumStr one = {
+      {{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}}};
+  static const GroupId gid = {
+      {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}};
+
+  if (!rnd_func || !gpk || !isk) {
+    return kEpidBadArgErr;
+  }
+  do {
+    sts = CreateEpid2Params(&params);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewEcPoint(params->G1, &h_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewEcPoint(params->G2, &w_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewFfElement(params->Fp, &gamma_el);
+    BREAK_ON_EPID_ERROR(sts);
+
+    gpk->gid = gid;
+    isk->gid = gid;
+
+    // h1, h2 <- G1
+    sts = EcGetRandom(params->G1, rnd_func, rnd_param, h_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = WriteEcPoint(params->G1, h_pt, (uint8_t*)&gpk->h1, sizeof(gpk->h1));
+    BREAK_ON_EPID_ERROR(sts);
+    sts = EcGetRandom(params->G1, rnd_func, rnd_param, h_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = WriteEcPoint(params->G1, h_pt, (uint8_t*)&gpk->h2, sizeof(gpk->h2));
+    BREAK_ON_EPID_ERROR(sts);
+
+    // gamma <- Fp, w = g2^gamma
+    sts = FfGetRandom(params->Fp, &one, rnd_func, rnd_param, gamma_el);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = WriteFfElement(params->Fp, gamma_el, (uint8_t*)&isk->gamma,
+                         sizeof(isk->gamma));
+    BREAK_ON_EPID_ERROR(sts);
+    sts = EcExp(params->G2, params->g2, (BigNumStr const*)&isk->gamma, w_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = WriteEcPoint(params->G2, w_pt, (uint8_t*)&gpk->w, sizeof(gpk->w));
+    BREAK_ON_EPID_ERROR(sts);
+
+    sts = kEpidNoErr;
+  } while (0);
+
+  DeleteFfElement(&gamma_el);
+  DeleteEcPoint(&w_pt);
+  DeleteEcPoint(&h_pt);
+  DeleteEpid2Params(&params);
+  return sts;
+}
+
+EpidStatus CreateBenchSigRl(GroupPubKey const* gpk, uint32_t num_entries,
+                            BitSupplier rnd_func, void* rnd_param,
+                            SigRl** sig_rl, size_t* sig_rl_size) {
+  EpidStatus sts = kEpidErr;
+  Epid2Params_* params = NULL;
+  EcPoint* b_pt = NULL;
+  EcPoint* k_pt = NULL;
+  FfElement* r_el = NULL;
+  SigRl* new_sig_rl = NULL;
+  size_t size = 0;
+  BigNumStr r_str;
+  uint32_t i = 0;
+  static const BigNumStr one = {
+      {{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}}};
+
+  if (!gpk || !rnd_func || !sig_rl || !sig_rl_size) {
+    return kEpidBadArgErr;
+  }
+  size = sizeof(SigRl) - sizeof(SigRlEntry) +
+         (size_t)num_entries * sizeof(SigRlEntry);
+  do {
+    new_sig_rl = calloc(1, size);
+    if (!new_sig_rl) {
+      sts = kEpidMemAllocErr;
+      break;
+    }
+    new_sig_rl->gid = gpk->gid;
+    WriteOctStr32(1, &new_sig_rl->version);
+    WriteOctStr32(num_entries, &new_sig_rl->n2);
+
+    sts = CreateEpid2Params(&params);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewEcPoint(params->G1, &b_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewEcPoint(params->G1, &k_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewFfElement(params->Fp, &r_el);
+    BREAK_ON_EPID_ERROR(sts);
+
+    for (i = 0; i < num_entries; i++) {
+      SigRlEntry* entry = &new_sig_rl->bk[i];
+      sts = EcGetRandom(params->G1, rnd_func, rnd_param, b_pt);
+      BREAK_ON_EPID_ERROR(sts);
+      sts = FfGetRandom(params->Fp, &one, rnd_func, rnd_param, r_el);
+      BREAK_ON_EPID_ERROR(sts);
+      sts = WriteFfElement(params->Fp, r_el, (uint8_t*)&r_str, sizeof(r_str));
+      BREAK_ON_EPID_ERROR(sts);
+      sts = EcExp(params->G1, b_pt, &r_str, k_pt);
+      BREAK_ON_EPID_ERROR(sts);
+      sts = WriteEcPoint(params->G1, b_pt, (uint8_t*)&entry->b,
+                         sizeof(entry->b));
+      BREAK_ON_EPID_ERROR(sts);
+      sts = WriteEcPoint(params->G1, k_pt, (uint8_t*)&entry->k,
+                         sizeof(entry->k));
+      BREAK_ON_EPID_ERROR(sts);
+    }
+  } while (0);
+
+  memset(&r_str, 0, sizeof(r_str));
+  DeleteFfElement(&r_el);
+  DeleteEcPoint(&k_pt);
+  DeleteEcPoint(&b_pt);
+  DeleteEpid2Params(&params);
+  if (kEpidNoErr != sts) {
+    free(new_sig_rl);
+    return sts;
+  }
+  *sig_rl = new_sig_rl;
+  *sig_rl_size = size;
+  return kEpidNoErr;
+}
@@ -0,0 +1,74 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Synthetic group interface.
+ */
+#ifndef EXAMPLE_EPIDBENCH_SRC_BENCHGROUP_H_
+#define EXAMPLE_EPIDBENCH_SRC_BENCHGROUP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "epid/common/bitsupplier.h"
+#include "epid/common/errors.h"
+#include "epid/common/types.h"
+
+/// Create a new group
+/*!
+  Chooses random h1, h2 and issuer secret gamma and derives the group
+  public key from them, the same way generate_priv_key does, but without
+  touching the file system.
+
+  \param[in] rnd_func
+  Random number generator.
+  \param[in] rnd_param
+  Pass through context data for rnd_func.
+  \param[out] gpk
+  The new group public key.
+  \param[out] isk
+  The new issuer private key.
+  \returns ::EpidStatus
+*/
+EpidStatus CreateBenchGroup(BitSupplier rnd_func, void* rnd_param,
+                            GroupPubKey* gpk, IPrivKey* isk);
+
+/// Create a signature based revocation list of random entries
+/*!
+  Every entry is a random B with K = B^r for a random r, so it is well
+  formed but revokes nobody: signing against it costs one non-revoked
+  proof per entry.
+
+  \param[in] gpk
+  The group public key the list is for.
+  \param[in] num_entries
+  The number of entries.
+  \param[in] rnd_func
+  Random number generator.
+  \param[in] rnd_param
+  Pass through context data for rnd_func.
+  \param[out] sig_rl
+  The new list. Must be freed with free().
+  \param[out] sig_rl_size
+  The size of sig_rl in bytes.
+  \returns ::EpidStatus
+*/
+EpidStatus CreateBenchSigRl(GroupPubKey const* gpk, uint32_t num_entries,
+                            BitSupplier rnd_func, void* rnd_param,
+                            SigRl** sig_rl, size_t* sig_rl_size);
+
+#endif  // EXAMPLE_EPIDBENCH_SRC_BENCHGROUP_H_
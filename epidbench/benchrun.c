@@ -0,0 +1,304 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Sign and verify benchmark implementation.
+ */
+#include "benchrun.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "epid/member/api.h"
+#include "epid/verifier/api.h"
+#include "prng.h"
+
+/// Length of the basename used when signing with a basename
+#define BENCH_BASENAME_SIZE 32
+
+/// Handle SDK Error with Break
+#define BREAK_ON_EPID_ERROR(ret) \
+  if (kEpidNoErr != (ret)) {     \
+    break;                       \
+  }
+
+/// Per thread state of a benchmark run
+typedef struct BenchWorker {
+  BenchConfig const* config;  ///< what to measure
+  MemberCtx* member;          ///< signs
+  VerifierCtx* verifier;      ///< verifies
+  void* prng;                 ///< random source of member
+  unsigned char* msg;         ///< message to sign
+  unsigned char basename[BENCH_BASENAME_SIZE];  ///< basename to sign with
+  unsigned char* sigs;  ///< config->iterations signatures
+  size_t sig_size;      ///< size of one signature in bytes
+  double* sign_us;      ///< latency of every EpidSign call
+  double* verify_us;    ///< latency of every EpidVerify call
+  EpidStatus sts;       ///< first error of this thread
+} BenchWorker;
+
+/// Microseconds between two points in time
+static double ElapsedUs(struct timespec const* start,
+                        struct timespec const* end) {
+  return (double)(end->tv_sec - start->tv_sec) * 1e6 +
+         (double)(end->tv_nsec - start->tv_nsec) / 1e3;
+}
+
+/// Sign config->iterations messages
+static void* SignThread(void* arg) {
+  BenchWorker* worker = arg;
+  BenchConfig const* config = worker->config;
+  void const* basename = config->use_basename ? worker->basename : NULL;
+  size_t basename_len = config->use_basename ? sizeof(worker->basename) : 0;
+  struct timespec start;
+  struct timespec end;
+  size_t i = 0;
+
+  for (i = 0; i < config->iterations && kEpidNoErr == worker->sts; i++) {
+    EpidSignature* sig =
+        (EpidSignature*)(worker->sigs + i * worker->sig_size);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    worker->sts = EpidSign(worker->member, worker->msg, config->msg_len,
+                           basename, basename_len, config->sig_rl,
+                           config->sig_rl_size, sig, worker->sig_size);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    worker->sign_us[i] = ElapsedUs(&start, &end);
+  }
+  return NULL;
+}
+
+/// Verify the signatures made by ::SignThread
+static void* VerifyThread(void* arg) {
+  BenchWorker* worker = arg;
+  BenchConfig const* config = worker->config;
+  struct timespec start;
+  struct timespec end;
+  size_t i = 0;
+
+  for (i = 0; i < config->iterations && kEpidNoErr == worker->sts; i++) {
+    EpidSignature const* sig =
+        (EpidSignature const*)(worker->sigs + i * worker->sig_size);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    worker->sts = EpidVerify(worker->verifier, sig, worker->sig_size,
+                             worker->msg, config->msg_len);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    worker->verify_us[i] = ElapsedUs(&start, &end);
+  }
+  return NULL;
+}
+
+/// Run one phase on every worker, returning its wall clock time in seconds
+static EpidStatus RunPhase(BenchWorker* workers, size_t num_workers,
+                           void* (*phase)(void*), double* elapsed_s) {
+  EpidStatus sts = kEpidNoErr;
+  pthread_t* threads = NULL;
+  size_t num_started = 0;
+  struct timespec start;
+  struct timespec end;
+  size_t i = 0;
+
+  if (num_workers > 1) {
+    threads = calloc(num_workers, sizeof(*threads));
+    if (!threads) {
+      return kEpidMemAllocErr;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if (1 == num_workers) {
+    phase(&workers[0]);
+  } else {
+    for (num_started = 0; num_started < num_workers; num_started++) {
+      if (0 != pthread_create(&threads[num_started], NULL, phase,
+                              &workers[num_started])) {
+        sts = kEpidErr;
+        break;
+      }
+    }
+    for (i = 0; i < num_started; i++) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  free(threads);
+
+  for (i = 0; i < num_workers && kEpidNoErr == sts; i++) {
+    sts = workers[i].sts;
+  }
+  *elapsed_s = ElapsedUs(&start, &end) / 1e6;
+  return sts;
+}
+
+/// qsort comparison of doubles
+static int CompareDouble(void const* a, void const* b) {
+  double x = *(double const*)a;
+  double y = *(double const*)b;
+  return (x > y) - (x < y);
+}
+
+/// Nearest rank percentile of sorted samples
+static double Percentile(double const* sorted, size_t count, double p) {
+  size_t rank = (size_t)(p * (double)count + 0.999999);
+  if (rank < 1) rank = 1;
+  if (rank > count) rank = count;
+  return sorted[rank - 1];
+}
+
+/// Summarize the latencies of one phase
+static void Summarize(double* samples, size_t count, double elapsed_s,
+                      BenchStats* stats) {
+  qsort(samples, count, sizeof(*samples), CompareDouble);
+  stats->p50_us = Percentile(samples, count, 0.50);
+  stats->p99_us = Percentile(samples, count, 0.99);
+  stats->ops_per_sec = elapsed_s > 0 ? (double)count / elapsed_s : 0.0;
+}
+
+/// Create the contexts, message and buffers of a worker
+static EpidStatus InitWorker(GroupPubKey const* gpk, PrivKey const* priv_key,
+                             BenchConfig const* config, double* sign_us,
+                             double* verify_us, FILE* urandom,
+                             BenchWorker* worker) {
+  EpidStatus sts = kEpidErr;
+  unsigned char seed[PRNG_MAX_SEED_SIZE];
+
+  worker->config = config;
+  worker->sign_us = sign_us;
+  worker->verify_us = verify_us;
+  worker->sts = kEpidNoErr;
+  do {
+    // every thread needs its own PRNG seed, or they make the same signatures
+    if (1 != fread(seed, sizeof(seed), 1, urandom) ||
+        1 != fread(worker->basename, sizeof(worker->basename), 1, urandom)) {
+      sts = kEpidErr;
+      break;
+    }
+    worker->msg = malloc(config->msg_len ? config->msg_len : 1);
+    if (!worker->msg) {
+      sts = kEpidMemAllocErr;
+      break;
+    }
+    if (config->msg_len &&
+        1 != fread(worker->msg, config->msg_len, 1, urandom)) {
+      sts = kEpidErr;
+      break;
+    }
+    worker->sig_size = EpidGetSigSize(config->sig_rl);
+    worker->sigs = calloc(config->iterations, worker->sig_size);
+    if (!worker->sigs) {
+      sts = kEpidMemAllocErr;
+      break;
+    }
+
+    sts = PrngCreateFromSeed(seed, sizeof(seed), &worker->prng);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = EpidMemberCreate(gpk, priv_key, NULL, PrngGen, worker->prng,
+                           &worker->member);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = EpidVerifierCreate(gpk, NULL, &worker->verifier);
+    BREAK_ON_EPID_ERROR(sts);
+    if (config->use_basename) {
+      sts = EpidRegisterBaseName(worker->member, worker->basename,
+                                 sizeof(worker->basename));
+      BREAK_ON_EPID_ERROR(sts);
+      sts = EpidVerifierSetBasename(worker->verifier, worker->basename,
+                                    sizeof(worker->basename));
+      BREAK_ON_EPID_ERROR(sts);
+    }
+    if (config->sig_rl) {
+      sts = EpidVerifierSetSigRl(worker->verifier, config->sig_rl,
+                                 config->sig_rl_size);
+      BREAK_ON_EPID_ERROR(sts);
+    }
+  } while (0);
+
+  memset(seed, 0, sizeof(seed));
+  return sts;
+}
+
+/// Free what ::InitWorker created
+static void DeinitWorker(BenchWorker* worker) {
+  EpidVerifierDelete(&worker->verifier);
+  EpidMemberDelete(&worker->member);
+  PrngDelete(&worker->prng);
+  free(worker->sigs);
+  free(worker->msg);
+  memset(worker, 0, sizeof(*worker));
+}
+
+EpidStatus RunBench(GroupPubKey const* gpk, PrivKey const* priv_keys,
+                    BenchConfig const* config, BenchResult* result) {
+  EpidStatus sts = kEpidErr;
+  BenchWorker* workers = NULL;
+  double* sign_us = NULL;
+  double* verify_us = NULL;
+  size_t num_samples = 0;
+  size_t num_init = 0;
+  double sign_s = 0;
+  double verify_s = 0;
+  FILE* urandom = NULL;
+  size_t i = 0;
+
+  if (!gpk || !priv_keys || !config || !result || 0 == config->num_threads ||
+      0 == config->iterations) {
+    return kEpidBadArgErr;
+  }
+  num_samples = config->num_threads * config->iterations;
+  do {
+    workers = calloc(config->num_threads, sizeof(*workers));
+    sign_us = calloc(num_samples, sizeof(*sign_us));
+    verify_us = calloc(num_samples, sizeof(*verify_us));
+    if (!workers || !sign_us || !verify_us) {
+      sts = kEpidMemAllocErr;
+      break;
+    }
+    urandom = fopen("/dev/urandom", "rb");
+    if (!urandom) {
+      sts = kEpidErr;
+      break;
+    }
+    for (num_init = 0; num_init < config->num_threads; num_init++) {
+      size_t offset = num_init * config->iterations;
+      sts = InitWorker(gpk, &priv_keys[num_init], config, sign_us + offset,
+                       verify_us + offset, urandom, &workers[num_init]);
+      if (kEpidNoErr != sts) {
+        num_init++;
+        break;
+      }
+    }
+    BREAK_ON_EPID_ERROR(sts);
+
+    sts = RunPhase(workers, config->num_threads, SignThread, &sign_s);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = RunPhase(workers, config->num_threads, VerifyThread, &verify_s);
+    BREAK_ON_EPID_ERROR(sts);
+
+    Summarize(sign_us, num_samples, sign_s, &result->sign);
+    Summarize(verify_us, num_samples, verify_s, &result->verify);
+  } while (0);
+
+  for (i = 0; i < num_init; i++) {
+    DeinitWorker(&workers[i]);
+  }
+  if (urandom) fclose(urandom);
+  free(verify_us);
+  free(sign_us);
+  free(workers);
+  return sts;
+}
@@ -0,0 +1,75 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Sign and verify benchmark interface.
+ */
+#ifndef EXAMPLE_EPIDBENCH_SRC_BENCHRUN_H_
+#define EXAMPLE_EPIDBENCH_SRC_BENCHRUN_H_
+
+#include <stddef.h>
+
+#include "epid/common/errors.h"
+#include "epid/common/types.h"
+
+/// One point of the benchmark sweep
+typedef struct BenchConfig {
+  size_t msg_len;       ///< message length in bytes
+  int use_basename;     ///< sign with a fixed basename if non-zero
+  SigRl const* sig_rl;  ///< signature based revocation list, or NULL
+  size_t sig_rl_size;   ///< size of sig_rl in bytes
+  size_t num_threads;   ///< number of signing/verifying threads
+  size_t iterations;    ///< operations per thread and phase
+} BenchConfig;
+
+/// Timings of one operation
+typedef struct BenchStats {
+  double p50_us;       ///< median latency in microseconds
+  double p99_us;       ///< 99th percentile latency in microseconds
+  double ops_per_sec;  ///< operations per second over all threads
+} BenchStats;
+
+/// Result of one point of the benchmark sweep
+typedef struct BenchResult {
+  BenchStats sign;    ///< EpidSign
+  BenchStats verify;  ///< EpidVerify
+} BenchResult;
+
+/// Measure signing and verifying
+/*!
+  Every thread gets its own member and verifier context, message and
+  basename, all created before timing starts. The threads first sign
+  iterations messages each, then verify the signatures they made, so the
+  two phases are timed separately and never compete for the CPU.
+  Throughput is the number of operations of a phase divided by its wall
+  clock time; latencies are taken over the operations of all threads.
+
+  \param[in] gpk
+  The group public key.
+  \param[in] priv_keys
+  One member private key per thread.
+  \param[in] config
+  What to measure.
+  \param[out] result
+  The measurements.
+  \returns ::EpidStatus
+  The result of ::EpidVerify if a signature failed to verify.
+*/
+EpidStatus RunBench(GroupPubKey const* gpk, PrivKey const* priv_keys,
+                    BenchConfig const* config, BenchResult* result);
+
+#endif  // EXAMPLE_EPIDBENCH_SRC_BENCHRUN_H_
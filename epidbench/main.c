@@ -0,0 +1,317 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Sign and verify throughput benchmark.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dropt.h>
+#include "epid/common/errors.h"
+#include "epid/common/types.h"
+
+#include "util/envutil.h"
+#include "util/buffutil.h"
+#include "benchgroup.h"
+#include "benchrun.h"
+#include "memberkeys.h"
+#include "prng.h"
+
+// Defaults
+#define PROGRAM_NAME "epidbench"
+#define ITERATIONS_DEFAULT 100
+#define MSG_SIZES_DEFAULT "32,1024,65536"
+#define SIGRL_SIZES_DEFAULT "0,10"
+#define THREADS_DEFAULT 1
+#define THREADS_MAX 256
+/// Maximum number of values in a size list option
+#define SIZE_LIST_MAX 16
+
+/// Values of a comma separated size list option
+typedef struct SizeList {
+  size_t count;                 ///< number of values
+  size_t values[SIZE_LIST_MAX];  ///< the values
+} SizeList;
+
+/// Parses a comma separated list of sizes
+static bool ParseSizeList(char const* str, SizeList* list) {
+  list->count = 0;
+  while (*str) {
+    char* end = NULL;
+    unsigned long long value = 0;
+    if (SIZE_LIST_MAX == list->count || '-' == *str) {
+      return false;
+    }
+    errno = 0;
+    value = strtoull(str, &end, 10);
+    if (end == str || 0 != errno || (',' != *end && '\0' != *end)) {
+      return false;
+    }
+    list->values[list->count++] = (size_t)value;
+    str = (',' == *end) ? end + 1 : end;
+  }
+  return 0 != list->count;
+}
+
+/// parses string to a size list
+static dropt_error HandleSizeList(dropt_context* context,
+                                  const char* option_argument,
+                                  void* handler_data) {
+  (void)context;
+  if (option_argument == NULL || option_argument[0] == '\0') {
+    return dropt_error_insufficient_arguments;
+  }
+  if (!ParseSizeList(option_argument, handler_data)) {
+    /* Reject the value as being inappropriate for this handler. */
+    return dropt_error_mismatch;
+  }
+  return dropt_error_none;
+}
+
+/// Main entrypoint
+int main(int argc, char* argv[]) {
+  // intermediate return value for C style functions
+  int ret_value = EXIT_SUCCESS;
+  // intermediate return value for EPID functions
+  EpidStatus sts = kEpidErr;
+
+  // User Settings
+
+  // Operations per thread parameter
+  static unsigned int iterations = ITERATIONS_DEFAULT;
+
+  // Number of threads for the multi-threaded run parameter
+  static unsigned int num_threads = THREADS_DEFAULT;
+
+  // Message sizes parameter
+  static SizeList msg_sizes = {0};
+
+  // SigRl sizes parameter
+  static SizeList sig_rl_sizes = {0};
+
+  // Verbose flag parameter
+  static bool verbose = false;
+
+  // help flag parameter
+  static bool show_help = false;
+
+  // Buffers and computed values
+
+  // Synthetic group
+  GroupPubKey pub_key = {0};
+  IPrivKey issuer_priv_key = {0};
+  PrivKey* priv_keys = NULL;
+  void* prng = NULL;
+  MemberKeyGen* gen = NULL;
+
+  // Thread counts to run: single-threaded and, if asked, num_threads
+  size_t thread_counts[2] = {1, 0};
+  size_t num_thread_counts = 1;
+
+  dropt_option options[] = {
+      {'\0', "iterations",
+       "sign and verify N messages per thread for every "
+       "configuration (default: 100)",
+       "N", dropt_handle_uint, &iterations},
+      {'\0', "threads",
+       "also measure with N threads (default: 1)", "N", dropt_handle_uint,
+       &num_threads},
+      {'\0', "msg-sizes",
+       "sweep message sizes in bytes (default: " MSG_SIZES_DEFAULT ")",
+       "LIST", HandleSizeList, &msg_sizes},
+      {'\0', "sigrl-sizes",
+       "sweep SigRl entry counts (default: " SIGRL_SIZES_DEFAULT ")", "LIST",
+       HandleSizeList, &sig_rl_sizes},
+      {'h', "help", "display this help and exit", NULL, dropt_handle_bool,
+       &show_help, dropt_attr_halt},
+      {'v', "verbose", "print status messages to stdout", NULL,
+       dropt_handle_bool, &verbose},
+
+      {0} /* Required sentinel value. */
+  };
+
+  dropt_context* dropt_ctx = NULL;
+
+  // set program name for logging
+  set_prog_name(PROGRAM_NAME);
+  do {
+    size_t t = 0;
+    size_t m = 0;
+    size_t r = 0;
+    int b = 0;
+
+    // Read command line args
+
+    dropt_ctx = dropt_new_context(options);
+    if (!dropt_ctx) {
+      ret_value = EXIT_FAILURE;
+      break;
+    } else if (argc > 0) {
+      char** rest = dropt_parse(dropt_ctx, -1, &argv[1]);
+      if (dropt_get_error(dropt_ctx) != dropt_error_none) {
+        log_error(dropt_get_error_message(dropt_ctx));
+        if (dropt_error_invalid_option == dropt_get_error(dropt_ctx)) {
+          fprintf(stderr, "Try '%s --help' for more information.\n",
+                  PROGRAM_NAME);
+        }
+        ret_value = EXIT_FAILURE;
+        break;
+      } else if (show_help) {
+        log_fmt(
+            "Usage: %s [OPTION]...\n"
+            "Measure sign and verify latency and throughput for a "
+            "synthetic group\n"
+            "\n"
+            "Every combination of message size, basename (off/on) and SigRl\n"
+            "size is measured single-threaded and, with --threads, again\n"
+            "with N threads. LIST is a comma separated list of numbers.\n"
+            "\n"
+            "Options:\n",
+            PROGRAM_NAME);
+        dropt_print_help(stdout, dropt_ctx, NULL);
+        ret_value = EXIT_SUCCESS;
+        break;
+      } else if (*rest) {
+        // we have unparsed (positional) arguments
+        log_error("invalid argument: %s", *rest);
+        fprintf(stderr, "Try '%s --help' for more information.\n",
+                PROGRAM_NAME);
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+    }
+    if (verbose) {
+      verbose = ToggleVerbosity();
+    }
+    if (0 == msg_sizes.count) ParseSizeList(MSG_SIZES_DEFAULT, &msg_sizes);
+    if (0 == sig_rl_sizes.count) {
+      ParseSizeList(SIGRL_SIZES_DEFAULT, &sig_rl_sizes);
+    }
+    if (0 == num_threads || THREADS_MAX < num_threads) {
+      log_error("number of threads must be between 1 and %d", THREADS_MAX);
+      ret_value = EXIT_FAILURE;
+      break;
+    }
+    if (0 == iterations) {
+      log_error("number of iterations must be at least 1");
+      ret_value = EXIT_FAILURE;
+      break;
+    }
+    if (num_threads > 1) {
+      thread_counts[num_thread_counts++] = num_threads;
+    }
+
+    // Create the group and one member per thread
+    sts = PrngCreate(&prng);
+    if (kEpidNoErr != sts) {
+      log_error("cannot create prng: %s", EpidStatusToString(sts));
+      ret_value = EXIT_FAILURE;
+      break;
+    }
+    sts = CreateBenchGroup(PrngGen, prng, &pub_key, &issuer_priv_key);
+    if (kEpidNoErr != sts) {
+      log_error("cannot create group: %s", EpidStatusToString(sts));
+      ret_value = EXIT_FAILURE;
+      break;
+    }
+    priv_keys = calloc(num_threads, sizeof(*priv_keys));
+    if (!priv_keys) {
+      log_error("cannot allocate member keys");
+      ret_value = EXIT_FAILURE;
+      break;
+    }
+    sts = NewMemberKeyGen(&pub_key, &issuer_priv_key, PrngGen, prng, &gen);
+    for (t = 0; t < num_threads && kEpidNoErr == sts; t++) {
+      sts = MemberKeyGenNext(gen, &priv_keys[t]);
+    }
+    if (kEpidNoErr != sts) {
+      log_error("cannot issue member keys: %s", EpidStatusToString(sts));
+      ret_value = EXIT_FAILURE;
+      break;
+    }
+    if (verbose) {
+      log_msg("created group with %u member keys", num_threads);
+    }
+
+    printf("%7s %8s %3s %5s %12s %12s %10s %12s %12s %10s\n", "threads",
+           "msg_len", "bsn", "sigrl", "sign_p50_us", "sign_p99_us",
+           "sign_op/s", "verif_p50_us", "verif_p99_us", "verif_op/s");
+    for (r = 0; r < sig_rl_sizes.count && EXIT_SUCCESS == ret_value; r++) {
+      SigRl* sig_rl = NULL;
+      size_t sig_rl_size = 0;
+      if (sig_rl_sizes.values[r] > 0) {
+        if (sig_rl_sizes.values[r] > UINT32_MAX) {
+          sts = kEpidBadArgErr;
+        } else {
+          sts = CreateBenchSigRl(&pub_key, (uint32_t)sig_rl_sizes.values[r],
+                                 PrngGen, prng, &sig_rl, &sig_rl_size);
+        }
+        if (kEpidNoErr != sts) {
+          log_error("cannot create SigRl with %zu entries: %s",
+                    sig_rl_sizes.values[r], EpidStatusToString(sts));
+          ret_value = EXIT_FAILURE;
+          break;
+        }
+      }
+      for (t = 0; t < num_thread_counts && EXIT_SUCCESS == ret_value; t++) {
+        for (m = 0; m < msg_sizes.count && EXIT_SUCCESS == ret_value; m++) {
+          for (b = 0; b < 2; b++) {
+            BenchConfig config;
+            BenchResult result;
+            memset(&config, 0, sizeof(config));
+            config.msg_len = msg_sizes.values[m];
+            config.use_basename = b;
+            config.sig_rl = sig_rl;
+            config.sig_rl_size = sig_rl_size;
+            config.num_threads = thread_counts[t];
+            config.iterations = iterations;
+            sts = RunBench(&pub_key, priv_keys, &config, &result);
+            if (kEpidNoErr != sts) {
+              log_error("benchmark failed: %s", EpidStatusToString(sts));
+              ret_value = EXIT_FAILURE;
+              break;
+            }
+            printf("%7zu %8zu %3s %5zu %12.1f %12.1f %10.1f %12.1f %12.1f "
+                   "%10.1f\n",
+                   config.num_threads, config.msg_len, b ? "on" : "off",
+                   sig_rl_sizes.values[r], result.sign.p50_us,
+                   result.sign.p99_us, result.sign.ops_per_sec,
+                   result.verify.p50_us, result.verify.p99_us,
+                   result.verify.ops_per_sec);
+            fflush(stdout);
+          }
+        }
+      }
+      free(sig_rl);
+    }
+  } while (0);
+
+  if (priv_keys) {
+    memset(priv_keys, 0, num_threads * sizeof(*priv_keys));
+    free(priv_keys);
+  }
+  memset(&issuer_priv_key, 0, sizeof(issuer_priv_key));
+  DeleteMemberKeyGen(&gen);
+  PrngDelete(&prng);
+  dropt_free_context(dropt_ctx);
+
+  return ret_value;
+}
@@ -0,0 +1,47 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+/*!
+ * \file
+ * \brief Allocation counting for benchmarks implementation.
+ */
+#include "epid/common/math/benchmarks/alloc_counter-bench.h"
+
+#include <atomic>
+#include <cstdlib>
+
+extern "C" {
+#include "epid/common/src/memory.h"
+}
+
+namespace {
+
+std::atomic<uint64_t> alloc_count(0);
+
+void* CountingAlloc(size_t size, void*) {
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+  return calloc(1, size);
+}
+
+void CountingFree(void* ptr, void*) { free(ptr); }
+
+}  // namespace
+
+void InstallAllocCounter() {
+  EpidAllocator const allocator = {CountingAlloc, CountingFree, nullptr};
+  EpidSetAllocator(&allocator);
+}
+
+uint64_t AllocCount() { return alloc_count.load(std::memory_order_relaxed); }
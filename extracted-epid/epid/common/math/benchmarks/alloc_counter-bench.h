@@ -0,0 +1,59 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+/*!
+ * \file
+ * \brief Allocation counting for benchmarks.
+ */
+#ifndef EPID_COMMON_MATH_BENCHMARKS_ALLOC_COUNTER_BENCH_H_
+#define EPID_COMMON_MATH_BENCHMARKS_ALLOC_COUNTER_BENCH_H_
+
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+
+/// Installs an allocator backend that counts allocations
+/*!
+ Must be called before the library allocates any memory.
+
+ Only allocations that reach the backend are counted. Blocks that
+ EpidAlloc hands out again from its per thread pools are not, so the
+ count is the heap traffic of an operation once the pools are warm.
+*/
+void InstallAllocCounter();
+
+/// Number of backend allocations since InstallAllocCounter
+uint64_t AllocCount();
+
+/// Reports the backend allocations of the timed loop as allocs_per_op
+/*!
+ Construct after the setup of the benchmark and call Report after the
+ timed loop.
+*/
+class AllocCounter {
+ public:
+  AllocCounter() : start_(AllocCount()) {}
+  /// Adds the allocs_per_op counter to state
+  void Report(benchmark::State& state) const {
+    state.counters["allocs_per_op"] =
+        benchmark::Counter(static_cast<double>(AllocCount() - start_),
+                           benchmark::Counter::kAvgIterations);
+  }
+
+ private:
+  uint64_t start_;
+};
+
+#endif  // EPID_COMMON_MATH_BENCHMARKS_ALLOC_COUNTER_BENCH_H_
@@ -0,0 +1,229 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+/*!
+ * \file
+ * \brief EcGroup benchmarks.
+ */
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "epid/common/math/benchmarks/alloc_counter-bench.h"
+
+extern "C" {
+#include "epid/common/math/ecgroup.h"
+#include "epid/common/src/epid2params.h"
+}
+
+namespace {
+
+/// Random bases and powers for multi-exponentiation in G1 or G2
+class EcMultiExpFixture : public benchmark::Fixture {
+ public:
+  void SetUp(benchmark::State const& state) override {
+    size_t m = static_cast<size_t>(state.range(0));
+    bool use_g2 = 0 != state.range(1);
+    std::mt19937 rnd(m);
+    if (kEpidNoErr != CreateEpid2Params(&params)) {
+      throw std::runtime_error("CreateEpid2Params failed");
+    }
+    group = use_g2 ? params->G2 : params->G1;
+    EcPoint const* generator = use_g2 ? params->g2 : params->g1;
+    powers.resize(m);
+    bases.resize(m, nullptr);
+    for (size_t i = 0; i < m; i++) {
+      BigNumStr exp = {0};
+      for (size_t j = 1; j < sizeof(exp.data.data); j++) {
+        exp.data.data[j] = static_cast<unsigned char>(rnd());
+        powers[i].data.data[j] = static_cast<unsigned char>(rnd());
+      }
+      if (kEpidNoErr != NewEcPoint(group, &bases[i]) ||
+          kEpidNoErr != EcExp(group, generator, &exp, bases[i])) {
+        throw std::runtime_error("EcExp failed");
+      }
+    }
+    for (auto& power : powers) {
+      power_ptrs.push_back(&power);
+    }
+    for (auto base : bases) {
+      base_ptrs.push_back(base);
+    }
+    if (kEpidNoErr != NewEcPoint(group, &r)) {
+      throw std::runtime_error("NewEcPoint failed");
+    }
+  }
+  void TearDown(benchmark::State const&) override {
+    DeleteEcPoint(&r);
+    for (auto& base : bases) {
+      DeleteEcPoint(&base);
+    }
+    bases.clear();
+    base_ptrs.clear();
+    powers.clear();
+    power_ptrs.clear();
+    DeleteEpid2Params(&params);
+  }
+
+ protected:
+  Epid2Params_* params = nullptr;
+  EcGroup* group = nullptr;
+  std::vector<EcPoint*> bases;
+  std::vector<EcPoint const*> base_ptrs;
+  std::vector<BigNumStr> powers;
+  std::vector<BigNumStr const*> power_ptrs;
+  EcPoint* r = nullptr;
+};
+
+/// A random point and power in G1 or G2
+class EcExpFixture : public benchmark::Fixture {
+ public:
+  void SetUp(benchmark::State const& state) override {
+    bool use_g2 = 0 != state.range(0);
+    std::mt19937 rnd(1);
+    BigNumStr exp = {0};
+    if (kEpidNoErr != CreateEpid2Params(&params)) {
+      throw std::runtime_error("CreateEpid2Params failed");
+    }
+    group = use_g2 ? params->G2 : params->G1;
+    for (size_t j = 1; j < sizeof(exp.data.data); j++) {
+      exp.data.data[j] = static_cast<unsigned char>(rnd());
+      power.data.data[j] = static_cast<unsigned char>(rnd());
+    }
+    if (kEpidNoErr != NewEcPoint(group, &base) ||
+        kEpidNoErr != EcExp(group, use_g2 ? params->g2 : params->g1, &exp,
+                            base) ||
+        kEpidNoErr != NewEcPoint(group, &r)) {
+      throw std::runtime_error("EcExp failed");
+    }
+  }
+  void TearDown(benchmark::State const&) override {
+    DeleteEcPoint(&r);
+    DeleteEcPoint(&base);
+    DeleteEpid2Params(&params);
+  }
+
+ protected:
+  Epid2Params_* params = nullptr;
+  EcGroup* group = nullptr;
+  EcPoint* base = nullptr;
+  BigNumStr power = {0};
+  EcPoint* r = nullptr;
+};
+
+/// Term counts for G1: few terms use wNAF, the largest use buckets
+void G1Terms(benchmark::internal::Benchmark* b) {
+  for (int64_t m : {1, 2, 3, 4, 5, 8, 16, 64, 256, 1024}) {
+    b->Args({m, 0});
+  }
+}
+
+/// Term counts for G2
+void G2Terms(benchmark::internal::Benchmark* b) {
+  for (int64_t m : {1, 2, 3, 4, 5, 8}) {
+    b->Args({m, 1});
+  }
+}
+
+}  // namespace
+
+/// Shared chain of doublings
+BENCHMARK_DEFINE_F(EcMultiExpFixture, MultiExp)(benchmark::State& state) {
+  AllocCounter allocs;
+  for (auto _ : state) {
+    if (kEpidNoErr != EcMultiExp(group, base_ptrs.data(), power_ptrs.data(),
+                                 base_ptrs.size(), r)) {
+      state.SkipWithError("EcMultiExp failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  allocs.Report(state);
+}
+BENCHMARK_REGISTER_F(EcMultiExpFixture, MultiExp)
+    ->Apply(G1Terms)
+    ->Apply(G2Terms)
+    ->Unit(benchmark::kMicrosecond);
+
+/// One exponentiation per term, as done before EcMultiExp shared doublings
+BENCHMARK_DEFINE_F(EcMultiExpFixture, ExpPerTerm)(benchmark::State& state) {
+  AllocCounter allocs;
+  for (auto _ : state) {
+    if (kEpidNoErr != EcSscmMultiExp(group, base_ptrs.data(),
+                                     power_ptrs.data(), base_ptrs.size(),
+                                     r)) {
+      state.SkipWithError("EcSscmMultiExp failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  allocs.Report(state);
+}
+BENCHMARK_REGISTER_F(EcMultiExpFixture, ExpPerTerm)
+    ->Apply(G1Terms)
+    ->Apply(G2Terms)
+    ->Unit(benchmark::kMicrosecond);
+
+/// Exponentiation of a random point, range(0) selects G2
+BENCHMARK_DEFINE_F(EcExpFixture, Exp)(benchmark::State& state) {
+  AllocCounter allocs;
+  for (auto _ : state) {
+    if (kEpidNoErr != EcExp(group, base, &power, r)) {
+      state.SkipWithError("EcExp failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  allocs.Report(state);
+}
+BENCHMARK_REGISTER_F(EcExpFixture, Exp)->ArgName("g2")->Arg(0)->Arg(1);
+
+namespace {
+
+/// Hash of a random message of range(0) bytes to G1
+void EcHashG1(benchmark::State& state) {
+  Epid2Params_* params = nullptr;
+  EcPoint* r = nullptr;
+  std::vector<unsigned char> msg(static_cast<size_t>(state.range(0)));
+  std::mt19937 rnd(2);
+  for (auto& byte : msg) {
+    byte = static_cast<unsigned char>(rnd());
+  }
+  if (kEpidNoErr != CreateEpid2Params(&params) ||
+      kEpidNoErr != NewEcPoint(params->G1, &r)) {
+    throw std::runtime_error("NewEcPoint failed");
+  }
+  AllocCounter allocs;
+  for (auto _ : state) {
+    if (kEpidNoErr !=
+        EcHash(params->G1, msg.data(), msg.size(), kSha256, r)) {
+      state.SkipWithError("EcHash failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+  allocs.Report(state);
+  DeleteEcPoint(&r);
+  DeleteEpid2Params(&params);
+}
+
+}  // namespace
+
+BENCHMARK(EcHashG1)->ArgName("msg_len")->Arg(32)->Arg(1024)->Arg(64 * 1024);
@@ -0,0 +1,174 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+/*!
+ * \file
+ * \brief FiniteField benchmarks.
+ */
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "epid/common/math/benchmarks/alloc_counter-bench.h"
+
+extern "C" {
+#include "epid/common/math/bignum.h"
+#include "epid/common/math/finitefield.h"
+#include "epid/common/src/epid2params.h"
+}
+
+namespace {
+
+/// Random elements of GT and powers for exponentiation
+class GtExpFixture : public benchmark::Fixture {
+ public:
+  void SetUp(benchmark::State const& state) override {
+    size_t m = static_cast<size_t>(state.range(0));
+    std::mt19937 rnd(static_cast<std::mt19937::result_type>(m));
+    if (kEpidNoErr != CreateEpid2Params(&params)) {
+      throw std::runtime_error("CreateEpid2Params failed");
+    }
+    powers.resize(m);
+    bases.resize(m, nullptr);
+    for (size_t i = 0; i < m; i++) {
+      Fq12ElemStr elem = {0};
+      // random coefficients below 2^248 are always reduced
+      for (auto& fq6 : elem.a) {
+        for (auto& fq2 : fq6.a) {
+          for (auto& fq : fq2.a) {
+            RandomBytes(&rnd, &fq, sizeof(fq));
+          }
+        }
+      }
+      RandomBytes(&rnd, &powers[i], sizeof(powers[i]));
+      if (kEpidNoErr != NewFfElement(params->GT, &bases[i]) ||
+          kEpidNoErr !=
+              ReadFfElement(params->GT, &elem, sizeof(elem), bases[i])) {
+        throw std::runtime_error("ReadFfElement failed");
+      }
+    }
+    for (auto& power : powers) {
+      power_ptrs.push_back(&power);
+    }
+    for (auto base : bases) {
+      base_ptrs.push_back(base);
+    }
+    if (kEpidNoErr != NewBigNum(sizeof(BigNumStr), &power_bn) ||
+        kEpidNoErr != ReadBigNum(&powers[0], sizeof(powers[0]), power_bn) ||
+        kEpidNoErr != NewFfElement(params->GT, &r)) {
+      throw std::runtime_error("NewFfElement failed");
+    }
+  }
+  void TearDown(benchmark::State const&) override {
+    DeleteFfElement(&r);
+    DeleteBigNum(&power_bn);
+    for (auto& base : bases) {
+      DeleteFfElement(&base);
+    }
+    bases.clear();
+    base_ptrs.clear();
+    powers.clear();
+    power_ptrs.clear();
+    DeleteEpid2Params(&params);
+  }
+
+ protected:
+  Epid2Params_* params = nullptr;
+  std::vector<FfElement*> bases;
+  std::vector<FfElement const*> base_ptrs;
+  std::vector<BigNumStr> powers;
+  std::vector<BigNumStr const*> power_ptrs;
+  BigNum* power_bn = nullptr;
+  FfElement* r = nullptr;
+
+ private:
+  /// Fills all but the most significant byte of a big-endian buffer
+  static void RandomBytes(std::mt19937* rnd, void* buf, size_t size) {
+    unsigned char* bytes = static_cast<unsigned char*>(buf);
+    for (size_t i = 1; i < size; i++) {
+      bytes[i] = static_cast<unsigned char>((*rnd)());
+    }
+  }
+};
+
+/// Hash of a random message of range(0) bytes to Fp
+void FfHashFp(benchmark::State& state) {
+  Epid2Params_* params = nullptr;
+  FfElement* r = nullptr;
+  std::vector<unsigned char> msg(static_cast<size_t>(state.range(0)));
+  std::mt19937 rnd(2);
+  for (auto& byte : msg) {
+    byte = static_cast<unsigned char>(rnd());
+  }
+  if (kEpidNoErr != CreateEpid2Params(&params) ||
+      kEpidNoErr != NewFfElement(params->Fp, &r)) {
+    throw std::runtime_error("NewFfElement failed");
+  }
+  AllocCounter allocs;
+  for (auto _ : state) {
+    if (kEpidNoErr !=
+        FfHash(params->Fp, msg.data(), msg.size(), kSha256, r)) {
+      state.SkipWithError("FfHash failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+  allocs.Report(state);
+  DeleteFfElement(&r);
+  DeleteEpid2Params(&params);
+}
+
+}  // namespace
+
+/// Exponentiation of a random element of GT
+BENCHMARK_DEFINE_F(GtExpFixture, Exp)(benchmark::State& state) {
+  AllocCounter allocs;
+  for (auto _ : state) {
+    if (kEpidNoErr != FfExp(params->GT, bases[0], power_bn, r)) {
+      state.SkipWithError("FfExp failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  allocs.Report(state);
+}
+BENCHMARK_REGISTER_F(GtExpFixture, Exp)->Arg(1);
+
+/// Multi-exponentiation of range(0) random elements of GT
+BENCHMARK_DEFINE_F(GtExpFixture, MultiExp)(benchmark::State& state) {
+  AllocCounter allocs;
+  for (auto _ : state) {
+    if (kEpidNoErr != FfMultiExp(params->GT, base_ptrs.data(),
+                                 power_ptrs.data(), base_ptrs.size(), r)) {
+      state.SkipWithError("FfMultiExp failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  allocs.Report(state);
+}
+BENCHMARK_REGISTER_F(GtExpFixture, MultiExp)
+    ->ArgName("terms")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(3)
+    ->Arg(4);
+
+BENCHMARK(FfHashFp)->ArgName("msg_len")->Arg(32)->Arg(1024)->Arg(64 * 1024);
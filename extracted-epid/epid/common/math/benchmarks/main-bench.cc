@@ -0,0 +1,39 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+/*!
+ * \file
+ * \brief Main entry point for benchmarks.
+ *
+ * Besides the time per operation, each benchmark reports allocs_per_op
+ * and, where it makes sense, items_per_second. Run with
+ * --benchmark_format=json or --benchmark_out=<file> to get the results
+ * as JSON for comparison across commits.
+ */
+
+#include "benchmark/benchmark.h"
+
+#include "epid/common/math/benchmarks/alloc_counter-bench.h"
+
+int main(int argc, char** argv) {
+  InstallAllocCounter();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
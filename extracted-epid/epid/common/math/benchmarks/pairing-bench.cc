@@ -0,0 +1,161 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+/*!
+ * \file
+ * \brief Pairing benchmarks.
+ */
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "epid/common/math/benchmarks/alloc_counter-bench.h"
+
+extern "C" {
+#include "epid/common/math/ecgroup.h"
+#include "epid/common/math/finitefield.h"
+#include "epid/common/math/pairing.h"
+#include "epid/common/src/epid2params.h"
+}
+
+namespace {
+
+/// Random pairs of points in G1 and G2 and a pairing state
+class PairingFixture : public benchmark::Fixture {
+ public:
+  void SetUp(benchmark::State const& state) override {
+    size_t n = static_cast<size_t>(state.range(0));
+    std::mt19937 rnd(static_cast<std::mt19937::result_type>(n));
+    BigNumStr t = {0};
+    if (kEpidNoErr != CreateEpid2Params(&params) ||
+        kEpidNoErr != WriteBigNum(params->t, sizeof(t), &t) ||
+        kEpidNoErr != NewPairingState(params->G1, params->G2, params->GT, &t,
+                                      params->neg, &ps)) {
+      throw std::runtime_error("NewPairingState failed");
+    }
+    a.resize(n, nullptr);
+    b.resize(n, nullptr);
+    for (size_t i = 0; i < n; i++) {
+      BigNumStr exp = {0};
+      for (size_t j = 1; j < sizeof(exp.data.data); j++) {
+        exp.data.data[j] = static_cast<unsigned char>(rnd());
+      }
+      if (kEpidNoErr != NewEcPoint(params->G1, &a[i]) ||
+          kEpidNoErr != EcExp(params->G1, params->g1, &exp, a[i]) ||
+          kEpidNoErr != NewEcPoint(params->G2, &b[i]) ||
+          kEpidNoErr != EcExp(params->G2, params->g2, &exp, b[i])) {
+        throw std::runtime_error("EcExp failed");
+      }
+    }
+    a_ptrs.assign(a.begin(), a.end());
+    b_ptrs.assign(b.begin(), b.end());
+    if (kEpidNoErr != NewFfElement(params->GT, &d)) {
+      throw std::runtime_error("NewFfElement failed");
+    }
+  }
+  void TearDown(benchmark::State const&) override {
+    DeleteFfElement(&d);
+    for (auto& point : a) {
+      DeleteEcPoint(&point);
+    }
+    for (auto& point : b) {
+      DeleteEcPoint(&point);
+    }
+    a.clear();
+    b.clear();
+    a_ptrs.clear();
+    b_ptrs.clear();
+    DeletePairingState(&ps);
+    DeleteEpid2Params(&params);
+  }
+
+ protected:
+  Epid2Params_* params = nullptr;
+  PairingState* ps = nullptr;
+  std::vector<EcPoint*> a;
+  std::vector<EcPoint*> b;
+  std::vector<EcPoint const*> a_ptrs;
+  std::vector<EcPoint const*> b_ptrs;
+  FfElement* d = nullptr;
+};
+
+}  // namespace
+
+/// One pairing, Miller loop and final exponentiation
+BENCHMARK_DEFINE_F(PairingFixture, Pairing)(benchmark::State& state) {
+  AllocCounter allocs;
+  for (auto _ : state) {
+    if (kEpidNoErr != Pairing(ps, d, a[0], b[0])) {
+      state.SkipWithError("Pairing failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  allocs.Report(state);
+}
+BENCHMARK_REGISTER_F(PairingFixture, Pairing)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
+
+/// Product of range(0) pairings
+/*!
+ The pairs share one final exponentiation, so the time of FinalExp is
+ the time for one pair less the increment per additional pair.
+*/
+BENCHMARK_DEFINE_F(PairingFixture, MultiPairing)(benchmark::State& state) {
+  AllocCounter allocs;
+  for (auto _ : state) {
+    if (kEpidNoErr !=
+        MultiPairing(ps, d, a_ptrs.data(), b_ptrs.data(), a_ptrs.size())) {
+      state.SkipWithError("MultiPairing failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  allocs.Report(state);
+}
+BENCHMARK_REGISTER_F(PairingFixture, MultiPairing)
+    ->ArgName("pairs")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMicrosecond);
+
+/// One pairing with the lines of the G2 point computed in advance
+BENCHMARK_DEFINE_F(PairingFixture, PairingWithPrecomp)
+(benchmark::State& state) {
+  PairingPrecomputedG2* pre = nullptr;
+  if (kEpidNoErr != NewPairingPrecomputedG2(ps, b[0], &pre)) {
+    state.SkipWithError("NewPairingPrecomputedG2 failed");
+    return;
+  }
+  AllocCounter allocs;
+  for (auto _ : state) {
+    if (kEpidNoErr != PairingWithPrecomp(ps, d, a[0], pre)) {
+      state.SkipWithError("PairingWithPrecomp failed");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  allocs.Report(state);
+  DeletePairingPrecomputedG2(&pre);
+}
+BENCHMARK_REGISTER_F(PairingFixture, PairingWithPrecomp)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
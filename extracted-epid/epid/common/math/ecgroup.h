@@ -159,6 +159,51 @@ EpidStatus ReadEcPoint(EcGroup* g, void const* p_str, size_t strlen,
 EpidStatus WriteEcPoint(EcGroup* g, EcPoint const* p, void* p_str,
                         size_t strlen);
 
+/// Converts EcPoints to affine coordinates.
+/*!
+ Points are kept in projective coordinates and converted to affine ones
+ every time they are serialized, at the cost of a field inversion each.
+ This converts all of them with a single inversion, after which
+ WriteEcPoint() is cheap for each point. The value of the points does not
+ change.
+
+ \param[in] g
+ The elliptic curve group.
+ \param[in,out] p
+ The EcPoints to convert.
+ \param[in] count
+ The number of points in p.
+
+ \returns ::EpidStatus
+
+ \see WriteEcPointBatch
+*/
+EpidStatus EcBatchToAffine(EcGroup* g, EcPoint** p, size_t count);
+
+/// Serializes EcPoints to consecutive strings.
+/*!
+ Same as calling WriteEcPoint() for each point, but the conversions to
+ affine coordinates share a single field inversion.
+
+ \param[in] g
+ The elliptic curve group.
+ \param[in] p
+ The EcPoints to be serialized.
+ \param[in] count
+ The number of points in p.
+ \param[out] p_str
+ The target strings, must hold count * strlen bytes.
+ \param[in] strlen
+ The size in bytes of the string of each point.
+
+ \returns ::EpidStatus
+
+ \see WriteEcPoint
+ \see EcBatchToAffine
+*/
+EpidStatus WriteEcPointBatch(EcGroup* g, EcPoint const** p, size_t count,
+                             void* p_str, size_t strlen);
+
 /// Multiplies two elements in an elliptic curve group.
 /*!
  This multiplication operation is also known as element addition for
@@ -237,6 +282,10 @@ EpidStatus EcSscmExp(EcGroup* g, EcPoint const* a, BigNumStr const* b,
  integers b[0], ..., b[m-1], where m is a small positive integer.
  Outputs r (in G) = EcExp(a[0],b[0]) * ... * EcExp(a[m-1],b[m-1]).
 
+ All terms share one chain of doublings: interleaved signed windows are
+ used for few terms and bucket accumulation for many. The time taken
+ depends on the powers, so use EcSscmMultiExp if they are secret.
+
  \param[in] g
  The elliptic curve group.
  \param[in] a
@@ -264,6 +313,8 @@ Takes a group elements a[0], ... , a[m-1] in G and positive
 integers b[0], ..., b[m-1], where m is a small positive integer.
 Outputs r (in G) = EcExp(a[0],b[0]) * ... * EcExp(a[m-1],b[m-1]).
 
+The time taken depends on the powers, see EcMultiExp.
+
 \param[in] g
 The elliptic curve group.
 \param[in] a
@@ -292,11 +343,11 @@ EpidStatus EcMultiExpBn(EcGroup* g, EcPoint const** a, BigNum const** b,
  Outputs r (in G) = EcExp(a[0],b[0]) * ... * EcExp(a[m-1],b[m-1]).
 
  \attention
- The reference implementation of EcSscmMultiExp calls EcMultiExp
- directly because the implementation of EcMultiExp is already side channel
- mitigated. Implementers providing their own versions of this function are
- responsible for ensuring that EcSscmMultiExp is side channel mitigated per
- section 8 of the Intel(R) EPID 2.0 spec.
+ The reference implementation of EcSscmMultiExp does one EcExp per term
+ instead of sharing a chain of doublings like EcMultiExp, because the work
+ done by EcMultiExp depends on the powers. Implementers providing their own
+ versions of this function are responsible for ensuring that EcSscmMultiExp
+ is side channel mitigated per section 8 of the Intel(R) EPID 2.0 spec.
 
  \param[in] g
  The elliptic curve group.
@@ -319,6 +370,96 @@ EpidStatus EcMultiExpBn(EcGroup* g, EcPoint const** a, BigNum const** b,
 EpidStatus EcSscmMultiExp(EcGroup* g, EcPoint const** a, BigNumStr const** b,
                           size_t m, EcPoint* r);
 
+/// Pre-computed multiples of a fixed elliptic curve group element.
+typedef struct EcFixedBaseTable EcFixedBaseTable;
+
+/// Creates a pre-computed table for exponentiation of a fixed base.
+/*!
+ The table holds the odd multiples 1, 3, ..., 15 of the base and their
+ inverses for every 4-bit window of a 256-bit power, so that EcExpFixedBase
+ needs one group multiplication per window and no doublings. Building it
+ costs roughly as much as 8 calls to EcExp, so it pays off for bases that
+ are raised to many powers, such as group generators.
+
+ The table is 64 KiB for G1 and 128 KiB for G2 and does not depend on g
+ other than through its parameters; it can be shared by all users of g.
+
+ \param[in] g
+ The elliptic curve group.
+ \param[in] base
+ The base.
+ \param[out] table
+ Newly constructed table.
+
+ \returns ::EpidStatus
+
+ \see DeleteEcFixedBaseTable
+ \see EcExpFixedBase
+*/
+EpidStatus NewEcFixedBaseTable(EcGroup* g, EcPoint const* base,
+                               EcFixedBaseTable** table);
+
+/// Deletes a previously allocated EcFixedBaseTable.
+/*!
+ Frees memory pointed to by table. Nulls the pointer.
+
+ \param[in] table
+ The table. Can be NULL.
+
+ \see NewEcFixedBaseTable
+*/
+void DeleteEcFixedBaseTable(EcFixedBaseTable** table);
+
+/// Raises a fixed base to a power using a pre-computed table.
+/*!
+ Computes the same result as EcExp for the base the table was created
+ from. The power is recoded into signed odd digits so that the same
+ sequence of group operations and table reads is performed for every
+ power.
+
+ \param[in] g
+ The elliptic curve group the table was created for.
+ \param[in] table
+ The pre-computed table of the base.
+ \param[in] b
+ The power. Power must be less than the order of the elliptic curve
+ group.
+ \param[out] r
+ The result of raising the base to the power b.
+
+ \returns ::EpidStatus
+
+ \see NewEcFixedBaseTable
+ \see EcExp
+*/
+EpidStatus EcExpFixedBase(EcGroup* g, EcFixedBaseTable const* table,
+                          BigNumStr const* b, EcPoint* r);
+
+/// Raises a point to many powers.
+/*!
+ Computes r[i] = EcExp(a, b[i]) for every i. For large enough batches a
+ fixed-base table of a is built and shared by all powers, and the results
+ are converted to affine coordinates together, see EcBatchToAffine.
+
+ \param[in] g
+ The elliptic curve group.
+ \param[in] a
+ The base.
+ \param[in] b
+ The powers.
+ \param[in] count
+ Number of entries in b and r.
+ \param[out] r
+ The results of raising a to each power in b.
+
+ \returns ::EpidStatus
+
+ \see EcExp
+ \see EcExpFixedBase
+*/
+EpidStatus EcExpBatch(EcGroup* g, EcPoint const* a, BigNumStr const** b,
+                      size_t count, EcPoint** r);
+
 /// Generates a random element from an elliptic curve group.
 /*!
  This function is only available for G1 and GT.
@@ -159,6 +159,43 @@ EpidStatus NewFfElement(FiniteField const* ff, FfElement** new_ff_elem);
 */
 void DeleteFfElement(FfElement** ff_elem);
 
+/// Creates several new finite field elements in one memory block.
+/*!
+ Allocates a single block of memory holding count new finite field
+ elements, each followed by its internal state, so that elements used
+ together are also stored together.
+
+ The elements can only be freed together with DeleteFfElements(); they
+ must not be passed to DeleteFfElement().
+
+ \param[in] ff
+ The finite field.
+ \param[out] new_ff_elems
+ The newly constructed finite field elements. Must have room for count
+ pointers.
+ \param[in] count
+ Number of elements to create. Must be positive.
+
+ \returns ::EpidStatus
+
+ \see DeleteFfElements
+*/
+EpidStatus NewFfElements(FiniteField const* ff, FfElement** new_ff_elems,
+                         size_t count);
+
+/// Frees finite field elements allocated by NewFfElements.
+/*!
+ Frees the memory block of the elements. Nulls the pointers.
+
+ \param[in] ff_elems
+ The finite field elements, as returned by NewFfElements. Can be NULL.
+ \param[in] count
+ Number of elements passed to NewFfElements.
+
+ \see NewFfElements
+*/
+void DeleteFfElements(FfElement** ff_elems, size_t count);
+
 /// Deserializes a FfElement from a string.
 /*!
  \param[in] ff
@@ -247,6 +284,27 @@ EpidStatus FfNeg(FiniteField* ff, FfElement const* a, FfElement* r);
  */
 EpidStatus FfInv(FiniteField* ff, FfElement const* a, FfElement* r);
 
+/// Calculates the multiplicative inverses of finite field elements.
+/*!
+ Same as calling FfInv() for each element, but uses a single inversion
+ and three multiplications per element.
+
+ \param[in] ff
+ The finite field.
+ \param[in] a
+ The elements. None of them may be zero.
+ \param[in] count
+ Number of entries in a and r.
+ \param[out] r
+ The inverted elements. Must not be any of the elements of a.
+
+ \returns ::EpidStatus
+
+ \see FfInv
+ */
+EpidStatus FfInvBatch(FiniteField* ff, FfElement const** a, size_t count,
+                      FfElement** r);
+
 /// Adds two finite field elements.
 /*!
  \param[in] ff
@@ -337,6 +395,70 @@ EpidStatus FfIsZero(FiniteField* ff, FfElement const* a, bool* is_zero);
 EpidStatus FfExp(FiniteField* ff, FfElement const* a, BigNum const* b,
                  FfElement* r);
 
+/// Scratch memory for finite field exponentiation.
+typedef struct FfExpScratch FfExpScratch;
+
+/// Creates scratch memory for finite field exponentiation.
+/*!
+ FfExp() allocates its working memory on every call. Scratch memory can be
+ passed to FfExpBatch() instead and reused across calls, but not by calls
+ made at the same time.
+
+ Use DeleteFfExpScratch() to free memory.
+
+ \param[in] ff
+ The finite field.
+ \param[in] exp_bits
+ The largest size in bits of the powers the scratch memory is used for.
+ \param[out] scratch
+ Newly constructed scratch memory.
+
+ \returns ::EpidStatus
+
+ \see DeleteFfExpScratch
+ \see FfExpBatch
+ */
+EpidStatus NewFfExpScratch(FiniteField* ff, size_t exp_bits,
+                           FfExpScratch** scratch);
+
+/// Deletes scratch memory for finite field exponentiation.
+/*!
+ Frees memory pointed to by scratch. Nulls the pointer.
+
+ \param[in] scratch
+ The scratch memory. Can be NULL.
+
+ \see NewFfExpScratch
+ */
+void DeleteFfExpScratch(FfExpScratch** scratch);
+
+/// Raises elements of a finite field to powers.
+/*!
+ Same as calling FfExp() for each element, with the working memory taken
+ from scratch.
+
+ \param[in] ff
+ The finite field in which to perform the operation
+ \param[in] a
+ The bases.
+ \param[in] b
+ The powers.
+ \param[in] count
+ Number of entries in a, b and r.
+ \param[in] scratch
+ Scratch memory large enough for all powers in b. If NULL it is allocated
+ once for all powers.
+ \param[out] r
+ The results of raising each a to the corresponding power b.
+
+ \returns ::EpidStatus
+
+ \see FfExp
+ \see NewFfExpScratch
+ */
+EpidStatus FfExpBatch(FiniteField* ff, FfElement const** a, BigNum const** b,
+                      size_t count, FfExpScratch* scratch, FfElement** r);
+
 /// Multi-exponentiates finite field elements.
 /*!
  Calculates FfExp(p[0],b[0]) * ... * FfExp(p[m-1],b[m-1]) for m > 1
@@ -457,6 +579,111 @@ EpidStatus FfIsEqual(FiniteField* ff, FfElement const* a, FfElement const* b,
 EpidStatus FfHash(FiniteField* ff, void const* msg, size_t msg_len,
                   HashAlg hash_alg, FfElement* r);
 
+/// State of an incremental hash to a finite field element.
+typedef struct FfHashState FfHashState;
+
+/// Creates state for an incremental hash to a finite field element.
+/*!
+ FfHash() needs the whole message in one buffer. A message that is
+ assembled from several parts can instead be absorbed part by part with
+ FfHashUpdate(), hashing to the same element without copying the parts
+ together.
+
+ Use DeleteFfHashState() to free memory.
+
+ \param[out] state
+ Newly constructed hash state. Must be initialized with FfHashInit()
+ before use.
+
+ \returns ::EpidStatus
+
+ \see DeleteFfHashState
+ \see FfHashInit
+ */
+EpidStatus NewFfHashState(FfHashState** state);
+
+/// Deletes state for an incremental hash to a finite field element.
+/*!
+ Frees memory pointed to by state. Nulls the pointer.
+
+ \param[in] state
+ The hash state. Can be NULL.
+
+ \see NewFfHashState
+ */
+void DeleteFfHashState(FfHashState** state);
+
+/// Starts an incremental hash to a finite field element.
+/*!
+ \param[in] hash_alg
+ The hash algorithm.
+ \param[in,out] state
+ The hash state. Any message absorbed so far is discarded.
+
+ \returns ::EpidStatus
+
+ \see FfHashUpdate
+ \see FfHashFinal
+ */
+EpidStatus FfHashInit(HashAlg hash_alg, FfHashState* state);
+
+/// Absorbs the next part of a message into an incremental hash.
+/*!
+ \param[in,out] state
+ The hash state.
+ \param[in] msg
+ The next part of the message. Can be NULL if msg_len is 0.
+ \param[in] msg_len
+ The size of msg in bytes.
+
+ \returns ::EpidStatus
+
+ \see FfHashInit
+ \see FfHashFinal
+ */
+EpidStatus FfHashUpdate(FfHashState* state, void const* msg, size_t msg_len);
+
+/// Copies the state of an incremental hash.
+/*!
+ Lets a message prefix that is shared by many messages be absorbed
+ once: the copy continues from where src is, and both states can then
+ absorb different parts independently.
+
+ \param[in] src
+ The hash state to copy. Must have been initialized with FfHashInit().
+ \param[out] dst
+ The copy.
+
+ \returns ::EpidStatus
+
+ \see FfHashInit
+ \see FfHashUpdate
+ */
+EpidStatus FfHashStateCopy(FfHashState const* src, FfHashState* dst);
+
+/// Finishes an incremental hash to a finite field element.
+/*!
+ The result is the one FfHash() gives for the concatenation of every
+ part absorbed since FfHashInit() or the previous FfHashFinal(). The
+ state is then ready to absorb a new message with the same hash
+ algorithm.
+
+ Like FfHash(), fails if the message is empty.
+
+ \param[in] ff
+ The finite field. Must be a prime field.
+ \param[in,out] state
+ The hash state.
+ \param[out] r
+ The hashed value.
+
+ \returns ::EpidStatus
+
+ \see FfHashInit
+ \see FfHash
+ */
+EpidStatus FfHashFinal(FiniteField* ff, FfHashState* state, FfElement* r);
+
 /// Generate random finite field element.
 /*!
  \param[in] ff
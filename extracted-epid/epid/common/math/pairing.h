@@ -40,10 +40,17 @@
 /// A pairing
 typedef struct PairingState PairingState;
 
+/// Line functions of the Miller loop for a fixed second pairing parameter
+typedef struct PairingPrecomputedG2 PairingPrecomputedG2;
+
 /// Constructs a new pairing state.
 /*!
  Allocates memory and creates a new pairing state for Optimal Ate Pairing.
 
+ The pairing state holds the temporaries of the pairing operations, so
+ computing a pairing does not allocate memory. As a consequence a pairing
+ state must not be used by more than one thread at a time.
+
  Use DeletePairingState() to free memory.
 
  \param[in] ga
@@ -68,6 +75,42 @@ EpidStatus NewPairingState(EcGroup const* ga, EcGroup const* gb,
                            FiniteField* ff, BigNumStr const* t, bool neg,
                            PairingState** ps);
 
+/// Constructs a new pairing state from precomputed constants.
+/*!
+ Same as NewPairingState(), except that the constants g[i][j] of the
+ Frobenius operations, which only depend on the fields, are read from
+ frob instead of computed. This saves an exponentiation in Fq2 for
+ parameters known in advance.
+
+ \param[in] ga
+ The EcGroup from which the first parameter of the pairing is taken.
+ \param[in] gb
+ The EcGroup from which the second parameter of the pairing is taken.
+ \param[in] ff
+ The result finite field. Must be a Fq12 field.
+ \param[in] t
+ A positive integer such that 6(t^2) == q - p, where p and q are parameters
+ of G1.
+ \param[in] neg
+ Select the alternate "negate" processing path for Optimal Ate Pairing.
+ \param[in] frob
+ The 15 serialized elements g[0][0], ..., g[0][4], g[1][0], ..., g[2][4]
+ of Fq2, where g[0][j] = xi^((j + 1)(q - 1)/6), g[1][j] = g[0][j] *
+ conjugate(g[0][j]) and g[2][j] = g[0][j] * g[1][j]. If NULL they are
+ computed.
+ \param[out] ps
+ Newly constructed pairing state.
+
+ \returns ::EpidStatus
+
+ \see NewPairingState
+ \see DeletePairingState
+*/
+EpidStatus NewPairingStateWithConstants(EcGroup const* ga, EcGroup const* gb,
+                                        FiniteField* ff, BigNumStr const* t,
+                                        bool neg, Fq2ElemStr const* frob,
+                                        PairingState** ps);
+
 /// Frees a previously allocated by PairingState.
 /*!
  Frees memory pointed to by pairing state. Nulls the pointer.
@@ -95,6 +138,94 @@ void DeletePairingState(PairingState** ps);
 EpidStatus Pairing(PairingState* ps, FfElement* d, EcPoint const* a,
                    EcPoint const* b);
 
+/// Computes the product of Optimal Ate Pairings of several pairs.
+/*!
+ Computes d = Pairing(a[0], b[0]) * ... * Pairing(a[n-1], b[n-1]).
+
+ The Miller loops of all pairs are run together so that the accumulator
+ is squared once per iteration, and the final exponentiation is done once
+ for the product. This is considerably cheaper than n calls to Pairing.
+
+ A quotient of pairings can be computed by negating one of the points of
+ the pairs in the denominator.
+
+ \param[in] ps
+ The pairing state.
+ \param[out] d
+ The product of the pairings. Will be in ff used to create the pairing
+ state.
+ \param[in] a
+ The first values to pair. Must be in ga used to create ps.
+ \param[in] b
+ The second values to pair. Must be in gb used to create ps.
+ \param[in] n
+ Number of entries in a and b.
+
+ \returns ::EpidStatus
+
+ \see Pairing
+*/
+EpidStatus MultiPairing(PairingState* ps, FfElement* d, EcPoint const** a,
+                        EcPoint const** b, size_t n);
+
+/// Precomputes the Miller loop line functions of a fixed G2 point.
+/*!
+ Records the coefficients of every tangent and line function that the
+ Miller loop of the Optimal Ate Pairing derives from b. Pairing with
+ PairingWithPrecomp() then only evaluates these lines at the first
+ parameter, so the G2 half of the Miller loop is paid once per b rather
+ than once per pairing.
+
+ Use DeletePairingPrecomputedG2() to free memory.
+
+ \param[in] ps
+ The pairing state. The precomputed lines may only be used with this
+ pairing state.
+ \param[in] b
+ The second value to pair. Must be in gb used to create ps.
+ \param[out] pre
+ Newly constructed line functions of b.
+
+ \returns ::EpidStatus
+
+ \see DeletePairingPrecomputedG2
+ \see PairingWithPrecomp
+*/
+EpidStatus NewPairingPrecomputedG2(PairingState* ps, EcPoint const* b,
+                                   PairingPrecomputedG2** pre);
+
+/// Frees line functions allocated by NewPairingPrecomputedG2.
+/*!
+ Frees memory pointed to by pre. Nulls the pointer.
+
+ \param[in] pre
+ The precomputed line functions. Can be NULL.
+
+ \see NewPairingPrecomputedG2
+*/
+void DeletePairingPrecomputedG2(PairingPrecomputedG2** pre);
+
+/// Computes an Optimal Ate Pairing with a precomputed second parameter.
+/*!
+ Gives the same result as Pairing() for the point b was precomputed from.
+
+ \param[in] ps
+ The pairing state.
+ \param[out] d
+ The result of the pairing. Will be in ff used to create the pairing state.
+ \param[in] a
+ The first value to pair. Must be in ga used to create ps.
+ \param[in] b
+ The line functions of the second value to pair. Must be created with ps.
+
+ \returns ::EpidStatus
+
+ \see NewPairingPrecomputedG2
+ \see Pairing
+*/
+EpidStatus PairingWithPrecomp(PairingState* ps, FfElement* d, EcPoint const* a,
+                              PairingPrecomputedG2 const* b);
+
 /*!
   @}
 */
@@ -22,8 +22,17 @@
 #ifndef EPID_COMMON_MATH_SRC_ECGROUP_INTERNAL_H_
 #define EPID_COMMON_MATH_SRC_ECGROUP_INTERNAL_H_
 
+#include "epid/common/stdtypes.h"
+#include "epid/common/math/ecgroup.h"
 #include "ext/ipp/include/ippcpepid.h"
 
+/// EcGroup::ipp_layout before the layout of ipp points has been checked
+#define EC_IPP_LAYOUT_UNCHECKED 0
+/// EcGroup::ipp_layout when ipp points can be read directly
+#define EC_IPP_LAYOUT_VALID 1
+/// EcGroup::ipp_layout when ipp points must be read through the ipp API
+#define EC_IPP_LAYOUT_INVALID 2
+
 /// Elpitic Curve Group
 struct EcGroup {
   /// Internal implementation of elliptic curve group
@@ -32,13 +41,71 @@ struct EcGroup {
   Ipp8u* scratch_buffer;
   /// Information about finite field of elliptic curve group created
   IppsGFpInfo info;
+  /// Whether the batch conversions may read ipp point contexts directly,
+  /// one of the EC_IPP_LAYOUT_ values
+  int ipp_layout;
+  /// Context identifier of the ipp points of the group, once checked
+  int ipp_point_id;
 };
 
 /// Elpitic Curve Point
+/*!
+ The ipp context is stored in the same memory block, EC_POINT_CTX_OFFSET
+ bytes after the start of the structure.
+*/
 struct EcPoint {
   /// Internal implementation of elliptic curve point
   IppsGFpECPoint* ipp_ec_pt;
   /// Information about finite field element of elliptic curve group created
   IppsGFpInfo info;
 };
+
+/// Deserializes an EcPoint without checking that it is in the group
+/*!
+ Only for points known to be valid, such as compiled in constants; use
+ ReadEcPoint() for anything else. The checks of ReadEcPoint() include a
+ multiplication by the group order, which is expensive in G2.
+
+ \param[in] g
+ The eliptic curve group.
+ \param[in] p_str
+ The serialized value.
+ \param[in] strlen
+ The size of p_str in bytes.
+ \param[out] p
+ The target EcPoint.
+
+ \returns ::EpidStatus
+
+ \see ReadEcPoint
+*/
+EpidStatus ReadEcPointUnchecked(EcGroup* g, void const* p_str, size_t strlen,
+                                EcPoint* p);
+
+/// Offset of the ipp context of an EcPoint from the start of the point
+#define EC_POINT_CTX_OFFSET ((sizeof(EcPoint) + 15) & ~(size_t)15)
+
+/// Number of bits in a window of a fixed-base table
+#define EC_FIXED_BASE_WINDOW_BITS 4
+/// Number of windows in a fixed-base table, enough for a 256-bit power
+#define EC_FIXED_BASE_NUM_WINDOWS 64
+/// Number of points in a window of a fixed-base table
+#define EC_FIXED_BASE_WINDOW_SIZE (1 << EC_FIXED_BASE_WINDOW_BITS)
+
+/// Pre-computed multiples of a fixed elliptic curve group element
+/*!
+ Points are stored as serialized affine coordinates x || y. Window i holds
+ d * 16^i * base at index (d + 15) / 2 for odd d in [-15, 15]. The windows
+ are followed by 16^64 * base, -base and -2 * base.
+*/
+struct EcFixedBaseTable {
+  /// Serialized points
+  Ipp8u* points;
+  /// Size of a serialized point in bytes
+  size_t point_size;
+  /// Whether the base is the point at infinity
+  bool base_is_identity;
+  /// Information about finite field of elliptic curve group created
+  IppsGFpInfo info;
+};
 #endif  // EPID_COMMON_MATH_SRC_ECGROUP_INTERNAL_H_
@@ -24,6 +24,7 @@
 #include "epid/common/math/src/ecgroup-internal.h"
 #include "epid/common/math/ecgroup.h"
 #include "epid/common/math/src/finitefield-internal.h"
+#include "epid/common/math/src/stats-internal.h"
 #include "epid/common/math/hash.h"
 #include "epid/common/src/memory.h"
 #include "epid/common/src/endian_convert.h"
@@ -183,8 +184,8 @@ void DeleteEcGroup(EcGroup** g) {
 
 EpidStatus NewEcPoint(EcGroup const* g, EcPoint** p) {
   EpidStatus result = kEpidErr;
-  IppsGFpECPoint* ec_pt_context = NULL;
   EcPoint* ecpoint = NULL;
+  EPID_MATH_STAT_START(start);
   do {
     IppStatus sts = ippStsNoErr;
     int sizeInBytes = 0;
@@ -205,14 +206,16 @@ EpidStatus NewEcPoint(EcGroup const* g, EcPoint** p) {
       result = kEpidMathErr;
       break;
     }
-    // allocate memory
-    ec_pt_context = (IppsGFpECPoint*)SAFE_ALLOC(sizeInBytes);
-    if (!ec_pt_context) {
+    // allocate memory for the point followed by its context
+    ecpoint = (EcPoint*)SAFE_ALLOC(EC_POINT_CTX_OFFSET + sizeInBytes);
+    if (!ecpoint) {
       result = kEpidMemAllocErr;
       break;
     }
+    ecpoint->ipp_ec_pt =
+        (IppsGFpECPoint*)((Ipp8u*)ecpoint + EC_POINT_CTX_OFFSET);
     // Initialize
-    sts = ippsGFpECPointInit(NULL, NULL, ec_pt_context, g->ipp_ec);
+    sts = ippsGFpECPointInit(NULL, NULL, ecpoint->ipp_ec_pt, g->ipp_ec);
     if (ippStsContextMatchErr == sts) {
       result = kEpidBadArgErr;
       break;
@@ -220,69 +223,34 @@ EpidStatus NewEcPoint(EcGroup const* g, EcPoint** p) {
       result = kEpidMathErr;
       break;
     }
-    ecpoint = SAFE_ALLOC(sizeof(EcPoint));
-    if (!ecpoint) {
-      result = kEpidMemAllocErr;
-      break;
-    }
     ecpoint->info = g->info;
-    ecpoint->ipp_ec_pt = ec_pt_context;
     *p = ecpoint;
     result = kEpidNoErr;
   } while (0);
   if (kEpidNoErr != result) {
-    SAFE_FREE(ec_pt_context);
     SAFE_FREE(ecpoint);
   }
+  EPID_MATH_STAT_STOP(kEpidMathStatNewEcPoint, 1, start);
   return result;
 }
 
 void DeleteEcPoint(EcPoint** p) {
   if (p) {
-    if (*p) {
-      SAFE_FREE((*p)->ipp_ec_pt);
-    }
     SAFE_FREE(*p);
   }
 }
 
-/// Check and initialize element if it is in elliptic curve group.
-/*!
-  This is internal function.
-  Takes a value p as input. If p is indeed an element of g, it
-  outputs true, otherwise, it outputs false.
-
-  This is only used to check if input buffer are actually valid
-  elements in group. If p is in g, this fills p and initializes it to
-  internal FfElement format.
-
-  \param[in] g
-  The eliptic curve group in which to perform the check
-  \param[in] p_str
-  Serialized eliptic curve group element to check
-  \param[in] strlen
-  The size of p_str in bytes.
-  \param[out] p
-  Deserialized value of p_str
-  \param[out] in_group
-  Result of the check
-
-  \returns ::EpidStatus
-
-  \see NewEcPoint
-*/
-EpidStatus eccontains(EcGroup* g, void const* p_str, size_t strlen, EcPoint* p,
-                      bool* in_group) {
+EpidStatus ReadEcPointUnchecked(EcGroup* g, void const* p_str, size_t strlen,
+                                EcPoint* p) {
   EpidStatus result = kEpidErr;
   IppStatus sts = ippStsNoErr;
   FiniteField fp;
   FfElement* fp_x = NULL;
   FfElement* fp_y = NULL;
   Ipp8u const* byte_str = (Ipp8u const*)p_str;
-  IppECResult ec_result = ippECPointIsNotValid;
   int ipp_half_strlen = (int)strlen / 2;
 
-  if (!g || !p_str || !p || !in_group) {
+  if (!g || !p_str || !p) {
     return kEpidBadArgErr;
   }
   if (!g->ipp_ec || !p->ipp_ec_pt) {
@@ -312,7 +280,6 @@ EpidStatus eccontains(EcGroup* g, void const* p_str, size_t strlen, EcPoint* p,
           result = kEpidMathErr;
         break;
       }
-      *in_group = true;
       result = kEpidNoErr;
       break;
     }
@@ -377,19 +344,6 @@ EpidStatus eccontains(EcGroup* g, void const* p_str, size_t strlen, EcPoint* p,
       break;
     }
 
-    // verify the point is actually on the curve
-    sts = ippsGFpECTstPoint(p->ipp_ec_pt, &ec_result, g->ipp_ec,
-                            g->scratch_buffer);
-    // check return codes
-    if (ippStsNoErr != sts) {
-      if (ippStsContextMatchErr == sts)
-        result = kEpidBadArgErr;
-      else
-        result = kEpidMathErr;
-      break;
-    }
-
-    *in_group = (ippECValid == ec_result);
     result = kEpidNoErr;
   } while (0);
 
@@ -398,6 +352,62 @@ EpidStatus eccontains(EcGroup* g, void const* p_str, size_t strlen, EcPoint* p,
   return result;
 }
 
+/// Check and initialize element if it is in elliptic curve group.
+/*!
+  This is internal function.
+  Takes a value p as input. If p is indeed an element of g, it
+  outputs true, otherwise, it outputs false.
+
+  This is only used to check if input buffer are actually valid
+  elements in group. If p is in g, this fills p and initializes it to
+  internal FfElement format.
+
+  \param[in] g
+  The eliptic curve group in which to perform the check
+  \param[in] p_str
+  Serialized eliptic curve group element to check
+  \param[in] strlen
+  The size of p_str in bytes.
+  \param[out] p
+  Deserialized value of p_str
+  \param[out] in_group
+  Result of the check
+
+  \returns ::EpidStatus
+
+  \see NewEcPoint
+*/
+EpidStatus eccontains(EcGroup* g, void const* p_str, size_t strlen, EcPoint* p,
+                      bool* in_group) {
+  EpidStatus result = kEpidErr;
+  IppStatus sts = ippStsNoErr;
+  IppECResult ec_result = ippECPointIsNotValid;
+
+  if (!g || !p_str || !p || !in_group) {
+    return kEpidBadArgErr;
+  }
+
+  result = ReadEcPointUnchecked(g, p_str, strlen, p);
+  if (kEpidNoErr != result) {
+    return result;
+  }
+
+  // verify the point is actually on the curve
+  sts = ippsGFpECTstPoint(p->ipp_ec_pt, &ec_result, g->ipp_ec,
+                          g->scratch_buffer);
+  // check return codes
+  if (ippStsNoErr != sts) {
+    if (ippStsContextMatchErr == sts)
+      return kEpidBadArgErr;
+    else
+      return kEpidMathErr;
+  }
+
+  // an all zero p_str is the point at infinity, which is in the group
+  *in_group = (ippECValid == ec_result || ippECPointIsAtInfinite == ec_result);
+  return kEpidNoErr;
+}
+
 EpidStatus ReadEcPoint(EcGroup* g, void const* p_str, size_t strlen,
                        EcPoint* p) {
   EpidStatus result;
@@ -524,6 +534,442 @@ EpidStatus WriteEcPoint(EcGroup* g, EcPoint const* p, void* p_str,
   return result;
 }
 
+/// Layout of an ipp elliptic curve point context
+/*!
+ Mirrors cpGFPECPoint of ippcpepid. The ipp API only hands out affine
+ coordinates and pays a field inversion for every point it converts, so
+ the batch conversions below read the projective coordinates directly in
+ order to share a single inversion between many points.
+
+ The layout is private to ipp, so CheckIppLayout() verifies it once per
+ group against the ipp API; if it does not match the batch conversions
+ fall back to converting each point through the API.
+*/
+typedef struct IppEcPointLayout {
+  int id;            ///< context identifier
+  int flags;         ///< IPP_EC_POINT_AFFINE and IPP_EC_POINT_FINITE
+  int element_size;  ///< size of a coordinate in ipp words
+  Ipp8u* data;       ///< Jacobian coordinates X, Y and Z in Montgomery form
+} IppEcPointLayout;
+
+/// Layout of an ipp finite field element context, mirrors cpElementGFp
+typedef struct IppFfElementLayout {
+  int id;       ///< context identifier
+  int length;   ///< size of the element in ipp words
+  Ipp8u* data;  ///< value in Montgomery form
+} IppFfElementLayout;
+
+/// Point flag set when Z == 1
+#define IPP_EC_POINT_AFFINE 1
+/// Point flag set unless the point is at infinity
+#define IPP_EC_POINT_FINITE 2
+
+/// Copies coordinate 0 (X), 1 (Y) or 2 (Z) of a point into an element
+static void GetProjectiveCoordinate(EcPoint const* p, int coordinate,
+                                    size_t coordinate_size, FfElement* r) {
+  IppEcPointLayout const* pt = (IppEcPointLayout const*)p->ipp_ec_pt;
+  IppFfElementLayout* elem = (IppFfElementLayout*)r->ipp_ff_elem;
+  memcpy(elem->data, pt->data + coordinate * coordinate_size,
+         coordinate_size);
+}
+
+/// Computes the affine coordinates of points with a single inversion
+/*!
+ Uses Montgomery's trick: with the inverse of the product of all Z
+ coordinates each 1/Z takes two multiplications. x and y of points at
+ infinity are set to zero, which serializes the same way as
+ WriteEcPoint() does.
+
+ Reads the points through IppEcPointLayout, see CheckIppLayout().
+*/
+static EpidStatus GetLayoutAffineCoordinates(EcGroup* g, FiniteField* fp,
+                                             EcPoint const** p, size_t count,
+                                             FfElement** x, FfElement** y) {
+  EpidStatus result = kEpidErr;
+  FfElement* t[3] = {NULL, NULL, NULL};
+  do {
+    IppStatus sts = ippStsNoErr;
+    Ipp32u zero = 0;
+    int ctx_size = 0;
+    size_t coordinate_size = 0;
+    size_t first = count;
+    size_t i = 0;
+    FfElement* acc = NULL;
+    FfElement* z_inv = NULL;
+    FfElement* tmp = NULL;
+
+    sts = ippsGFpECPointGetSize(g->ipp_ec, &ctx_size);
+    BREAK_ON_IPP_ERROR(sts, result);
+    coordinate_size = ((size_t)ctx_size - sizeof(IppEcPointLayout)) / 3;
+    result = NewFfElements(fp, t, sizeof(t) / sizeof(t[0]));
+    BREAK_ON_EPID_ERROR(result);
+    acc = t[0];
+    z_inv = t[1];
+    tmp = t[2];
+
+    // x[i] = product of the Z of the projective points before i
+    for (i = 0; i < count; i++) {
+      int flags = ((IppEcPointLayout const*)p[i]->ipp_ec_pt)->flags;
+      if (!(flags & IPP_EC_POINT_FINITE) || (flags & IPP_EC_POINT_AFFINE)) {
+        continue;
+      }
+      if (first == count) {
+        first = i;
+        GetProjectiveCoordinate(p[i], 2, coordinate_size, acc);
+        continue;
+      }
+      sts = ippsGFpCpyElement(acc->ipp_ff_elem, x[i]->ipp_ff_elem,
+                              fp->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+      GetProjectiveCoordinate(p[i], 2, coordinate_size, tmp);
+      sts = ippsGFpMul(acc->ipp_ff_elem, tmp->ipp_ff_elem, acc->ipp_ff_elem,
+                       fp->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    if (i < count) break;
+    if (first < count) {
+      sts = ippsGFpInv(acc->ipp_ff_elem, acc->ipp_ff_elem, fp->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+
+    // walk back, acc = 1 / product of the Z of the points up to i
+    for (i = count; i-- > 0;) {
+      int flags = ((IppEcPointLayout const*)p[i]->ipp_ec_pt)->flags;
+      if (!(flags & IPP_EC_POINT_FINITE)) {
+        sts = ippsGFpSetElement(&zero, 1, x[i]->ipp_ff_elem, fp->ipp_ff);
+        BREAK_ON_IPP_ERROR(sts, result);
+        sts = ippsGFpSetElement(&zero, 1, y[i]->ipp_ff_elem, fp->ipp_ff);
+        BREAK_ON_IPP_ERROR(sts, result);
+        continue;
+      }
+      if (flags & IPP_EC_POINT_AFFINE) {
+        GetProjectiveCoordinate(p[i], 0, coordinate_size, x[i]);
+        GetProjectiveCoordinate(p[i], 1, coordinate_size, y[i]);
+        continue;
+      }
+      if (i == first) {
+        sts = ippsGFpCpyElement(acc->ipp_ff_elem, z_inv->ipp_ff_elem,
+                                fp->ipp_ff);
+        BREAK_ON_IPP_ERROR(sts, result);
+      } else {
+        sts = ippsGFpMul(acc->ipp_ff_elem, x[i]->ipp_ff_elem,
+                         z_inv->ipp_ff_elem, fp->ipp_ff);
+        BREAK_ON_IPP_ERROR(sts, result);
+        GetProjectiveCoordinate(p[i], 2, coordinate_size, tmp);
+        sts = ippsGFpMul(acc->ipp_ff_elem, tmp->ipp_ff_elem,
+                         acc->ipp_ff_elem, fp->ipp_ff);
+        BREAK_ON_IPP_ERROR(sts, result);
+      }
+      // x = X / Z^2, y = Y / Z^3
+      sts = ippsGFpSqr(z_inv->ipp_ff_elem, tmp->ipp_ff_elem, fp->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+      GetProjectiveCoordinate(p[i], 0, coordinate_size, x[i]);
+      sts = ippsGFpMul(x[i]->ipp_ff_elem, tmp->ipp_ff_elem, x[i]->ipp_ff_elem,
+                       fp->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpMul(tmp->ipp_ff_elem, z_inv->ipp_ff_elem, tmp->ipp_ff_elem,
+                       fp->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+      GetProjectiveCoordinate(p[i], 1, coordinate_size, y[i]);
+      sts = ippsGFpMul(y[i]->ipp_ff_elem, tmp->ipp_ff_elem, y[i]->ipp_ff_elem,
+                       fp->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    if (i < count) break;
+    result = kEpidNoErr;
+  } while (0);
+  DeleteFfElements(t, sizeof(t) / sizeof(t[0]));
+  return result;
+}
+
+/// Checks that the points of a group can be read through IppEcPointLayout
+/*!
+ Sets g->ipp_layout. The sizes and identifiers of a point and an element
+ context must agree with the mirrored layouts, and the affine coordinates
+ computed from them for a point in projective coordinates must be the
+ ones ippsGFpECGetPoint() returns.
+
+ \returns ::EpidStatus, kEpidNoErr also if the layout does not match
+*/
+static EpidStatus CheckIppLayout(EcGroup* g, FiniteField* fp) {
+  EpidStatus result = kEpidErr;
+  EcPoint* q = NULL;
+  FfElement* t[4] = {NULL, NULL, NULL, NULL};
+  g->ipp_layout = EC_IPP_LAYOUT_INVALID;
+  do {
+    IppStatus sts = ippStsNoErr;
+    int point_ctx_size = 0;
+    int elem_ctx_size = 0;
+    size_t coordinate_size = 0;
+    IppEcPointLayout const* pt = NULL;
+    IppFfElementLayout const* elem = NULL;
+    EcPoint const* qs[1];
+    int cmp_x = !IPP_IS_EQ;
+    int cmp_y = !IPP_IS_EQ;
+
+    sts = ippsGFpECPointGetSize(g->ipp_ec, &point_ctx_size);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpElementGetSize(fp->ipp_ff, &elem_ctx_size);
+    BREAK_ON_IPP_ERROR(sts, result);
+    result = NewEcPoint(g, &q);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewFfElements(fp, t, sizeof(t) / sizeof(t[0]));
+    BREAK_ON_EPID_ERROR(result);
+    pt = (IppEcPointLayout const*)q->ipp_ec_pt;
+    elem = (IppFfElementLayout const*)t[0]->ipp_ff_elem;
+
+    result = kEpidNoErr;
+    if ((size_t)point_ctx_size <= sizeof(IppEcPointLayout) ||
+        (size_t)elem_ctx_size <= sizeof(IppFfElementLayout)) {
+      break;
+    }
+    coordinate_size =
+        ((size_t)point_ctx_size - sizeof(IppEcPointLayout)) / 3;
+    if (sizeof(IppEcPointLayout) + 3 * coordinate_size !=
+            (size_t)point_ctx_size ||
+        sizeof(IppFfElementLayout) + coordinate_size !=
+            (size_t)elem_ctx_size ||
+        pt->id == elem->id || pt->element_size != elem->length ||
+        pt->element_size <= 0 ||
+        0 != coordinate_size % (size_t)pt->element_size ||
+        pt->data != (Ipp8u const*)(pt + 1) ||
+        elem->data != (Ipp8u const*)(elem + 1) ||
+        0 != (pt->flags & (IPP_EC_POINT_AFFINE | IPP_EC_POINT_FINITE))) {
+      break;
+    }
+
+    // q = 2 * generator, which ipp leaves in projective coordinates
+    sts = ippsGFpECGet(g->ipp_ec, NULL, NULL, NULL, t[0]->ipp_ff_elem,
+                       t[1]->ipp_ff_elem, NULL, NULL, NULL, NULL);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpECSetPoint(t[0]->ipp_ff_elem, t[1]->ipp_ff_elem,
+                            q->ipp_ec_pt, g->ipp_ec);
+    BREAK_ON_IPP_ERROR(sts, result);
+    if ((IPP_EC_POINT_AFFINE | IPP_EC_POINT_FINITE) != pt->flags) {
+      break;
+    }
+    sts = ippsGFpECAddPoint(q->ipp_ec_pt, q->ipp_ec_pt, q->ipp_ec_pt,
+                            g->ipp_ec);
+    BREAK_ON_IPP_ERROR(sts, result);
+    if (IPP_EC_POINT_FINITE != pt->flags) {
+      break;
+    }
+    sts = ippsGFpECGetPoint(q->ipp_ec_pt, t[0]->ipp_ff_elem,
+                            t[1]->ipp_ff_elem, g->ipp_ec);
+    BREAK_ON_IPP_ERROR(sts, result);
+    qs[0] = q;
+    result = GetLayoutAffineCoordinates(g, fp, qs, 1, &t[2], &t[3]);
+    BREAK_ON_EPID_ERROR(result);
+    sts = ippsGFpCmpElement(t[0]->ipp_ff_elem, t[2]->ipp_ff_elem, &cmp_x,
+                            fp->ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpCmpElement(t[1]->ipp_ff_elem, t[3]->ipp_ff_elem, &cmp_y,
+                            fp->ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    if (IPP_IS_EQ != cmp_x || IPP_IS_EQ != cmp_y) {
+      break;
+    }
+    g->ipp_point_id = pt->id;
+    g->ipp_layout = EC_IPP_LAYOUT_VALID;
+  } while (0);
+  DeleteFfElements(t, sizeof(t) / sizeof(t[0]));
+  DeleteEcPoint(&q);
+  return result;
+}
+
+/// Whether points of a group can be read through IppEcPointLayout
+static EpidStatus UseIppLayout(EcGroup* g, FiniteField* fp, EcPoint const** p,
+                               size_t count, bool* use_layout) {
+  size_t i = 0;
+  *use_layout = false;
+  if (EC_IPP_LAYOUT_UNCHECKED == g->ipp_layout) {
+    EpidStatus result = CheckIppLayout(g, fp);
+    if (kEpidNoErr != result) {
+      g->ipp_layout = EC_IPP_LAYOUT_UNCHECKED;
+      return result;
+    }
+  }
+  if (EC_IPP_LAYOUT_VALID != g->ipp_layout) {
+    return kEpidNoErr;
+  }
+  for (i = 0; i < count; i++) {
+    if (((IppEcPointLayout const*)p[i]->ipp_ec_pt)->id != g->ipp_point_id) {
+      return kEpidNoErr;
+    }
+  }
+  *use_layout = true;
+  return kEpidNoErr;
+}
+
+/// Computes the affine coordinates of points
+/*!
+ x and y of points at infinity are set to zero, which serializes the same
+ way as WriteEcPoint() does. Shares a single inversion between all points
+ where the ipp layout allows, see CheckIppLayout(), and converts each
+ point through ippsGFpECGetPoint() otherwise.
+*/
+static EpidStatus GetAffineCoordinates(EcGroup* g, FiniteField* fp,
+                                       EcPoint const** p, size_t count,
+                                       FfElement** x, FfElement** y) {
+  EpidStatus result = kEpidErr;
+  bool use_layout = false;
+  size_t i = 0;
+  Ipp32u zero = 0;
+  result = UseIppLayout(g, fp, p, count, &use_layout);
+  if (kEpidNoErr != result) {
+    return result;
+  }
+  if (use_layout) {
+    return GetLayoutAffineCoordinates(g, fp, p, count, x, y);
+  }
+  for (i = 0; i < count; i++) {
+    IppStatus sts = ippsGFpECGetPoint(p[i]->ipp_ec_pt, x[i]->ipp_ff_elem,
+                                      y[i]->ipp_ff_elem, g->ipp_ec);
+    if (ippStsPointAtInfinity == sts) {
+      sts = ippsGFpSetElement(&zero, 1, x[i]->ipp_ff_elem, fp->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpSetElement(&zero, 1, y[i]->ipp_ff_elem, fp->ipp_ff);
+    }
+    BREAK_ON_IPP_ERROR(sts, result);
+  }
+  if (i < count) {
+    return result;
+  }
+  return kEpidNoErr;
+}
+
+/// Checks the arguments of the batch conversions and allocates x and y
+static EpidStatus NewBatchCoordinates(EcGroup* g, EcPoint const** p,
+                                      size_t count, FiniteField* fp,
+                                      FfElement*** xy) {
+  EpidStatus result = kEpidErr;
+  size_t i = 0;
+  IppStatus sts = ippStsNoErr;
+  if (!g || !p || 0 == count || !xy) {
+    return kEpidBadArgErr;
+  }
+  if (!g->ipp_ec) {
+    return kEpidBadArgErr;
+  }
+  for (i = 0; i < count; i++) {
+    if (!p[i] || !p[i]->ipp_ec_pt ||
+        g->info.elementLen != p[i]->info.elementLen) {
+      return kEpidBadArgErr;
+    }
+  }
+  if (count > SIZE_MAX / (2 * sizeof(FfElement*))) {
+    return kEpidBadArgErr;
+  }
+  sts = ippsGFpECGet(g->ipp_ec, (const IppsGFpState**)&(fp->ipp_ff), 0, 0, 0,
+                     0, 0, 0, 0, 0);
+  if (ippStsNoErr != sts) {
+    return kEpidMathErr;
+  }
+  *xy = (FfElement**)SAFE_ALLOC(2 * count * sizeof(FfElement*));
+  if (!*xy) {
+    return kEpidMemAllocErr;
+  }
+  result = NewFfElements(fp, *xy, 2 * count);
+  if (kEpidNoErr != result) {
+    SAFE_FREE(*xy);
+  }
+  return result;
+}
+
+/// Frees x and y allocated by NewBatchCoordinates
+static void DeleteBatchCoordinates(size_t count, FfElement*** xy) {
+  if (*xy) {
+    DeleteFfElements(*xy, 2 * count);
+  }
+  SAFE_FREE(*xy);
+}
+
+EpidStatus EcBatchToAffine(EcGroup* g, EcPoint** p, size_t count) {
+  EpidStatus result = kEpidErr;
+  FiniteField fp;
+  FfElement** xy = NULL;
+  do {
+    size_t i = 0;
+    bool use_layout = false;
+    result = NewBatchCoordinates(g, (EcPoint const**)p, count, &fp, &xy);
+    BREAK_ON_EPID_ERROR(result);
+    result =
+        UseIppLayout(g, &fp, (EcPoint const**)p, count, &use_layout);
+    BREAK_ON_EPID_ERROR(result);
+    if (!use_layout) {
+      // one inversion per point, as WriteEcPoint() would pay later
+      for (i = 0; i < count; i++) {
+        IppStatus sts = ippsGFpECGetPoint(p[i]->ipp_ec_pt, xy[0]->ipp_ff_elem,
+                                          xy[count]->ipp_ff_elem, g->ipp_ec);
+        if (ippStsPointAtInfinity == sts) {
+          continue;
+        }
+        BREAK_ON_IPP_ERROR(sts, result);
+        sts = ippsGFpECSetPoint(xy[0]->ipp_ff_elem, xy[count]->ipp_ff_elem,
+                                p[i]->ipp_ec_pt, g->ipp_ec);
+        BREAK_ON_IPP_ERROR(sts, result);
+      }
+      if (i < count) break;
+      result = kEpidNoErr;
+      break;
+    }
+    result = GetLayoutAffineCoordinates(g, &fp, (EcPoint const**)p, count,
+                                        xy, xy + count);
+    BREAK_ON_EPID_ERROR(result);
+    for (i = 0; i < count; i++) {
+      IppStatus sts = ippStsNoErr;
+      int flags = ((IppEcPointLayout const*)p[i]->ipp_ec_pt)->flags;
+      if (!(flags & IPP_EC_POINT_FINITE) || (flags & IPP_EC_POINT_AFFINE)) {
+        continue;
+      }
+      sts = ippsGFpECSetPoint(xy[i]->ipp_ff_elem, xy[count + i]->ipp_ff_elem,
+                              p[i]->ipp_ec_pt, g->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    if (i < count) break;
+    result = kEpidNoErr;
+  } while (0);
+  DeleteBatchCoordinates(count, &xy);
+  return result;
+}
+
+EpidStatus WriteEcPointBatch(EcGroup* g, EcPoint const** p, size_t count,
+                             void* p_str, size_t strlen) {
+  EpidStatus result = kEpidErr;
+  FiniteField fp;
+  FfElement** xy = NULL;
+  Ipp8u* byte_str = (Ipp8u*)p_str;
+  int ipp_half_strlen = (int)strlen / 2;
+  if (!p_str) {
+    return kEpidBadArgErr;
+  }
+  if (INT_MAX < strlen || strlen <= 0 || strlen & 0x1) {
+    return kEpidBadArgErr;
+  }
+  do {
+    size_t i = 0;
+    result = NewBatchCoordinates(g, p, count, &fp, &xy);
+    BREAK_ON_EPID_ERROR(result);
+    result = GetAffineCoordinates(g, &fp, p, count, xy, xy + count);
+    BREAK_ON_EPID_ERROR(result);
+    for (i = 0; i < count; i++) {
+      IppStatus sts = ippStsNoErr;
+      sts = ippsGFpGetElementOctString(xy[i]->ipp_ff_elem,
+                                       byte_str + i * strlen, ipp_half_strlen,
+                                       fp.ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpGetElementOctString(
+          xy[count + i]->ipp_ff_elem, byte_str + i * strlen + ipp_half_strlen,
+          ipp_half_strlen, fp.ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    if (i < count) break;
+    result = kEpidNoErr;
+  } while (0);
+  DeleteBatchCoordinates(count, &xy);
+  return result;
+}
+
 EpidStatus EcMul(EcGroup* g, EcPoint const* a, EcPoint const* b, EcPoint* r) {
   IppStatus sts = ippStsNoErr;
   if (!g || !a || !b || !r) {
@@ -554,6 +1000,7 @@ EpidStatus EcMul(EcGroup* g, EcPoint const* a, EcPoint const* b, EcPoint* r) {
 EpidStatus EcExp(EcGroup* g, EcPoint const* a, BigNumStr const* b, EcPoint* r) {
   EpidStatus result = kEpidErr;
   BigNum* b_bn = NULL;
+  EPID_MATH_STAT_START(start);
   do {
     IppStatus sts = ippStsNoErr;
 
@@ -591,6 +1038,7 @@ EpidStatus EcExp(EcGroup* g, EcPoint const* a, BigNumStr const* b, EcPoint* r) {
     result = kEpidNoErr;
   } while (0);
   DeleteBigNum(&b_bn);
+  EPID_MATH_STAT_STOP(kEpidMathStatEcExp, 1, start);
   return result;
 }
 
@@ -601,14 +1049,445 @@ EpidStatus EcSscmExp(EcGroup* g, EcPoint const* a, BigNumStr const* b,
   return EcExp(g, a, b, r);
 }
 
-EpidStatus EcMultiExp(EcGroup* g, EcPoint const** a, BigNumStr const** b,
-                      size_t m, EcPoint* r) {
+/// Width of the signed digits used by EcMultiExp for few terms
+#define EC_MULTIEXP_WNAF_WIDTH 5
+/// Number of pre-computed odd multiples of each base for few terms
+#define EC_MULTIEXP_WNAF_POINTS (1 << (EC_MULTIEXP_WNAF_WIDTH - 2))
+/// Largest bucket window used by EcMultiExp for many terms
+#define EC_MULTIEXP_MAX_BUCKET_BITS 16
+
+/// Number of significant bits of a little endian power
+static int PowerBits(Ipp32u const* k, int k_len) {
+  while (k_len > 0 && 0 == k[k_len - 1]) {
+    k_len--;
+  }
+  if (0 == k_len) {
+    return 0;
+  } else {
+    Ipp32u top = k[k_len - 1];
+    int bits = 32 * (k_len - 1);
+    while (top) {
+      bits++;
+      top >>= 1;
+    }
+    return bits;
+  }
+}
+
+/// Checks that a little endian power is less than the group order
+static bool PowerIsInRange(Ipp32u const* k, int k_len, Ipp32u const* order,
+                           int order_len) {
+  int i = 0;
+  while (k_len > 0 && 0 == k[k_len - 1]) {
+    k_len--;
+  }
+  while (order_len > 0 && 0 == order[order_len - 1]) {
+    order_len--;
+  }
+  if (k_len != order_len) {
+    return k_len < order_len;
+  }
+  for (i = k_len - 1; i >= 0; i--) {
+    if (k[i] != order[i]) {
+      return k[i] < order[i];
+    }
+  }
+  return false;
+}
+
+/// Gets c <= 16 bits of a little endian power starting at bit pos
+static int PowerWindow(Ipp32u const* k, int k_len, int pos, int c) {
+  int word = pos / 32;
+  int shift = pos % 32;
+  Ipp32u bits = 0;
+  if (word < k_len) {
+    bits = k[word] >> shift;
+    if (shift + c > 32 && word + 1 < k_len) {
+      bits |= k[word + 1] << (32 - shift);
+    }
+  }
+  return (int)(bits & ((1u << c) - 1));
+}
+
+/// Recodes a power into width-w non-adjacent form
+/*!
+ Every non-zero digit is odd and less than 2^(w-1) in absolute value, and
+ of any w consecutive digits at most one is non-zero.
+
+ \param[in,out] k
+ The power, little endian with one spare zero word. Destroyed.
+ \param[in] k_len
+ Number of words in k not counting the spare word.
+ \param[out] naf
+ The digits, least significant first. Room for 32 * k_len + 1 digits.
+ \returns
+ The number of digits.
+*/
+static int RecodeWnaf(Ipp32u* k, int k_len, signed char* naf) {
+  int n = 0;
+  int len = k_len + 1;
+  while (len > 0 && 0 == k[len - 1]) {
+    len--;
+  }
+  while (len > 0) {
+    int d = 0;
+    int i = 0;
+    if (k[0] & 1) {
+      Ipp64u carry = 0;
+      d = (int)(k[0] & ((1u << EC_MULTIEXP_WNAF_WIDTH) - 1));
+      if (d >= (1 << (EC_MULTIEXP_WNAF_WIDTH - 1))) {
+        d -= 1 << EC_MULTIEXP_WNAF_WIDTH;
+      }
+      // k -= d, which clears the low w bits
+      if (d > 0) {
+        carry = (Ipp64u)k[0] - (Ipp32u)d;
+        k[0] = (Ipp32u)carry;
+      } else {
+        carry = (Ipp64u)k[0] + (Ipp32u)(-d);
+        k[0] = (Ipp32u)carry;
+        for (i = 1; (carry >> 32) && i < k_len + 1; i++) {
+          carry = (Ipp64u)k[i] + 1;
+          k[i] = (Ipp32u)carry;
+        }
+        if (i > len) len = i;
+      }
+    }
+    naf[n++] = (signed char)d;
+    for (i = 0; i < len - 1; i++) {
+      k[i] = (k[i] >> 1) | (k[i + 1] << 31);
+    }
+    k[len - 1] >>= 1;
+    while (len > 0 && 0 == k[len - 1]) {
+      len--;
+    }
+  }
+  return n;
+}
+
+/// Adds a or its inverse to an accumulator that may still be empty
+static EpidStatus AccumulatePoint(EcGroup* g, IppsGFpECPoint const* a,
+                                  bool negate, EcPoint* tmp, EcPoint* acc,
+                                  bool* acc_is_empty) {
+  IppStatus sts = ippStsNoErr;
+  if (negate) {
+    sts = ippsGFpECNegPoint(a, tmp->ipp_ec_pt, g->ipp_ec);
+    if (ippStsNoErr != sts) return kEpidMathErr;
+    a = tmp->ipp_ec_pt;
+  }
+  if (*acc_is_empty) {
+    sts = ippsGFpECCpyPoint(a, acc->ipp_ec_pt, g->ipp_ec);
+  } else {
+    sts = ippsGFpECAddPoint(a, acc->ipp_ec_pt, acc->ipp_ec_pt, g->ipp_ec);
+  }
+  if (ippStsNoErr != sts) return kEpidMathErr;
+  *acc_is_empty = false;
+  return kEpidNoErr;
+}
+
+/// Chooses the bucket window for a multi-exponentiation
+/*!
+ Estimates the number of point additions of interleaved wNAF (Straus) and
+ of bucket (Pippenger) multi-exponentiation; doublings are the same for
+ both.
+
+ \returns
+ The bucket window in bits, or 0 if interleaved wNAF is cheaper.
+*/
+static int ChooseBucketBits(size_t m, int bits) {
+  size_t best_cost =
+      m * (EC_MULTIEXP_WNAF_POINTS + bits / (EC_MULTIEXP_WNAF_WIDTH + 1));
+  int best_c = 0;
+  int c = 0;
+  for (c = 2; c <= EC_MULTIEXP_MAX_BUCKET_BITS; c++) {
+    size_t windows = (size_t)(bits / c + 1);
+    size_t cost = windows * (m + ((size_t)1 << c));
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_c = c;
+    }
+  }
+  return best_c;
+}
+
+/// Multi-exponentiation by interleaved wNAF (Straus)
+static EpidStatus StrausMultiExp(EcGroup* g, EcPoint const** a,
+                                 Ipp32u const** k, int const* k_len, size_t m,
+                                 int bits, EcPoint* acc) {
   EpidStatus result = kEpidErr;
-  BigNum* b_bn = NULL;
-  EcPoint* ecp_t = NULL;
+  EcPoint** table = NULL;
+  EcPoint* tmp = NULL;
+  signed char* naf = NULL;
+  int* naf_len = NULL;
+  Ipp32u* k_copy = NULL;
+  size_t num_points = m * EC_MULTIEXP_WNAF_POINTS;
+  int max_words = (bits + 31) / 32;
+  int naf_size = 32 * max_words + 1;
+  do {
+    IppStatus sts = ippStsNoErr;
+    bool acc_is_empty = true;
+    size_t i = 0;
+    size_t j = 0;
+    int n = 0;
+    int max_len = 0;
+
+    table = (EcPoint**)SAFE_ALLOC(num_points * sizeof(EcPoint*));
+    naf = (signed char*)SAFE_ALLOC(m * naf_size);
+    naf_len = (int*)SAFE_ALLOC(m * sizeof(int));
+    k_copy = (Ipp32u*)SAFE_ALLOC((max_words + 1) * sizeof(Ipp32u));
+    if (!table || !naf || !naf_len || !k_copy) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    result = NewEcPoint(g, &tmp);
+    BREAK_ON_EPID_ERROR(result);
+    for (i = 0; i < num_points; i++) {
+      result = NewEcPoint(g, &table[i]);
+      BREAK_ON_EPID_ERROR(result);
+    }
+    BREAK_ON_EPID_ERROR(result);
+
+    for (i = 0; i < m; i++) {
+      int words = k_len[i] < max_words ? k_len[i] : max_words;
+      EcPoint** odd = table + i * EC_MULTIEXP_WNAF_POINTS;
+      memset(k_copy, 0, (max_words + 1) * sizeof(Ipp32u));
+      memcpy(k_copy, k[i], words * sizeof(Ipp32u));
+      naf_len[i] = RecodeWnaf(k_copy, max_words, naf + i * naf_size);
+      if (naf_len[i] > max_len) max_len = naf_len[i];
+      if (0 == naf_len[i]) continue;
+      // odd[j] = (2j + 1) * a[i]
+      sts = ippsGFpECAddPoint(a[i]->ipp_ec_pt, a[i]->ipp_ec_pt, tmp->ipp_ec_pt,
+                              g->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpECCpyPoint(a[i]->ipp_ec_pt, odd[0]->ipp_ec_pt, g->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+      for (j = 1; j < EC_MULTIEXP_WNAF_POINTS; j++) {
+        sts = ippsGFpECAddPoint(odd[j - 1]->ipp_ec_pt, tmp->ipp_ec_pt,
+                                odd[j]->ipp_ec_pt, g->ipp_ec);
+        BREAK_ON_IPP_ERROR(sts, result);
+      }
+      if (kEpidNoErr != result) break;
+    }
+    if (kEpidNoErr != result) break;
+
+    // one shared chain of doublings for all terms
+    for (n = max_len - 1; n >= 0; n--) {
+      if (!acc_is_empty) {
+        sts = ippsGFpECAddPoint(acc->ipp_ec_pt, acc->ipp_ec_pt, acc->ipp_ec_pt,
+                                g->ipp_ec);
+        BREAK_ON_IPP_ERROR(sts, result);
+      }
+      for (i = 0; i < m; i++) {
+        int d = 0;
+        if (n >= naf_len[i]) continue;
+        d = naf[i * naf_size + n];
+        if (0 == d) continue;
+        result = AccumulatePoint(
+            g, table[i * EC_MULTIEXP_WNAF_POINTS + (d < 0 ? -d : d) / 2]
+                   ->ipp_ec_pt,
+            d < 0, tmp, acc, &acc_is_empty);
+        BREAK_ON_EPID_ERROR(result);
+      }
+      if (kEpidNoErr != result) break;
+    }
+    if (kEpidNoErr != result) break;
+    if (acc_is_empty) {
+      sts = ippsGFpECSetPointAtInfinity(acc->ipp_ec_pt, g->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    result = kEpidNoErr;
+  } while (0);
+  if (table) {
+    size_t i = 0;
+    for (i = 0; i < num_points; i++) {
+      DeleteEcPoint(&table[i]);
+    }
+  }
+  DeleteEcPoint(&tmp);
+  SAFE_FREE(k_copy);
+  SAFE_FREE(naf_len);
+  SAFE_FREE(naf);
+  SAFE_FREE(table);
+  return result;
+}
+
+/// Multi-exponentiation by signed buckets (Pippenger)
+static EpidStatus PippengerMultiExp(EcGroup* g, EcPoint const** a,
+                                    Ipp32u const** k, int const* k_len,
+                                    size_t m, int bits, int c, EcPoint* acc) {
+  EpidStatus result = kEpidErr;
+  size_t num_buckets = (size_t)1 << (c - 1);
+  // one window more than the bits so the last carry is absorbed
+  int num_windows = (bits + 1) / c + 1;
+  EcPoint** buckets = NULL;
+  bool* bucket_is_empty = NULL;
+  short* digits = NULL;
+  EcPoint* sum = NULL;
+  EcPoint* window_sum = NULL;
+  EcPoint* tmp = NULL;
+  do {
+    IppStatus sts = ippStsNoErr;
+    bool acc_is_empty = true;
+    size_t i = 0;
+    int w = 0;
+
+    buckets = (EcPoint**)SAFE_ALLOC(num_buckets * sizeof(EcPoint*));
+    bucket_is_empty = (bool*)SAFE_ALLOC(num_buckets * sizeof(bool));
+    digits = (short*)SAFE_ALLOC(m * num_windows * sizeof(short));
+    if (!buckets || !bucket_is_empty || !digits) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    result = NewEcPoint(g, &sum);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewEcPoint(g, &window_sum);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewEcPoint(g, &tmp);
+    BREAK_ON_EPID_ERROR(result);
+    for (i = 0; i < num_buckets; i++) {
+      result = NewEcPoint(g, &buckets[i]);
+      BREAK_ON_EPID_ERROR(result);
+    }
+    BREAK_ON_EPID_ERROR(result);
+
+    // signed digits in [-2^(c-1), 2^(c-1)) halve the number of buckets
+    for (i = 0; i < m; i++) {
+      int carry = 0;
+      for (w = 0; w < num_windows; w++) {
+        int d = PowerWindow(k[i], k_len[i], w * c, c) + carry;
+        carry = d >= (1 << (c - 1));
+        d -= carry << c;
+        digits[i * num_windows + w] = (short)d;
+      }
+    }
+
+    for (w = num_windows - 1; w >= 0; w--) {
+      bool sum_is_empty = true;
+      bool window_sum_is_empty = true;
+      size_t b = 0;
+      int j = 0;
+      if (!acc_is_empty) {
+        for (j = 0; j < c; j++) {
+          sts = ippsGFpECAddPoint(acc->ipp_ec_pt, acc->ipp_ec_pt,
+                                  acc->ipp_ec_pt, g->ipp_ec);
+          BREAK_ON_IPP_ERROR(sts, result);
+        }
+        if (kEpidNoErr != result) break;
+      }
+      for (b = 0; b < num_buckets; b++) {
+        bucket_is_empty[b] = true;
+      }
+      for (i = 0; i < m; i++) {
+        int d = digits[i * num_windows + w];
+        if (0 == d) continue;
+        b = (size_t)(d < 0 ? -d : d) - 1;
+        result = AccumulatePoint(g, a[i]->ipp_ec_pt, d < 0, tmp, buckets[b],
+                                 &bucket_is_empty[b]);
+        BREAK_ON_EPID_ERROR(result);
+      }
+      if (kEpidNoErr != result) break;
+      // window_sum = sum of (b + 1) * buckets[b] by running sums
+      for (b = num_buckets; b-- > 0;) {
+        if (!bucket_is_empty[b]) {
+          result = AccumulatePoint(g, buckets[b]->ipp_ec_pt, false, tmp, sum,
+                                   &sum_is_empty);
+          BREAK_ON_EPID_ERROR(result);
+        }
+        if (!sum_is_empty) {
+          result = AccumulatePoint(g, sum->ipp_ec_pt, false, tmp, window_sum,
+                                   &window_sum_is_empty);
+          BREAK_ON_EPID_ERROR(result);
+        }
+      }
+      if (kEpidNoErr != result) break;
+      if (!window_sum_is_empty) {
+        result = AccumulatePoint(g, window_sum->ipp_ec_pt, false, tmp, acc,
+                                 &acc_is_empty);
+        BREAK_ON_EPID_ERROR(result);
+      }
+    }
+    if (kEpidNoErr != result) break;
+    if (acc_is_empty) {
+      sts = ippsGFpECSetPointAtInfinity(acc->ipp_ec_pt, g->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    result = kEpidNoErr;
+  } while (0);
+  if (buckets) {
+    size_t i = 0;
+    for (i = 0; i < num_buckets; i++) {
+      DeleteEcPoint(&buckets[i]);
+    }
+  }
+  DeleteEcPoint(&tmp);
+  DeleteEcPoint(&window_sum);
+  DeleteEcPoint(&sum);
+  SAFE_FREE(digits);
+  SAFE_FREE(bucket_is_empty);
+  SAFE_FREE(buckets);
+  return result;
+}
+
+/// Multi-exponentiation of little endian powers
+/*!
+ Picks interleaved wNAF for few terms and buckets for many. Both are
+ faster than one EcExp per term but take time that depends on the powers,
+ see EcSscmMultiExp.
+*/
+static EpidStatus MultiExpWords(EcGroup* g, EcPoint const** a,
+                                Ipp32u const** k, int const* k_len, size_t m,
+                                EcPoint* r) {
+  EpidStatus result = kEpidErr;
+  EcPoint* acc = NULL;
+  do {
+    IppStatus sts = ippStsNoErr;
+    Ipp32u const* order = NULL;
+    int order_len = 0;
+    int bits = 0;
+    int c = 0;
+    size_t i = 0;
+
+    sts = ippsGFpECGet(g->ipp_ec, NULL, NULL, NULL, NULL, NULL, &order,
+                       &order_len, NULL, NULL);
+    BREAK_ON_IPP_ERROR(sts, result);
+    for (i = 0; i < m; i++) {
+      int k_bits = PowerBits(k[i], k_len[i]);
+      // The power should be less than elliptic curve group order
+      if (!PowerIsInRange(k[i], k_len[i], order, order_len)) {
+        result = kEpidBadArgErr;
+        break;
+      }
+      if (k_bits > bits) bits = k_bits;
+    }
+    if (kEpidBadArgErr == result) break;
+
+    // accumulate separately in case r is also one of the bases
+    result = NewEcPoint(g, &acc);
+    BREAK_ON_EPID_ERROR(result);
+    c = ChooseBucketBits(m, bits);
+    if (c) {
+      result = PippengerMultiExp(g, a, k, k_len, m, bits, c, acc);
+    } else {
+      result = StrausMultiExp(g, a, k, k_len, m, bits, acc);
+    }
+    BREAK_ON_EPID_ERROR(result);
+    sts = ippsGFpECCpyPoint(acc->ipp_ec_pt, r->ipp_ec_pt, g->ipp_ec);
+    BREAK_ON_IPP_ERROR(sts, result);
+    result = kEpidNoErr;
+  } while (0);
+  DeleteEcPoint(&acc);
+  return result;
+}
+
+EpidStatus EcMultiExp(EcGroup* g, EcPoint const** a, BigNumStr const** b,
+                      size_t m, EcPoint* r) {
+  EpidStatus result = kEpidErr;
+  Ipp32u* words = NULL;
+  Ipp32u const** k = NULL;
+  int* k_len = NULL;
   int i = 0;
   int ii = 0;
   int ipp_m = 0;
+  EPID_MATH_STAT_START(start);
 
   if (!g || !a || !b || !r) {
     return kEpidBadArgErr;
@@ -631,6 +1510,9 @@ EpidStatus EcMultiExp(EcGroup* g, EcPoint const** a, BigNumStr const** b,
     if (!a[i]->ipp_ec_pt) {
       return kEpidBadArgErr;
     }
+    if (!b[i]) {
+      return kEpidBadArgErr;
+    }
     if (g->info.elementLen != a[i]->info.elementLen) {
       return kEpidBadArgErr;
     }
@@ -644,59 +1526,145 @@ EpidStatus EcMultiExp(EcGroup* g, EcPoint const** a, BigNumStr const** b,
     return kEpidBadArgErr;
   }
 
+  if (1 == m) {
+    // a single term gains nothing from sharing doublings
+    return EcExp(g, a[0], b[0], r);
+  }
+
   do {
-    IppStatus sts = ippStsNoErr;
+    size_t n = 0;
+    size_t num_words = sizeof(((BigNumStr*)0)->data.data) / sizeof(Ipp32u);
+    words = (Ipp32u*)SAFE_ALLOC(m * num_words * sizeof(Ipp32u));
+    k = (Ipp32u const**)SAFE_ALLOC(m * sizeof(Ipp32u const*));
+    k_len = (int*)SAFE_ALLOC(m * sizeof(int));
+    if (!words || !k || !k_len) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    // convert big endian octet strings to little endian words
+    for (i = 0; i < ipp_m; i++) {
+      Ipp8u const* str = b[i]->data.data;
+      Ipp32u* w = words + i * num_words;
+      for (n = 0; n < num_words; n++) {
+        Ipp8u const* oct = str + 4 * (num_words - 1 - n);
+        w[n] = ((Ipp32u)oct[0] << 24) | ((Ipp32u)oct[1] << 16) |
+               ((Ipp32u)oct[2] << 8) | oct[3];
+      }
+      k[i] = w;
+      k_len[i] = (int)num_words;
+    }
+    result = MultiExpWords(g, a, k, k_len, m, r);
+  } while (0);
+  if (words) {
+    EpidZeroMemory(words, m * sizeof(((BigNumStr*)0)->data.data));
+  }
+  SAFE_FREE(k_len);
+  SAFE_FREE(k);
+  SAFE_FREE(words);
+  EPID_MATH_STAT_STOP(kEpidMathStatEcMultiExp, 1, start);
 
-    // Create big number element for ipp call
-    result = NewBigNum(sizeof(((BigNumStr*)0)->data.data), &b_bn);
-    if (kEpidNoErr != result) break;
-    // Create temporal EcPoint element
-    result = NewEcPoint(g, &ecp_t);
-    if (kEpidNoErr != result) break;
+  return result;
+}
+EpidStatus EcMultiExpBn(EcGroup* g, EcPoint const** a, BigNum const** b,
+                        size_t m, EcPoint* r) {
+  EpidStatus result = kEpidErr;
+  Ipp32u const** k = NULL;
+  int* k_len = NULL;
+  int i = 0;
+  int ii = 0;
+  int ipp_m = 0;
 
-    for (i = 0; i < ipp_m; i++) {
-      // Initialize big number element for ipp call
-      result = ReadBigNum(b[i], sizeof(BigNumStr), b_bn);
-      if (kEpidNoErr != result) break;
+  if (!g || !a || !b || !r) {
+    return kEpidBadArgErr;
+  }
+  if (!g->ipp_ec || m <= 0) {
+    return kEpidBadArgErr;
+  }
+  // because we use ipp function with number of items parameter
+  // defined as "int" we need to verify that input length
+  // do not exceed INT_MAX to avoid overflow
+  if (m > INT_MAX) {
+    return kEpidBadArgErr;
+  }
+  ipp_m = (int)m;
+  // Verify that ec points are not NULL
+  for (i = 0; i < ipp_m; i++) {
+    if (!a[i]) {
+      return kEpidBadArgErr;
+    }
+    if (!a[i]->ipp_ec_pt) {
+      return kEpidBadArgErr;
+    }
+    if (!b[i]) {
+      return kEpidBadArgErr;
+    }
+    if (!b[i]->ipp_bn) {
+      return kEpidBadArgErr;
+    }
+    if (g->info.elementLen != a[i]->info.elementLen) {
+      return kEpidBadArgErr;
+    }
+    for (ii = i + 1; ii < ipp_m; ii++) {
+      if (a[i]->info.elementLen != a[ii]->info.elementLen) {
+        return kEpidBadArgErr;
+      }
+    }
+  }
+  if (g->info.elementLen != r->info.elementLen) {
+    return kEpidBadArgErr;
+  }
 
-      sts = ippsGFpECMulPoint(a[i]->ipp_ec_pt, b_bn->ipp_bn, ecp_t->ipp_ec_pt,
-                              g->ipp_ec, g->scratch_buffer);
+  if (1 == m) {
+    // a single term gains nothing from sharing doublings
+    IppStatus sts = ippsGFpECMulPoint(a[0]->ipp_ec_pt, b[0]->ipp_bn,
+                                      r->ipp_ec_pt, g->ipp_ec,
+                                      g->scratch_buffer);
+    if (ippStsNoErr != sts) {
+      if (ippStsContextMatchErr == sts || ippStsRangeErr == sts ||
+          ippStsOutOfRangeErr == sts)
+        return kEpidBadArgErr;
+      else
+        return kEpidMathErr;
+    }
+    return kEpidNoErr;
+  }
+
+  do {
+    k = (Ipp32u const**)SAFE_ALLOC(m * sizeof(Ipp32u const*));
+    k_len = (int*)SAFE_ALLOC(m * sizeof(int));
+    if (!k || !k_len) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    for (i = 0; i < ipp_m; i++) {
+      IppStatus sts = ippStsNoErr;
+      IppsBigNumSGN sgn = IppsBigNumPOS;
+      int bits = 0;
+      Ipp32u* data = NULL;
+      sts = ippsRef_BN(&sgn, &bits, &data, b[i]->ipp_bn);
       if (ippStsNoErr != sts) {
-        if (ippStsContextMatchErr == sts || ippStsRangeErr == sts ||
-            ippStsOutOfRangeErr == sts)
-          result = kEpidBadArgErr;
-        else
-          result = kEpidMathErr;
+        result = kEpidMathErr;
         break;
       }
-      if (1 == m) {
-        sts = ippsGFpECCpyPoint(ecp_t->ipp_ec_pt, r->ipp_ec_pt, g->ipp_ec);
-        if (ippStsNoErr != sts) {
-          result = kEpidMathErr;
-          break;
-        }
-      } else {
-        sts = ippsGFpECAddPoint(ecp_t->ipp_ec_pt, r->ipp_ec_pt, r->ipp_ec_pt,
-                                g->ipp_ec);
-        if (ippStsNoErr != sts) {
-          result = kEpidMathErr;
-          break;
-        }
+      if (IppsBigNumNEG == sgn) {
+        result = kEpidBadArgErr;
+        break;
       }
+      k[i] = data;
+      k_len[i] = (bits + 31) / 32;
     }
-    if (kEpidNoErr != result) break;
-
-    result = kEpidNoErr;
+    if (kEpidMathErr == result || kEpidBadArgErr == result) break;
+    result = MultiExpWords(g, a, k, k_len, m, r);
   } while (0);
-  DeleteBigNum(&b_bn);
-  DeleteEcPoint(&ecp_t);
+  SAFE_FREE(k_len);
+  SAFE_FREE(k);
 
   return result;
 }
-
-EpidStatus EcMultiExpBn(EcGroup* g, EcPoint const** a, BigNum const** b,
-                        size_t m, EcPoint* r) {
+EpidStatus EcSscmMultiExp(EcGroup* g, EcPoint const** a, BigNumStr const** b,
+                          size_t m, EcPoint* r) {
   EpidStatus result = kEpidErr;
+  BigNum* b_bn = NULL;
   EcPoint* ecp_t = NULL;
   int i = 0;
   int ii = 0;
@@ -726,9 +1694,6 @@ EpidStatus EcMultiExpBn(EcGroup* g, EcPoint const** a, BigNum const** b,
     if (!b[i]) {
       return kEpidBadArgErr;
     }
-    if (!b[i]->ipp_bn) {
-      return kEpidBadArgErr;
-    }
     if (g->info.elementLen != a[i]->info.elementLen) {
       return kEpidBadArgErr;
     }
@@ -745,12 +1710,21 @@ EpidStatus EcMultiExpBn(EcGroup* g, EcPoint const** a, BigNum const** b,
   do {
     IppStatus sts = ippStsNoErr;
 
+    // Create big number element for ipp call
+    result = NewBigNum(sizeof(((BigNumStr*)0)->data.data), &b_bn);
+    if (kEpidNoErr != result) break;
     // Create temporal EcPoint element
     result = NewEcPoint(g, &ecp_t);
     if (kEpidNoErr != result) break;
 
+    // one full exponentiation per term, each of which is side channel
+    // mitigated, rather than a shared chain that depends on the powers
     for (i = 0; i < ipp_m; i++) {
-      sts = ippsGFpECMulPoint(a[i]->ipp_ec_pt, b[i]->ipp_bn, ecp_t->ipp_ec_pt,
+      // Initialize big number element for ipp call
+      result = ReadBigNum(b[i], sizeof(BigNumStr), b_bn);
+      if (kEpidNoErr != result) break;
+
+      sts = ippsGFpECMulPoint(a[i]->ipp_ec_pt, b_bn->ipp_bn, ecp_t->ipp_ec_pt,
                               g->ipp_ec, g->scratch_buffer);
       if (ippStsNoErr != sts) {
         if (ippStsContextMatchErr == sts || ippStsRangeErr == sts ||
@@ -760,7 +1734,7 @@ EpidStatus EcMultiExpBn(EcGroup* g, EcPoint const** a, BigNum const** b,
           result = kEpidMathErr;
         break;
       }
-      if (1 == m) {
+      if (0 == i) {
         sts = ippsGFpECCpyPoint(ecp_t->ipp_ec_pt, r->ipp_ec_pt, g->ipp_ec);
         if (ippStsNoErr != sts) {
           result = kEpidMathErr;
@@ -779,16 +1753,428 @@ EpidStatus EcMultiExpBn(EcGroup* g, EcPoint const** a, BigNum const** b,
 
     result = kEpidNoErr;
   } while (0);
+  DeleteBigNum(&b_bn);
   DeleteEcPoint(&ecp_t);
 
   return result;
 }
 
-EpidStatus EcSscmMultiExp(EcGroup* g, EcPoint const** a, BigNumStr const** b,
-                          size_t m, EcPoint* r) {
-  // call EcMultiExp directly because its implementation is side channel
-  // mitigated already
-  return EcMultiExp(g, a, b, m, r);
+/// Serialize affine coordinates and/or their inverse into a fixed-base table
+static EpidStatus WriteFixedBaseCoordinates(FiniteField* fp, FfElement* x,
+                                            FfElement* y, Ipp8u* p_str,
+                                            Ipp8u* neg_p_str,
+                                            size_t point_size) {
+  IppStatus sts = ippStsNoErr;
+  int half_size = (int)point_size / 2;
+  if (p_str) {
+    sts = ippsGFpGetElementOctString(x->ipp_ff_elem, p_str, half_size,
+                                     fp->ipp_ff);
+    if (ippStsNoErr != sts) return kEpidMathErr;
+    sts = ippsGFpGetElementOctString(y->ipp_ff_elem, p_str + half_size,
+                                     half_size, fp->ipp_ff);
+    if (ippStsNoErr != sts) return kEpidMathErr;
+  }
+  if (neg_p_str) {
+    // the inverse shares x and has y negated, which avoids a field inversion
+    sts = ippsGFpGetElementOctString(x->ipp_ff_elem, neg_p_str, half_size,
+                                     fp->ipp_ff);
+    if (ippStsNoErr != sts) return kEpidMathErr;
+    sts = ippsGFpNeg(y->ipp_ff_elem, y->ipp_ff_elem, fp->ipp_ff);
+    if (ippStsNoErr != sts) return kEpidMathErr;
+    sts = ippsGFpGetElementOctString(y->ipp_ff_elem, neg_p_str + half_size,
+                                     half_size, fp->ipp_ff);
+    if (ippStsNoErr != sts) return kEpidMathErr;
+  }
+  return kEpidNoErr;
+}
+
+/// Serialize a point and/or its inverse into a fixed-base table
+static EpidStatus WriteFixedBasePoint(EcGroup* g, FiniteField* fp,
+                                      EcPoint const* p, FfElement* x,
+                                      FfElement* y, Ipp8u* p_str,
+                                      Ipp8u* neg_p_str, size_t point_size) {
+  IppStatus sts = ippStsNoErr;
+  sts = ippsGFpECGetPoint(p->ipp_ec_pt, x->ipp_ff_elem, y->ipp_ff_elem,
+                          g->ipp_ec);
+  if (ippStsPointAtInfinity == sts) {
+    // an all zero string is read back as the point at infinity
+    if (p_str) memset(p_str, 0, point_size);
+    if (neg_p_str) memset(neg_p_str, 0, point_size);
+    return kEpidNoErr;
+  } else if (ippStsNoErr != sts) {
+    return kEpidMathErr;
+  }
+  return WriteFixedBaseCoordinates(fp, x, y, p_str, neg_p_str, point_size);
+}
+
+EpidStatus NewEcFixedBaseTable(EcGroup* g, EcPoint const* base,
+                               EcFixedBaseTable** table) {
+  EpidStatus result = kEpidErr;
+  EcFixedBaseTable* tbl = NULL;
+  FiniteField fp;
+  FfElement* x = NULL;
+  FfElement* y = NULL;
+  EcPoint* b = NULL;
+  EcPoint* b2 = NULL;
+  // odd multiples of the base of a window and their affine coordinates
+  EcPoint* odd[EC_FIXED_BASE_WINDOW_SIZE / 2] = {NULL};
+  FfElement* xy[EC_FIXED_BASE_WINDOW_SIZE] = {NULL};
+  size_t i = 0;
+  size_t j = 0;
+  do {
+    IppStatus sts = ippStsNoErr;
+    size_t point_size = 0;
+    size_t num_points = 0;
+    Ipp8u* window = NULL;
+
+    if (!g || !base || !table) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (!g->ipp_ec || !base->ipp_ec_pt) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (g->info.elementLen != base->info.elementLen) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    sts = ippsGFpECGet(g->ipp_ec, (const IppsGFpState**)&(fp.ipp_ff), 0, 0, 0,
+                       0, 0, 0, 0, 0);
+    BREAK_ON_IPP_ERROR(sts, result);
+
+    result = NewFfElement(&fp, &x);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewFfElement(&fp, &y);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewEcPoint(g, &b);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewEcPoint(g, &b2);
+    BREAK_ON_EPID_ERROR(result);
+    for (j = 0; j < EC_FIXED_BASE_WINDOW_SIZE / 2; j++) {
+      result = NewEcPoint(g, &odd[j]);
+      BREAK_ON_EPID_ERROR(result);
+    }
+    BREAK_ON_EPID_ERROR(result);
+    result = NewFfElements(&fp, xy, EC_FIXED_BASE_WINDOW_SIZE);
+    BREAK_ON_EPID_ERROR(result);
+
+    tbl = (EcFixedBaseTable*)SAFE_ALLOC(sizeof(EcFixedBaseTable));
+    if (!tbl) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    point_size = 2 * g->info.elementLen * sizeof(Ipp32u);
+    num_points = EC_FIXED_BASE_NUM_WINDOWS * EC_FIXED_BASE_WINDOW_SIZE + 3;
+    tbl->points = (Ipp8u*)SAFE_ALLOC(num_points * point_size);
+    if (!tbl->points) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    tbl->point_size = point_size;
+    tbl->info = g->info;
+    result = EcIsIdentity(g, base, &tbl->base_is_identity);
+    BREAK_ON_EPID_ERROR(result);
+    if (tbl->base_is_identity) {
+      *table = tbl;
+      result = kEpidNoErr;
+      break;
+    }
+
+    sts = ippsGFpECCpyPoint(base->ipp_ec_pt, b->ipp_ec_pt, g->ipp_ec);
+    BREAK_ON_IPP_ERROR(sts, result);
+    for (i = 0; i < EC_FIXED_BASE_NUM_WINDOWS; i++) {
+      window = tbl->points + i * EC_FIXED_BASE_WINDOW_SIZE * point_size;
+      // b = 16^i * base, odd holds its odd multiples
+      sts = ippsGFpECAddPoint(b->ipp_ec_pt, b->ipp_ec_pt, b2->ipp_ec_pt,
+                              g->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+      if (0 == i) {
+        // -2 * base is needed to make even powers odd
+        result = WriteFixedBasePoint(
+            g, &fp, b2, x, y, NULL,
+            tbl->points + (num_points - 1) * point_size, point_size);
+        BREAK_ON_EPID_ERROR(result);
+      }
+      sts = ippsGFpECCpyPoint(b->ipp_ec_pt, odd[0]->ipp_ec_pt, g->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+      for (j = 1; j < EC_FIXED_BASE_WINDOW_SIZE / 2; j++) {
+        sts = ippsGFpECAddPoint(odd[j - 1]->ipp_ec_pt, b2->ipp_ec_pt,
+                                odd[j]->ipp_ec_pt, g->ipp_ec);
+        BREAK_ON_IPP_ERROR(sts, result);
+      }
+      if (kEpidNoErr != result) break;
+      result = GetAffineCoordinates(g, &fp, (EcPoint const**)odd,
+                                    EC_FIXED_BASE_WINDOW_SIZE / 2, xy,
+                                    xy + EC_FIXED_BASE_WINDOW_SIZE / 2);
+      BREAK_ON_EPID_ERROR(result);
+      for (j = 0; j < EC_FIXED_BASE_WINDOW_SIZE / 2; j++) {
+        // (2j + 1) * b goes at 8 + j and its inverse at 7 - j
+        result = WriteFixedBaseCoordinates(
+            &fp, xy[j], xy[EC_FIXED_BASE_WINDOW_SIZE / 2 + j],
+            window + (EC_FIXED_BASE_WINDOW_SIZE / 2 + j) * point_size,
+            window + (EC_FIXED_BASE_WINDOW_SIZE / 2 - 1 - j) * point_size,
+            point_size);
+        BREAK_ON_EPID_ERROR(result);
+      }
+      if (kEpidNoErr != result) break;
+      // 16 * b = 15 * b + b
+      sts = ippsGFpECAddPoint(
+          odd[EC_FIXED_BASE_WINDOW_SIZE / 2 - 1]->ipp_ec_pt, b->ipp_ec_pt,
+          b->ipp_ec_pt, g->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    if (kEpidNoErr != result) break;
+    result = WriteFixedBasePoint(
+        g, &fp, b, x, y, tbl->points + (num_points - 3) * point_size, NULL,
+        point_size);
+    BREAK_ON_EPID_ERROR(result);
+    // -base was written to window 0
+    memcpy(tbl->points + (num_points - 2) * point_size,
+           tbl->points + (EC_FIXED_BASE_WINDOW_SIZE / 2 - 1) * point_size,
+           point_size);
+    *table = tbl;
+    result = kEpidNoErr;
+  } while (0);
+
+  if (kEpidNoErr != result && tbl) {
+    DeleteEcFixedBaseTable(&tbl);
+  }
+  DeleteFfElements(xy, EC_FIXED_BASE_WINDOW_SIZE);
+  for (i = 0; i < EC_FIXED_BASE_WINDOW_SIZE / 2; i++) {
+    DeleteEcPoint(&odd[i]);
+  }
+  DeleteEcPoint(&b2);
+  DeleteEcPoint(&b);
+  DeleteFfElement(&y);
+  DeleteFfElement(&x);
+  return result;
+}
+
+void DeleteEcFixedBaseTable(EcFixedBaseTable** table) {
+  if (!table || !(*table)) {
+    return;
+  }
+  SAFE_FREE((*table)->points);
+  SAFE_FREE(*table);
+  *table = NULL;
+}
+
+/// Copy the index-th point of a window without revealing the index
+static void SelectFixedBasePoint(Ipp8u const* window, size_t num_points,
+                                 size_t point_size, uint32_t index,
+                                 Ipp8u* p_str) {
+  size_t i = 0;
+  size_t j = 0;
+  memset(p_str, 0, point_size);
+  for (i = 0; i < num_points; i++) {
+    // mask is all ones if i == index, zero otherwise
+    uint32_t diff = (uint32_t)i ^ index;
+    Ipp8u mask = (Ipp8u)(((diff | (0u - diff)) >> 31) - 1);
+    for (j = 0; j < point_size; j++) {
+      p_str[j] |= window[i * point_size + j] & mask;
+    }
+  }
+}
+
+/// Set a point from a string selected from a fixed-base table
+static EpidStatus ReadFixedBasePoint(EcGroup* g, FiniteField* fp,
+                                     Ipp8u const* p_str, size_t point_size,
+                                     FfElement* x, FfElement* y, EcPoint* p) {
+  IppStatus sts = ippStsNoErr;
+  int half_size = (int)point_size / 2;
+  Ipp8u nonzero = 0;
+  size_t i = 0;
+  for (i = 0; i < point_size; i++) {
+    nonzero |= p_str[i];
+  }
+  if (!nonzero) {
+    // only possible if the order of the base divides a table multiple
+    sts = ippsGFpECSetPointAtInfinity(p->ipp_ec_pt, g->ipp_ec);
+    return (ippStsNoErr == sts) ? kEpidNoErr : kEpidMathErr;
+  }
+  sts = ippsGFpSetElementOctString(p_str, half_size, x->ipp_ff_elem,
+                                   fp->ipp_ff);
+  if (ippStsNoErr != sts) return kEpidMathErr;
+  sts = ippsGFpSetElementOctString(p_str + half_size, half_size,
+                                   y->ipp_ff_elem, fp->ipp_ff);
+  if (ippStsNoErr != sts) return kEpidMathErr;
+  sts = ippsGFpECSetPoint(x->ipp_ff_elem, y->ipp_ff_elem, p->ipp_ec_pt,
+                          g->ipp_ec);
+  if (ippStsNoErr != sts) return kEpidMathErr;
+  return kEpidNoErr;
+}
+
+EpidStatus EcExpFixedBase(EcGroup* g, EcFixedBaseTable const* table,
+                          BigNumStr const* b, EcPoint* r) {
+  EpidStatus result = kEpidErr;
+  FiniteField fp;
+  FfElement* x = NULL;
+  FfElement* y = NULL;
+  EcPoint* t = NULL;
+  Ipp8u* p_str = NULL;
+  // power plus one or two, little endian, one extra limb for the carry
+  uint32_t k[sizeof(b->data.data) / sizeof(uint32_t) + 1];
+  uint32_t digits[EC_FIXED_BASE_NUM_WINDOWS];
+  uint32_t odd = 0;
+  do {
+    IppStatus sts = ippStsNoErr;
+    size_t num_limbs = sizeof(k) / sizeof(k[0]);
+    size_t point_size = 0;
+    Ipp8u const* fixed = NULL;
+    Ipp32u const* order = NULL;
+    int order_len = 0;
+    uint64_t carry = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    if (!g || !table || !b || !r) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (!g->ipp_ec || !table->points || !r->ipp_ec_pt) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (g->info.elementLen != table->info.elementLen ||
+        g->info.elementLen != r->info.elementLen) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (table->base_is_identity) {
+      sts = ippsGFpECSetPointAtInfinity(r->ipp_ec_pt, g->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+      result = kEpidNoErr;
+      break;
+    }
+    point_size = table->point_size;
+    fixed = table->points +
+            EC_FIXED_BASE_NUM_WINDOWS * EC_FIXED_BASE_WINDOW_SIZE * point_size;
+
+    // k = b + 1 if b is even, b + 2 if b is odd, so that k is odd
+    for (i = 0; i < num_limbs - 1; i++) {
+      size_t n = sizeof(b->data.data) - 4 * (i + 1);
+      k[i] = ((uint32_t)b->data.data[n] << 24) |
+             ((uint32_t)b->data.data[n + 1] << 16) |
+             ((uint32_t)b->data.data[n + 2] << 8) | b->data.data[n + 3];
+    }
+    k[num_limbs - 1] = 0;
+    // The power should be less than elliptic curve group order, as EcExp
+    // requires
+    sts = ippsGFpECGet(g->ipp_ec, NULL, NULL, NULL, NULL, NULL, &order,
+                       &order_len, NULL, NULL);
+    BREAK_ON_IPP_ERROR(sts, result);
+    if (!PowerIsInRange(k, (int)num_limbs, order, order_len)) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    odd = k[0] & 1;
+    carry = 1 + odd;
+    for (i = 0; i < num_limbs; i++) {
+      carry += k[i];
+      k[i] = (uint32_t)carry;
+      carry >>= 32;
+    }
+    // recode k into odd digits d in [-15, 15] with k = 16^64 + sum d * 16^i
+    for (i = 0; i < EC_FIXED_BASE_NUM_WINDOWS; i++) {
+      uint32_t low = k[0] & (2 * EC_FIXED_BASE_WINDOW_SIZE - 1);
+      // k -= d, where d = low - 16, by adding the sign extended -d
+      uint32_t neg_d = EC_FIXED_BASE_WINDOW_SIZE - low;
+      uint32_t ext = 0u - (neg_d >> 31);
+      digits[i] = low >> 1;
+      carry = (uint64_t)k[0] + neg_d;
+      k[0] = (uint32_t)carry;
+      for (j = 1; j < num_limbs; j++) {
+        carry = (carry >> 32) + k[j] + ext;
+        k[j] = (uint32_t)carry;
+      }
+      for (j = 0; j < num_limbs - 1; j++) {
+        k[j] = (k[j] >> EC_FIXED_BASE_WINDOW_BITS) |
+               (k[j + 1] << (32 - EC_FIXED_BASE_WINDOW_BITS));
+      }
+      k[num_limbs - 1] >>= EC_FIXED_BASE_WINDOW_BITS;
+    }
+
+    sts = ippsGFpECGet(g->ipp_ec, (const IppsGFpState**)&(fp.ipp_ff), 0, 0, 0,
+                       0, 0, 0, 0, 0);
+    BREAK_ON_IPP_ERROR(sts, result);
+    result = NewFfElement(&fp, &x);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewFfElement(&fp, &y);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewEcPoint(g, &t);
+    BREAK_ON_EPID_ERROR(result);
+    p_str = (Ipp8u*)SAFE_ALLOC(point_size);
+    if (!p_str) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+
+    // r = 16^64 * base
+    result = ReadFixedBasePoint(g, &fp, fixed, point_size, x, y, r);
+    BREAK_ON_EPID_ERROR(result);
+    for (i = 0; i < EC_FIXED_BASE_NUM_WINDOWS; i++) {
+      SelectFixedBasePoint(
+          table->points + i * EC_FIXED_BASE_WINDOW_SIZE * point_size,
+          EC_FIXED_BASE_WINDOW_SIZE, point_size, digits[i], p_str);
+      result = ReadFixedBasePoint(g, &fp, p_str, point_size, x, y, t);
+      BREAK_ON_EPID_ERROR(result);
+      sts = ippsGFpECAddPoint(r->ipp_ec_pt, t->ipp_ec_pt, r->ipp_ec_pt,
+                              g->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    if (kEpidNoErr != result) break;
+    // undo the adjustment of the power: subtract base or 2 * base
+    SelectFixedBasePoint(fixed + point_size, 2, point_size, odd, p_str);
+    result = ReadFixedBasePoint(g, &fp, p_str, point_size, x, y, t);
+    BREAK_ON_EPID_ERROR(result);
+    sts = ippsGFpECAddPoint(r->ipp_ec_pt, t->ipp_ec_pt, r->ipp_ec_pt,
+                            g->ipp_ec);
+    BREAK_ON_IPP_ERROR(sts, result);
+    result = kEpidNoErr;
+  } while (0);
+  EpidZeroMemory(k, sizeof(k));
+  EpidZeroMemory(digits, sizeof(digits));
+  if (p_str) {
+    EpidZeroMemory(p_str, table->point_size);
+  }
+  SAFE_FREE(p_str);
+  DeleteEcPoint(&t);
+  DeleteFfElement(&y);
+  DeleteFfElement(&x);
+  return result;
+}
+
+/// Smallest batch for which EcExpBatch builds a fixed-base table
+#define EC_EXP_BATCH_MIN_TABLE 16
+
+EpidStatus EcExpBatch(EcGroup* g, EcPoint const* a, BigNumStr const** b,
+                      size_t count, EcPoint** r) {
+  EpidStatus result = kEpidErr;
+  EcFixedBaseTable* table = NULL;
+  do {
+    size_t i = 0;
+    if (!g || !a || !b || !r || 0 == count) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (count >= EC_EXP_BATCH_MIN_TABLE) {
+      result = NewEcFixedBaseTable(g, a, &table);
+      BREAK_ON_EPID_ERROR(result);
+    }
+    for (i = 0; i < count; i++) {
+      if (table) {
+        result = EcExpFixedBase(g, table, b[i], r[i]);
+      } else {
+        result = EcExp(g, a, b[i], r[i]);
+      }
+      BREAK_ON_EPID_ERROR(result);
+    }
+    BREAK_ON_EPID_ERROR(result);
+    result = EcBatchToAffine(g, r, count);
+  } while (0);
+  DeleteEcFixedBaseTable(&table);
+  return result;
 }
 
 EpidStatus EcGetRandom(EcGroup* g, BitSupplier rnd_func, void* rnd_func_param,
@@ -1127,6 +2513,7 @@ EpidStatus EcHash(EcGroup* g, void const* msg, size_t msg_len, HashAlg hash_alg,
   IppHashID hash_id;
   int ipp_msg_len = 0;
   Ipp32u i = 0;
+  EPID_MATH_STAT_START(start);
   if (!g || (!msg && msg_len > 0) || !r) {
     return kEpidBadArgErr;
   } else if (!g->ipp_ec || !r->ipp_ec_pt) {
@@ -1156,6 +2543,8 @@ EpidStatus EcHash(EcGroup* g, void const* msg, size_t msg_len, HashAlg hash_alg,
     sts = ippsGFpECSetPointHash(i, msg, ipp_msg_len, hash_id, r->ipp_ec_pt,
                                 g->ipp_ec, g->scratch_buffer);
   } while (ippStsQuadraticNonResidueErr == sts && i++ < EPID_ECHASH_WATCHDOG);
+  EPID_MATH_STAT_STOP(kEpidMathStatEcHash, 1, start);
+  EPID_MATH_STAT_COUNT(kEpidMathStatEcHashRetry, i);
 
   if (ippStsContextMatchErr == sts || ippStsBadArgErr == sts ||
       ippStsLengthErr == sts) {
@@ -35,6 +35,10 @@ struct FiniteField {
 };
 
 /// Finite Field Element
+/*!
+ The ipp context is stored in the same memory block, FF_ELEM_CTX_OFFSET
+ bytes after the start of the structure.
+*/
 struct FfElement {
   /// Internal implementation of finite field element
   IppsGFpElement* ipp_ff_elem;
@@ -42,6 +46,36 @@ struct FfElement {
   IppsGFpInfo info;
 };
 
+/// Offset of the ipp context of a FfElement from the start of the element
+#define FF_ELEM_CTX_OFFSET ((sizeof(FfElement) + 15) & ~(size_t)15)
+
+/// Scratch memory for finite field exponentiation
+struct FfExpScratch {
+  /// Working memory of ippsGFpExp
+  Ipp8u* buffer;
+  /// Size of buffer in bytes
+  int size;
+};
+
+/// State of an incremental hash to a finite field element
+/*!
+ The ipp hash context is stored in the same memory block,
+ FF_HASH_CTX_OFFSET bytes after the start of the structure. It is an
+ IppsSHA256State for kSha256 and an IppsSHA512State for kSha384 and
+ kSha512.
+*/
+struct FfHashState {
+  /// Hash algorithm of the context, kInvalidHashAlg until initialized
+  HashAlg hash_alg;
+  /// Number of message bytes absorbed since the hash was started
+  size_t msg_len;
+  /// Internal implementation of the hash
+  Ipp8u* ipp_hash;
+};
+
+/// Offset of the ipp context of a FfHashState from the start of the state
+#define FF_HASH_CTX_OFFSET ((sizeof(FfHashState) + 15) & ~(size_t)15)
+
 /// Initialize FiniteField structure
 EpidStatus InitFiniteFieldFromIpp(IppsGFpState* ipp_ff, FiniteField* ff);
 
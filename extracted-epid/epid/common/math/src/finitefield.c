@@ -25,6 +25,7 @@
 #include "epid/common/math/finitefield.h"
 #include "epid/common/math/src/bignum-internal.h"
 #include "epid/common/math/src/finitefield-internal.h"
+#include "epid/common/math/src/stats-internal.h"
 #include "epid/common/src/memory.h"
 #include "ext/ipp/include/ippcp.h"
 #include "ext/ipp/include/ippcpepid.h"
@@ -348,15 +349,23 @@ void DeleteFiniteField(FiniteField** ff) {
 }
 
 EpidStatus NewFfElement(FiniteField const* ff, FfElement** new_ff_elem) {
+  return NewFfElements(ff, new_ff_elem, 1);
+}
+
+EpidStatus NewFfElements(FiniteField const* ff, FfElement** new_ff_elems,
+                         size_t count) {
   EpidStatus result = kEpidErr;
-  IppsGFpElement* ipp_ff_elem = NULL;
-  FfElement* ff_elem = NULL;
+  Ipp8u* block = NULL;
+  EPID_MATH_STAT_START(start);
   do {
     IppStatus sts = ippStsNoErr;
     unsigned int ctxsize = 0;
+    size_t elem_size = 0;
+    size_t i = 0;
     Ipp32u zero = 0;
+    IppsGFpInfo info;
     // check parameters
-    if (!ff || !new_ff_elem) {
+    if (!ff || !new_ff_elems || 0 == count) {
       result = kEpidBadArgErr;
       break;
     } else if (!ff->ipp_ff) {
@@ -369,54 +378,67 @@ EpidStatus NewFfElement(FiniteField const* ff, FfElement** new_ff_elem) {
       result = kEpidMathErr;
       break;
     }
-    // Allocate space for ipp bignum context
-    ipp_ff_elem = (IppsGFpElement*)SAFE_ALLOC(ctxsize);
-    if (!ipp_ff_elem) {
-      result = kEpidMemAllocErr;
-      break;
-    }
-    // Initialize ipp bignum context
-    // initialize state
-    sts = ippsGFpElementInit(&zero, 1, ipp_ff_elem, ff->ipp_ff);
+    sts = ippsGFpGetInfo(ff->ipp_ff, &info);
     if (ippStsNoErr != sts) {
       result = kEpidMathErr;
       break;
     }
-
-    ff_elem = (FfElement*)SAFE_ALLOC(sizeof(FfElement));
-    if (!ff_elem) {
+    // Each element is stored with its ipp context right behind it
+    elem_size = FF_ELEM_CTX_OFFSET + ctxsize;
+    if (count > SIZE_MAX / elem_size) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    block = (Ipp8u*)SAFE_ALLOC(count * elem_size);
+    if (!block) {
       result = kEpidMemAllocErr;
       break;
     }
-
-    ff_elem->ipp_ff_elem = ipp_ff_elem;
-
-    sts = ippsGFpGetInfo(ff->ipp_ff, &(ff_elem->info));
-    if (ippStsNoErr != sts) {
-      result = kEpidMathErr;
+    for (i = 0; i < count; i++) {
+      FfElement* ff_elem = (FfElement*)(block + i * elem_size);
+      ff_elem->ipp_ff_elem =
+          (IppsGFpElement*)((Ipp8u*)ff_elem + FF_ELEM_CTX_OFFSET);
+      ff_elem->info = info;
+      // Initialize ipp finite field element context
+      sts = ippsGFpElementInit(&zero, 1, ff_elem->ipp_ff_elem, ff->ipp_ff);
+      if (ippStsNoErr != sts) {
+        result = kEpidMathErr;
+        break;
+      }
+    }
+    if (i < count) {
       break;
     }
-
-    *new_ff_elem = ff_elem;
+    for (i = 0; i < count; i++) {
+      new_ff_elems[i] = (FfElement*)(block + i * elem_size);
+    }
     result = kEpidNoErr;
   } while (0);
 
   if (kEpidNoErr != result) {
-    SAFE_FREE(ipp_ff_elem);
-    SAFE_FREE(ff_elem);
+    SAFE_FREE(block);
   }
+  EPID_MATH_STAT_STOP(kEpidMathStatNewFfElement, count, start);
   return result;
 }
 
 void DeleteFfElement(FfElement** ff_elem) {
   if (ff_elem) {
-    if (*ff_elem) {
-      SAFE_FREE((*ff_elem)->ipp_ff_elem);
-    }
     SAFE_FREE(*ff_elem);
   }
 }
 
+void DeleteFfElements(FfElement** ff_elems, size_t count) {
+  size_t i = 0;
+  if (ff_elems && count > 0) {
+    // the first element is the start of the block holding all of them
+    SAFE_FREE(ff_elems[0]);
+    for (i = 1; i < count; i++) {
+      ff_elems[i] = NULL;
+    }
+  }
+}
+
 EpidStatus ReadFfElement(FiniteField* ff, void const* ff_elem_str,
                          size_t strlen, FfElement* ff_elem) {
   IppStatus sts;
@@ -684,6 +706,105 @@ EpidStatus FfInv(FiniteField* ff, FfElement const* a, FfElement* r) {
   return kEpidNoErr;
 }
 
+EpidStatus FfInvBatch(FiniteField* ff, FfElement const** a, size_t count,
+                      FfElement** r) {
+  EpidStatus result = kEpidErr;
+  FfElement* t[2] = {NULL, NULL};
+  do {
+    IppStatus sts = ippStsNoErr;
+    FfElement* acc = NULL;
+    FfElement* a_inv = NULL;
+    size_t i = 0;
+    if (!ff || !a || !r || 0 == count) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (!ff->ipp_ff) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    for (i = 0; i < count; i++) {
+      if (!a[i] || !r[i] || !a[i]->ipp_ff_elem || !r[i]->ipp_ff_elem) {
+        break;
+      }
+      if (ff->info.elementLen != a[i]->info.elementLen ||
+          ff->info.elementLen != r[i]->info.elementLen) {
+        break;
+      }
+    }
+    if (i < count) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    result = NewFfElements(ff, t, sizeof(t) / sizeof(t[0]));
+    if (kEpidNoErr != result) {
+      break;
+    }
+    acc = t[0];
+    a_inv = t[1];
+
+    // r[i] = a[0] * ... * a[i - 1], acc = a[0] * ... * a[count - 1]
+    sts = ippsGFpCpyElement(a[0]->ipp_ff_elem, acc->ipp_ff_elem, ff->ipp_ff);
+    if (ippStsNoErr != sts) {
+      result = kEpidMathErr;
+      break;
+    }
+    for (i = 1; i < count; i++) {
+      sts = ippsGFpCpyElement(acc->ipp_ff_elem, r[i]->ipp_ff_elem, ff->ipp_ff);
+      if (ippStsNoErr != sts) {
+        break;
+      }
+      sts = ippsGFpMul(acc->ipp_ff_elem, a[i]->ipp_ff_elem, acc->ipp_ff_elem,
+                       ff->ipp_ff);
+      if (ippStsNoErr != sts) {
+        break;
+      }
+    }
+    if (ippStsNoErr != sts) {
+      result = kEpidMathErr;
+      break;
+    }
+    sts = ippsGFpInv(acc->ipp_ff_elem, acc->ipp_ff_elem, ff->ipp_ff);
+    if (ippStsNoErr != sts) {
+      if (ippStsDivByZeroErr == sts)
+        result = kEpidDivByZeroErr;
+      else
+        result = kEpidMathErr;
+      break;
+    }
+    // walk back, acc = 1 / (a[0] * ... * a[i])
+    for (i = count - 1; i > 0; i--) {
+      sts = ippsGFpMul(acc->ipp_ff_elem, r[i]->ipp_ff_elem,
+                       a_inv->ipp_ff_elem, ff->ipp_ff);
+      if (ippStsNoErr != sts) {
+        break;
+      }
+      sts = ippsGFpMul(acc->ipp_ff_elem, a[i]->ipp_ff_elem, acc->ipp_ff_elem,
+                       ff->ipp_ff);
+      if (ippStsNoErr != sts) {
+        break;
+      }
+      sts = ippsGFpCpyElement(a_inv->ipp_ff_elem, r[i]->ipp_ff_elem,
+                              ff->ipp_ff);
+      if (ippStsNoErr != sts) {
+        break;
+      }
+    }
+    if (ippStsNoErr != sts) {
+      result = kEpidMathErr;
+      break;
+    }
+    sts = ippsGFpCpyElement(acc->ipp_ff_elem, r[0]->ipp_ff_elem, ff->ipp_ff);
+    if (ippStsNoErr != sts) {
+      result = kEpidMathErr;
+      break;
+    }
+    result = kEpidNoErr;
+  } while (0);
+  DeleteFfElements(t, sizeof(t) / sizeof(t[0]));
+  return result;
+}
+
 EpidStatus FfAdd(FiniteField* ff, FfElement const* a, FfElement const* b,
                  FfElement* r) {
   IppStatus sts = ippStsNoErr;
@@ -801,15 +922,108 @@ EpidStatus FfIsZero(FiniteField* ff, FfElement const* a, bool* is_zero) {
   return kEpidNoErr;
 }
 
+EpidStatus NewFfExpScratch(FiniteField* ff, size_t exp_bits,
+                           FfExpScratch** scratch) {
+  EpidStatus result = kEpidErr;
+  FfExpScratch* s = NULL;
+  do {
+    IppStatus sts = ippStsNoErr;
+    int size = 0;
+    if (!ff || !scratch) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (!ff->ipp_ff || 0 == exp_bits || INT_MAX < exp_bits) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    sts = ippsGFpScratchBufferSize(1, (int)exp_bits, ff->ipp_ff, &size);
+    if (ippStsNoErr != sts) {
+      result = kEpidMathErr;
+      break;
+    }
+    s = (FfExpScratch*)SAFE_ALLOC(sizeof(FfExpScratch));
+    if (!s) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    s->buffer = (Ipp8u*)SAFE_ALLOC(size);
+    if (!s->buffer) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    s->size = size;
+    *scratch = s;
+    result = kEpidNoErr;
+  } while (0);
+  if (kEpidNoErr != result) {
+    DeleteFfExpScratch(&s);
+  }
+  return result;
+}
+
+void DeleteFfExpScratch(FfExpScratch** scratch) {
+  if (!scratch || !*scratch) {
+    return;
+  }
+  SAFE_FREE((*scratch)->buffer);
+  SAFE_FREE(*scratch);
+}
+
+/// Gets the size in bits ippsGFpExp works with for a power
+static EpidStatus GetExpBits(BigNum const* b, int* exp_bits) {
+  if (ippStsNoErr != ippsRef_BN(0, exp_bits, 0, b->ipp_bn)) {
+    return kEpidMathErr;
+  }
+  return kEpidNoErr;
+}
+
+/// Raises an element to a power using preallocated working memory
+static EpidStatus FfExpWithScratch(FiniteField* ff, FfElement const* a,
+                                   BigNum const* b, FfExpScratch* scratch,
+                                   FfElement* r) {
+  EpidStatus result = kEpidErr;
+  IppStatus sts = ippStsNoErr;
+  int exp_bits = 0;
+  int size = 0;
+  if (!ff || !a || !b || !r) {
+    return kEpidBadArgErr;
+  } else if (!ff->ipp_ff || !a->ipp_ff_elem || !r->ipp_ff_elem) {
+    return kEpidBadArgErr;
+  }
+  if (ff->info.elementLen != a->info.elementLen ||
+      ff->info.elementLen != r->info.elementLen) {
+    return kEpidBadArgErr;
+  }
+  result = GetExpBits(b, &exp_bits);
+  if (kEpidNoErr != result) {
+    return result;
+  }
+  sts = ippsGFpScratchBufferSize(1, exp_bits, ff->ipp_ff, &size);
+  if (ippStsNoErr != sts) {
+    return kEpidMathErr;
+  }
+  if (size > scratch->size) {
+    return kEpidBadArgErr;
+  }
+  sts = ippsGFpExp(a->ipp_ff_elem, b->ipp_bn, r->ipp_ff_elem, ff->ipp_ff,
+                   scratch->buffer);
+  // Check return codes
+  if (ippStsNoErr != sts) {
+    if (ippStsContextMatchErr == sts || ippStsRangeErr == sts)
+      return kEpidBadArgErr;
+    else
+      return kEpidMathErr;
+  }
+  return kEpidNoErr;
+}
+
 EpidStatus FfExp(FiniteField* ff, FfElement const* a, BigNum const* b,
                  FfElement* r) {
   EpidStatus result = kEpidErr;
-  Ipp8u* scratch_buffer = NULL;
-  int exp_bit_size = 0;
-  int element_size = 0;
-
+  FfExpScratch* scratch = NULL;
   do {
-    IppStatus sts = ippStsNoErr;
+    int exp_bits = 0;
     // Check required parameters
     if (!ff || !a || !b || !r) {
       result = kEpidBadArgErr;
@@ -823,38 +1037,63 @@ EpidStatus FfExp(FiniteField* ff, FfElement const* a, BigNum const* b,
         a->info.elementLen != r->info.elementLen) {
       return kEpidBadArgErr;
     }
-
-    sts = ippsRef_BN(0, &exp_bit_size, 0, b->ipp_bn);
-    if (ippStsNoErr != sts) {
-      result = kEpidMathErr;
+    result = GetExpBits(b, &exp_bits);
+    if (kEpidNoErr != result) {
       break;
     }
-
-    sts = ippsGFpScratchBufferSize(1, exp_bit_size, ff->ipp_ff, &element_size);
-    if (ippStsNoErr != sts) {
-      result = kEpidMathErr;
+    result = NewFfExpScratch(ff, (size_t)exp_bits, &scratch);
+    if (kEpidNoErr != result) {
       break;
     }
+    result = FfExpWithScratch(ff, a, b, scratch, r);
+  } while (0);
+  DeleteFfExpScratch(&scratch);
+  return result;
+}
 
-    scratch_buffer = (Ipp8u*)SAFE_ALLOC(element_size);
-    if (!scratch_buffer) {
-      result = kEpidMemAllocErr;
+EpidStatus FfExpBatch(FiniteField* ff, FfElement const** a, BigNum const** b,
+                      size_t count, FfExpScratch* scratch, FfElement** r) {
+  EpidStatus result = kEpidErr;
+  FfExpScratch* own_scratch = NULL;
+  do {
+    size_t i = 0;
+    if (!ff || !a || !b || !r || 0 == count) {
+      result = kEpidBadArgErr;
       break;
     }
-
-    sts = ippsGFpExp(a->ipp_ff_elem, b->ipp_bn, r->ipp_ff_elem, ff->ipp_ff,
-                     scratch_buffer);
-    // Check return codes
-    if (ippStsNoErr != sts) {
-      if (ippStsContextMatchErr == sts || ippStsRangeErr == sts)
-        result = kEpidBadArgErr;
-      else
-        result = kEpidMathErr;
-      break;
+    if (!scratch) {
+      int max_bits = 1;
+      for (i = 0; i < count; i++) {
+        int exp_bits = 0;
+        if (!b[i]) {
+          result = kEpidBadArgErr;
+          break;
+        }
+        result = GetExpBits(b[i], &exp_bits);
+        if (kEpidNoErr != result) {
+          break;
+        }
+        if (exp_bits > max_bits) {
+          max_bits = exp_bits;
+        }
+      }
+      if (i < count) {
+        break;
+      }
+      result = NewFfExpScratch(ff, (size_t)max_bits, &own_scratch);
+      if (kEpidNoErr != result) {
+        break;
+      }
+      scratch = own_scratch;
+    }
+    for (i = 0; i < count; i++) {
+      result = FfExpWithScratch(ff, a[i], b[i], scratch, r[i]);
+      if (kEpidNoErr != result) {
+        break;
+      }
     }
-    result = kEpidNoErr;
   } while (0);
-  SAFE_FREE(scratch_buffer);
+  DeleteFfExpScratch(&own_scratch);
   return result;
 }
 
@@ -867,6 +1106,7 @@ EpidStatus FfMultiExp(FiniteField* ff, FfElement const** p, BigNumStr const** b,
   Ipp8u* scratch_buffer = NULL;
   int i = 0;
   int ipp_m = 0;
+  EPID_MATH_STAT_START(start);
 
   // Check required parameters
   if (!ff || !p || !b || !r) {
@@ -969,6 +1209,7 @@ EpidStatus FfMultiExp(FiniteField* ff, FfElement const** p, BigNumStr const** b,
   SAFE_FREE(ipp_p);
   SAFE_FREE(ipp_b);
   SAFE_FREE(scratch_buffer);
+  EPID_MATH_STAT_STOP(kEpidMathStatFfMultiExp, 1, start);
   return result;
 }
 
@@ -1172,6 +1413,171 @@ EpidStatus FfHash(FiniteField* ff, void const* msg, size_t msg_len,
   return result;
 }
 
+EpidStatus NewFfHashState(FfHashState** state) {
+  EpidStatus result = kEpidErr;
+  FfHashState* s = NULL;
+  do {
+    int sha256_size = 0;
+    int sha512_size = 0;
+    if (!state) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (ippStsNoErr != ippsSHA256GetSize(&sha256_size) ||
+        ippStsNoErr != ippsSHA512GetSize(&sha512_size)) {
+      result = kEpidMathErr;
+      break;
+    }
+    // allocate memory for the state followed by the larger ipp context
+    s = (FfHashState*)SAFE_ALLOC(
+        FF_HASH_CTX_OFFSET +
+        (size_t)(sha256_size > sha512_size ? sha256_size : sha512_size));
+    if (!s) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    s->hash_alg = kInvalidHashAlg;
+    s->ipp_hash = (Ipp8u*)s + FF_HASH_CTX_OFFSET;
+    *state = s;
+    result = kEpidNoErr;
+  } while (0);
+  return result;
+}
+
+void DeleteFfHashState(FfHashState** state) {
+  if (state) {
+    SAFE_FREE(*state);
+  }
+}
+
+EpidStatus FfHashInit(HashAlg hash_alg, FfHashState* state) {
+  IppStatus sts = ippStsNoErr;
+  if (!state || !state->ipp_hash) {
+    return kEpidBadArgErr;
+  }
+  if (kSha256 == hash_alg) {
+    sts = ippsSHA256Init((IppsSHA256State*)state->ipp_hash);
+  } else if (kSha384 == hash_alg) {
+    sts = ippsSHA384Init((IppsSHA384State*)state->ipp_hash);
+  } else if (kSha512 == hash_alg) {
+    sts = ippsSHA512Init((IppsSHA512State*)state->ipp_hash);
+  } else {
+    return kEpidHashAlgorithmNotSupported;
+  }
+  if (ippStsNoErr != sts) {
+    state->hash_alg = kInvalidHashAlg;
+    return kEpidMathErr;
+  }
+  state->hash_alg = hash_alg;
+  state->msg_len = 0;
+  return kEpidNoErr;
+}
+
+EpidStatus FfHashUpdate(FfHashState* state, void const* msg, size_t msg_len) {
+  Ipp8u const* part = (Ipp8u const*)msg;
+  if (!state || !state->ipp_hash || (!msg && msg_len > 0)) {
+    return kEpidBadArgErr;
+  }
+  // ipp takes the length as an int, so longer parts are absorbed in
+  // pieces of at most INT_MAX bytes
+  while (msg_len > 0) {
+    IppStatus sts = ippStsNoErr;
+    int len = msg_len > INT_MAX ? INT_MAX : (int)msg_len;
+    if (kSha256 == state->hash_alg) {
+      sts = ippsSHA256Update(part, len, (IppsSHA256State*)state->ipp_hash);
+    } else if (kSha384 == state->hash_alg) {
+      sts = ippsSHA384Update(part, len, (IppsSHA384State*)state->ipp_hash);
+    } else if (kSha512 == state->hash_alg) {
+      sts = ippsSHA512Update(part, len, (IppsSHA512State*)state->ipp_hash);
+    } else {
+      return kEpidBadArgErr;
+    }
+    if (ippStsNoErr != sts) {
+      return kEpidMathErr;
+    }
+    part += len;
+    msg_len -= (size_t)len;
+    state->msg_len += (size_t)len;
+  }
+  return kEpidNoErr;
+}
+
+EpidStatus FfHashStateCopy(FfHashState const* src, FfHashState* dst) {
+  IppStatus sts = ippStsNoErr;
+  if (!src || !src->ipp_hash || !dst || !dst->ipp_hash) {
+    return kEpidBadArgErr;
+  }
+  if (kSha256 == src->hash_alg) {
+    sts = ippsSHA256Duplicate((IppsSHA256State const*)src->ipp_hash,
+                              (IppsSHA256State*)dst->ipp_hash);
+  } else if (kSha384 == src->hash_alg) {
+    sts = ippsSHA384Duplicate((IppsSHA384State const*)src->ipp_hash,
+                              (IppsSHA384State*)dst->ipp_hash);
+  } else if (kSha512 == src->hash_alg) {
+    sts = ippsSHA512Duplicate((IppsSHA512State const*)src->ipp_hash,
+                              (IppsSHA512State*)dst->ipp_hash);
+  } else {
+    return kEpidBadArgErr;
+  }
+  if (ippStsNoErr != sts) {
+    dst->hash_alg = kInvalidHashAlg;
+    return kEpidMathErr;
+  }
+  dst->hash_alg = src->hash_alg;
+  dst->msg_len = src->msg_len;
+  return kEpidNoErr;
+}
+
+EpidStatus FfHashFinal(FiniteField* ff, FfHashState* state, FfElement* r) {
+  EpidStatus result = kEpidErr;
+  BigNum* digest_bn = NULL;
+  Ipp8u digest[IPP_SHA512_DIGEST_BITSIZE / CHAR_BIT];
+  size_t digest_len = 0;
+  do {
+    IppStatus sts = ippStsNoErr;
+    if (!ff || !state || !state->ipp_hash || !r) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    // an empty message is rejected, as FfHash does
+    if (0 == state->msg_len) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (kSha256 == state->hash_alg) {
+      digest_len = IPP_SHA256_DIGEST_BITSIZE / CHAR_BIT;
+      sts = ippsSHA256Final(digest, (IppsSHA256State*)state->ipp_hash);
+    } else if (kSha384 == state->hash_alg) {
+      digest_len = IPP_SHA384_DIGEST_BITSIZE / CHAR_BIT;
+      sts = ippsSHA384Final(digest, (IppsSHA384State*)state->ipp_hash);
+    } else if (kSha512 == state->hash_alg) {
+      digest_len = IPP_SHA512_DIGEST_BITSIZE / CHAR_BIT;
+      sts = ippsSHA512Final(digest, (IppsSHA512State*)state->ipp_hash);
+    } else {
+      result = kEpidBadArgErr;
+      break;
+    }
+    state->msg_len = 0;
+    if (ippStsNoErr != sts) {
+      state->hash_alg = kInvalidHashAlg;
+      result = kEpidMathErr;
+      break;
+    }
+    // the digest is read as a big-endian integer and reduced modulo the
+    // prime, as ippsGFpSetElementHash does for FfHash
+    result = NewBigNum(digest_len, &digest_bn);
+    if (kEpidNoErr != result) break;
+    result = ReadBigNum(digest, digest_len, digest_bn);
+    if (kEpidNoErr != result) break;
+    result = InitFfElementFromBn(ff, digest_bn, r);
+    if (kEpidNoErr != result) break;
+    result = kEpidNoErr;
+  } while (0);
+  EpidZeroMemory(digest, sizeof(digest));
+  DeleteBigNum(&digest_bn);
+  return result;
+}
+
 /// Number of tries for RNG
 #define RNG_WATCHDOG (10)
 EpidStatus FfGetRandom(FiniteField* ff, BigNumStr const* low_bound,
@@ -1276,6 +1682,7 @@ EpidStatus FfSqrt(FiniteField* ff, FfElement const* a, FfElement* r) {
   BigNum* tp1d2 = NULL;
   FfElement* gtp1d2 = NULL;
   FfElement* dd = NULL;
+  FfExpScratch* scratch = NULL;
 
   if (!ff || !a || !r) {
     return kEpidBadArgErr;
@@ -1285,6 +1692,11 @@ EpidStatus FfSqrt(FiniteField* ff, FfElement const* a, FfElement* r) {
     if (kEpidNoErr != result) {
       break;
     }
+    // all powers below are less than the prime
+    result = NewFfExpScratch(ff, sizeof(BigNumStr) * CHAR_BIT, &scratch);
+    if (kEpidNoErr != result) {
+      break;
+    }
     result = NewBigNum(sizeof(BigNumStr) * CHAR_BIT, &qm1);
     if (kEpidNoErr != result) {
       break;
@@ -1412,7 +1824,7 @@ EpidStatus FfSqrt(FiniteField* ff, FfElement const* a, FfElement* r) {
       }
 
       // 2. Check whether g^((q-1)/2) mod q = q-1. If not, go to step 1.
-      result = FfExp(ff, g, qm1d2, gg);
+      result = FfExpWithScratch(ff, g, qm1d2, scratch, gg);
       if (kEpidNoErr != result) {
         break;
       }
@@ -1472,7 +1884,7 @@ EpidStatus FfSqrt(FiniteField* ff, FfElement const* a, FfElement* r) {
       if (kEpidNoErr != result) {
         break;
       }
-      result = FfExp(ff, g, e, ge);
+      result = FfExpWithScratch(ff, g, e, scratch, ge);
       if (kEpidNoErr != result) {
         break;
       }
@@ -1485,7 +1897,7 @@ EpidStatus FfSqrt(FiniteField* ff, FfElement const* a, FfElement* r) {
       if (kEpidNoErr != result) {
         break;
       }
-      result = FfExp(ff, h, qm1dj, temp);
+      result = FfExpWithScratch(ff, h, qm1dj, scratch, temp);
       if (kEpidNoErr != result) {
         break;
       }
@@ -1503,7 +1915,7 @@ EpidStatus FfSqrt(FiniteField* ff, FfElement const* a, FfElement* r) {
     }
 
     // 8. Compute h = (a * g^(-e)) mod q.
-    result = FfExp(ff, g, e, ge);
+    result = FfExpWithScratch(ff, g, e, scratch, ge);
     if (kEpidNoErr != result) {
       break;
     }
@@ -1521,7 +1933,7 @@ EpidStatus FfSqrt(FiniteField* ff, FfElement const* a, FfElement* r) {
     if (kEpidNoErr != result) {
       break;
     }
-    result = FfExp(ff, g, ed2, ged2);
+    result = FfExpWithScratch(ff, g, ed2, scratch, ged2);
     if (kEpidNoErr != result) {
       break;
     }
@@ -1533,7 +1945,7 @@ EpidStatus FfSqrt(FiniteField* ff, FfElement const* a, FfElement* r) {
     if (kEpidNoErr != result) {
       break;
     }
-    result = FfExp(ff, h, tp1d2, gtp1d2);
+    result = FfExpWithScratch(ff, h, tp1d2, scratch, gtp1d2);
     if (kEpidNoErr != result) {
       break;
     }
@@ -1557,6 +1969,7 @@ EpidStatus FfSqrt(FiniteField* ff, FfElement const* a, FfElement* r) {
     }
     result = kEpidNoErr;
   } while (0);
+  DeleteFfExpScratch(&scratch);
   DeleteFfElement(&dd);
   DeleteFfElement(&gtp1d2);
   DeleteBigNum(&tp1d2);
@@ -22,6 +22,33 @@
 #ifndef EPID_COMMON_MATH_SRC_PAIRING_INTERNAL_H_
 #define EPID_COMMON_MATH_SRC_PAIRING_INTERNAL_H_
 
+#include <limits.h>
+
+/// Line functions of the Miller loop for a fixed G2 point
+struct PairingPrecomputedG2 {
+  size_t num_lines;  ///< number of line functions
+  FfElement** l;     ///< 3 coefficients in Fq2 per line, in loop order
+};
+
+/// Stack of reusable scratch elements of one field
+typedef struct PairingScratch {
+  FiniteField* ff;    ///< field of the elements
+  FfElement** elems;  ///< elements, allocated on first use
+  size_t size;        ///< number of allocated elements
+  size_t top;         ///< number of elements in use
+  /// index of the first element of each block allocated by NewFfElements
+  size_t blocks[sizeof(size_t) * CHAR_BIT];
+  size_t num_blocks;  ///< number of entries in blocks
+} PairingScratch;
+
+/// Miller loop variables of one pair of points, reused across pairings
+typedef struct MillerPair {
+  FfElement* ax;                    ///< x coordinate of the G1 point, in Fq
+  FfElement* ay;                    ///< y coordinate of the G1 point, in Fq
+  PairingPrecomputedG2 const* pre;  ///< lines of the G2 point
+  PairingPrecomputedG2 lines;       ///< lines computed by MultiPairing
+} MillerPair;
+
 /// Pairing State
 struct PairingState {
   EcGroup* ga;      ///< elliptic curve group G1
@@ -34,6 +61,20 @@ struct PairingState {
   FiniteField Fq;      ///< Fq
   FiniteField Fq2;     ///< Fq2
   FiniteField Fq6;     ///< Fq6
+  /// ternary representation of the Miller loop count s = 6t + 2 or 6t - 2
+  int s_ternary[sizeof(BigNumStr) * CHAR_BIT];
+  int s_len;                   ///< number of digits in s_ternary
+  /// ternary representation of t, the exponent of the final
+  /// exponentiation
+  int t_ternary[sizeof(BigNumStr) * CHAR_BIT];
+  int t_len;                   ///< index of the leading digit of t_ternary
+  size_t num_lines;            ///< number of lines in the Miller loop
+  PairingScratch fq_scratch;   ///< scratch elements in Fq
+  PairingScratch fq2_scratch;  ///< scratch elements in Fq2
+  PairingScratch fq6_scratch;  ///< scratch elements in Fq6
+  PairingScratch gt_scratch;   ///< scratch elements in GT
+  MillerPair* pairs;           ///< per pair variables of the Miller loop
+  size_t num_pairs;            ///< number of allocated pairs
 };
 
 #endif  // EPID_COMMON_MATH_SRC_PAIRING_INTERNAL_H_
@@ -20,11 +20,13 @@
  */
 
 #include <limits.h>
+#include <stdint.h>
 #include "epid/common/math/pairing.h"
 #include "epid/common/math/src/bignum-internal.h"
 #include "epid/common/math/src/finitefield-internal.h"
 #include "epid/common/math/src/ecgroup-internal.h"
 #include "epid/common/math/src/pairing-internal.h"
+#include "epid/common/math/src/stats-internal.h"
 #include "epid/common/src/memory.h"
 #include "ext/ipp/include/ippcp.h"
 #include "ext/ipp/include/ippcpepid.h"
@@ -60,6 +62,9 @@
     break;                       \
   }
 
+/// Count of elements in array
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
 #pragma pack(1)
 /// Data for element in Fq
 typedef struct FqElemDat {
@@ -88,19 +93,23 @@ static EpidStatus PiOp(PairingState* ps, FfElement* x_out, FfElement* y_out,
 static EpidStatus FrobeniusOp(PairingState* ps, FfElement* d_out,
                               FfElement const* a, const int e);
 
-static EpidStatus Line(FiniteField* gt, FfElement* f, FfElement* x_out,
-                       FfElement* y_out, FfElement* z_out, FfElement* z2_out,
-                       FfElement const* px, FfElement const* py,
-                       FfElement const* x, FfElement const* y,
-                       FfElement const* z, FfElement const* z2,
-                       FfElement const* qx, FfElement const* qy);
+static EpidStatus Line(PairingState* ps, FfElement* l0, FfElement* l1,
+                       FfElement* l2, FfElement* x_out, FfElement* y_out,
+                       FfElement* z_out, FfElement* z2_out, FfElement const* x,
+                       FfElement const* y, FfElement const* z,
+                       FfElement const* z2, FfElement const* qx,
+                       FfElement const* qy);
 
-static EpidStatus Tangent(FiniteField* gt, FfElement* f, FfElement* x_out,
-                          FfElement* y_out, FfElement* z_out, FfElement* z2_out,
-                          FfElement const* px, FfElement const* py,
+static EpidStatus Tangent(PairingState* ps, FfElement* l0, FfElement* l1,
+                          FfElement* l2, FfElement* x_out, FfElement* y_out,
+                          FfElement* z_out, FfElement* z2_out,
                           FfElement const* x, FfElement const* y,
                           FfElement const* z, FfElement const* z2);
 
+static EpidStatus EvalLine(PairingState* ps, FfElement* f, FfElement const* l0,
+                           FfElement const* l1, FfElement const* l2,
+                           FfElement const* px, FfElement const* py);
+
 static EpidStatus Ternary(int* s, int* n, int max_elements, BigNum const* x);
 
 static int Bit(Ipp32u const* num, Ipp32u bit_index);
@@ -118,22 +127,200 @@ static EpidStatus MulSpecial(FfElement* e, FfElement const* a,
 static EpidStatus SquareCyclotomic(PairingState* ps, FfElement* e_out,
                                    FfElement const* a_in);
 
+static EpidStatus SquareCompressedCyclotomic(PairingState* ps,
+                                             FfElement* const* g,
+                                             FfElement const* xi);
+
+static EpidStatus MulDecompressedCyclotomic(PairingState* ps, FfElement* e,
+                                            FfElement* c[][5], int const* s,
+                                            size_t n, FfElement const* xi);
+
+static EpidStatus ExpCyclotomicBinary(PairingState* ps, FfElement* e,
+                                      FfElement const* a,
+                                      int const* b_ternary, int b_len);
+
 static EpidStatus ExpCyclotomic(PairingState* ps, FfElement* e,
-                                FfElement const* a, BigNum const* b);
+                                FfElement const* a, int const* b_ternary,
+                                int b_len);
+
+static EpidStatus MillerLoopCount(PairingState* ps, int* s_ternary, int* s_len,
+                                  int max_elements);
+
+static size_t NumMillerLines(int const* s_ternary, int s_len);
+
+static size_t NumExpCyclotomicScratch(int const* b_ternary, int b_len);
+
+static EpidStatus ReserveMillerPairs(PairingState* ps, size_t n,
+                                     bool with_lines);
+
+static void DeleteMillerPairs(PairingState* ps);
+
+static EpidStatus ComputeFrobeniusConstants(PairingState* ps,
+                                            FfElement const* xi,
+                                            FqElemDat const* q_dat);
+
+/// Scratch elements allocated by NewPairingState, enough for Pairing
+/*!
+ These are the largest number of temporaries the pairing operations hold
+ at once. The scratch stacks grow on demand beyond these sizes and keep
+ their size until the pairing state is deleted.
+*/
+#define PAIRING_SCRATCH_FQ 4
+/// \copydoc PAIRING_SCRATCH_FQ
+#define PAIRING_SCRATCH_FQ2 22
+/// \copydoc PAIRING_SCRATCH_FQ
+#define PAIRING_SCRATCH_FQ6 7
+/// \copydoc PAIRING_SCRATCH_FQ
+#define PAIRING_SCRATCH_GT 21
+
+/// Number of compressed powers ExpCyclotomic decompresses together
+#define EXP_CYCLOTOMIC_BATCH 32
+
+/// Position of the scratch element stacks of a pairing state
+typedef struct ScratchMark {
+  size_t fq;   ///< elements in use in Fq
+  size_t fq2;  ///< elements in use in Fq2
+  size_t fq6;  ///< elements in use in Fq6
+  size_t gt;   ///< elements in use in GT
+} ScratchMark;
+
+/// Gets the current position of the scratch stacks of a pairing state
+static ScratchMark GetScratchMark(PairingState const* ps) {
+  ScratchMark mark = {0};
+  if (ps) {
+    mark.fq = ps->fq_scratch.top;
+    mark.fq2 = ps->fq2_scratch.top;
+    mark.fq6 = ps->fq6_scratch.top;
+    mark.gt = ps->gt_scratch.top;
+  }
+  return mark;
+}
+
+/// Returns the scratch elements taken after mark to the pairing state
+static void ReleaseScratch(PairingState* ps, ScratchMark mark) {
+  if (ps) {
+    ps->fq_scratch.top = mark.fq;
+    ps->fq2_scratch.top = mark.fq2;
+    ps->fq6_scratch.top = mark.fq6;
+    ps->gt_scratch.top = mark.gt;
+  }
+}
+
+/// Makes sure a scratch stack has at least size elements
+/*!
+ The stack at least doubles, and the new elements are allocated as one
+ block so that temporaries used together are close in memory.
+*/
+static EpidStatus ReserveScratch(PairingScratch* scratch, size_t size) {
+  EpidStatus result = kEpidErr;
+  FfElement** elems = NULL;
+  size_t arena_depth = 0;
+  if (size <= scratch->size) {
+    return kEpidNoErr;
+  }
+  if (size < 2 * scratch->size) {
+    size = 2 * scratch->size;
+  }
+  if (size > SIZE_MAX / sizeof(FfElement*) ||
+      scratch->num_blocks >= COUNT_OF(scratch->blocks)) {
+    return kEpidBadArgErr;
+  }
+  // the scratch lives as long as the pairing state, so it must not be
+  // taken from an allocation arena of the calling thread
+  arena_depth = EpidArenaSuspend();
+  do {
+    elems =
+        (FfElement**)EpidRealloc(scratch->elems, size * sizeof(FfElement*));
+    if (!elems) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    scratch->elems = elems;
+    result = NewFfElements(scratch->ff, &scratch->elems[scratch->size],
+                           size - scratch->size);
+    if (kEpidNoErr != result) {
+      break;
+    }
+    scratch->blocks[scratch->num_blocks++] = scratch->size;
+    scratch->size = size;
+    result = kEpidNoErr;
+  } while (0);
+  EpidArenaResume(arena_depth);
+  return result;
+}
+
+/// Frees the elements of a scratch stack
+static void DeleteScratch(PairingScratch* scratch) {
+  size_t i = 0;
+  if (scratch->elems) {
+    for (i = 0; i < scratch->num_blocks; i++) {
+      size_t end = (i + 1 < scratch->num_blocks) ? scratch->blocks[i + 1]
+                                                   : scratch->size;
+      DeleteFfElements(&scratch->elems[scratch->blocks[i]],
+                       end - scratch->blocks[i]);
+    }
+    SAFE_FREE(scratch->elems);
+  }
+  scratch->num_blocks = 0;
+  scratch->size = 0;
+  scratch->top = 0;
+}
+
+/// Takes a zero element of field ff from the scratch of a pairing state
+/*!
+ Replaces NewFfElement for temporaries of the pairing operations. The
+ element belongs to the pairing state and is returned by ReleaseScratch
+ to a mark taken before this call; it must not be deleted.
+*/
+static EpidStatus NewScratchElement(PairingState* ps, FiniteField* ff,
+                                    FfElement** e) {
+  PairingScratch* scratch = NULL;
+  IppStatus sts = ippStsNoErr;
+  Ipp32u zero_dat[] = {0};
+  if (!ps || !ff || !e) {
+    return kEpidBadArgErr;
+  }
+  if (ff == &ps->Fq) {
+    scratch = &ps->fq_scratch;
+  } else if (ff == &ps->Fq2) {
+    scratch = &ps->fq2_scratch;
+  } else if (ff == &ps->Fq6) {
+    scratch = &ps->fq6_scratch;
+  } else if (ff == ps->ff) {
+    scratch = &ps->gt_scratch;
+  } else {
+    return kEpidBadArgErr;
+  }
+  if (scratch->top == scratch->size) {
+    EpidStatus result =
+        ReserveScratch(scratch, scratch->size ? 2 * scratch->size : 1);
+    if (kEpidNoErr != result) {
+      return result;
+    }
+  }
+  sts = ippsGFpSetElement(zero_dat, sizeof(zero_dat) / sizeof(Ipp32u),
+                          scratch->elems[scratch->top]->ipp_ff_elem,
+                          ff->ipp_ff);
+  RETURN_ON_IPP_ERROR(sts);
+  *e = scratch->elems[scratch->top++];
+  return kEpidNoErr;
+}
 
 // Implementation
 
 EpidStatus NewPairingState(EcGroup const* ga, EcGroup const* gb,
                            FiniteField* ff, BigNumStr const* t, bool neg,
                            PairingState** ps) {
+  return NewPairingStateWithConstants(ga, gb, ff, t, neg, NULL, ps);
+}
+
+EpidStatus NewPairingStateWithConstants(EcGroup const* ga, EcGroup const* gb,
+                                        FiniteField* ff, BigNumStr const* t,
+                                        bool neg, Fq2ElemStr const* frob,
+                                        PairingState** ps) {
   EpidStatus result = kEpidErr;
   FfElement* xi = NULL;
   PairingState* paring_state_ctx = NULL;
-  BigNum* e = NULL;
-  BigNum* one = NULL;
-  BigNum* q = NULL;
-  BigNum* six = NULL;
-  Ipp8u* scratch_buffer = NULL;
   do {
     IppStatus sts = ippStsNoErr;
     IppsGFpState* Fq6 = NULL;
@@ -142,13 +329,8 @@ EpidStatus NewPairingState(EcGroup const* ga, EcGroup const* gb,
     FiniteField Ffq2;
     IppsGFpInfo info = {0};
     Fq2ElemDat Fq6IrrPolynomial[3 + 1] = {0};
-    uint8_t one_str[] = {1};
-    uint8_t six_str[] = {6};
     FqElemDat qDat = {0};
     int i = 0;
-    int j = 0;
-    int bufferSize = 0;
-    int bitSize = 0;
     // validate inputs
     if (!ga || !gb || !ff || !t || !ps) {
       result = kEpidBadArgErr;
@@ -209,12 +391,121 @@ EpidStatus NewPairingState(EcGroup const* ga, EcGroup const* gb,
     BREAK_ON_EPID_ERROR(result);
     // 2. Let g[0][0], ..., g[0][4], g[1][0], ..., g[1][4], g[2][0], ...,
     // g[2][4] be 15 elements in Fq2.
-    for (i = 0; i < 3; i++) {
-      for (j = 0; j < 5; j++) {
-        result = NewFfElement(&Ffq2, &paring_state_ctx->g[i][j]);
+    result = NewFfElements(&Ffq2, &paring_state_ctx->g[0][0],
+                           sizeof(paring_state_ctx->g) / sizeof(FfElement*));
+    BREAK_ON_EPID_ERROR(result);
+    if (frob) {
+      // 3. - 5. Read g[0][0], ..., g[2][4] from the precomputed values.
+      for (i = 0; i < 15; i++) {
+        result = ReadFfElement(&Ffq2, &frob[i], sizeof(frob[i]),
+                               (&paring_state_ctx->g[0][0])[i]);
         BREAK_ON_EPID_ERROR(result);
       }
+      BREAK_ON_EPID_ERROR(result);
+    } else {
+      result = ComputeFrobeniusConstants(paring_state_ctx, xi, &qDat);
+      BREAK_ON_EPID_ERROR(result);
+    }
+    // 6. Save g[0][0], ..., g[0][4], g[1][0], ..., g[1][4], g[2][0], ...,
+    // g[2][4]
+    //    for the pairing operations.
+    // 7. Save the ternary representations of s = 6t + 2 or 6t - 2 and of
+    // t and allocate the scratch elements of the pairing operations, so
+    // that pairings do not allocate memory.
+    result = MillerLoopCount(
+        paring_state_ctx, paring_state_ctx->s_ternary,
+        &paring_state_ctx->s_len,
+        sizeof(paring_state_ctx->s_ternary) / sizeof(int));
+    BREAK_ON_EPID_ERROR(result);
+    paring_state_ctx->num_lines = NumMillerLines(paring_state_ctx->s_ternary,
+                                                 paring_state_ctx->s_len);
+    result = Ternary(paring_state_ctx->t_ternary, &paring_state_ctx->t_len,
+                     COUNT_OF(paring_state_ctx->t_ternary),
+                     paring_state_ctx->t);
+    BREAK_ON_EPID_ERROR(result);
+    paring_state_ctx->fq_scratch.ff = &paring_state_ctx->Fq;
+    paring_state_ctx->fq2_scratch.ff = &paring_state_ctx->Fq2;
+    paring_state_ctx->fq6_scratch.ff = &paring_state_ctx->Fq6;
+    paring_state_ctx->gt_scratch.ff = paring_state_ctx->ff;
+    result = ReserveScratch(&paring_state_ctx->fq_scratch, PAIRING_SCRATCH_FQ);
+    BREAK_ON_EPID_ERROR(result);
+    result =
+        ReserveScratch(&paring_state_ctx->fq2_scratch, PAIRING_SCRATCH_FQ2);
+    BREAK_ON_EPID_ERROR(result);
+    result = ReserveScratch(
+        &paring_state_ctx->fq2_scratch,
+        NumExpCyclotomicScratch(paring_state_ctx->t_ternary,
+                                paring_state_ctx->t_len));
+    BREAK_ON_EPID_ERROR(result);
+    result =
+        ReserveScratch(&paring_state_ctx->fq6_scratch, PAIRING_SCRATCH_FQ6);
+    BREAK_ON_EPID_ERROR(result);
+    result = ReserveScratch(&paring_state_ctx->gt_scratch, PAIRING_SCRATCH_GT);
+    BREAK_ON_EPID_ERROR(result);
+    result = ReserveMillerPairs(paring_state_ctx, 1, true);
+    BREAK_ON_EPID_ERROR(result);
+    *ps = paring_state_ctx;
+    result = kEpidNoErr;
+  } while (0);
+  DeleteFfElement(&xi);
+  if (kEpidNoErr != result) {
+    if (paring_state_ctx) {
+      DeleteFfElements(&paring_state_ctx->g[0][0],
+                       sizeof(paring_state_ctx->g) / sizeof(FfElement*));
+      DeleteMillerPairs(paring_state_ctx);
+      DeleteScratch(&paring_state_ctx->fq_scratch);
+      DeleteScratch(&paring_state_ctx->fq2_scratch);
+      DeleteScratch(&paring_state_ctx->fq6_scratch);
+      DeleteScratch(&paring_state_ctx->gt_scratch);
+      DeleteBigNum(&paring_state_ctx->t);
+      SAFE_FREE(paring_state_ctx);
+    }
+  }
+  return result;
+}
+
+void DeletePairingState(PairingState** ps) {
+  if (!ps) {
+    return;
+  }
+  if (!*ps) {
+    return;
+  }
+  if (ps) {
+    if (*ps) {
+      DeleteFfElements(&(*ps)->g[0][0], sizeof((*ps)->g) / sizeof(FfElement*));
+      DeleteMillerPairs(*ps);
+      DeleteScratch(&(*ps)->fq_scratch);
+      DeleteScratch(&(*ps)->fq2_scratch);
+      DeleteScratch(&(*ps)->fq6_scratch);
+      DeleteScratch(&(*ps)->gt_scratch);
+      DeleteBigNum(&(*ps)->t);
+      (*ps)->ga = NULL;
+      (*ps)->gb = NULL;
+      (*ps)->ff = NULL;
     }
+    SAFE_FREE(*ps);
+  }
+}
+
+/// Computes the Frobenius constants g[0][0], ..., g[2][4] of a pairing state
+static EpidStatus ComputeFrobeniusConstants(PairingState* ps,
+                                            FfElement const* xi,
+                                            FqElemDat const* q_dat) {
+  EpidStatus result = kEpidErr;
+  BigNum* e = NULL;
+  BigNum* one = NULL;
+  BigNum* q = NULL;
+  BigNum* six = NULL;
+  Ipp8u* scratch_buffer = NULL;
+  do {
+    IppStatus sts = ippStsNoErr;
+    IppsGFpState* Fq2 = ps->Fq2.ipp_ff;
+    uint8_t one_str[] = {1};
+    uint8_t six_str[] = {6};
+    int i = 0;
+    int bufferSize = 0;
+    int bitSize = 0;
     // 3. Compute a big integer e = (q - 1)/6.
     result = NewBigNum(sizeof(BigNumStr), &one);
     BREAK_ON_EPID_ERROR(result);
@@ -222,8 +513,8 @@ EpidStatus NewPairingState(EcGroup const* ga, EcGroup const* gb,
     BREAK_ON_EPID_ERROR(result);
     result = NewBigNum(sizeof(BigNumStr), &q);
     BREAK_ON_EPID_ERROR(result);
-    sts = ippsSet_BN(IppsBigNumPOS, sizeof(qDat) / sizeof(Ipp32u),
-                     (Ipp32u*)&qDat, q->ipp_bn);
+    sts = ippsSet_BN(IppsBigNumPOS, sizeof(*q_dat) / sizeof(Ipp32u),
+                     (Ipp32u*)q_dat, q->ipp_bn);
     BREAK_ON_IPP_ERROR(sts, result);
     result = NewBigNum(sizeof(BigNumStr), &e);
     BREAK_ON_EPID_ERROR(result);
@@ -248,34 +539,26 @@ EpidStatus NewPairingState(EcGroup const* ga, EcGroup const* gb,
       result = kEpidMemAllocErr;
       break;
     }
-    sts =
-        ippsGFpExp(xi->ipp_ff_elem, e->ipp_bn,
-                   paring_state_ctx->g[0][0]->ipp_ff_elem, Fq2, scratch_buffer);
+    sts = ippsGFpExp(xi->ipp_ff_elem, e->ipp_bn, ps->g[0][0]->ipp_ff_elem,
+                     Fq2, scratch_buffer);
     BREAK_ON_IPP_ERROR(sts, result);
     // 5. For i = 0, ..., 4, compute
     for (i = 0; i < 5; i++) {
       // a. If i > 0, compute g[0][i] = Fq2.mul(g[0][i-1], g[0][0]).
       if (i > 0) {
-        sts = ippsGFpMul(paring_state_ctx->g[0][i - 1]->ipp_ff_elem,
-                         paring_state_ctx->g[0][0]->ipp_ff_elem,
-                         paring_state_ctx->g[0][i]->ipp_ff_elem, Fq2);
+        sts = ippsGFpMul(ps->g[0][i - 1]->ipp_ff_elem, ps->g[0][0]->ipp_ff_elem,
+                         ps->g[0][i]->ipp_ff_elem, Fq2);
       }
       // b. Compute g[1][i] = Fq2.conjugate(g[0][i]),
-      sts = ippsGFpConj(paring_state_ctx->g[0][i]->ipp_ff_elem,
-                        paring_state_ctx->g[1][i]->ipp_ff_elem, Fq2);
+      sts = ippsGFpConj(ps->g[0][i]->ipp_ff_elem, ps->g[1][i]->ipp_ff_elem,
+                        Fq2);
       // c. Compute g[1][i] = Fq2.mul(g[0][i], g[1][i]),
-      sts = ippsGFpMul(paring_state_ctx->g[0][i]->ipp_ff_elem,
-                       paring_state_ctx->g[1][i]->ipp_ff_elem,
-                       paring_state_ctx->g[1][i]->ipp_ff_elem, Fq2);
+      sts = ippsGFpMul(ps->g[0][i]->ipp_ff_elem, ps->g[1][i]->ipp_ff_elem,
+                       ps->g[1][i]->ipp_ff_elem, Fq2);
       // d. Compute g[2][i] = Fq2.mul(g[0][i], g[1][i]).
-      sts = ippsGFpMul(paring_state_ctx->g[0][i]->ipp_ff_elem,
-                       paring_state_ctx->g[1][i]->ipp_ff_elem,
-                       paring_state_ctx->g[2][i]->ipp_ff_elem, Fq2);
+      sts = ippsGFpMul(ps->g[0][i]->ipp_ff_elem, ps->g[1][i]->ipp_ff_elem,
+                       ps->g[2][i]->ipp_ff_elem, Fq2);
     }
-    // 6. Save g[0][0], ..., g[0][4], g[1][0], ..., g[1][4], g[2][0], ...,
-    // g[2][4]
-    //    for the pairing operations.
-    *ps = paring_state_ctx;
     result = kEpidNoErr;
   } while (0);
   SAFE_FREE(scratch_buffer)
@@ -283,150 +566,164 @@ EpidStatus NewPairingState(EcGroup const* ga, EcGroup const* gb,
   DeleteBigNum(&e);
   DeleteBigNum(&q);
   DeleteBigNum(&one);
-  DeleteFfElement(&xi);
-  if (kEpidNoErr != result) {
-    if (paring_state_ctx) {
-      int i = 0;
-      int j = 0;
-      for (i = 0; i < 3; i++) {
-        for (j = 0; j < 5; j++) {
-          DeleteFfElement(&paring_state_ctx->g[i][j]);
-        }
-      }
-      DeleteBigNum(&paring_state_ctx->t);
-      SAFE_FREE(paring_state_ctx);
+  return result;
+}
+
+/// Computes the ternary representation of the Miller loop count
+/*!
+ If neg = 0, computes integer s = 6t + 2, otherwise, computes s = 6t - 2.
+ Returns sn...s1s0, the ternary representation of s, that is s = s0 +
+ 2*s1 + ... + 2^n*sn, where si is in {-1, 0, 1}.
+*/
+static EpidStatus MillerLoopCount(PairingState* ps, int* s_ternary, int* s_len,
+                                  int max_elements) {
+  EpidStatus result = kEpidErr;
+  BigNum* s = NULL;
+  BigNum* two = NULL;
+  BigNum* six = NULL;
+  do {
+    IppStatus sts = ippStsNoErr;
+    Ipp32u two_dat[] = {2};
+    Ipp32u six_dat[] = {6};
+    result = NewBigNum(sizeof(BigNumStr), &s);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewBigNum(sizeof(BigNumStr), &two);
+    BREAK_ON_EPID_ERROR(result);
+    sts = ippsSet_BN(IppsBigNumPOS, sizeof(two_dat) / sizeof(Ipp32u), two_dat,
+                     two->ipp_bn);
+    BREAK_ON_IPP_ERROR(sts, result);
+    result = NewBigNum(sizeof(BigNumStr), &six);
+    BREAK_ON_EPID_ERROR(result);
+    sts = ippsSet_BN(IppsBigNumPOS, sizeof(six_dat) / sizeof(Ipp32u), six_dat,
+                     six->ipp_bn);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsMul_BN(six->ipp_bn, ps->t->ipp_bn, s->ipp_bn);
+    BREAK_ON_IPP_ERROR(sts, result);
+    if (ps->neg) {
+      sts = ippsSub_BN(s->ipp_bn, two->ipp_bn, s->ipp_bn);
+      BREAK_ON_IPP_ERROR(sts, result);
+    } else {
+      sts = ippsAdd_BN(s->ipp_bn, two->ipp_bn, s->ipp_bn);
+      BREAK_ON_IPP_ERROR(sts, result);
     }
-  }
+    result = Ternary(s_ternary, s_len, max_elements, s);
+    BREAK_ON_EPID_ERROR(result);
+    result = kEpidNoErr;
+  } while (0);
+  DeleteBigNum(&s);
+  DeleteBigNum(&two);
+  DeleteBigNum(&six);
   return result;
 }
 
-void DeletePairingState(PairingState** ps) {
-  if (!ps) {
-    return;
-  }
-  if (!*ps) {
-    return;
+/// Number of line functions evaluated by a Miller loop of count s
+static size_t NumMillerLines(int const* s_ternary, int s_len) {
+  // a tangent for every digit, a line for every non-zero digit and the
+  // two Frobenius lines at the end
+  size_t num_lines = 2;
+  int i = 0;
+  for (i = 0; i < s_len; i++) {
+    num_lines += (0 != s_ternary[i]) ? 2 : 1;
   }
-  if (ps) {
-    if (*ps) {
-      int i = 0;
-      int j = 0;
-      for (i = 0; i < 3; i++) {
-        for (j = 0; j < 5; j++) {
-          DeleteFfElement(&(*ps)->g[i][j]);
-        }
-      }
-      DeleteBigNum(&(*ps)->t);
-      (*ps)->ga = NULL;
-      (*ps)->gb = NULL;
-      (*ps)->ff = NULL;
+  return num_lines;
+}
+
+/// Number of scratch elements in Fq2 taken by ExpCyclotomic for exponent b
+static size_t NumExpCyclotomicScratch(int const* b_ternary, int b_len) {
+  // xi, the compressed power, the temporaries of a squaring and five
+  // elements for each compressed power in a batch
+  size_t batch = 0;
+  int i = 0;
+  for (i = 0; i <= b_len; i++) {
+    if (0 != b_ternary[i] && batch < EXP_CYCLOTOMIC_BATCH) {
+      batch++;
     }
-    SAFE_FREE(*ps);
   }
+  return 1 + 4 + 7 + 5 * batch;
 }
 
-EpidStatus Pairing(PairingState* ps, FfElement* d, EcPoint const* a,
-                   EcPoint const* b) {
+/// Allocates the coefficients of the lines of a Miller loop
+static EpidStatus NewMillerLines(PairingState* ps,
+                                 PairingPrecomputedG2* lines) {
+  lines->l = (FfElement**)SAFE_ALLOC(3 * ps->num_lines * sizeof(FfElement*));
+  if (!lines->l) {
+    return kEpidMemAllocErr;
+  }
+  lines->num_lines = ps->num_lines;
+  return NewFfElements(&ps->Fq2, lines->l, 3 * lines->num_lines);
+}
+
+/// Frees the coefficients of the lines of a Miller loop
+static void DeleteMillerLines(PairingPrecomputedG2* lines) {
+  if (lines->l) {
+    DeleteFfElements(lines->l, 3 * lines->num_lines);
+    SAFE_FREE(lines->l);
+  }
+  lines->num_lines = 0;
+}
+
+/// Records the lines of the Miller loop of a G2 point
+/*!
+ Runs the G2 half of the Miller loop for b and stores the coefficients of
+ every tangent and line function in lines, in the order they are
+ evaluated.
+*/
+static EpidStatus RecordMillerLines(PairingState* ps, EcPoint const* b,
+                                    PairingPrecomputedG2* lines) {
   EpidStatus result = kEpidErr;
-  FfElement* ax = NULL;
-  FfElement* ay = NULL;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* bx = NULL;
   FfElement* by = NULL;
+  FfElement* neg_by = NULL;
   FfElement* x = NULL;
   FfElement* y = NULL;
   FfElement* z = NULL;
   FfElement* z2 = NULL;
   FfElement* bx_ = NULL;
   FfElement* by_ = NULL;
-  FfElement* f = NULL;
-  BigNum* s = NULL;
-  BigNum* two = NULL;
-  BigNum* six = NULL;
-  FfElement* neg_qy = NULL;
 
   do {
     IppStatus sts = ippStsNoErr;
-    Ipp32u two_dat[] = {2};
-    Ipp32u six_dat[] = {6};
     Ipp32u one_dat[] = {1};
-    int s_ternary[sizeof(BigNumStr) * CHAR_BIT] = {0};
     int i = 0;
-    int n = 0;
+    FfElement** l = NULL;
     // check parameters
-    if (!ps || !d || !a || !b) {
+    if (!ps || !b || !lines) {
       result = kEpidBadArgErr;
       break;
     }
-    if (!d->ipp_ff_elem || !a->ipp_ec_pt || !b->ipp_ec_pt || !ps->ff ||
-        !ps->ff->ipp_ff || !ps->Fq.ipp_ff || !ps->Fq2.ipp_ff || !ps->t ||
-        !ps->t->ipp_bn || !ps->ga || !ps->ga->ipp_ec || !ps->gb ||
+    if (!b->ipp_ec_pt || !lines->l || ps->num_lines != lines->num_lines ||
+        !ps->ff || !ps->ff->ipp_ff || !ps->Fq2.ipp_ff || !ps->gb ||
         !ps->gb->ipp_ec) {
       result = kEpidBadArgErr;
       break;
     }
-    // Let ax, ay be elements in Fq. Let bx, by, x, y, z, z2, bx', by'
-    // be elements in Fq2. Let f be a variable in GT.
-    result = NewFfElement(&ps->Fq, &ax);
-    BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&ps->Fq, &ay);
-    BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&ps->Fq2, &bx);
-    BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&ps->Fq2, &by);
+    // Let bx, by, bx', by', x, y, z, z2 be elements in Fq2.
+    result = NewScratchElement(ps, &ps->Fq2, &bx);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&ps->Fq2, &x);
+    result = NewScratchElement(ps, &ps->Fq2, &by);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&ps->Fq2, &y);
+    result = NewScratchElement(ps, &ps->Fq2, &neg_by);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&ps->Fq2, &z);
+    result = NewScratchElement(ps, &ps->Fq2, &x);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&ps->Fq2, &z2);
+    result = NewScratchElement(ps, &ps->Fq2, &y);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&ps->Fq2, &bx_);
+    result = NewScratchElement(ps, &ps->Fq2, &z);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&ps->Fq2, &by_);
+    result = NewScratchElement(ps, &ps->Fq2, &z2);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &f);
+    result = NewScratchElement(ps, &ps->Fq2, &bx_);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&ps->Fq2, &neg_qy);
+    result = NewScratchElement(ps, &ps->Fq2, &by_);
     BREAK_ON_EPID_ERROR(result);
 
-    // 1. If neg = 0, compute integer s = 6t + 2, otherwise, compute
-    // s = 6t - 2
-    result = NewBigNum(sizeof(BigNumStr), &s);
-    BREAK_ON_EPID_ERROR(result);
-    result = NewBigNum(sizeof(BigNumStr), &two);
-    BREAK_ON_EPID_ERROR(result);
-    sts = ippsSet_BN(IppsBigNumPOS, sizeof(two_dat) / sizeof(Ipp32u), two_dat,
-                     two->ipp_bn);
-    BREAK_ON_IPP_ERROR(sts, result);
-    result = NewBigNum(sizeof(BigNumStr), &six);
-    BREAK_ON_EPID_ERROR(result);
-    sts = ippsSet_BN(IppsBigNumPOS, sizeof(six_dat) / sizeof(Ipp32u), six_dat,
-                     six->ipp_bn);
-    BREAK_ON_IPP_ERROR(sts, result);
-    sts = ippsMul_BN(six->ipp_bn, ps->t->ipp_bn, s->ipp_bn);
-    BREAK_ON_IPP_ERROR(sts, result);
-    if (ps->neg) {
-      sts = ippsSub_BN(s->ipp_bn, two->ipp_bn, s->ipp_bn);
-      BREAK_ON_IPP_ERROR(sts, result);
-    } else {
-      sts = ippsAdd_BN(s->ipp_bn, two->ipp_bn, s->ipp_bn);
-      BREAK_ON_IPP_ERROR(sts, result);
-    }
-    // 2. Let sn...s1s0 be the ternary representation of s, that is s =
-    // s0 + 2*s1 + ... + 2^n*sn, where si is in {-1, 0, 1}.
-    result =
-        Ternary(s_ternary, &n, sizeof(s_ternary) / sizeof(s_ternary[0]), s);
-    BREAK_ON_EPID_ERROR(result);
-    // 3. Set (ax, ay) = E(Fq).outputPoint(a)
-    sts = ippsGFpECGetPoint(a->ipp_ec_pt, ax->ipp_ff_elem, ay->ipp_ff_elem,
-                            ps->ga->ipp_ec);
-    BREAK_ON_IPP_ERROR(sts, result);
     // 4. Set (bx, by) = E(Fq2).outputPoint(b).
     sts = ippsGFpECGetPoint(b->ipp_ec_pt, bx->ipp_ff_elem, by->ipp_ff_elem,
                             ps->gb->ipp_ec);
     BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpNeg(by->ipp_ff_elem, neg_by->ipp_ff_elem, ps->Fq2.ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
     // 5. Set X = bx, Y = by, Z = Z2 = 1.
     sts = ippsGFpCpyElement(bx->ipp_ff_elem, x->ipp_ff_elem, ps->Fq2.ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
@@ -438,104 +735,309 @@ EpidStatus Pairing(PairingState* ps, FfElement* d, EcPoint const* a,
     sts = ippsGFpSetElement(one_dat, sizeof(one_dat) / sizeof(Ipp32u),
                             z2->ipp_ff_elem, ps->Fq2.ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
-    // 6. Set d = 1.
-    sts = ippsGFpSetElement(one_dat, sizeof(one_dat) / sizeof(Ipp32u),
-                            d->ipp_ff_elem, ps->ff->ipp_ff);
-    BREAK_ON_IPP_ERROR(sts, result);
-    // 7. For i = n-1, ..., 0, do the following:
-    for (i = n - 1; i >= 0; i--) {
-      // a. Set (f, x, y, z, z2) = tangent(ax, ay, x, y, z, z2),
-      result = Tangent(ps->ff, f, x, y, z, z2, ax, ay, x, y, z, z2);
-      BREAK_ON_EPID_ERROR(result);
-      // b. Set d = Fq12.square(d),
-      sts = ippsGFpMul(d->ipp_ff_elem, d->ipp_ff_elem, d->ipp_ff_elem,
-                       ps->ff->ipp_ff);
-      BREAK_ON_IPP_ERROR(sts, result);
-      // c. Set d = Fq12.mulSpecial(d, f),
-      result = MulSpecial(d, d, f, ps);
+    // 7. For i = n-1, ..., 0, record the lines of the Miller loop in the
+    // order they are evaluated:
+    l = lines->l;
+    for (i = ps->s_len - 1; i >= 0; i--) {
+      // a. Set (l, x, y, z, z2) = tangent(x, y, z, z2),
+      result = Tangent(ps, l[0], l[1], l[2], x, y, z, z2, x, y, z, z2);
       BREAK_ON_EPID_ERROR(result);
-      // d. If s[i] = -1 then
-      if (-1 == s_ternary[i]) {
-        // i. Set (f, x, y, z, z2) = line(ax, ay, x, y, z, z2, bx,
-        // -by),
-        BREAK_ON_EPID_ERROR(result);
-        sts = ippsGFpNeg(by->ipp_ff_elem, neg_qy->ipp_ff_elem, ps->Fq2.ipp_ff);
-        BREAK_ON_IPP_ERROR(sts, result);
-        result = Line(ps->ff, f, x, y, z, z2, ax, ay, x, y, z, z2, bx, neg_qy);
-        BREAK_ON_EPID_ERROR(result);
-        // ii. Set d = Fq12.mulSpecial(d, f).
-        result = MulSpecial(d, d, f, ps);
-        BREAK_ON_EPID_ERROR(result);
-      }
-      // e. If s[i] = 1 then
-      if (1 == s_ternary[i]) {
-        // i. Set (f, x, y, z, z2) = line(ax, ay, x, y, z, z2, bx,
-        // by),
-        result = Line(ps->ff, f, x, y, z, z2, ax, ay, x, y, z, z2, bx, by);
-        BREAK_ON_EPID_ERROR(result);
-        // ii. Set d = Fq12.mulSpecial(d, f).
-        result = MulSpecial(d, d, f, ps);
+      l += 3;
+      // d. If s[i] = -1 then set (l, x, y, z, z2) = line(x, y, z, z2,
+      // bx, -by),
+      // e. If s[i] = 1 then set (l, x, y, z, z2) = line(x, y, z, z2,
+      // bx, by).
+      if (0 != ps->s_ternary[i]) {
+        result = Line(ps, l[0], l[1], l[2], x, y, z, z2, x, y, z, z2, bx,
+                      (-1 == ps->s_ternary[i]) ? neg_by : by);
         BREAK_ON_EPID_ERROR(result);
+        l += 3;
       }
     }
-
-    // 8. if neg = true,
+    BREAK_ON_EPID_ERROR(result);
+    // 8. If neg = true, set Y = Fq2.negate(y).
     if (ps->neg) {
-      // a. Set Y = Fq2.negate(y),
       sts = ippsGFpNeg(y->ipp_ff_elem, y->ipp_ff_elem, ps->Fq2.ipp_ff);
       BREAK_ON_IPP_ERROR(sts, result);
-      // b. Set d = Fq12.conjugate(d).
-      sts = ippsGFpConj(d->ipp_ff_elem, d->ipp_ff_elem, ps->ff->ipp_ff);
-      BREAK_ON_IPP_ERROR(sts, result);
     }
     // 9. Set (bx', by') = Pi-op(bx, by, 1).
     result = PiOp(ps, bx_, by_, bx, by, 1);
     BREAK_ON_EPID_ERROR(result);
-    // 10. Set (f, x, y, z, z2) = line(ax, ay, x, y, z, z2, bx', by').
-    result = Line(ps->ff, f, x, y, z, z2, ax, ay, x, y, z, z2, bx_, by_);
-    BREAK_ON_EPID_ERROR(result);
-    // 11. Set d = Fq12.mulSpecial(d, f).
-    result = MulSpecial(d, d, f, ps);
+    // 10. Set (l, x, y, z, z2) = line(x, y, z, z2, bx', by').
+    result = Line(ps, l[0], l[1], l[2], x, y, z, z2, x, y, z, z2, bx_, by_);
     BREAK_ON_EPID_ERROR(result);
+    l += 3;
     // 12. Set (bx', by') = piOp(bx, by, 2).
     result = PiOp(ps, bx_, by_, bx, by, 2);
     BREAK_ON_EPID_ERROR(result);
     // 13. Set by' = Fq2.negate(by').
     sts = ippsGFpNeg(by_->ipp_ff_elem, by_->ipp_ff_elem, ps->Fq2.ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
-    // 14. Set (f, x, y, z, z2) = line(ax, ay, x, y, z, z2, bx', by').
-    result = Line(ps->ff, f, x, y, z, z2, ax, ay, x, y, z, z2, bx_, by_);
+    // 14. Set (l, x, y, z, z2) = line(x, y, z, z2, bx', by').
+    result = Line(ps, l[0], l[1], l[2], x, y, z, z2, x, y, z, z2, bx_, by_);
     BREAK_ON_EPID_ERROR(result);
-    // 15. Set d = Fq12.mulSpecial(d, f).
-    result = MulSpecial(d, d, f, ps);
+    result = kEpidNoErr;
+  } while (0);
+
+  ReleaseScratch(ps, mark);
+
+  return result;
+}
+
+/// Makes sure the pairing state has Miller loop variables for n pairs
+static EpidStatus ReserveMillerPairs(PairingState* ps, size_t n,
+                                     bool with_lines) {
+  EpidStatus result = kEpidNoErr;
+  size_t j = 0;
+  size_t arena_depth = 0;
+  if (n > SIZE_MAX / sizeof(MillerPair)) {
+    return kEpidBadArgErr;
+  }
+  // the variables live as long as the pairing state, so they must not be
+  // taken from an allocation arena of the calling thread
+  arena_depth = EpidArenaSuspend();
+  do {
+    if (n > ps->num_pairs) {
+      MillerPair* pairs =
+          (MillerPair*)EpidRealloc(ps->pairs, n * sizeof(MillerPair));
+      if (!pairs) {
+        result = kEpidMemAllocErr;
+        break;
+      }
+      EpidZeroMemory(pairs + ps->num_pairs,
+                     (n - ps->num_pairs) * sizeof(MillerPair));
+      ps->pairs = pairs;
+      ps->num_pairs = n;
+    }
+    for (j = 0; j < n; j++) {
+      MillerPair* pair = &ps->pairs[j];
+      if (!pair->ax) {
+        result = NewFfElement(&ps->Fq, &pair->ax);
+        if (kEpidNoErr != result) break;
+      }
+      if (!pair->ay) {
+        result = NewFfElement(&ps->Fq, &pair->ay);
+        if (kEpidNoErr != result) break;
+      }
+      if (with_lines && !pair->lines.l) {
+        result = NewMillerLines(ps, &pair->lines);
+        if (kEpidNoErr != result) break;
+      }
+    }
+  } while (0);
+  EpidArenaResume(arena_depth);
+  return result;
+}
+
+/// Frees the Miller loop variables of a pairing state
+static void DeleteMillerPairs(PairingState* ps) {
+  size_t j = 0;
+  if (ps->pairs) {
+    for (j = 0; j < ps->num_pairs; j++) {
+      DeleteFfElement(&ps->pairs[j].ax);
+      DeleteFfElement(&ps->pairs[j].ay);
+      DeleteMillerLines(&ps->pairs[j].lines);
+    }
+    SAFE_FREE(ps->pairs);
+  }
+  ps->num_pairs = 0;
+}
+
+EpidStatus NewPairingPrecomputedG2(PairingState* ps, EcPoint const* b,
+                                   PairingPrecomputedG2** pre) {
+  EpidStatus result = kEpidErr;
+  PairingPrecomputedG2* lines = NULL;
+  do {
+    // check parameters
+    if (!ps || !b || !pre) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    lines = (PairingPrecomputedG2*)SAFE_ALLOC(sizeof(PairingPrecomputedG2));
+    if (!lines) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    result = NewMillerLines(ps, lines);
     BREAK_ON_EPID_ERROR(result);
-    // 16. Set d = finalExp(d).
+    result = RecordMillerLines(ps, b, lines);
+    BREAK_ON_EPID_ERROR(result);
+    *pre = lines;
+    lines = NULL;
+    result = kEpidNoErr;
+  } while (0);
+  DeletePairingPrecomputedG2(&lines);
+  return result;
+}
+
+void DeletePairingPrecomputedG2(PairingPrecomputedG2** pre) {
+  if (pre && *pre) {
+    DeleteMillerLines(*pre);
+    SAFE_FREE(*pre);
+  }
+}
+
+/// Computes the product of pairings of G1 points and precomputed G2 points
+/*!
+ Pairs a[j] with the lines ps->pairs[j].pre. The Miller loops of all
+ pairs are run together so that the accumulator is squared once per
+ iteration and the final exponentiation is done once for the product.
+*/
+static EpidStatus MultiPairingPrecomp(PairingState* ps, FfElement* d,
+                                      EcPoint const** a, size_t n) {
+  EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
+  FfElement* f = NULL;
+  EPID_MATH_STAT_START(start);
+
+  do {
+    IppStatus sts = ippStsNoErr;
+    Ipp32u one_dat[] = {1};
+    int i = 0;
+    size_t j = 0;
+    size_t k = 0;
+    // check parameters
+    if (!ps || !d || !a || 0 == n || n > ps->num_pairs) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (!d->ipp_ff_elem || !ps->ff || !ps->ff->ipp_ff || !ps->Fq.ipp_ff ||
+        !ps->Fq2.ipp_ff || !ps->ga || !ps->ga->ipp_ec) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    for (j = 0; j < n; j++) {
+      PairingPrecomputedG2 const* pre = ps->pairs[j].pre;
+      if (!a[j] || !a[j]->ipp_ec_pt || !pre || !pre->l ||
+          ps->num_lines != pre->num_lines) {
+        break;
+      }
+    }
+    if (j < n) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    // Let f be a variable in GT.
+    result = NewScratchElement(ps, ps->ff, &f);
+    BREAK_ON_EPID_ERROR(result);
+    // 3. For every pair set (ax, ay) = E(Fq).outputPoint(a).
+    for (j = 0; j < n; j++) {
+      sts = ippsGFpECGetPoint(a[j]->ipp_ec_pt, ps->pairs[j].ax->ipp_ff_elem,
+                              ps->pairs[j].ay->ipp_ff_elem, ps->ga->ipp_ec);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    BREAK_ON_EPID_ERROR(result);
+    // 6. Set d = 1.
+    sts = ippsGFpSetElement(one_dat, sizeof(one_dat) / sizeof(Ipp32u),
+                            d->ipp_ff_elem, ps->ff->ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 7. For i = n-1, ..., 0, do the following, where the square of d
+    // is shared by all pairs:
+    for (i = ps->s_len - 1; i >= 0; i--) {
+      // b. Set d = Fq12.square(d),
+      sts = ippsGFpMul(d->ipp_ff_elem, d->ipp_ff_elem, d->ipp_ff_elem,
+                       ps->ff->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+      for (j = 0; j < n; j++) {
+        MillerPair const* p = &ps->pairs[j];
+        FfElement* const* l = p->pre->l + k;
+        // a. Set f = evalLine(l, ax, ay) for the tangent,
+        result = EvalLine(ps, f, l[0], l[1], l[2], p->ax, p->ay);
+        BREAK_ON_EPID_ERROR(result);
+        // c. Set d = Fq12.mulSpecial(d, f),
+        result = MulSpecial(d, d, f, ps);
+        BREAK_ON_EPID_ERROR(result);
+        // d. - e. If s[i] != 0 then set f = evalLine(l, ax, ay) for the
+        // line and set d = Fq12.mulSpecial(d, f).
+        if (0 != ps->s_ternary[i]) {
+          result = EvalLine(ps, f, l[3], l[4], l[5], p->ax, p->ay);
+          BREAK_ON_EPID_ERROR(result);
+          result = MulSpecial(d, d, f, ps);
+          BREAK_ON_EPID_ERROR(result);
+        }
+      }
+      BREAK_ON_EPID_ERROR(result);
+      k += (0 != ps->s_ternary[i]) ? 6 : 3;
+    }
+    BREAK_ON_EPID_ERROR(result);
+    // 8. If neg = true, set d = Fq12.conjugate(d).
+    if (ps->neg) {
+      sts = ippsGFpConj(d->ipp_ff_elem, d->ipp_ff_elem, ps->ff->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    for (j = 0; j < n; j++) {
+      MillerPair const* p = &ps->pairs[j];
+      FfElement* const* l = p->pre->l + k;
+      // 10. - 11. Set d = Fq12.mulSpecial(d, evalLine(l, ax, ay)) for
+      // the line through Pi-op(b, 1),
+      result = EvalLine(ps, f, l[0], l[1], l[2], p->ax, p->ay);
+      BREAK_ON_EPID_ERROR(result);
+      result = MulSpecial(d, d, f, ps);
+      BREAK_ON_EPID_ERROR(result);
+      // 14. - 15. and for the line through -Pi-op(b, 2).
+      result = EvalLine(ps, f, l[3], l[4], l[5], p->ax, p->ay);
+      BREAK_ON_EPID_ERROR(result);
+      result = MulSpecial(d, d, f, ps);
+      BREAK_ON_EPID_ERROR(result);
+    }
+    BREAK_ON_EPID_ERROR(result);
+    // 16. Set d = finalExp(d), once for the product of all pairs.
     result = FinalExp(ps, d, d);
     BREAK_ON_EPID_ERROR(result);
     // 17. Return d.
     result = kEpidNoErr;
   } while (0);
 
-  DeleteFfElement(&ax);
-  DeleteFfElement(&ay);
-  DeleteFfElement(&bx);
-  DeleteFfElement(&by);
-  DeleteFfElement(&x);
-  DeleteFfElement(&y);
-  DeleteFfElement(&z);
-  DeleteFfElement(&z2);
-  DeleteFfElement(&bx_);
-  DeleteFfElement(&by_);
-  DeleteFfElement(&f);
-  DeleteFfElement(&neg_qy);
-
-  DeleteBigNum(&s);
-  DeleteBigNum(&two);
-  DeleteBigNum(&six);
+  ReleaseScratch(ps, mark);
+  EPID_MATH_STAT_STOP(kEpidMathStatPairing, n, start);
 
   return result;
 }
 
+EpidStatus Pairing(PairingState* ps, FfElement* d, EcPoint const* a,
+                   EcPoint const* b) {
+  return MultiPairing(ps, d, &a, &b, 1);
+}
+
+EpidStatus MultiPairing(PairingState* ps, FfElement* d, EcPoint const** a,
+                        EcPoint const** b, size_t n) {
+  EpidStatus result = kEpidErr;
+  size_t j = 0;
+  // check parameters
+  if (!ps || !d || !a || !b || 0 == n) {
+    return kEpidBadArgErr;
+  }
+  // The lines of every b[j] are recorded into storage kept by ps; this
+  // costs the same as computing them inside the Miller loop.
+  result = ReserveMillerPairs(ps, n, true);
+  if (kEpidNoErr != result) {
+    return result;
+  }
+  for (j = 0; j < n; j++) {
+    result = RecordMillerLines(ps, b[j], &ps->pairs[j].lines);
+    if (kEpidNoErr != result) {
+      return result;
+    }
+    ps->pairs[j].pre = &ps->pairs[j].lines;
+  }
+  return MultiPairingPrecomp(ps, d, a, n);
+}
+
+EpidStatus PairingWithPrecomp(PairingState* ps, FfElement* d, EcPoint const* a,
+                              PairingPrecomputedG2 const* b) {
+  EpidStatus result = kEpidErr;
+  // check parameters
+  if (!ps || !b) {
+    return kEpidBadArgErr;
+  }
+  result = ReserveMillerPairs(ps, 1, false);
+  if (kEpidNoErr != result) {
+    return result;
+  }
+  ps->pairs[0].pre = b;
+  return MultiPairingPrecomp(ps, d, &a, 1);
+}
+
 /*
 d = finalExp(h)
 Input: h (an element in GT)
@@ -543,6 +1045,7 @@ Output: d (an element in GT) where d = GT.exp(h, (q^12-1)/p)
 */
 static EpidStatus FinalExp(PairingState* ps, FfElement* d, FfElement const* h) {
   EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* f = NULL;
   FfElement* f1 = NULL;
   FfElement* f2 = NULL;
@@ -562,6 +1065,7 @@ static EpidStatus FinalExp(PairingState* ps, FfElement* d, FfElement const* h) {
   FfElement* y6 = NULL;
   FfElement* t0 = NULL;
   FfElement* t1 = NULL;
+  EPID_MATH_STAT_START(start);
   do {
     IppStatus sts = ippStsNoErr;
     // Check parameters
@@ -578,43 +1082,43 @@ static EpidStatus FinalExp(PairingState* ps, FfElement* d, FfElement const* h) {
     // y3, y4, y5, y6, t0, t1 be temporary variables in GT. All the
     // following operations are computed in Fq12 unless explicitly
     // specified.
-    result = NewFfElement(ps->ff, &f);
+    result = NewScratchElement(ps, ps->ff, &f);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &f1);
+    result = NewScratchElement(ps, ps->ff, &f1);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &f2);
+    result = NewScratchElement(ps, ps->ff, &f2);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &f3);
+    result = NewScratchElement(ps, ps->ff, &f3);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &ft1);
+    result = NewScratchElement(ps, ps->ff, &ft1);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &ft2);
+    result = NewScratchElement(ps, ps->ff, &ft2);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &ft3);
+    result = NewScratchElement(ps, ps->ff, &ft3);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &fp1);
+    result = NewScratchElement(ps, ps->ff, &fp1);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &fp2);
+    result = NewScratchElement(ps, ps->ff, &fp2);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &fp3);
+    result = NewScratchElement(ps, ps->ff, &fp3);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &y0);
+    result = NewScratchElement(ps, ps->ff, &y0);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &y1);
+    result = NewScratchElement(ps, ps->ff, &y1);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &y2);
+    result = NewScratchElement(ps, ps->ff, &y2);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &y3);
+    result = NewScratchElement(ps, ps->ff, &y3);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &y4);
+    result = NewScratchElement(ps, ps->ff, &y4);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &y5);
+    result = NewScratchElement(ps, ps->ff, &y5);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &y6);
+    result = NewScratchElement(ps, ps->ff, &y6);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &t0);
+    result = NewScratchElement(ps, ps->ff, &t0);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(ps->ff, &t1);
+    result = NewScratchElement(ps, ps->ff, &t1);
     BREAK_ON_EPID_ERROR(result);
     // 1.  Set f1 = Fq12.conjugate(h).
     sts = ippsGFpConj(h->ipp_ff_elem, f1->ipp_ff_elem, ps->ff->ipp_ff);
@@ -634,7 +1138,7 @@ static EpidStatus FinalExp(PairingState* ps, FfElement* d, FfElement const* h) {
                      ps->ff->ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
     // 6.  Set ft1 = Fq12.expCyclotomic (f, t).
-    result = ExpCyclotomic(ps, ft1, f, ps->t);
+    result = ExpCyclotomic(ps, ft1, f, ps->t_ternary, ps->t_len);
     BREAK_ON_EPID_ERROR(result);
     // 7.  If neg = true, ft1 = Fq12.conjugate(ft1).
     if (ps->neg) {
@@ -642,7 +1146,7 @@ static EpidStatus FinalExp(PairingState* ps, FfElement* d, FfElement const* h) {
       BREAK_ON_IPP_ERROR(sts, result);
     }
     // 8.  Set ft2 = Fq12.expCyclotomic (ft1, t).
-    result = ExpCyclotomic(ps, ft2, ft1, ps->t);
+    result = ExpCyclotomic(ps, ft2, ft1, ps->t_ternary, ps->t_len);
     BREAK_ON_EPID_ERROR(result);
     // 9.  If neg = true, ft2 = Fq12.conjugate(ft2).
     if (ps->neg) {
@@ -650,7 +1154,7 @@ static EpidStatus FinalExp(PairingState* ps, FfElement* d, FfElement const* h) {
       BREAK_ON_IPP_ERROR(sts, result);
     }
     // 10. Set ft3 = Fq12.expCyclotomic (ft2, t).
-    result = ExpCyclotomic(ps, ft3, ft2, ps->t);
+    result = ExpCyclotomic(ps, ft3, ft2, ps->t_ternary, ps->t_len);
     BREAK_ON_EPID_ERROR(result);
     // 11. If neg = true, ft3 = Fq12.conjugate(ft3).
     if (ps->neg) {
@@ -758,26 +1262,8 @@ static EpidStatus FinalExp(PairingState* ps, FfElement* d, FfElement const* h) {
     result = kEpidNoErr;
   } while (0);
 
-  DeleteFfElement(&f);
-  DeleteFfElement(&f1);
-  DeleteFfElement(&f2);
-  DeleteFfElement(&f3);
-  DeleteFfElement(&ft1);
-  DeleteFfElement(&ft2);
-  DeleteFfElement(&ft3);
-  DeleteFfElement(&fp1);
-  DeleteFfElement(&fp2);
-  DeleteFfElement(&fp3);
-  DeleteFfElement(&y0);
-  DeleteFfElement(&y1);
-  DeleteFfElement(&y2);
-  DeleteFfElement(&y3);
-  DeleteFfElement(&y4);
-  DeleteFfElement(&y5);
-  DeleteFfElement(&y6);
-  DeleteFfElement(&t0);
-  DeleteFfElement(&t1);
-
+  ReleaseScratch(ps, mark);
+  EPID_MATH_STAT_STOP(kEpidMathStatFinalExp, 1, start);
   return result;
 }
 
@@ -843,6 +1329,7 @@ Output: d (an element in GT) such that d = GT.exp(a, qe)
 static EpidStatus FrobeniusOp(PairingState* ps, FfElement* d_out,
                               FfElement const* a, const int e) {
   EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* d[6] = {0};
   size_t i = 0;
   Fq12ElemDat a_dat = {0};
@@ -859,7 +1346,7 @@ static EpidStatus FrobeniusOp(PairingState* ps, FfElement* d_out,
     }
 
     for (i = 0; i < sizeof(d) / sizeof(FfElement*); i++) {
-      result = NewFfElement(&ps->Fq2, &d[i]);
+      result = NewScratchElement(ps, &ps->Fq2, &d[i]);
       BREAK_ON_EPID_ERROR(result);
     }
 
@@ -941,25 +1428,25 @@ static EpidStatus FrobeniusOp(PairingState* ps, FfElement* d_out,
 
   EpidZeroMemory(&a_dat, sizeof(a_dat));
   EpidZeroMemory(&d_dat, sizeof(d_dat));
-  for (i = 0; i < sizeof(d) / sizeof(FfElement*); i++) {
-    DeleteFfElement(&d[i]);
-  }
 
+  ReleaseScratch(ps, mark);
   return result;
 }
 
 /*
-(f, X', Y', Z', Z2') = line(Px, Py, X, Y, Z, Z2, Qx, Qy)
-Input: Px, Py (elements in Fq), X, Y, Z, Z2, Qx, Qy (elements in Fq2)
-Output: f (an element in GT), X', Y', Z', Z2' (elements in Fq2)
+(l, X', Y', Z', Z2') = line(X, Y, Z, Z2, Qx, Qy)
+Input: X, Y, Z, Z2, Qx, Qy (elements in Fq2)
+Output: l = (l0, l1, l2), X', Y', Z', Z2' (elements in Fq2)
+The line function at a point P is f = evalLine(l, Px, Py).
 */
-static EpidStatus Line(FiniteField* gt, FfElement* f, FfElement* x_out,
-                       FfElement* y_out, FfElement* z_out, FfElement* z2_out,
-                       FfElement const* px, FfElement const* py,
-                       FfElement const* x, FfElement const* y,
-                       FfElement const* z, FfElement const* z2,
-                       FfElement const* qx, FfElement const* qy) {
+static EpidStatus Line(PairingState* ps, FfElement* l0, FfElement* l1,
+                       FfElement* l2, FfElement* x_out, FfElement* y_out,
+                       FfElement* z_out, FfElement* z2_out, FfElement const* x,
+                       FfElement const* y, FfElement const* z,
+                       FfElement const* z2, FfElement const* qx,
+                       FfElement const* qy) {
   EpidStatus result = kEpidNotImpl;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* t0 = NULL;
   FfElement* t1 = NULL;
   FfElement* t2 = NULL;
@@ -972,85 +1459,73 @@ static EpidStatus Line(FiniteField* gt, FfElement* f, FfElement* x_out,
   FfElement* t9 = NULL;
   FfElement* t10 = NULL;
   FfElement* t = NULL;
-  Fq12ElemDat fDat = {0};
   do {
     IppStatus sts = ippStsNoErr;
     IppsGFpState* Fq2 = 0;
-    IppsGFpState* Fq6 = 0;
-    IppsGFpInfo info = {0};
-    FiniteField Ffq2;
 
     // check parameters
-    if (!f || !x_out || !y_out || !z_out || !z2_out || !px || !py || !x || !y ||
-        !z || !z2 || !qx || !qy || !gt) {
+    if (!l0 || !l1 || !l2 || !x_out || !y_out || !z_out || !z2_out || !x ||
+        !y || !z || !z2 || !qx || !qy || !ps) {
       result = kEpidBadArgErr;
       break;
     }
-    if (!f->ipp_ff_elem || !x_out->ipp_ff_elem || !y_out->ipp_ff_elem ||
-        !z_out->ipp_ff_elem || !z2_out->ipp_ff_elem || !px->ipp_ff_elem ||
-        !py->ipp_ff_elem || !x->ipp_ff_elem || !y->ipp_ff_elem ||
+    if (!l0->ipp_ff_elem || !l1->ipp_ff_elem || !l2->ipp_ff_elem ||
+        !x_out->ipp_ff_elem || !y_out->ipp_ff_elem || !z_out->ipp_ff_elem ||
+        !z2_out->ipp_ff_elem || !x->ipp_ff_elem || !y->ipp_ff_elem ||
         !z->ipp_ff_elem || !z2->ipp_ff_elem || !qx->ipp_ff_elem ||
-        !qy->ipp_ff_elem || !gt->ipp_ff) {
+        !qy->ipp_ff_elem || !ps->Fq2.ipp_ff) {
       result = kEpidBadArgErr;
       break;
     }
-    // get Fq6, Fq2
-    sts = ippsGFpGetInfo(gt->ipp_ff, &info);
-    BREAK_ON_IPP_ERROR(sts, result);
-    Fq6 = (IppsGFpState*)info.pGroundGF;
-    sts = ippsGFpGetInfo(Fq6, &info);
-    BREAK_ON_IPP_ERROR(sts, result);
-    Fq2 = (IppsGFpState*)info.pGroundGF;
-    result = InitFiniteFieldFromIpp(Fq2, &Ffq2);
-    BREAK_ON_EPID_ERROR(result);
+    Fq2 = ps->Fq2.ipp_ff;
     // Let t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10 be temporary
     // elements in Fq2. All the following operations are computed in
     // Fq2 unless explicitly specified.
-    result = NewFfElement(&Ffq2, &t0);
+    result = NewScratchElement(ps, &ps->Fq2, &t0);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t1);
+    result = NewScratchElement(ps, &ps->Fq2, &t1);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t2);
+    result = NewScratchElement(ps, &ps->Fq2, &t2);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t3);
+    result = NewScratchElement(ps, &ps->Fq2, &t3);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t4);
+    result = NewScratchElement(ps, &ps->Fq2, &t4);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t5);
+    result = NewScratchElement(ps, &ps->Fq2, &t5);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t6);
+    result = NewScratchElement(ps, &ps->Fq2, &t6);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t7);
+    result = NewScratchElement(ps, &ps->Fq2, &t7);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t8);
+    result = NewScratchElement(ps, &ps->Fq2, &t8);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t9);
+    result = NewScratchElement(ps, &ps->Fq2, &t9);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t10);
+    result = NewScratchElement(ps, &ps->Fq2, &t10);
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewFfElement(&Ffq2, &t);
+    result = NewScratchElement(ps, &ps->Fq2, &t);
     if (kEpidNoErr != result) {
       break;
     }
@@ -1157,67 +1632,39 @@ static EpidStatus Line(FiniteField* gt, FfElement* f, FfElement* x_out,
     BREAK_ON_IPP_ERROR(sts, result);
     sts = ippsGFpSub(t9->ipp_ff_elem, t10->ipp_ff_elem, t9->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
-    // 20. Set t10 = Fq2.mul(Z', Py).
-    sts = ippsGFpMul_GFpE(z_out->ipp_ff_elem, py->ipp_ff_elem, t10->ipp_ff_elem,
-                          Fq2);
-    BREAK_ON_IPP_ERROR(sts, result);
-    // 21. Set t10 = t10 + t10.
-    sts = ippsGFpAdd(t10->ipp_ff_elem, t10->ipp_ff_elem, t10->ipp_ff_elem, Fq2);
-    BREAK_ON_IPP_ERROR(sts, result);
-    // 22. Set t6 = -t6.
-    sts = ippsGFpNeg(t6->ipp_ff_elem, t6->ipp_ff_elem, Fq2);
-    BREAK_ON_IPP_ERROR(sts, result);
-    // 23. Set t1 = Fq2.mul(t6, Px).
-    sts =
-        ippsGFpMul_GFpE(t6->ipp_ff_elem, px->ipp_ff_elem, t1->ipp_ff_elem, Fq2);
-    BREAK_ON_IPP_ERROR(sts, result);
-    // 24. Set t1 = t1 + t1.
-    sts = ippsGFpAdd(t1->ipp_ff_elem, t1->ipp_ff_elem, t1->ipp_ff_elem, Fq2);
+    // 20. Set l0 = Z' + Z'.
+    sts = ippsGFpAdd(z_out->ipp_ff_elem, z_out->ipp_ff_elem, l0->ipp_ff_elem,
+                     Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
-    // 25. Set f = ((t10, 0, 0), (t1, t9, 0)).
-    sts = ippsGFpGetElement(t10->ipp_ff_elem, (Ipp32u*)&fDat.x[0].x[0],
-                            sizeof(fDat.x[0].x[0]) / sizeof(Ipp32u), Fq2);
+    // 21. Set l1 = -(t6 + t6).
+    sts = ippsGFpAdd(t6->ipp_ff_elem, t6->ipp_ff_elem, l1->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
-    sts = ippsGFpGetElement(t1->ipp_ff_elem, (Ipp32u*)&fDat.x[1].x[0],
-                            sizeof(fDat.x[1].x[0]) / sizeof(Ipp32u), Fq2);
+    sts = ippsGFpNeg(l1->ipp_ff_elem, l1->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
-    sts = ippsGFpGetElement(t9->ipp_ff_elem, (Ipp32u*)&fDat.x[1].x[1],
-                            sizeof(fDat.x[1].x[1]) / sizeof(Ipp32u), Fq2);
+    // 22. Set l2 = t9.
+    sts = ippsGFpCpyElement(t9->ipp_ff_elem, l2->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
-    sts = ippsGFpSetElement((Ipp32u*)&fDat, sizeof(fDat) / sizeof(Ipp32u),
-                            f->ipp_ff_elem, gt->ipp_ff);
-    BREAK_ON_IPP_ERROR(sts, result);
-    // 26. Return (f, X', Y', Z', Z2').
+    // 23. Return (l, X', Y', Z', Z2').
   } while (0);
-  EpidZeroMemory(&fDat, sizeof(fDat));
-  DeleteFfElement(&t);
-  DeleteFfElement(&t10);
-  DeleteFfElement(&t9);
-  DeleteFfElement(&t8);
-  DeleteFfElement(&t7);
-  DeleteFfElement(&t6);
-  DeleteFfElement(&t5);
-  DeleteFfElement(&t4);
-  DeleteFfElement(&t3);
-  DeleteFfElement(&t2);
-  DeleteFfElement(&t1);
-  DeleteFfElement(&t0);
 
+  ReleaseScratch(ps, mark);
   return (result);
 }
 
 /*
-(f, X', Y', Z', Z2') = tangent(Px, Py, X, Y, Z, Z2)
-Input: Px, Py (elements in Fq), X, Y, Z, Z2 (elements in Fq2)
-Output: f (an element in GT), X', Y', Z', Z2' (elements in Fq2)
+(l, X', Y', Z', Z2') = tangent(X, Y, Z, Z2)
+Input: X, Y, Z, Z2 (elements in Fq2)
+Output: l = (l0, l1, l2), X', Y', Z', Z2' (elements in Fq2)
+The tangent line function at a point P is f = evalLine(l, Px, Py).
 Steps:
 */
-static EpidStatus Tangent(FiniteField* gt, FfElement* f, FfElement* x_out,
-                          FfElement* y_out, FfElement* z_out, FfElement* z2_out,
-                          FfElement const* px, FfElement const* py,
+static EpidStatus Tangent(PairingState* ps, FfElement* l0, FfElement* l1,
+                          FfElement* l2, FfElement* x_out, FfElement* y_out,
+                          FfElement* z_out, FfElement* z2_out,
                           FfElement const* x, FfElement const* y,
                           FfElement const* z, FfElement const* z2) {
   EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* t0 = NULL;
   FfElement* t1 = NULL;
   FfElement* t2 = NULL;
@@ -1225,55 +1672,43 @@ static EpidStatus Tangent(FiniteField* gt, FfElement* f, FfElement* x_out,
   FfElement* t4 = NULL;
   FfElement* t5 = NULL;
   FfElement* t6 = NULL;
-  Fq12ElemDat fDat = {0};
   do {
     IppStatus sts = ippStsNoErr;
     IppsGFpState* Fq2 = NULL;
-    IppsGFpState* Fq6 = NULL;
-    FiniteField Ffq2;
-    IppsGFpInfo info = {0};
     int i = 0;
     // validate input
-    if (!gt || !f || !x_out || !y_out || !z_out || !z2_out || !px || !py ||
+    if (!ps || !l0 || !l1 || !l2 || !x_out || !y_out || !z_out || !z2_out ||
         !x || !y || !z || !z2) {
       result = kEpidBadArgErr;
-      break;
-    }
-    if (!gt->ipp_ff || !f->ipp_ff_elem || !x_out->ipp_ff_elem ||
-        !y_out->ipp_ff_elem || !z_out->ipp_ff_elem || !z2_out->ipp_ff_elem ||
-        !px->ipp_ff_elem || !py->ipp_ff_elem || !x->ipp_ff_elem ||
-        !y->ipp_ff_elem || !z->ipp_ff_elem || !z2->ipp_ff_elem) {
-      result = kEpidBadArgErr;
-      break;
-    }
-    // get Fq2, Fq6
-    sts = ippsGFpGetInfo(gt->ipp_ff, &info);
-    BREAK_ON_IPP_ERROR(sts, result);
-    Fq6 = (IppsGFpState*)info.pGroundGF;
-    sts = ippsGFpGetInfo(Fq6, &info);
-    BREAK_ON_IPP_ERROR(sts, result);
-    Fq2 = (IppsGFpState*)info.pGroundGF;
-    result = InitFiniteFieldFromIpp(Fq2, &Ffq2);
-    BREAK_ON_EPID_ERROR(result);
+      break;
+    }
+    if (!ps->Fq2.ipp_ff || !l0->ipp_ff_elem || !l1->ipp_ff_elem ||
+        !l2->ipp_ff_elem || !x_out->ipp_ff_elem || !y_out->ipp_ff_elem ||
+        !z_out->ipp_ff_elem || !z2_out->ipp_ff_elem || !x->ipp_ff_elem ||
+        !y->ipp_ff_elem || !z->ipp_ff_elem || !z2->ipp_ff_elem) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    Fq2 = ps->Fq2.ipp_ff;
     // Let t0, t1, t2, t3, t4, t5, t6 be elements in Fq2. All the following
     // operations are computed in Fq2 unless explicitly specified.
     // 1. Set t0 = X * X.
-    result = NewFfElement(&Ffq2, &t0);
+    result = NewScratchElement(ps, &ps->Fq2, &t0);
     BREAK_ON_EPID_ERROR(result);
     sts = ippsGFpMul(x->ipp_ff_elem, x->ipp_ff_elem, t0->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
     // 2. Set t1 = Y * Y.
-    result = NewFfElement(&Ffq2, &t1);
+    result = NewScratchElement(ps, &ps->Fq2, &t1);
     BREAK_ON_EPID_ERROR(result);
     sts = ippsGFpMul(y->ipp_ff_elem, y->ipp_ff_elem, t1->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
     // 3. Set t2 = t1 * t1.
-    result = NewFfElement(&Ffq2, &t2);
+    result = NewScratchElement(ps, &ps->Fq2, &t2);
     BREAK_ON_EPID_ERROR(result);
     sts = ippsGFpMul(t1->ipp_ff_elem, t1->ipp_ff_elem, t2->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
     // 4. Set t3 = (t1 + X)^2 - t0 - t2.
-    result = NewFfElement(&Ffq2, &t3);
+    result = NewScratchElement(ps, &ps->Fq2, &t3);
     BREAK_ON_EPID_ERROR(result);
     sts = ippsGFpAdd(t1->ipp_ff_elem, x->ipp_ff_elem, t3->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
@@ -1287,19 +1722,19 @@ static EpidStatus Tangent(FiniteField* gt, FfElement* f, FfElement* x_out,
     sts = ippsGFpAdd(t3->ipp_ff_elem, t3->ipp_ff_elem, t3->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
     // 6. Set t4 = 3 * t0.
-    result = NewFfElement(&Ffq2, &t4);
+    result = NewScratchElement(ps, &ps->Fq2, &t4);
     BREAK_ON_EPID_ERROR(result);
     sts = ippsGFpAdd(t0->ipp_ff_elem, t0->ipp_ff_elem, t4->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
     sts = ippsGFpAdd(t4->ipp_ff_elem, t0->ipp_ff_elem, t4->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
     // 7. Set t6 = X + t4.
-    result = NewFfElement(&Ffq2, &t6);
+    result = NewScratchElement(ps, &ps->Fq2, &t6);
     BREAK_ON_EPID_ERROR(result);
     sts = ippsGFpAdd(x->ipp_ff_elem, t4->ipp_ff_elem, t6->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
     // 8. Set t5 = t4 * t4.
-    result = NewFfElement(&Ffq2, &t5);
+    result = NewScratchElement(ps, &ps->Fq2, &t5);
     BREAK_ON_EPID_ERROR(result);
     sts = ippsGFpMul(t4->ipp_ff_elem, t4->ipp_ff_elem, t5->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
@@ -1340,11 +1775,7 @@ static EpidStatus Tangent(FiniteField* gt, FfElement* f, FfElement* x_out,
     BREAK_ON_IPP_ERROR(sts, result);
     sts = ippsGFpNeg(t3->ipp_ff_elem, t3->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
-    // 13.Set t3 = Fq2.mul(t3, Px).
-    sts =
-        ippsGFpMul_GFpE(t3->ipp_ff_elem, px->ipp_ff_elem, t3->ipp_ff_elem, Fq2);
-    BREAK_ON_IPP_ERROR(sts, result);
-    // 14.Set t6 = t6 * t6 - t0 - t5 - 4 * t1.
+    // 13.Set t6 = t6 * t6 - t0 - t5 - 4 * t1.
     sts = ippsGFpMul(t6->ipp_ff_elem, t6->ipp_ff_elem, t6->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
     sts = ippsGFpSub(t6->ipp_ff_elem, t0->ipp_ff_elem, t6->ipp_ff_elem, Fq2);
@@ -1355,42 +1786,86 @@ static EpidStatus Tangent(FiniteField* gt, FfElement* f, FfElement* x_out,
       sts = ippsGFpSub(t6->ipp_ff_elem, t1->ipp_ff_elem, t6->ipp_ff_elem, Fq2);
       BREAK_ON_IPP_ERROR(sts, result);
     }
-    // 15.Set t0 = 2 * (Z' * Z2).
-    sts = ippsGFpMul(z_out->ipp_ff_elem, z2->ipp_ff_elem, t0->ipp_ff_elem, Fq2);
+    // 14.Set l0 = 2 * (Z' * Z2).
+    sts = ippsGFpMul(z_out->ipp_ff_elem, z2->ipp_ff_elem, l0->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
-    sts = ippsGFpAdd(t0->ipp_ff_elem, t0->ipp_ff_elem, t0->ipp_ff_elem, Fq2);
+    sts = ippsGFpAdd(l0->ipp_ff_elem, l0->ipp_ff_elem, l0->ipp_ff_elem, Fq2);
     BREAK_ON_IPP_ERROR(sts, result);
-    // 16.Set t0 = Fq2.mul(t0, Py).
-    sts =
-        ippsGFpMul_GFpE(t0->ipp_ff_elem, py->ipp_ff_elem, t0->ipp_ff_elem, Fq2);
+    // 15.Set l1 = t3, l2 = t6.
+    sts = ippsGFpCpyElement(t3->ipp_ff_elem, l1->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpCpyElement(t6->ipp_ff_elem, l2->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 16.Set Z2' = Z' * Z'.
+    sts = ippsGFpMul(z_out->ipp_ff_elem, z_out->ipp_ff_elem,
+                     z2_out->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 17.Return (l, X', Y', Z', Z2').
+  } while (0);
+  ReleaseScratch(ps, mark);
+  return result;
+}
+
+/*
+f = evalLine(l, Px, Py)
+Input: l = (l0, l1, l2) (elements in Fq2), Px, Py (elements in Fq)
+Output: f (an element in GT) where f = ((l0 * Py, 0, 0), (l1 * Px, l2, 0))
+*/
+static EpidStatus EvalLine(PairingState* ps, FfElement* f, FfElement const* l0,
+                           FfElement const* l1, FfElement const* l2,
+                           FfElement const* px, FfElement const* py) {
+  EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
+  FfElement* t0 = NULL;
+  FfElement* t1 = NULL;
+  Fq12ElemDat fDat = {0};
+  do {
+    IppStatus sts = ippStsNoErr;
+    // check parameters
+    if (!ps || !f || !l0 || !l1 || !l2 || !px || !py) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    if (!f->ipp_ff_elem || !l0->ipp_ff_elem || !l1->ipp_ff_elem ||
+        !l2->ipp_ff_elem || !px->ipp_ff_elem || !py->ipp_ff_elem ||
+        !ps->Fq2.ipp_ff || !ps->ff || !ps->ff->ipp_ff) {
+      result = kEpidBadArgErr;
+      break;
+    }
+    // Let t0, t1 be temporary elements in Fq2.
+    result = NewScratchElement(ps, &ps->Fq2, &t0);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewScratchElement(ps, &ps->Fq2, &t1);
+    BREAK_ON_EPID_ERROR(result);
+    // 1. Set t0 = Fq2.mul(l0, Py).
+    sts = ippsGFpMul_GFpE(l0->ipp_ff_elem, py->ipp_ff_elem, t0->ipp_ff_elem,
+                          ps->Fq2.ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
-    // 17.Set f = ((t0, 0, 0), (t3, t6, 0)).
+    // 2. Set t1 = Fq2.mul(l1, Px).
+    sts = ippsGFpMul_GFpE(l1->ipp_ff_elem, px->ipp_ff_elem, t1->ipp_ff_elem,
+                          ps->Fq2.ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 3. Set f = ((t0, 0, 0), (t1, l2, 0)).
     sts = ippsGFpGetElement(t0->ipp_ff_elem, (Ipp32u*)&fDat.x[0].x[0],
-                            sizeof(fDat.x[0].x[0]) / sizeof(Ipp32u), Fq2);
+                            sizeof(fDat.x[0].x[0]) / sizeof(Ipp32u),
+                            ps->Fq2.ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
-    sts = ippsGFpGetElement(t3->ipp_ff_elem, (Ipp32u*)&fDat.x[1].x[0],
-                            sizeof(fDat.x[1].x[0]) / sizeof(Ipp32u), Fq2);
+    sts = ippsGFpGetElement(t1->ipp_ff_elem, (Ipp32u*)&fDat.x[1].x[0],
+                            sizeof(fDat.x[1].x[0]) / sizeof(Ipp32u),
+                            ps->Fq2.ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
-    sts = ippsGFpGetElement(t6->ipp_ff_elem, (Ipp32u*)&fDat.x[1].x[1],
-                            sizeof(fDat.x[1].x[1]) / sizeof(Ipp32u), Fq2);
+    sts = ippsGFpGetElement(l2->ipp_ff_elem, (Ipp32u*)&fDat.x[1].x[1],
+                            sizeof(fDat.x[1].x[1]) / sizeof(Ipp32u),
+                            ps->Fq2.ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
     sts = ippsGFpSetElement((Ipp32u*)&fDat, sizeof(fDat) / sizeof(Ipp32u),
-                            f->ipp_ff_elem, gt->ipp_ff);
-    BREAK_ON_IPP_ERROR(sts, result);
-    // 18.Set Z2' = Z' * Z'.
-    sts = ippsGFpMul(z_out->ipp_ff_elem, z_out->ipp_ff_elem,
-                     z2_out->ipp_ff_elem, Fq2);
+                            f->ipp_ff_elem, ps->ff->ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
-    // 19.Return (f, X', Y', Z', Z2').
+    // 4. Return f.
+    result = kEpidNoErr;
   } while (0);
   EpidZeroMemory(&fDat, sizeof(fDat));
-  DeleteFfElement(&t6);
-  DeleteFfElement(&t5);
-  DeleteFfElement(&t4);
-  DeleteFfElement(&t3);
-  DeleteFfElement(&t2);
-  DeleteFfElement(&t1);
-  DeleteFfElement(&t0);
+  ReleaseScratch(ps, mark);
   return result;
 }
 
@@ -1511,6 +1986,7 @@ Output: e (an element in Fq2) where e = a * xi
 static EpidStatus MulXiFast(FfElement* e, FfElement const* a,
                             PairingState* ps) {
   EpidStatus retvalue = kEpidNotImpl;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* a0 = NULL;
   FfElement* a1 = NULL;
   FfElement* e0 = NULL;
@@ -1532,13 +2008,13 @@ static EpidStatus MulXiFast(FfElement* e, FfElement const* a,
     }
     // All the following arithmetic operations are in ps->Fq.
     // 1. Let a = (a[0], a[1]), xi = (xi[0], xi[1]), and e = (e[0], e[1]).
-    retvalue = NewFfElement(&(ps->Fq), &a0);
+    retvalue = NewScratchElement(ps, &(ps->Fq), &a0);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq), &a1);
+    retvalue = NewScratchElement(ps, &(ps->Fq), &a1);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq), &e0);
+    retvalue = NewScratchElement(ps, &(ps->Fq), &e0);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq), &e1);
+    retvalue = NewScratchElement(ps, &(ps->Fq), &e1);
     BREAK_ON_EPID_ERROR(retvalue);
 
     sts = ippsGFpGetElement(a->ipp_ff_elem, (Ipp32u*)&a_dat,
@@ -1584,11 +2060,8 @@ static EpidStatus MulXiFast(FfElement* e, FfElement const* a,
 
   EpidZeroMemory(&a_dat, sizeof(a_dat));
   EpidZeroMemory(&e_dat, sizeof(e_dat));
-  DeleteFfElement(&a0);
-  DeleteFfElement(&a1);
-  DeleteFfElement(&e0);
-  DeleteFfElement(&e1);
 
+  ReleaseScratch(ps, mark);
   return (retvalue);
 }
 
@@ -1601,6 +2074,7 @@ Output: e (an element in Fq6) where e = a * V, where V = 0 * v2 + 1 * v + 0
 */
 static EpidStatus MulV(FfElement* e, FfElement* a, PairingState* ps) {
   EpidStatus retvalue = kEpidNotImpl;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* a2 = NULL;
   FfElement* e0 = NULL;
   FfElement* e1 = NULL;
@@ -1620,13 +2094,13 @@ static EpidStatus MulV(FfElement* e, FfElement* a, PairingState* ps) {
       BREAK_ON_EPID_ERROR(retvalue);
     }
     // 1. Let a = (a[0], a[1], a[2]) and e = (e[0], e[1], e[2]).
-    retvalue = NewFfElement(&(ps->Fq2), &a2);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &a2);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &e0);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &e0);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &e1);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &e1);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &e2);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &e2);
     BREAK_ON_EPID_ERROR(retvalue);
 
     sts = ippsGFpGetElement(a->ipp_ff_elem, (Ipp32u*)&a_dat,
@@ -1656,11 +2130,8 @@ static EpidStatus MulV(FfElement* e, FfElement* a, PairingState* ps) {
 
   EpidZeroMemory(&a_dat, sizeof(a_dat));
   EpidZeroMemory(&e_dat, sizeof(e_dat));
-  DeleteFfElement(&a2);
-  DeleteFfElement(&e0);
-  DeleteFfElement(&e1);
-  DeleteFfElement(&e2);
 
+  ReleaseScratch(ps, mark);
   return (retvalue);
 }
 
@@ -1676,6 +2147,7 @@ Output: e (an element in Fq6) where e = a * b, and b = b[1] * v + b[0]
 static EpidStatus Fq6MulGFpE2(FfElement* e, FfElement* a, FfElement* b0,
                               FfElement* b1, PairingState* ps) {
   EpidStatus retvalue = kEpidNotImpl;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* t0 = NULL;
   FfElement* t1 = NULL;
   FfElement* t2 = NULL;
@@ -1704,28 +2176,28 @@ static EpidStatus Fq6MulGFpE2(FfElement* e, FfElement* a, FfElement* b0,
 
     // Let t0, t1, t3, t4 be temporary variables in Fq2. All the
     // following arithmetic operations are in Fq2.
-    retvalue = NewFfElement(&(ps->Fq2), &t0);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &t0);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &t1);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &t1);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &t2);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &t2);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &t3);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &t3);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &t4);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &t4);
     BREAK_ON_EPID_ERROR(retvalue);
     // 1. Let a = (a[0], a[1], a[2]) and e = (e[0], e[1], e[2]).
-    retvalue = NewFfElement(&(ps->Fq2), &a0);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &a0);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &a1);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &a1);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &a2);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &a2);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &e0);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &e0);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &e1);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &e1);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &e2);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &e2);
     BREAK_ON_EPID_ERROR(retvalue);
 
     sts = ippsGFpGetElement(a->ipp_ff_elem, (Ipp32u*)&a_dat,
@@ -1817,18 +2289,8 @@ static EpidStatus Fq6MulGFpE2(FfElement* e, FfElement* a, FfElement* b0,
 
   EpidZeroMemory(&a_dat, sizeof(a_dat));
   EpidZeroMemory(&e_dat, sizeof(e_dat));
-  DeleteFfElement(&t0);
-  DeleteFfElement(&t1);
-  DeleteFfElement(&t2);
-  DeleteFfElement(&t3);
-  DeleteFfElement(&t4);
-  DeleteFfElement(&a0);
-  DeleteFfElement(&a1);
-  DeleteFfElement(&a2);
-  DeleteFfElement(&e0);
-  DeleteFfElement(&e1);
-  DeleteFfElement(&e2);
 
+  ReleaseScratch(ps, mark);
   return (retvalue);
 }
 
@@ -1841,6 +2303,7 @@ Output: e (an element in Fq12) where e = a * b
 static EpidStatus MulSpecial(FfElement* e, FfElement const* a,
                              FfElement const* b, PairingState* ps) {
   EpidStatus retvalue = kEpidNotImpl;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* t0 = NULL;
   FfElement* t1 = NULL;
   FfElement* t2 = NULL;
@@ -1870,23 +2333,23 @@ static EpidStatus MulSpecial(FfElement* e, FfElement const* a,
     }
 
     // Let t0, t1, t2 be temporary variables in ps->Fq6.
-    retvalue = NewFfElement(&(ps->Fq6), &t0);
+    retvalue = NewScratchElement(ps, &(ps->Fq6), &t0);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq6), &t1);
+    retvalue = NewScratchElement(ps, &(ps->Fq6), &t1);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq6), &t2);
+    retvalue = NewScratchElement(ps, &(ps->Fq6), &t2);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &b0plusb1);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &b0plusb1);
     BREAK_ON_EPID_ERROR(retvalue);
 
     // 1.  Let a = (a[0], a[1]) and e = (e[0], e[1]).
-    retvalue = NewFfElement(&(ps->Fq6), &a0);
+    retvalue = NewScratchElement(ps, &(ps->Fq6), &a0);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq6), &a1);
+    retvalue = NewScratchElement(ps, &(ps->Fq6), &a1);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq6), &e0);
+    retvalue = NewScratchElement(ps, &(ps->Fq6), &e0);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq6), &e1);
+    retvalue = NewScratchElement(ps, &(ps->Fq6), &e1);
     BREAK_ON_EPID_ERROR(retvalue);
 
     sts = ippsGFpGetElement(a->ipp_ff_elem, (Ipp32u*)&a_dat,
@@ -1904,11 +2367,11 @@ static EpidStatus MulSpecial(FfElement* e, FfElement const* a,
     // 2.  Let b = ((b[0], b[2], b[4]), (b[1], b[3], b[5])) where
     //     b[0], ..., b[5] are elements in ps->Fq2 and b[2] = b[4] = b[5]
     //     = 0.
-    retvalue = NewFfElement(&(ps->Fq2), &b0);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &b0);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &b1);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &b1);
     BREAK_ON_EPID_ERROR(retvalue);
-    retvalue = NewFfElement(&(ps->Fq2), &b3);
+    retvalue = NewScratchElement(ps, &(ps->Fq2), &b3);
     BREAK_ON_EPID_ERROR(retvalue);
 
     sts = ippsGFpGetElement(b->ipp_ff_elem, (Ipp32u*)&b_dat,
@@ -1976,18 +2439,8 @@ static EpidStatus MulSpecial(FfElement* e, FfElement const* a,
   EpidZeroMemory(&a_dat, sizeof(a_dat));
   EpidZeroMemory(&b_dat, sizeof(b_dat));
   EpidZeroMemory(&e_dat, sizeof(e_dat));
-  DeleteFfElement(&t0);
-  DeleteFfElement(&t1);
-  DeleteFfElement(&t2);
-  DeleteFfElement(&a0);
-  DeleteFfElement(&a1);
-  DeleteFfElement(&b0);
-  DeleteFfElement(&b1);
-  DeleteFfElement(&b3);
-  DeleteFfElement(&e0);
-  DeleteFfElement(&e1);
-  DeleteFfElement(&b0plusb1);
 
+  ReleaseScratch(ps, mark);
   return (retvalue);
 }
 
@@ -1999,6 +2452,7 @@ static EpidStatus MulSpecial(FfElement* e, FfElement const* a,
 static EpidStatus SquareForFq4(PairingState* ps, FfElement* e0, FfElement* e1,
                                FfElement const* a0, FfElement const* a1) {
   EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* t0 = NULL;
   FfElement* t1 = NULL;
   FfElement* xi = NULL;
@@ -2016,7 +2470,7 @@ static EpidStatus SquareForFq4(PairingState* ps, FfElement* e0, FfElement* e1,
     IppStatus sts = ippStsNoErr;
 
     // extract xi from Fq6 irr poly
-    result = NewFfElement(&(ps->Fq2), &xi);
+    result = NewScratchElement(ps, &(ps->Fq2), &xi);
     BREAK_ON_EPID_ERROR(result);
     sts = ippsGFpGetModulus(ps->Fq6.ipp_ff, (Ipp32u*)&Fq6IrrPolynomial[0]);
     BREAK_ON_IPP_ERROR(sts, result);
@@ -2030,9 +2484,9 @@ static EpidStatus SquareForFq4(PairingState* ps, FfElement* e0, FfElement* e1,
 
     // Let t0, t1 be temporary variables in Fq2. All the following
     // operations are computed in Fq2.
-    result = NewFfElement(&(ps->Fq2), &t0);
+    result = NewScratchElement(ps, &(ps->Fq2), &t0);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&(ps->Fq2), &t1);
+    result = NewScratchElement(ps, &(ps->Fq2), &t1);
     BREAK_ON_EPID_ERROR(result);
 
     // 1. Set t0 = a0 * a0.
@@ -2070,10 +2524,8 @@ static EpidStatus SquareForFq4(PairingState* ps, FfElement* e0, FfElement* e1,
   } while (0);
 
   EpidZeroMemory(Fq6IrrPolynomial, sizeof(Fq6IrrPolynomial));
-  DeleteFfElement(&t0);
-  DeleteFfElement(&t1);
-  DeleteFfElement(&xi);
 
+  ReleaseScratch(ps, mark);
   return (result);
 }
 
@@ -2085,6 +2537,7 @@ static EpidStatus SquareForFq4(PairingState* ps, FfElement* e0, FfElement* e1,
 static EpidStatus SquareCyclotomic(PairingState* ps, FfElement* e_out,
                                    FfElement const* a_in) {
   EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
   FfElement* t00 = NULL;
   FfElement* t01 = NULL;
   FfElement* t02 = NULL;
@@ -2112,7 +2565,7 @@ static EpidStatus SquareCyclotomic(PairingState* ps, FfElement* e_out,
     IppStatus sts = ippStsNoErr;
 
     // extract xi from Fq6 irr poly
-    result = NewFfElement(&(ps->Fq2), &xi);
+    result = NewScratchElement(ps, &(ps->Fq2), &xi);
     BREAK_ON_EPID_ERROR(result);
     sts = ippsGFpGetModulus(ps->Fq6.ipp_ff, (Ipp32u*)&Fq6IrrPolynomial);
     BREAK_ON_IPP_ERROR(sts, result);
@@ -2127,22 +2580,22 @@ static EpidStatus SquareCyclotomic(PairingState* ps, FfElement* e_out,
     // Let t00, t01, t02, t10, t11, t12 be temporary variables in
     // Fq2. All the following operations are computed in Fq2 unless
     // specified otherwise.
-    result = NewFfElement(&(ps->Fq2), &t00);
+    result = NewScratchElement(ps, &(ps->Fq2), &t00);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&(ps->Fq2), &t01);
+    result = NewScratchElement(ps, &(ps->Fq2), &t01);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&(ps->Fq2), &t02);
+    result = NewScratchElement(ps, &(ps->Fq2), &t02);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&(ps->Fq2), &t10);
+    result = NewScratchElement(ps, &(ps->Fq2), &t10);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&(ps->Fq2), &t11);
+    result = NewScratchElement(ps, &(ps->Fq2), &t11);
     BREAK_ON_EPID_ERROR(result);
-    result = NewFfElement(&(ps->Fq2), &t12);
+    result = NewScratchElement(ps, &(ps->Fq2), &t12);
     BREAK_ON_EPID_ERROR(result);
     for (i = 0; i < 6; i++) {
-      result = NewFfElement(&(ps->Fq2), &a[i]);
+      result = NewScratchElement(ps, &(ps->Fq2), &a[i]);
       BREAK_ON_EPID_ERROR(result);
-      result = NewFfElement(&(ps->Fq2), &e[i]);
+      result = NewScratchElement(ps, &(ps->Fq2), &e[i]);
       BREAK_ON_EPID_ERROR(result);
     }
     BREAK_ON_EPID_ERROR(result);
@@ -2301,73 +2754,530 @@ static EpidStatus SquareCyclotomic(PairingState* ps, FfElement* e_out,
   EpidZeroMemory(&a_str, sizeof(a_str));
   EpidZeroMemory(&e_str, sizeof(e_str));
   EpidZeroMemory(Fq6IrrPolynomial, sizeof(Fq6IrrPolynomial));
-  DeleteFfElement(&t00);
-  DeleteFfElement(&t01);
-  DeleteFfElement(&t02);
-  DeleteFfElement(&t10);
-  DeleteFfElement(&t11);
-  DeleteFfElement(&t12);
-
-  for (i = 0; i < 6; i++) {
-    DeleteFfElement(&a[i]);
-    DeleteFfElement(&e[i]);
-  }
 
-  DeleteFfElement(&xi);
+  ReleaseScratch(ps, mark);
+  return (result);
+}
+
+/*
+  C(e) = Fq12.squareCompressed(C(a))
+  Input: C(a) = (g2, g3, g4, g5) (the compressed form of an element a in
+  the cyclotomic subgroup of Fq12)
+  Output: C(e) (the compressed form of e = a * a), computed in place
+  Steps:
+  1.  Set h2 = 2 * (g2 + 3 * xi * g4 * g5).
+  2.  Set h3 = 3 * (g4^2 + xi * g5^2) - 2 * g3.
+  3.  Set h4 = 3 * (g2^2 + xi * g3^2) - 2 * g4.
+  4.  Set h5 = 2 * (g5 + 3 * g2 * g3).
+  5.  Return C(e) = (h2, h3, h4, h5).
+*/
+static EpidStatus SquareCompressedCyclotomic(PairingState* ps,
+                                             FfElement* const* g,
+                                             FfElement const* xi) {
+  EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
+  FfElement* t[6] = {0};
+  FfElement* u = NULL;
+  int i = 0;
+
+  // check parameters
+  if (!ps || !g || !xi || !ps->Fq2.ipp_ff) return kEpidBadArgErr;
+
+  do {
+    IppStatus sts = ippStsNoErr;
+    IppsGFpState* Fq2 = ps->Fq2.ipp_ff;
+    // Let t[0], ..., t[5], u be temporary variables in Fq2. All the
+    // following operations are computed in Fq2.
+    for (i = 0; i < 6; i++) {
+      result = NewScratchElement(ps, &(ps->Fq2), &t[i]);
+      BREAK_ON_EPID_ERROR(result);
+    }
+    BREAK_ON_EPID_ERROR(result);
+    result = NewScratchElement(ps, &(ps->Fq2), &u);
+    BREAK_ON_EPID_ERROR(result);
+    // Set t[0] = g4^2, t[1] = g5^2, t[2] = g4 * g5, t[3] = g2^2,
+    // t[4] = g3^2 and t[5] = g2 * g3.
+    sts = ippsGFpSqr(g[2]->ipp_ff_elem, t[0]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSqr(g[3]->ipp_ff_elem, t[1]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpMul(g[2]->ipp_ff_elem, g[3]->ipp_ff_elem, t[2]->ipp_ff_elem,
+                     Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSqr(g[0]->ipp_ff_elem, t[3]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSqr(g[1]->ipp_ff_elem, t[4]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpMul(g[0]->ipp_ff_elem, g[1]->ipp_ff_elem, t[5]->ipp_ff_elem,
+                     Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 1.  Set h2 = 2 * (g2 + 3 * xi * g4 * g5).
+    sts = ippsGFpMul(t[2]->ipp_ff_elem, xi->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(u->ipp_ff_elem, u->ipp_ff_elem, t[2]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(t[2]->ipp_ff_elem, u->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(u->ipp_ff_elem, g[0]->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(u->ipp_ff_elem, u->ipp_ff_elem, g[0]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 2.  Set h3 = 3 * (g4^2 + xi * g5^2) - 2 * g3.
+    sts = ippsGFpMul(t[1]->ipp_ff_elem, xi->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(u->ipp_ff_elem, t[0]->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(u->ipp_ff_elem, u->ipp_ff_elem, t[0]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(t[0]->ipp_ff_elem, u->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSub(u->ipp_ff_elem, g[1]->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSub(u->ipp_ff_elem, g[1]->ipp_ff_elem, g[1]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 3.  Set h4 = 3 * (g2^2 + xi * g3^2) - 2 * g4.
+    sts = ippsGFpMul(t[4]->ipp_ff_elem, xi->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(u->ipp_ff_elem, t[3]->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(u->ipp_ff_elem, u->ipp_ff_elem, t[3]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(t[3]->ipp_ff_elem, u->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSub(u->ipp_ff_elem, g[2]->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSub(u->ipp_ff_elem, g[2]->ipp_ff_elem, g[2]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 4.  Set h5 = 2 * (g5 + 3 * g2 * g3).
+    sts = ippsGFpAdd(t[5]->ipp_ff_elem, t[5]->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(u->ipp_ff_elem, t[5]->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(u->ipp_ff_elem, g[3]->ipp_ff_elem, u->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpAdd(u->ipp_ff_elem, u->ipp_ff_elem, g[3]->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 5.  Return C(e) = (h2, h3, h4, h5).
+    result = kEpidNoErr;
+  } while (0);
 
+  ReleaseScratch(ps, mark);
   return (result);
 }
 
 /*
-  e = Fq12.expCyclotomic(a, b)
-  Input: a (an element in Fq12), b (a non-negative integer)
+  e = e * Fq12.decompress(C(c[0]))^s[0] * ... *
+      Fq12.decompress(C(c[n-1]))^s[n-1]
+  Input: C(c[0]), ..., C(c[n-1]) (compressed elements of the cyclotomic
+  subgroup of Fq12, where each C(c[j]) = (g2, g3, g4, g5) has g2 != 0),
+  s[0], ..., s[n-1] (signs in {-1, 1}), e (an element in Fq12)
+  Output: e (an element in Fq12)
+  Steps:
+  1.  For j = 0, ..., n-1, set p[j] = (4 * g2 of c[0]) * ... *
+      (4 * g2 of c[j]).
+  2.  Set v = Fq2.inverse(p[n-1]).
+  3.  For j = n-1, ..., 0, do the following:
+      a. If j > 0, set w = v * p[j-1] and v = v * 4 * g2, else set w = v,
+      b. Set g1 = (xi * g5^2 + 3 * g4^2 - 2 * g3) * w,
+      c. Set g0 = (2 * g1^2 + g2 * g5 - 3 * g3 * g4) * xi + 1,
+      d. Set d = ((g0, g4, g3), (g2, g1, g5)),
+      e. If s[j] = -1, set d = Fq12.conjugate(d),
+      f. Set e = e * d.
+  4.  Return e.
+  p[j] is kept in c[j][4], so that all n elements are decompressed with
+  one inversion in Fq2.
+*/
+static EpidStatus MulDecompressedCyclotomic(PairingState* ps, FfElement* e,
+                                            FfElement* c[][5], int const* s,
+                                            size_t n, FfElement const* xi) {
+  EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
+  FfElement* v = NULL;
+  FfElement* w = NULL;
+  FfElement* g0 = NULL;
+  FfElement* g1 = NULL;
+  FfElement* t = NULL;
+  FfElement* d = NULL;
+  Fq12ElemStr d_str = {0};
+  size_t j = 0;
+
+  // check parameters
+  if (!ps || !e || !c || !s || !xi || 0 == n) return kEpidBadArgErr;
+
+  if (!e->ipp_ff_elem || !ps->ff || !ps->ff->ipp_ff || !ps->Fq2.ipp_ff)
+    return kEpidBadArgErr;
+
+  do {
+    IppStatus sts = ippStsNoErr;
+    IppsGFpState* Fq2 = ps->Fq2.ipp_ff;
+    Ipp32u one_dat[] = {1};
+    // Let v, w, g0, g1, t be temporary variables in Fq2 and d be a
+    // temporary variable in Fq12.
+    result = NewScratchElement(ps, &(ps->Fq2), &v);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewScratchElement(ps, &(ps->Fq2), &w);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewScratchElement(ps, &(ps->Fq2), &g0);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewScratchElement(ps, &(ps->Fq2), &g1);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewScratchElement(ps, &(ps->Fq2), &t);
+    BREAK_ON_EPID_ERROR(result);
+    result = NewScratchElement(ps, ps->ff, &d);
+    BREAK_ON_EPID_ERROR(result);
+    // 1.  For j = 0, ..., n-1, set p[j] = (4 * g2 of c[0]) * ... *
+    //     (4 * g2 of c[j]).
+    for (j = 0; j < n; j++) {
+      sts = ippsGFpAdd(c[j][0]->ipp_ff_elem, c[j][0]->ipp_ff_elem,
+                       t->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      if (0 == j) {
+        sts = ippsGFpAdd(t->ipp_ff_elem, t->ipp_ff_elem, c[j][4]->ipp_ff_elem,
+                         Fq2);
+        BREAK_ON_IPP_ERROR(sts, result);
+      } else {
+        sts = ippsGFpAdd(t->ipp_ff_elem, t->ipp_ff_elem, t->ipp_ff_elem, Fq2);
+        BREAK_ON_IPP_ERROR(sts, result);
+        sts = ippsGFpMul(c[j - 1][4]->ipp_ff_elem, t->ipp_ff_elem,
+                         c[j][4]->ipp_ff_elem, Fq2);
+        BREAK_ON_IPP_ERROR(sts, result);
+      }
+    }
+    BREAK_ON_EPID_ERROR(result);
+    // 2.  Set v = Fq2.inverse(p[n-1]).
+    sts = ippsGFpInv(c[n - 1][4]->ipp_ff_elem, v->ipp_ff_elem, Fq2);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 3.  For j = n-1, ..., 0, do the following:
+    for (j = n; j-- > 0;) {
+      FfElement* const* g = c[j];
+      //     a. If j > 0, set w = v * p[j-1] and v = v * 4 * g2, else set
+      //        w = v,
+      if (j > 0) {
+        sts = ippsGFpMul(v->ipp_ff_elem, c[j - 1][4]->ipp_ff_elem,
+                         w->ipp_ff_elem, Fq2);
+        BREAK_ON_IPP_ERROR(sts, result);
+        sts = ippsGFpAdd(g[0]->ipp_ff_elem, g[0]->ipp_ff_elem, t->ipp_ff_elem,
+                         Fq2);
+        BREAK_ON_IPP_ERROR(sts, result);
+        sts = ippsGFpAdd(t->ipp_ff_elem, t->ipp_ff_elem, t->ipp_ff_elem, Fq2);
+        BREAK_ON_IPP_ERROR(sts, result);
+        sts = ippsGFpMul(v->ipp_ff_elem, t->ipp_ff_elem, v->ipp_ff_elem, Fq2);
+        BREAK_ON_IPP_ERROR(sts, result);
+      } else {
+        sts = ippsGFpCpyElement(v->ipp_ff_elem, w->ipp_ff_elem, Fq2);
+        BREAK_ON_IPP_ERROR(sts, result);
+      }
+      //     b. Set g1 = (xi * g5^2 + 3 * g4^2 - 2 * g3) * w,
+      sts = ippsGFpSqr(g[3]->ipp_ff_elem, g1->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpMul(g1->ipp_ff_elem, xi->ipp_ff_elem, g1->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpSqr(g[2]->ipp_ff_elem, t->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpAdd(g1->ipp_ff_elem, t->ipp_ff_elem, g1->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpAdd(g1->ipp_ff_elem, t->ipp_ff_elem, g1->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpAdd(g1->ipp_ff_elem, t->ipp_ff_elem, g1->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpSub(g1->ipp_ff_elem, g[1]->ipp_ff_elem, g1->ipp_ff_elem,
+                       Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpSub(g1->ipp_ff_elem, g[1]->ipp_ff_elem, g1->ipp_ff_elem,
+                       Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpMul(g1->ipp_ff_elem, w->ipp_ff_elem, g1->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      //     c. Set g0 = (2 * g1^2 + g2 * g5 - 3 * g3 * g4) * xi + 1,
+      sts = ippsGFpSqr(g1->ipp_ff_elem, g0->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpAdd(g0->ipp_ff_elem, g0->ipp_ff_elem, g0->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpMul(g[0]->ipp_ff_elem, g[3]->ipp_ff_elem, t->ipp_ff_elem,
+                       Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpAdd(g0->ipp_ff_elem, t->ipp_ff_elem, g0->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpMul(g[1]->ipp_ff_elem, g[2]->ipp_ff_elem, t->ipp_ff_elem,
+                       Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpSub(g0->ipp_ff_elem, t->ipp_ff_elem, g0->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpSub(g0->ipp_ff_elem, t->ipp_ff_elem, g0->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpSub(g0->ipp_ff_elem, t->ipp_ff_elem, g0->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpMul(g0->ipp_ff_elem, xi->ipp_ff_elem, g0->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpSetElement(one_dat, COUNT_OF(one_dat), t->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpAdd(g0->ipp_ff_elem, t->ipp_ff_elem, g0->ipp_ff_elem, Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      //     d. Set d = ((g0, g4, g3), (g2, g1, g5)),
+      sts = ippsGFpGetElement(g0->ipp_ff_elem, (Ipp32u*)&d_str.a[0].a[0],
+                              sizeof(d_str.a[0].a[0]) / sizeof(Ipp32u), Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpGetElement(g[2]->ipp_ff_elem, (Ipp32u*)&d_str.a[0].a[1],
+                              sizeof(d_str.a[0].a[1]) / sizeof(Ipp32u), Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpGetElement(g[1]->ipp_ff_elem, (Ipp32u*)&d_str.a[0].a[2],
+                              sizeof(d_str.a[0].a[2]) / sizeof(Ipp32u), Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpGetElement(g[0]->ipp_ff_elem, (Ipp32u*)&d_str.a[1].a[0],
+                              sizeof(d_str.a[1].a[0]) / sizeof(Ipp32u), Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpGetElement(g1->ipp_ff_elem, (Ipp32u*)&d_str.a[1].a[1],
+                              sizeof(d_str.a[1].a[1]) / sizeof(Ipp32u), Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpGetElement(g[3]->ipp_ff_elem, (Ipp32u*)&d_str.a[1].a[2],
+                              sizeof(d_str.a[1].a[2]) / sizeof(Ipp32u), Fq2);
+      BREAK_ON_IPP_ERROR(sts, result);
+      sts = ippsGFpSetElement((Ipp32u*)&d_str, sizeof(d_str) / sizeof(Ipp32u),
+                              d->ipp_ff_elem, ps->ff->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+      //     e. If s[j] = -1, set d = Fq12.conjugate(d),
+      if (-1 == s[j]) {
+        sts = ippsGFpConj(d->ipp_ff_elem, d->ipp_ff_elem, ps->ff->ipp_ff);
+        BREAK_ON_IPP_ERROR(sts, result);
+      }
+      //     f. Set e = e * d.
+      sts = ippsGFpMul(e->ipp_ff_elem, d->ipp_ff_elem, e->ipp_ff_elem,
+                       ps->ff->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+    }
+    BREAK_ON_EPID_ERROR(result);
+    // 4.  Return e.
+    result = kEpidNoErr;
+  } while (0);
+
+  EpidZeroMemory(&d_str, sizeof(d_str));
+
+  ReleaseScratch(ps, mark);
+  return (result);
+}
+
+/*
+  e = Fq12.expCyclotomicBinary(a, b)
+  Input: a (an element in Fq12), bn...b1b0 (ternary representation of a
+  non-negative integer b)
   Output: e (an element in Fq12) where e = a^b
   Steps:
+  1.  Set e = 1.
+  2.  For i = n, ..., 0, do the following:
+      If i < n, e = Fq12.squareCyclotomic(e, e),
+      If bi = 1, compute e = Fq12.mul(e, a),
+      If bi = -1, compute e = Fq12.mul(e, Fq12.conjugate(a)).
+  3.  Return e.
+*/
+static EpidStatus ExpCyclotomicBinary(PairingState* ps, FfElement* e,
+                                      FfElement const* a,
+                                      int const* b_ternary, int b_len) {
+  EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
+  FfElement* a_conj = NULL;
+  int i = 0;
 
-  2.  Set e = a.
-  3.  For i = n-1, ..., 0, do the following:
-  e = Fq12.squareCyclotomic(e, e),
-  If bi = 1, compute e = Fq12.mul(e, a).
-  4.  Return e.
+  // check parameters
+  if (!e || !a || !b_ternary || !ps || e == a) return kEpidBadArgErr;
+
+  do {
+    IppStatus sts = ippStsNoErr;
+    Ipp32u one_dat[] = {1};
+    result = NewScratchElement(ps, ps->ff, &a_conj);
+    BREAK_ON_EPID_ERROR(result);
+    sts = ippsGFpConj(a->ipp_ff_elem, a_conj->ipp_ff_elem, ps->ff->ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 1.  Set e = 1.
+    sts = ippsGFpSetElement(one_dat, COUNT_OF(one_dat), e->ipp_ff_elem,
+                            ps->ff->ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 2.  For i = n, ..., 0, do the following:
+    for (i = b_len; i >= 0; i--) {
+      //       If i < n, e = Fq12.squareCyclotomic(e, e),
+      if (i < b_len) {
+        result = SquareCyclotomic(ps, e, e);
+        BREAK_ON_EPID_ERROR(result);
+      }
+      //       If bi = 1, compute e = Fq12.mul(e, a),
+      //       If bi = -1, compute e = Fq12.mul(e, Fq12.conjugate(a)).
+      if (0 != b_ternary[i]) {
+        sts = ippsGFpMul(e->ipp_ff_elem,
+                         (-1 == b_ternary[i]) ? a_conj->ipp_ff_elem
+                                              : a->ipp_ff_elem,
+                         e->ipp_ff_elem, ps->ff->ipp_ff);
+        BREAK_ON_IPP_ERROR(sts, result);
+      }
+    }
+    BREAK_ON_EPID_ERROR(result);
+    // 3.  Return e.
+    result = kEpidNoErr;
+  } while (0);
+
+  ReleaseScratch(ps, mark);
+  return (result);
+}
+
+/*
+  e = Fq12.expCyclotomic(a, b)
+  Input: a (an element in the cyclotomic subgroup of Fq12), bn...b1b0
+  (ternary representation of a non-negative integer b)
+  Output: e (an element in Fq12) where e = a^b
+  Steps:
+  1.  Let a = ((a[0], a[2], a[4]), (a[1], a[3], a[5])) and let
+      C(a) = (g2, g3, g4, g5) = (a[1], a[4], a[2], a[5]) be its
+      compressed form.
+  2.  Set e = 1.
+  3.  For i = 0, ..., n, do the following:
+      If bi != 0, save C(a^(2^i)) and bi,
+      If EXP_CYCLOTOMIC_BATCH values are saved, multiply them into e
+      with Fq12.mulDecompressed and forget them,
+      If i < n, C(a^(2^(i+1))) = Fq12.squareCompressed(C(a^(2^i))).
+  4.  Multiply the remaining saved values into e with
+      Fq12.mulDecompressed.
+  5.  Return e.
+  Compressed squaring and decompression follow Karabina, "Squaring in
+  cyclotomic subgroups". If a saved value has g2 = 0, for instance when
+  a = 1, it cannot be decompressed this way and e is computed with
+  Fq12.expCyclotomicBinary instead.
 */
 static EpidStatus ExpCyclotomic(PairingState* ps, FfElement* e,
-                                FfElement const* a, BigNum const* b) {
+                                FfElement const* a, int const* b_ternary,
+                                int b_len) {
   EpidStatus result = kEpidErr;
+  ScratchMark const mark = GetScratchMark(ps);
+  FfElement* xi = NULL;
+  FfElement* g[4] = {0};
+  FfElement* c[EXP_CYCLOTOMIC_BATCH][5] = {{0}};
+  int s[EXP_CYCLOTOMIC_BATCH] = {0};
+  size_t num_c = 0;
+  size_t k = 0;
+  bool compressible = true;
+  FfElement* a_copy = NULL;
+  int i = 0;
+  int j = 0;
+  Fq12ElemStr a_str = {0};
+  Fq2ElemStr Fq6IrrPolynomial[3 + 1] = {0};
 
   // check parameters
-  if (!e || !a || !b || !ps) return kEpidBadArgErr;
+  if (!e || !a || !b_ternary || !ps || b_len < 0) return kEpidBadArgErr;
 
-  if (!e->ipp_ff_elem || !a->ipp_ff_elem || !ps->Fq.ipp_ff || !ps->Fq2.ipp_ff ||
-      !b->ipp_bn)
+  if (!e->ipp_ff_elem || !a->ipp_ff_elem || !ps->ff || !ps->ff->ipp_ff ||
+      !ps->Fq2.ipp_ff || !ps->Fq6.ipp_ff)
     return kEpidBadArgErr;
 
   do {
     IppStatus sts = ippStsNoErr;
-    int num_bits = 0;
-    Ipp32u* b_str = 0;
-    int i = 0;
+    Ipp32u one_dat[] = {1};
 
-    // 1.  Let bn...b1b0 be the binary representation of b.
-    sts = ippsRef_BN(0, &num_bits, &b_str, b->ipp_bn);
+    // extract xi from Fq6 irr poly
+    result = NewScratchElement(ps, &(ps->Fq2), &xi);
+    BREAK_ON_EPID_ERROR(result);
+    sts = ippsGFpGetModulus(ps->Fq6.ipp_ff, (Ipp32u*)&Fq6IrrPolynomial);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSetElement((Ipp32u const*)&Fq6IrrPolynomial[0],
+                            sizeof(Fq6IrrPolynomial[0]) / sizeof(Ipp32u),
+                            xi->ipp_ff_elem, ps->Fq2.ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
-    // 2.  Set e = a.
-    sts = ippsGFpCpyElement(a->ipp_ff_elem, e->ipp_ff_elem, ps->ff->ipp_ff);
+    // first coefficent is -xi
+    sts = ippsGFpNeg(xi->ipp_ff_elem, xi->ipp_ff_elem, ps->Fq2.ipp_ff);
     BREAK_ON_IPP_ERROR(sts, result);
-    // 3.  For i = n-1, ..., 0, do the following:
-    for (i = num_bits - 2; i >= 0; i--) {
-      //       e = Fq12.squareCyclotomic(e, e),
-      result = SquareCyclotomic(ps, e, e);
+
+    // 1.  Let a = ((a[0], a[2], a[4]), (a[1], a[3], a[5])) and let
+    //     C(a) = (g2, g3, g4, g5) = (a[1], a[4], a[2], a[5]) be its
+    //     compressed form.
+    for (j = 0; j < 4; j++) {
+      result = NewScratchElement(ps, &(ps->Fq2), &g[j]);
       BREAK_ON_EPID_ERROR(result);
-      //       If bi = 1, compute e = Fq12.mul(e, a).
-      if (1 == Bit(b_str, i)) {
-        sts = ippsGFpMul(e->ipp_ff_elem, a->ipp_ff_elem, e->ipp_ff_elem,
-                         ps->ff->ipp_ff);
+    }
+    BREAK_ON_EPID_ERROR(result);
+    sts = ippsGFpGetElement(a->ipp_ff_elem, (Ipp32u*)&a_str,
+                            sizeof(a_str) / sizeof(Ipp32u), ps->ff->ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSetElement((Ipp32u*)&a_str.a[1].a[0],
+                            sizeof(a_str.a[1].a[0]) / sizeof(Ipp32u),
+                            g[0]->ipp_ff_elem, ps->Fq2.ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSetElement((Ipp32u*)&a_str.a[0].a[2],
+                            sizeof(a_str.a[0].a[2]) / sizeof(Ipp32u),
+                            g[1]->ipp_ff_elem, ps->Fq2.ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSetElement((Ipp32u*)&a_str.a[0].a[1],
+                            sizeof(a_str.a[0].a[1]) / sizeof(Ipp32u),
+                            g[2]->ipp_ff_elem, ps->Fq2.ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    sts = ippsGFpSetElement((Ipp32u*)&a_str.a[1].a[2],
+                            sizeof(a_str.a[1].a[2]) / sizeof(Ipp32u),
+                            g[3]->ipp_ff_elem, ps->Fq2.ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 2.  Set e = 1.
+    sts = ippsGFpSetElement(one_dat, COUNT_OF(one_dat), e->ipp_ff_elem,
+                            ps->ff->ipp_ff);
+    BREAK_ON_IPP_ERROR(sts, result);
+    // 3.  For i = 0, ..., n, do the following:
+    for (i = 0; i <= b_len; i++) {
+      //       If bi != 0, save C(a^(2^i)) and bi,
+      if (0 != b_ternary[i]) {
+        int is_zero = IPP_IS_NE;
+        sts = ippsGFpIsZeroElement(g[0]->ipp_ff_elem, &is_zero,
+                                   ps->Fq2.ipp_ff);
         BREAK_ON_IPP_ERROR(sts, result);
+        if (IPP_IS_EQ == is_zero) {
+          compressible = false;
+          break;
+        }
+        if (k == num_c) {
+          for (j = 0; j < 5; j++) {
+            result = NewScratchElement(ps, &(ps->Fq2), &c[k][j]);
+            BREAK_ON_EPID_ERROR(result);
+          }
+          BREAK_ON_EPID_ERROR(result);
+          num_c++;
+        }
+        for (j = 0; j < 4; j++) {
+          sts = ippsGFpCpyElement(g[j]->ipp_ff_elem, c[k][j]->ipp_ff_elem,
+                                  ps->Fq2.ipp_ff);
+          BREAK_ON_IPP_ERROR(sts, result);
+        }
+        BREAK_ON_EPID_ERROR(result);
+        s[k++] = b_ternary[i];
+        //       If EXP_CYCLOTOMIC_BATCH values are saved, multiply them
+        //       into e with Fq12.mulDecompressed and forget them,
+        if (EXP_CYCLOTOMIC_BATCH == k) {
+          result = MulDecompressedCyclotomic(ps, e, c, s, k, xi);
+          BREAK_ON_EPID_ERROR(result);
+          k = 0;
+        }
+      }
+      //       If i < n, C(a^(2^(i+1))) = Fq12.squareCompressed(C(a^(2^i))).
+      if (i < b_len) {
+        result = SquareCompressedCyclotomic(ps, g, xi);
+        BREAK_ON_EPID_ERROR(result);
       }
-      // 4.  Return e.
     }
+    BREAK_ON_EPID_ERROR(result);
+    if (!compressible) {
+      result = NewScratchElement(ps, ps->ff, &a_copy);
+      BREAK_ON_EPID_ERROR(result);
+      sts = ippsGFpSetElement((Ipp32u*)&a_str, sizeof(a_str) / sizeof(Ipp32u),
+                              a_copy->ipp_ff_elem, ps->ff->ipp_ff);
+      BREAK_ON_IPP_ERROR(sts, result);
+      result = ExpCyclotomicBinary(ps, e, a_copy, b_ternary, b_len);
+      BREAK_ON_EPID_ERROR(result);
+      break;
+    }
+    // 4.  Multiply the remaining saved values into e with
+    //     Fq12.mulDecompressed.
+    if (k > 0) {
+      result = MulDecompressedCyclotomic(ps, e, c, s, k, xi);
+      BREAK_ON_EPID_ERROR(result);
+    }
+    // 5.  Return e.
     result = kEpidNoErr;
   } while (0);
 
+  EpidZeroMemory(&a_str, sizeof(a_str));
+  EpidZeroMemory(Fq6IrrPolynomial, sizeof(Fq6IrrPolynomial));
+
+  ReleaseScratch(ps, mark);
   return (result);
 }
@@ -0,0 +1,80 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Math layer statistics private interface.
+ */
+
+#ifndef EPID_COMMON_MATH_SRC_STATS_INTERNAL_H_
+#define EPID_COMMON_MATH_SRC_STATS_INTERNAL_H_
+
+#include "epid/common/math/stats.h"
+
+#if defined(EPID_ENABLE_MATH_STATS)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+/// Reads the time stamp counter
+#define EPID_MATH_STAT_CYCLES() ((uint64_t)__rdtsc())
+/// Storage class of per thread statistics
+#define EPID_MATH_STAT_THREAD_LOCAL __declspec(thread)
+#else  // defined(_MSC_VER)
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+/// Reads the time stamp counter
+#define EPID_MATH_STAT_CYCLES() ((uint64_t)__rdtsc())
+#else  // defined(__x86_64__) || defined(__i386__)
+/// No time stamp counter, only operations are counted
+#define EPID_MATH_STAT_CYCLES() ((uint64_t)0)
+#endif  // defined(__x86_64__) || defined(__i386__)
+/// Storage class of per thread statistics
+#define EPID_MATH_STAT_THREAD_LOCAL __thread
+#endif  // defined(_MSC_VER)
+
+/// Statistics of the calling thread
+extern EPID_MATH_STAT_THREAD_LOCAL EpidMathStats epid_math_stats;
+
+/// Declares timer t and starts it
+#define EPID_MATH_STAT_START(t) uint64_t const t = EPID_MATH_STAT_CYCLES()
+
+/// Charges n operations of kind id and the cycles since timer t started
+#define EPID_MATH_STAT_STOP(id, n, t)                                 \
+  do {                                                                \
+    epid_math_stats.stat[id].count += (n);                            \
+    epid_math_stats.stat[id].cycles += EPID_MATH_STAT_CYCLES() - (t); \
+  } while (0)
+
+/// Counts n operations of kind id without timing them
+#define EPID_MATH_STAT_COUNT(id, n)        \
+  do {                                     \
+    epid_math_stats.stat[id].count += (n); \
+  } while (0)
+
+#else  // defined(EPID_ENABLE_MATH_STATS)
+
+/// Statistics are not gathered if EPID_ENABLE_MATH_STATS is undefined
+#define EPID_MATH_STAT_START(t)
+
+/// Statistics are not gathered if EPID_ENABLE_MATH_STATS is undefined
+#define EPID_MATH_STAT_STOP(id, n, t)
+
+/// Statistics are not gathered if EPID_ENABLE_MATH_STATS is undefined
+#define EPID_MATH_STAT_COUNT(id, n)
+
+#endif  // defined(EPID_ENABLE_MATH_STATS)
+
+#endif  // EPID_COMMON_MATH_SRC_STATS_INTERNAL_H_
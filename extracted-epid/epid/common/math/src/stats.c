@@ -0,0 +1,61 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Math layer statistics implementation.
+ */
+
+#include "epid/common/math/src/stats-internal.h"
+
+#include <string.h>
+
+#if defined(EPID_ENABLE_MATH_STATS)
+EPID_MATH_STAT_THREAD_LOCAL EpidMathStats epid_math_stats;
+#endif  // defined(EPID_ENABLE_MATH_STATS)
+
+void EpidGetMathStats(EpidMathStats* stats) {
+  if (!stats) return;
+#if defined(EPID_ENABLE_MATH_STATS)
+  *stats = epid_math_stats;
+#else   // defined(EPID_ENABLE_MATH_STATS)
+  memset(stats, 0, sizeof(*stats));
+#endif  // defined(EPID_ENABLE_MATH_STATS)
+}
+
+void EpidResetMathStats(void) {
+#if defined(EPID_ENABLE_MATH_STATS)
+  memset(&epid_math_stats, 0, sizeof(epid_math_stats));
+#endif  // defined(EPID_ENABLE_MATH_STATS)
+}
+
+char const* EpidMathStatName(EpidMathStatId id) {
+  static char const* const names[kEpidMathStatCount] = {
+      "Pairing",       "FinalExp",     "EcExp",
+      "EcMultiExp",    "FfMultiExp",   "EcHash",
+      "EcHashRetry",   "NewFfElement", "NewEcPoint",
+      "EpidAlloc"};
+  if ((int)id < 0 || id >= kEpidMathStatCount) return NULL;
+  return names[id];
+}
+
+int EpidMathStatsEnabled(void) {
+#if defined(EPID_ENABLE_MATH_STATS)
+  return 1;
+#else   // defined(EPID_ENABLE_MATH_STATS)
+  return 0;
+#endif  // defined(EPID_ENABLE_MATH_STATS)
+}
@@ -0,0 +1,104 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Math layer statistics interface.
+ */
+#ifndef EPID_COMMON_MATH_STATS_H_
+#define EPID_COMMON_MATH_STATS_H_
+
+#include <stdint.h>
+
+/// Math layer statistics
+/*!
+  \defgroup EpidMathStats stats
+  Counts the expensive operations of the math layer, and the time spent
+  in them, for the calling thread.
+
+  The counters are only updated if the library is built with the symbol
+  EPID_ENABLE_MATH_STATS defined; otherwise they stay zero and the
+  operations carry no instrumentation at all.
+
+  \ingroup EpidMath
+  @{
+*/
+
+/// Counted operations
+typedef enum {
+  kEpidMathStatPairing = 0,   //!< pairings, counting every multi-pairing term
+  kEpidMathStatFinalExp,      //!< pairing final exponentiations
+  kEpidMathStatEcExp,         //!< EcExp and EcSscmExp calls
+  kEpidMathStatEcMultiExp,    //!< EcMultiExp calls
+  kEpidMathStatFfMultiExp,    //!< FfMultiExp calls
+  kEpidMathStatEcHash,        //!< EcHash calls
+  kEpidMathStatEcHashRetry,   //!< EcHash candidates off the curve, not timed
+  kEpidMathStatNewFfElement,  //!< finite field elements created
+  kEpidMathStatNewEcPoint,    //!< elliptic curve points created
+  kEpidMathStatAlloc,         //!< EpidAlloc calls, not timed
+  kEpidMathStatCount,         //!< Count of counted operations
+} EpidMathStatId;
+
+/// Statistics of one operation
+typedef struct EpidMathStat {
+  uint64_t count;   ///< number of operations
+  uint64_t cycles;  ///< time stamp counter cycles spent in them
+} EpidMathStat;
+
+/// Statistics of all operations
+typedef struct EpidMathStats {
+  EpidMathStat stat[kEpidMathStatCount];  ///< indexed by ::EpidMathStatId
+} EpidMathStats;
+
+/// Reads the statistics of the calling thread
+/*!
+  Cycles are inclusive: the cycles of a pairing include those of its
+  final exponentiation, and an operation that calls another counted
+  operation is charged for both.
+
+  Operations run on other threads are not included. A caller that spreads
+  work over threads must read the statistics on each of them and add
+  them up.
+
+  \param[out] stats
+  The statistics gathered since the thread started or last called
+  ::EpidResetMathStats.
+*/
+void EpidGetMathStats(EpidMathStats* stats);
+
+/// Clears the statistics of the calling thread
+void EpidResetMathStats(void);
+
+/// Gets the name of a counted operation
+/*!
+  \param[in] id
+  The operation.
+  \returns
+  A short name suitable for reports, or NULL if id is out of range.
+*/
+char const* EpidMathStatName(EpidMathStatId id);
+
+/// Tells whether the library was built with EPID_ENABLE_MATH_STATS
+/*!
+  \returns
+  Non-zero if the statistics are gathered.
+*/
+int EpidMathStatsEnabled(void);
+
+/*!
+  @}
+*/
+#endif  // EPID_COMMON_MATH_STATS_H_
@@ -30,6 +30,7 @@
 extern "C" {
 #include "epid/common/math/ecgroup.h"
 #include "epid/common/math/finitefield.h"
+#include "epid/common/math/src/ecgroup-internal.h"
 }
 #include "epid/common-testhelper/errors-testhelper.h"
 #include "epid/common-testhelper/prng-testhelper.h"
@@ -836,6 +837,69 @@ TEST_F(EcGroupTest, WriteEcPointWritesG2PointCorrectly) {
   EXPECT_EQ(this->efq2_a_str, g2_elem_str);
 }
 ///////////////////////////////////////////////////////////////////////
+// WriteEcPointBatch / EcBatchToAffine
+TEST_F(EcGroupTest, WriteBatchFailsGivenNullPointer) {
+  G1ElemStr g1_elem_str[2];
+  EcPoint const* pts[] = {this->efq_a, this->efq_b};
+  EcPoint const* pts_withnull[] = {this->efq_a, nullptr};
+  EXPECT_EQ(kEpidBadArgErr, WriteEcPointBatch(nullptr, pts, 2, g1_elem_str,
+                                              sizeof(g1_elem_str[0])));
+  EXPECT_EQ(kEpidBadArgErr, WriteEcPointBatch(this->efq, nullptr, 2,
+                                              g1_elem_str,
+                                              sizeof(g1_elem_str[0])));
+  EXPECT_EQ(kEpidBadArgErr,
+            WriteEcPointBatch(this->efq, pts_withnull, 2, g1_elem_str,
+                              sizeof(g1_elem_str[0])));
+  EXPECT_EQ(kEpidBadArgErr, WriteEcPointBatch(this->efq, pts, 2, nullptr,
+                                              sizeof(g1_elem_str[0])));
+}
+TEST_F(EcGroupTest, WriteBatchWritesG1PointsCorrectly) {
+  G1ElemStr g1_elem_str[3];
+  // a projective, an infinite and an affine point
+  THROW_ON_EPIDERR(EcMul(this->efq, this->efq_a, this->efq_b, this->efq_r));
+  EcPoint const* pts[] = {this->efq_r, this->efq_identity, this->efq_a};
+  EXPECT_EQ(kEpidNoErr, WriteEcPointBatch(this->efq, pts, 3, g1_elem_str,
+                                          sizeof(g1_elem_str[0])));
+  EXPECT_EQ(this->efq_mul_ab_str, g1_elem_str[0]);
+  EXPECT_EQ(this->efq_identity_str, g1_elem_str[1]);
+  EXPECT_EQ(this->efq_a_str, g1_elem_str[2]);
+}
+TEST_F(EcGroupTest, WriteBatchWritesG2PointsCorrectly) {
+  G2ElemStr g2_elem_str[3];
+  THROW_ON_EPIDERR(
+      EcMul(this->efq2, this->efq2_a, this->efq2_b, this->efq2_r));
+  EcPoint const* pts[] = {this->efq2_a, this->efq2_r, this->efq2_identity};
+  EXPECT_EQ(kEpidNoErr, WriteEcPointBatch(this->efq2, pts, 3, g2_elem_str,
+                                          sizeof(g2_elem_str[0])));
+  EXPECT_EQ(this->efq2_a_str, g2_elem_str[0]);
+  EXPECT_EQ(this->efq2_mul_ab_str, g2_elem_str[1]);
+  EXPECT_EQ(this->efq2_identity_str, g2_elem_str[2]);
+}
+TEST_F(EcGroupTest, WriteBatchWritesPointsCorrectlyWithoutIppLayout) {
+  G1ElemStr g1_elem_str[3];
+  EcGroup* efq = this->efq;
+  efq->ipp_layout = EC_IPP_LAYOUT_INVALID;
+  THROW_ON_EPIDERR(EcMul(efq, this->efq_a, this->efq_b, this->efq_r));
+  EcPoint const* pts[] = {this->efq_r, this->efq_identity, this->efq_a};
+  EXPECT_EQ(kEpidNoErr, WriteEcPointBatch(efq, pts, 3, g1_elem_str,
+                                          sizeof(g1_elem_str[0])));
+  EXPECT_EQ(this->efq_mul_ab_str, g1_elem_str[0]);
+  EXPECT_EQ(this->efq_identity_str, g1_elem_str[1]);
+  EXPECT_EQ(this->efq_a_str, g1_elem_str[2]);
+}
+TEST_F(EcGroupTest, BatchToAffineKeepsValueOfPoints) {
+  G1ElemStr g1_elem_str;
+  THROW_ON_EPIDERR(EcMul(this->efq, this->efq_a, this->efq_b, this->efq_r));
+  EcPoint* pts[] = {this->efq_identity, this->efq_r};
+  EXPECT_EQ(kEpidNoErr, EcBatchToAffine(this->efq, pts, 2));
+  THROW_ON_EPIDERR(
+      WriteEcPoint(this->efq, this->efq_r, &g1_elem_str, sizeof(g1_elem_str)));
+  EXPECT_EQ(this->efq_mul_ab_str, g1_elem_str);
+  THROW_ON_EPIDERR(WriteEcPoint(this->efq, this->efq_identity, &g1_elem_str,
+                                sizeof(g1_elem_str)));
+  EXPECT_EQ(this->efq_identity_str, g1_elem_str);
+}
+///////////////////////////////////////////////////////////////////////
 // EcMul
 TEST_F(EcGroupTest, MulFailsGivenArgumentsMismatch) {
   EXPECT_EQ(kEpidBadArgErr,
@@ -1025,6 +1089,130 @@ TEST_F(EcGroupTest, SscmExpResultIsCorrectForG2) {
   EXPECT_EQ(this->efq2_exp_ax_str, efq2_r_str);
 }
 ///////////////////////////////////////////////////////////////////////
+// EcExpFixedBase
+TEST_F(EcGroupTest, NewFixedBaseTableFailsGivenNullPointer) {
+  EcFixedBaseTable* table = nullptr;
+  EXPECT_EQ(kEpidBadArgErr, NewEcFixedBaseTable(nullptr, this->efq_a, &table));
+  EXPECT_EQ(kEpidBadArgErr, NewEcFixedBaseTable(this->efq, nullptr, &table));
+  EXPECT_EQ(kEpidBadArgErr,
+            NewEcFixedBaseTable(this->efq, this->efq_a, nullptr));
+}
+TEST_F(EcGroupTest, NewFixedBaseTableFailsGivenArgumentsMismatch) {
+  EcFixedBaseTable* table = nullptr;
+  EXPECT_EQ(kEpidBadArgErr,
+            NewEcFixedBaseTable(this->efq, this->efq2_a, &table));
+}
+TEST_F(EcGroupTest, ExpFixedBaseFailsGivenNullPointer) {
+  BigNumStr zero_bn_str = {0};
+  EcFixedBaseTable* table = nullptr;
+  THROW_ON_EPIDERR(NewEcFixedBaseTable(this->efq, this->efq_a, &table));
+  EXPECT_EQ(kEpidBadArgErr,
+            EcExpFixedBase(nullptr, table, &zero_bn_str, this->efq_r));
+  EXPECT_EQ(kEpidBadArgErr,
+            EcExpFixedBase(this->efq, nullptr, &zero_bn_str, this->efq_r));
+  EXPECT_EQ(kEpidBadArgErr,
+            EcExpFixedBase(this->efq, table, nullptr, this->efq_r));
+  EXPECT_EQ(kEpidBadArgErr,
+            EcExpFixedBase(this->efq, table, &zero_bn_str, nullptr));
+  DeleteEcFixedBaseTable(&table);
+}
+TEST_F(EcGroupTest, ExpFixedBaseFailsGivenArgumentsMismatch) {
+  BigNumStr zero_bn_str = {0};
+  EcFixedBaseTable* table = nullptr;
+  THROW_ON_EPIDERR(NewEcFixedBaseTable(this->efq2, this->efq2_a, &table));
+  EXPECT_EQ(kEpidBadArgErr,
+            EcExpFixedBase(this->efq, table, &zero_bn_str, this->efq_r));
+  DeleteEcFixedBaseTable(&table);
+}
+TEST_F(EcGroupTest, ExpFixedBaseFailsGivenOutOfRangeExponent) {
+  BigNumStr large_bn_str;
+  memset(&large_bn_str, 0xff, sizeof(large_bn_str));
+  EcFixedBaseTable* table = nullptr;
+  THROW_ON_EPIDERR(NewEcFixedBaseTable(this->efq, this->efq_a, &table));
+  // same status as EcExp for a power not less than the group order
+  EXPECT_EQ(kEpidBadArgErr,
+            EcExp(this->efq, this->efq_a, &large_bn_str, this->efq_r));
+  EXPECT_EQ(kEpidBadArgErr,
+            EcExpFixedBase(this->efq, table, &large_bn_str, this->efq_r));
+  DeleteEcFixedBaseTable(&table);
+}
+TEST_F(EcGroupTest, ExpFixedBaseSucceedsGivenZeroExponent) {
+  G1ElemStr efq_r_str;
+  BigNumStr zero_bn_str = {0};
+  EcFixedBaseTable* table = nullptr;
+  THROW_ON_EPIDERR(NewEcFixedBaseTable(this->efq, this->efq_a, &table));
+  EXPECT_EQ(kEpidNoErr,
+            EcExpFixedBase(this->efq, table, &zero_bn_str, this->efq_r));
+  DeleteEcFixedBaseTable(&table);
+  THROW_ON_EPIDERR(
+      WriteEcPoint(this->efq, this->efq_r, &efq_r_str, sizeof(efq_r_str)));
+  EXPECT_EQ(this->efq_identity_str, efq_r_str);
+}
+TEST_F(EcGroupTest, ExpFixedBaseSucceedsGivenIdentityBase) {
+  G1ElemStr efq_r_str;
+  EcFixedBaseTable* table = nullptr;
+  THROW_ON_EPIDERR(NewEcFixedBaseTable(this->efq, this->efq_identity, &table));
+  EXPECT_EQ(kEpidNoErr,
+            EcExpFixedBase(this->efq, table, &this->x_str, this->efq_r));
+  DeleteEcFixedBaseTable(&table);
+  THROW_ON_EPIDERR(
+      WriteEcPoint(this->efq, this->efq_r, &efq_r_str, sizeof(efq_r_str)));
+  EXPECT_EQ(this->efq_identity_str, efq_r_str);
+}
+TEST_F(EcGroupTest, ExpFixedBaseResultIsCorrect) {
+  G1ElemStr efq_r_str;
+  EcFixedBaseTable* table = nullptr;
+  THROW_ON_EPIDERR(NewEcFixedBaseTable(this->efq, this->efq_a, &table));
+  EXPECT_EQ(kEpidNoErr,
+            EcExpFixedBase(this->efq, table, &this->x_str, this->efq_r));
+  DeleteEcFixedBaseTable(&table);
+  THROW_ON_EPIDERR(
+      WriteEcPoint(this->efq, this->efq_r, &efq_r_str, sizeof(efq_r_str)));
+  EXPECT_EQ(this->efq_exp_ax_str, efq_r_str);
+}
+TEST_F(EcGroupTest, ExpFixedBaseResultIsCorrectForG2) {
+  G2ElemStr efq2_r_str;
+  EcFixedBaseTable* table = nullptr;
+  THROW_ON_EPIDERR(NewEcFixedBaseTable(this->efq2, this->efq2_a, &table));
+  EXPECT_EQ(kEpidNoErr,
+            EcExpFixedBase(this->efq2, table, &this->x_str, this->efq2_r));
+  DeleteEcFixedBaseTable(&table);
+  THROW_ON_EPIDERR(
+      WriteEcPoint(this->efq2, this->efq2_r, &efq2_r_str, sizeof(efq2_r_str)));
+  EXPECT_EQ(this->efq2_exp_ax_str, efq2_r_str);
+}
+///////////////////////////////////////////////////////////////////////
+// EcExpBatch
+TEST_F(EcGroupTest, ExpBatchFailsGivenNullPointer) {
+  BigNumStr const* b[] = {&this->x_str};
+  EcPoint* r[] = {this->efq_r};
+  EXPECT_EQ(kEpidBadArgErr, EcExpBatch(nullptr, this->efq_a, b, 1, r));
+  EXPECT_EQ(kEpidBadArgErr, EcExpBatch(this->efq, nullptr, b, 1, r));
+  EXPECT_EQ(kEpidBadArgErr, EcExpBatch(this->efq, this->efq_a, nullptr, 1, r));
+  EXPECT_EQ(kEpidBadArgErr, EcExpBatch(this->efq, this->efq_a, b, 1, nullptr));
+}
+TEST_F(EcGroupTest, ExpBatchResultIsCorrect) {
+  // small batches use EcExp, large ones a fixed-base table
+  const size_t kMaxCount = 16;
+  EcPointObj r_obj[kMaxCount];
+  EcPoint* r[kMaxCount];
+  BigNumStr const* b[kMaxCount];
+  for (size_t i = 0; i < kMaxCount; i++) {
+    r_obj[i] = EcPointObj(&this->efq2);
+    r[i] = r_obj[i];
+    b[i] = &this->x_str;
+  }
+  for (size_t count = 1; count <= kMaxCount; count += kMaxCount - 1) {
+    EXPECT_EQ(kEpidNoErr, EcExpBatch(this->efq2, this->efq2_a, b, count, r));
+    for (size_t i = 0; i < count; i++) {
+      G2ElemStr efq2_r_str;
+      THROW_ON_EPIDERR(
+          WriteEcPoint(this->efq2, r[i], &efq2_r_str, sizeof(efq2_r_str)));
+      EXPECT_EQ(this->efq2_exp_ax_str, efq2_r_str);
+    }
+  }
+}
+///////////////////////////////////////////////////////////////////////
 // EcMultiExp
 TEST_F(EcGroupTest, MultiExpFailsGivenArgumentsMismatch) {
   EcPoint const* pts_ec1[] = {this->efq_a, this->efq_b};
@@ -1218,6 +1406,44 @@ TEST_F(EcGroupTest, MultiExpWorksGivenTwoG2Exponents) {
       WriteEcPoint(this->efq2, this->efq2_r, &efq2_r_str, sizeof(efq2_r_str)));
   EXPECT_EQ(this->efq2_multiexp_abxy_str, efq2_r_str);
 }
+TEST_F(EcGroupTest, MultiExpWorksGivenResultIsABase) {
+  G1ElemStr efq_r_str;
+  EcPointObj efq_r(&this->efq, this->efq_a_str);
+  EcPoint const* pts[] = {efq_r, this->efq_b};
+  BigNumStr const* b[] = {&this->x_str, &this->y_str};
+  size_t m = 2;
+  EXPECT_EQ(kEpidNoErr, EcMultiExp(this->efq, pts, b, m, efq_r));
+  THROW_ON_EPIDERR(
+      WriteEcPoint(this->efq, efq_r, &efq_r_str, sizeof(efq_r_str)));
+  EXPECT_EQ(this->efq_multiexp_abxy_str, efq_r_str);
+}
+TEST_F(EcGroupTest, MultiExpWorksGivenManyExponents) {
+  // enough terms to accumulate in buckets instead of interleaving windows
+  size_t const m = 512;
+  G1ElemStr efq_r_str;
+  G1ElemStr expected_str;
+  std::vector<EcPoint const*> pts;
+  std::vector<BigNumStr const*> b;
+  for (size_t i = 0; i < m / 2; i++) {
+    pts.push_back(this->efq_a);
+    b.push_back(&this->x_str);
+    pts.push_back(this->efq_b);
+    b.push_back(&this->y_str);
+  }
+  // expected is (m / 2) * (a * x + b * y)
+  BigNumStr half_m_str = {0};
+  half_m_str.data.data[sizeof(half_m_str.data.data) - 2] = 1;
+  EcPointObj abxy(&this->efq, this->efq_multiexp_abxy_str);
+  EcPointObj expected(&this->efq);
+  THROW_ON_EPIDERR(EcExp(this->efq, abxy, &half_m_str, expected));
+  THROW_ON_EPIDERR(
+      WriteEcPoint(this->efq, expected, &expected_str, sizeof(expected_str)));
+  EXPECT_EQ(kEpidNoErr,
+            EcMultiExp(this->efq, pts.data(), b.data(), m, this->efq_r));
+  THROW_ON_EPIDERR(
+      WriteEcPoint(this->efq, this->efq_r, &efq_r_str, sizeof(efq_r_str)));
+  EXPECT_EQ(expected_str, efq_r_str);
+}
 ///////////////////////////////////////////////////////////////////////
 // EcMultiExpBn
 TEST_F(EcGroupTest, MultiExpBnFailsGivenArgumentsMismatch) {
@@ -19,6 +19,7 @@
  * \brief FfElement unit tests.
  */
 
+#include <climits>
 #include <cstring>
 #include <limits>
 #include <algorithm>
@@ -1446,6 +1447,47 @@ TEST_F(FfElementTest, DeleteWorksGivenNullPointer) {
   EXPECT_NO_THROW(DeleteFfElement(&ff_elem));
 }
 
+////////////////////////////////////////////////
+// NewFfElements / DeleteFfElements
+
+TEST_F(FfElementTest, NewElementsFailsGivenInvalidParameters) {
+  FfElement* ff_elems[2] = {nullptr, nullptr};
+  EXPECT_EQ(kEpidBadArgErr, NewFfElements(nullptr, ff_elems, 2));
+  EXPECT_EQ(kEpidBadArgErr, NewFfElements(this->fq, nullptr, 2));
+  EXPECT_EQ(kEpidBadArgErr, NewFfElements(this->fq, ff_elems, 0));
+}
+
+TEST_F(FfElementTest, NewElementsCreatesIndependentZeroElements) {
+  FfElement* ff_elems[3] = {nullptr, nullptr, nullptr};
+  THROW_ON_EPIDERR(NewFfElements(this->fq, ff_elems, 3));
+  FqElemStr ff_elem_str[3];
+  EpidStatus sts = ReadFfElement(this->fq, &this->fq_2_str,
+                                 sizeof(this->fq_2_str), ff_elems[1]);
+  for (size_t i = 0; kEpidNoErr == sts && i < 3; i++) {
+    sts = WriteFfElement(this->fq, ff_elems[i], &ff_elem_str[i],
+                         sizeof(ff_elem_str[i]));
+  }
+  DeleteFfElements(ff_elems, 3);
+  THROW_ON_EPIDERR(sts);
+
+  FqElemStr fq_zero_str = {0};
+  EXPECT_EQ(fq_zero_str, ff_elem_str[0]);
+  EXPECT_EQ(this->fq_2_str, ff_elem_str[1]);
+  EXPECT_EQ(fq_zero_str, ff_elem_str[2]);
+}
+
+TEST_F(FfElementTest, DeleteElementsNullsPointers) {
+  FfElement* ff_elems[2] = {nullptr, nullptr};
+  THROW_ON_EPIDERR(NewFfElements(this->fq, ff_elems, 2));
+  DeleteFfElements(ff_elems, 2);
+  EXPECT_EQ(nullptr, ff_elems[0]);
+  EXPECT_EQ(nullptr, ff_elems[1]);
+}
+
+TEST_F(FfElementTest, DeleteElementsWorksGivenNullPointer) {
+  EXPECT_NO_THROW(DeleteFfElements(nullptr, 2));
+}
+
 ////////////////////////////////////////////////
 // ReadFfElement
 
@@ -2028,6 +2070,45 @@ TEST_F(FfElementTest, FfInvSucceedsGivenAnElement) {
   EXPECT_EQ(this->fq_inv_a_str, fq_r_str);
 }
 
+////////////////////////////////////////////////
+// FfInvBatch
+
+TEST_F(FfElementTest, FfInvBatchFailsGivenNullPointer) {
+  FfElement const* a[] = {this->fq_a, this->fq_b};
+  FfElement const* a_withnull[] = {this->fq_a, nullptr};
+  FfElementObj r0(&this->fq);
+  FfElementObj r1(&this->fq);
+  FfElement* r[] = {r0, r1};
+  EXPECT_EQ(kEpidBadArgErr, FfInvBatch(nullptr, a, 2, r));
+  EXPECT_EQ(kEpidBadArgErr, FfInvBatch(this->fq, nullptr, 2, r));
+  EXPECT_EQ(kEpidBadArgErr, FfInvBatch(this->fq, a_withnull, 2, r));
+  EXPECT_EQ(kEpidBadArgErr, FfInvBatch(this->fq, a, 2, nullptr));
+}
+
+TEST_F(FfElementTest, FfInvBatchFailsGivenElementZero) {
+  FfElement const* a[] = {this->fq_a, this->fq_0};
+  FfElementObj r0(&this->fq);
+  FfElementObj r1(&this->fq);
+  FfElement* r[] = {r0, r1};
+  EXPECT_EQ(kEpidDivByZeroErr, FfInvBatch(this->fq, a, 2, r));
+}
+
+TEST_F(FfElementTest, FfInvBatchGivesSameResultsAsFfInv) {
+  FfElement const* a[] = {this->fq_a, this->fq_1, this->fq_b};
+  FfElementObj r0(&this->fq);
+  FfElementObj r1(&this->fq);
+  FfElementObj r2(&this->fq);
+  FfElement* r[] = {r0, r1, r2};
+  FfElementObj expected(&this->fq);
+
+  EXPECT_EQ(kEpidNoErr, FfInvBatch(this->fq, a, 3, r));
+  THROW_ON_EPIDERR(FfInv(this->fq, this->fq_a, expected));
+  EXPECT_EQ(expected, r0);
+  EXPECT_EQ(this->fq_1, r1);
+  THROW_ON_EPIDERR(FfInv(this->fq, this->fq_b, expected));
+  EXPECT_EQ(expected, r2);
+}
+
 ////////////////////////////////////////////////
 // FfExp
 
@@ -2110,6 +2191,52 @@ TEST_F(FfElementTest, FfExpSucceedsGivenAnElement) {
   EXPECT_EQ(this->fq12_mul_gb_str, fq12_r_str);
 }
 
+////////////////////////////////////////////////
+// FfExpBatch
+
+TEST_F(FfElementTest, FfExpBatchFailsGivenNullPointer) {
+  FfElement const* a[] = {this->fq_a};
+  BigNum const* b[] = {this->bn_a};
+  FfElement* r[] = {this->fq_result};
+  EXPECT_EQ(kEpidBadArgErr, FfExpBatch(nullptr, a, b, 1, nullptr, r));
+  EXPECT_EQ(kEpidBadArgErr, FfExpBatch(this->fq, nullptr, b, 1, nullptr, r));
+  EXPECT_EQ(kEpidBadArgErr, FfExpBatch(this->fq, a, nullptr, 1, nullptr, r));
+  EXPECT_EQ(kEpidBadArgErr, FfExpBatch(this->fq, a, b, 1, nullptr, nullptr));
+}
+
+TEST_F(FfElementTest, FfExpBatchFailsGivenTooSmallScratch) {
+  FfElement const* a[] = {this->fq_a};
+  BigNum const* b[] = {this->bn_a};
+  FfElement* r[] = {this->fq_result};
+  FfExpScratch* scratch = nullptr;
+  THROW_ON_EPIDERR(NewFfExpScratch(this->fq, 1, &scratch));
+  EXPECT_EQ(kEpidBadArgErr, FfExpBatch(this->fq, a, b, 1, scratch, r));
+  DeleteFfExpScratch(&scratch);
+}
+
+TEST_F(FfElementTest, FfExpBatchGivesSameResultsAsFfExp) {
+  FfElement const* a[] = {this->fq_a, this->fq_1, this->fq_b};
+  BigNum const* b[] = {this->bn_a, this->bn_a, this->bn_1};
+  FfElementObj r0(&this->fq);
+  FfElementObj r1(&this->fq);
+  FfElementObj r2(&this->fq);
+  FfElement* r[] = {r0, r1, r2};
+  FqElemStr fq_r_str;
+  FfExpScratch* scratch = nullptr;
+  THROW_ON_EPIDERR(
+      NewFfExpScratch(this->fq, sizeof(BigNumStr) * CHAR_BIT, &scratch));
+
+  // with reused scratch memory and with scratch memory of the call
+  for (FfExpScratch* s : {scratch, static_cast<FfExpScratch*>(nullptr)}) {
+    EXPECT_EQ(kEpidNoErr, FfExpBatch(this->fq, a, b, 3, s, r));
+    THROW_ON_EPIDERR(WriteFfElement(this->fq, r0, &fq_r_str, sizeof(fq_r_str)));
+    EXPECT_EQ(this->fq_exp_ab_str, fq_r_str);
+    EXPECT_EQ(this->fq_1, r1);
+    EXPECT_EQ(this->fq_b, r2);
+  }
+  DeleteFfExpScratch(&scratch);
+}
+
 ////////////////////////////////////////////////
 // FfHash
 
@@ -2185,6 +2312,126 @@ TEST_F(FfElementTest, FfHashWorksGivenSHA512HashAlg) {
       << "FfHash: Hash element does not match to reference value";
 }
 
+////////////////////////////////////////////////
+// FfHashInit / FfHashUpdate / FfHashFinal
+
+TEST_F(FfElementTest, FfHashStreamFailsGivenNullPointer) {
+  FfHashState* state = nullptr;
+  uint8_t msg[1] = {0};
+  THROW_ON_EPIDERR(NewFfHashState(&state));
+  EXPECT_EQ(kEpidBadArgErr, NewFfHashState(nullptr));
+  EXPECT_EQ(kEpidBadArgErr, FfHashInit(kSha256, nullptr));
+  THROW_ON_EPIDERR(FfHashInit(kSha256, state));
+  EXPECT_EQ(kEpidBadArgErr, FfHashUpdate(nullptr, msg, sizeof(msg)));
+  EXPECT_EQ(kEpidBadArgErr, FfHashUpdate(state, nullptr, sizeof(msg)));
+  EXPECT_EQ(kEpidBadArgErr, FfHashFinal(nullptr, state, this->fq_result));
+  EXPECT_EQ(kEpidBadArgErr, FfHashFinal(this->fq, nullptr, this->fq_result));
+  EXPECT_EQ(kEpidBadArgErr, FfHashFinal(this->fq, state, nullptr));
+  DeleteFfHashState(&state);
+}
+
+TEST_F(FfElementTest, FfHashStreamFailsGivenUnsupportedHashAlg) {
+  FfHashState* state = nullptr;
+  THROW_ON_EPIDERR(NewFfHashState(&state));
+  EXPECT_EQ(kEpidHashAlgorithmNotSupported, FfHashInit(kSha512_256, state));
+  EXPECT_EQ(kEpidHashAlgorithmNotSupported, FfHashInit(kSha3_256, state));
+  EXPECT_EQ(kEpidHashAlgorithmNotSupported, FfHashInit(kSha3_384, state));
+  EXPECT_EQ(kEpidHashAlgorithmNotSupported, FfHashInit(kSha3_512, state));
+  DeleteFfHashState(&state);
+}
+
+TEST_F(FfElementTest, FfHashFinalFailsWithoutInit) {
+  FfHashState* state = nullptr;
+  THROW_ON_EPIDERR(NewFfHashState(&state));
+  EXPECT_EQ(kEpidBadArgErr, FfHashFinal(this->fq, state, this->fq_result));
+  DeleteFfHashState(&state);
+}
+
+TEST_F(FfElementTest, FfHashFinalFailsGivenEmptyMessage) {
+  FfHashState* state = nullptr;
+  THROW_ON_EPIDERR(NewFfHashState(&state));
+  THROW_ON_EPIDERR(FfHashInit(kSha256, state));
+  EXPECT_EQ(kEpidBadArgErr, FfHashFinal(this->fq, state, this->fq_result));
+  THROW_ON_EPIDERR(FfHashUpdate(state, nullptr, 0));
+  EXPECT_EQ(kEpidBadArgErr, FfHashFinal(this->fq, state, this->fq_result));
+  DeleteFfHashState(&state);
+}
+
+TEST_F(FfElementTest, FfHashFinalCanBeFollowedByNewMessage) {
+  FfHashState* state = nullptr;
+  FqElemStr fq_r_str;
+  uint8_t msg[] = {'x', 'y', 'z'};
+  THROW_ON_EPIDERR(NewFfHashState(&state));
+  THROW_ON_EPIDERR(FfHashInit(kSha384, state));
+  THROW_ON_EPIDERR(FfHashUpdate(state, msg, sizeof(msg)));
+  THROW_ON_EPIDERR(FfHashFinal(this->fq, state, this->fq_result));
+  EXPECT_EQ(kEpidNoErr, FfHashUpdate(state, sha_msg, sizeof(sha_msg)));
+  EXPECT_EQ(kEpidNoErr, FfHashFinal(this->fq, state, this->fq_result));
+  THROW_ON_EPIDERR(
+      WriteFfElement(this->fq, this->fq_result, &fq_r_str, sizeof(fq_r_str)));
+  EXPECT_EQ(this->fq_abc_sha384_str, fq_r_str);
+  DeleteFfHashState(&state);
+}
+
+TEST_F(FfElementTest, FfHashStateCopyFailsGivenNullPointer) {
+  FfHashState* state = nullptr;
+  THROW_ON_EPIDERR(NewFfHashState(&state));
+  THROW_ON_EPIDERR(FfHashInit(kSha256, state));
+  EXPECT_EQ(kEpidBadArgErr, FfHashStateCopy(nullptr, state));
+  EXPECT_EQ(kEpidBadArgErr, FfHashStateCopy(state, nullptr));
+  DeleteFfHashState(&state);
+}
+
+TEST_F(FfElementTest, FfHashStateCopyContinuesFromSource) {
+  HashAlg const algs[] = {kSha256, kSha384, kSha512};
+  FqElemStr const* expected[] = {&this->fq_abc_sha256_str,
+                                 &this->fq_abc_sha384_str,
+                                 &this->fq_abc_sha512_str};
+  uint8_t other[] = {'x', 'y', 'z'};
+  FfHashState* state = nullptr;
+  FfHashState* copy = nullptr;
+  FqElemStr fq_r_str;
+  THROW_ON_EPIDERR(NewFfHashState(&state));
+  THROW_ON_EPIDERR(NewFfHashState(&copy));
+  for (size_t i = 0; i < sizeof(algs) / sizeof(algs[0]); i++) {
+    THROW_ON_EPIDERR(FfHashInit(algs[i], state));
+    THROW_ON_EPIDERR(FfHashUpdate(state, sha_msg, 1));
+    EXPECT_EQ(kEpidNoErr, FfHashStateCopy(state, copy));
+    // the source can absorb something else without affecting the copy
+    THROW_ON_EPIDERR(FfHashUpdate(state, other, sizeof(other)));
+    THROW_ON_EPIDERR(FfHashUpdate(copy, sha_msg + 1, sizeof(sha_msg) - 1));
+    EXPECT_EQ(kEpidNoErr, FfHashFinal(this->fq, copy, this->fq_result));
+    THROW_ON_EPIDERR(
+        WriteFfElement(this->fq, this->fq_result, &fq_r_str, sizeof(fq_r_str)));
+    EXPECT_EQ(*expected[i], fq_r_str);
+  }
+  DeleteFfHashState(&copy);
+  DeleteFfHashState(&state);
+}
+
+TEST_F(FfElementTest, FfHashStreamMatchesFfHashGivenSplitMessage) {
+  HashAlg const algs[] = {kSha256, kSha384, kSha512};
+  FqElemStr const* expected[] = {&this->fq_abc_sha256_str,
+                                 &this->fq_abc_sha384_str,
+                                 &this->fq_abc_sha512_str};
+  FfHashState* state = nullptr;
+  FqElemStr fq_r_str;
+  THROW_ON_EPIDERR(NewFfHashState(&state));
+  for (size_t i = 0; i < sizeof(algs) / sizeof(algs[0]); i++) {
+    EXPECT_EQ(kEpidNoErr, FfHashInit(algs[i], state));
+    EXPECT_EQ(kEpidNoErr, FfHashUpdate(state, sha_msg, 1));
+    EXPECT_EQ(kEpidNoErr, FfHashUpdate(state, nullptr, 0));
+    EXPECT_EQ(kEpidNoErr,
+              FfHashUpdate(state, sha_msg + 1, sizeof(sha_msg) - 1));
+    EXPECT_EQ(kEpidNoErr, FfHashFinal(this->fq, state, this->fq_result));
+    THROW_ON_EPIDERR(
+        WriteFfElement(this->fq, this->fq_result, &fq_r_str, sizeof(fq_r_str)));
+    EXPECT_EQ(*expected[i], fq_r_str)
+        << "FfHashFinal: Hash element does not match to reference value";
+  }
+  DeleteFfHashState(&state);
+}
+
 ////////////////////////////////////////////////
 // FfMultiExp
 
@@ -0,0 +1,77 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Math statistics unit tests.
+ */
+
+#include <cstring>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "epid/common/math/finitefield.h"
+#include "epid/common/math/stats.h"
+}
+
+namespace {
+
+/// Fq of the Intel(R) EPID 2.0 curve
+const BigNumStr q_str = {
+    {{0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFC, 0xF0, 0xCD, 0x46, 0xE5, 0xF2,
+      0x5E, 0xEE, 0x71, 0xA4, 0x9F, 0x0C, 0xDC, 0x65, 0xFB, 0x12, 0x98,
+      0x0A, 0x82, 0xD3, 0x29, 0x2D, 0xDB, 0xAE, 0xD3, 0x30, 0x13}}};
+
+TEST(MathStats, EveryOperationHasAName) {
+  for (int i = 0; i < kEpidMathStatCount; i++) {
+    EXPECT_NE(nullptr, EpidMathStatName((EpidMathStatId)i));
+  }
+  EXPECT_EQ(nullptr, EpidMathStatName(kEpidMathStatCount));
+}
+
+TEST(MathStats, ResetClearsStats) {
+  EpidMathStats stats;
+  EpidResetMathStats();
+  std::memset(&stats, 0xff, sizeof(stats));
+  EpidGetMathStats(&stats);
+  for (int i = 0; i < kEpidMathStatCount; i++) {
+    EXPECT_EQ(0u, stats.stat[i].count);
+    EXPECT_EQ(0u, stats.stat[i].cycles);
+  }
+}
+
+TEST(MathStats, CountsNewFfElementOnlyIfEnabled) {
+  FiniteField* ff = nullptr;
+  FfElement* elems[3] = {nullptr, nullptr, nullptr};
+  EpidMathStats stats;
+  ASSERT_EQ(kEpidNoErr, NewFiniteField(&q_str, &ff));
+  EpidResetMathStats();
+  EXPECT_EQ(kEpidNoErr, NewFfElement(ff, &elems[0]));
+  EXPECT_EQ(kEpidNoErr, NewFfElements(ff, &elems[1], 2));
+  EpidGetMathStats(&stats);
+  if (EpidMathStatsEnabled()) {
+    EXPECT_EQ(3u, stats.stat[kEpidMathStatNewFfElement].count);
+    EXPECT_LT(0u, stats.stat[kEpidMathStatAlloc].count);
+  } else {
+    EXPECT_EQ(0u, stats.stat[kEpidMathStatNewFfElement].count);
+    EXPECT_EQ(0u, stats.stat[kEpidMathStatAlloc].count);
+  }
+  DeleteFfElements(&elems[1], 2);
+  DeleteFfElement(&elems[0]);
+  DeleteFiniteField(&ff);
+}
+
+}  // namespace
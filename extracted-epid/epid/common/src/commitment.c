@@ -18,9 +18,8 @@
  * \file
  * \brief Commitment hash implementation.
  */
-#include <limits.h>
+#include <stddef.h>
 #include "epid/common/src/commitment.h"
-#include "epid/common/src/memory.h"
 
 EpidStatus SetKeySpecificCommitValues(GroupPubKey const* pub_key,
                                       CommitValues* values) {
@@ -62,61 +61,131 @@ EpidStatus SetCalculatedCommitValues(G1ElemStr const* B, G1ElemStr const* K,
   return kEpidNoErr;
 }
 
+/// Size of the group public key related part of CommitValues
+#define COMMIT_VALUES_PREFIX_SIZE (offsetof(CommitValues, B))
+
+/// Finish Fp.hash(t3 || m) from a state that has absorbed the prefix
+static EpidStatus FinishCommitmentHash(FfHashState* state,
+                                       CommitValues const* values,
+                                       FiniteField* Fp, void const* msg,
+                                       size_t msg_len, FfElement* c) {
+  EpidStatus sts;
+
+  FfElement* t3 = NULL;
+  FpElemStr t3_str;
+
+  do {
+    sts = NewFfElement(Fp, &t3);
+    if (kEpidNoErr != sts) break;
+
+    // compute t3 = Fp.hash(p || g1 || g2 || h1 ||
+    //  h2 || w || B || K || T || R1 || R2). p through w have already
+    //  been absorbed into state.
+    sts = FfHashUpdate(state, &values->B,
+                       sizeof(*values) - COMMIT_VALUES_PREFIX_SIZE);
+    if (kEpidNoErr != sts) break;
+    sts = FfHashFinal(Fp, state, t3);
+    if (kEpidNoErr != sts) break;
+    sts = WriteFfElement(Fp, t3, &t3_str, sizeof(t3_str));
+    if (kEpidNoErr != sts) break;
+
+    //   compute c = Fp.hash(t3 || m).
+    // t3 and m are fed to the hash one after the other so that m, which
+    // can be large, is never copied.
+    sts = FfHashUpdate(state, &t3_str, sizeof(t3_str));
+    if (kEpidNoErr != sts) break;
+    sts = FfHashUpdate(state, msg, msg_len);
+    if (kEpidNoErr != sts) break;
+    sts = FfHashFinal(Fp, state, c);
+    if (kEpidNoErr != sts) break;
+
+    sts = kEpidNoErr;
+  } while (0);
+
+  DeleteFfElement(&t3);
+
+  return sts;
+}
+
 EpidStatus CalculateCommitmentHash(CommitValues const* values, FiniteField* Fp,
                                    HashAlg hash_alg, void const* msg,
                                    size_t msg_len, FfElement* c) {
   EpidStatus sts;
 
-  FfElement* t3 = NULL;
-  size_t t3mconcat_size = sizeof(FpElemStr) + msg_len;
-  uint8_t* t3mconcat_buf = NULL;
+  FfHashState* hash_state = NULL;
 
   if (!values || !Fp || !c) return kEpidBadArgErr;
   if (!msg && (0 != msg_len)) {
     // if message is non-empty it must have both length and content
     return kEpidBadArgErr;
   }
-  if (SIZE_MAX - sizeof(FpElemStr) < msg_len) {
+
+  do {
+    sts = NewFfHashState(&hash_state);
+    if (kEpidNoErr != sts) break;
+
+    sts = FfHashInit(hash_alg, hash_state);
+    if (kEpidNoErr != sts) break;
+    sts = FfHashUpdate(hash_state, values, COMMIT_VALUES_PREFIX_SIZE);
+    if (kEpidNoErr != sts) break;
+
+    sts = FinishCommitmentHash(hash_state, values, Fp, msg, msg_len, c);
+    if (kEpidNoErr != sts) break;
+
+    sts = kEpidNoErr;
+  } while (0);
+
+  DeleteFfHashState(&hash_state);
+
+  return sts;
+}
+
+EpidStatus InitKeySpecificCommitHash(GroupPubKey const* pub_key,
+                                     HashAlg hash_alg, FfHashState* state) {
+  EpidStatus sts;
+  CommitValues values;
+
+  if (!pub_key || !state) return kEpidBadArgErr;
+
+  sts = SetKeySpecificCommitValues(pub_key, &values);
+  if (kEpidNoErr != sts) return sts;
+  sts = FfHashInit(hash_alg, state);
+  if (kEpidNoErr != sts) return sts;
+  sts = FfHashUpdate(state, &values, COMMIT_VALUES_PREFIX_SIZE);
+  if (kEpidNoErr != sts) return sts;
+
+  return kEpidNoErr;
+}
+
+EpidStatus CalculateCommitmentHashFromPrefix(FfHashState const* prefix,
+                                             CommitValues const* values,
+                                             FiniteField* Fp, void const* msg,
+                                             size_t msg_len, FfElement* c) {
+  EpidStatus sts;
+
+  FfHashState* hash_state = NULL;
+
+  if (!prefix || !values || !Fp || !c) return kEpidBadArgErr;
+  if (!msg && (0 != msg_len)) {
+    // if message is non-empty it must have both length and content
     return kEpidBadArgErr;
   }
 
   do {
-    sts = NewFfElement(Fp, &t3);
+    sts = NewFfHashState(&hash_state);
     if (kEpidNoErr != sts) break;
 
-    // compute t3 = Fp.hash(p || g1 || g2 || h1 ||
-    //  h2 || w || B || K || T || R1 || R2).
-    sts = FfHash(Fp, values, sizeof(*values), hash_alg, t3);
+    // continue from a copy so that prefix can be reused
+    sts = FfHashStateCopy(prefix, hash_state);
     if (kEpidNoErr != sts) break;
 
-    //   compute c = Fp.hash(t3 || m).
-    t3mconcat_buf = SAFE_ALLOC(t3mconcat_size);
-    if (!t3mconcat_buf) {
-      sts = kEpidMemAllocErr;
-      break;
-    }
-
-    // get t3 into buffer
-    sts = WriteFfElement(Fp, t3, t3mconcat_buf, sizeof(FpElemStr));
-    if (kEpidNoErr != sts) break;
-    // get m into buffer
-    if (msg) {
-      // Memory copy is used to copy a message of variable length
-      if (0 != memcpy_S(t3mconcat_buf + sizeof(FpElemStr),
-                        t3mconcat_size - sizeof(FpElemStr), msg, msg_len)) {
-        sts = kEpidBadArgErr;
-        break;
-      }
-    }
-
-    sts = FfHash(Fp, t3mconcat_buf, t3mconcat_size, hash_alg, c);
+    sts = FinishCommitmentHash(hash_state, values, Fp, msg, msg_len, c);
     if (kEpidNoErr != sts) break;
 
     sts = kEpidNoErr;
   } while (0);
 
-  SAFE_FREE(t3mconcat_buf);
-  DeleteFfElement(&t3);
+  DeleteFfHashState(&hash_state);
 
   return sts;
 }
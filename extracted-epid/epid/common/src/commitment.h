@@ -116,5 +116,58 @@ EpidStatus CalculateCommitmentHash(CommitValues const* values, FiniteField* Fp,
                                    HashAlg hash_alg, void const* msg,
                                    size_t msg_len, FfElement* c);
 
+/// Absorb the group public key related commit values into a hash state
+/*!
+  Initializes state and absorbs p || g1 || g2 || h1 || h2 || w, the part
+  of the commit values that is the same for every Sign and Verify with a
+  group. The result can be kept with the member or verifier context and
+  passed to CalculateCommitmentHashFromPrefix() so that this part is only
+  hashed once per group and hash algorithm.
+
+  \param[in] pub_key
+  Group public key
+  \param[in] hash_alg
+  Hash algorithm to use
+  \param[out] state
+  Hash state to initialize
+
+  \returns ::EpidStatus
+
+  \see CalculateCommitmentHashFromPrefix
+*/
+EpidStatus InitKeySpecificCommitHash(GroupPubKey const* pub_key,
+                                     HashAlg hash_alg, FfHashState* state);
+
+/// Calculate Fp.hash(t3 || m) continuing from a key-specific hash state
+/*!
+  Gives the same result as CalculateCommitmentHash() with the hash
+  algorithm and group public key of prefix, but only absorbs
+  B || K || T || R1 || R2 of values. prefix is not modified and can be
+  reused.
+
+  \param[in] prefix
+  Hash state from InitKeySpecificCommitHash()
+  \param[in] values
+  Commit values to hash. Only the fields set by
+  SetCalculatedCommitValues() are read.
+  \param[in] Fp
+  Finite field to perfom hash operation in
+  \param[in] msg
+  Message to hash
+  \param[in] msg_len
+  Size of msg buffer in bytes
+  \param[out] c
+  Result of calculation
+
+  \returns ::EpidStatus
+
+  \see InitKeySpecificCommitHash
+  \see SetCalculatedCommitValues
+*/
+EpidStatus CalculateCommitmentHashFromPrefix(FfHashState const* prefix,
+                                             CommitValues const* values,
+                                             FiniteField* Fp, void const* msg,
+                                             size_t msg_len, FfElement* c);
+
 /*! @} */
 #endif  // EPID_COMMON_SRC_COMMITMENT_H_
@@ -19,7 +19,34 @@
  * \brief Intel(R) EPID 2.0 constant parameters implementation.
  */
 #include "epid/common/src/epid2params.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else  // defined(_WIN32)
+#include <pthread.h>
+#endif  // defined(_WIN32)
 #include "epid/common/src/memory.h"
+#include "epid/common/math/src/ecgroup-internal.h"
+
+#if defined(_WIN32)
+/// Guards the shared Epid2Params and its reference count
+static SRWLOCK shared_params_lock = SRWLOCK_INIT;
+/// Locks shared_params_lock
+#define LOCK_SHARED_PARAMS() AcquireSRWLockExclusive(&shared_params_lock)
+/// Unlocks shared_params_lock
+#define UNLOCK_SHARED_PARAMS() ReleaseSRWLockExclusive(&shared_params_lock)
+#else  // defined(_WIN32)
+/// Guards the shared Epid2Params and its reference count
+static pthread_mutex_t shared_params_lock = PTHREAD_MUTEX_INITIALIZER;
+/// Locks shared_params_lock
+#define LOCK_SHARED_PARAMS() pthread_mutex_lock(&shared_params_lock)
+/// Unlocks shared_params_lock
+#define UNLOCK_SHARED_PARAMS() pthread_mutex_unlock(&shared_params_lock)
+#endif  // defined(_WIN32)
+
+/// Shared Epid2Params, NULL while no reference is held
+static Epid2Params_* shared_params = NULL;
+/// Number of references held to shared_params
+static size_t shared_params_refs = 0;
 
 /// create a new Finite Field Fp
 static EpidStatus NewFp(Epid2Params const* param, FiniteField** Fp);
@@ -63,6 +90,9 @@ EpidStatus CreateEpid2Params(Epid2Params_** params) {
   BigNumStr t_str = {0};
   Epid2Params params_str = {
 #include "epid/common/src/epid2params_ate.inc"
+  };
+  static const Fq2ElemStr frob[15] = {
+#include "epid/common/src/epid2params_frob.inc"
   };
   if (!params) {
     return kEpidBadArgErr;
@@ -137,8 +167,10 @@ EpidStatus CreateEpid2Params(Epid2Params_** params) {
     if (kEpidNoErr != result) {
       break;
     }
-    result = ReadEcPoint(internal_param->G1, &params_str.g1,
-                         sizeof(params_str.g1), internal_param->g1);
+    // g1 and g2 are compiled-in constants, skip the group membership
+    // checks (the G2 one costs a full multiplication by the order)
+    result = ReadEcPointUnchecked(internal_param->G1, &params_str.g1,
+                                  sizeof(params_str.g1), internal_param->g1);
     if (kEpidNoErr != result) {
       break;
     }
@@ -152,8 +184,8 @@ EpidStatus CreateEpid2Params(Epid2Params_** params) {
     if (kEpidNoErr != result) {
       break;
     }
-    result = ReadEcPoint(internal_param->G2, &params_str.g2,
-                         sizeof(params_str.g2), internal_param->g2);
+    result = ReadEcPointUnchecked(internal_param->G2, &params_str.g2,
+                                  sizeof(params_str.g2), internal_param->g2);
     if (kEpidNoErr != result) {
       break;
     }
@@ -161,9 +193,9 @@ EpidStatus CreateEpid2Params(Epid2Params_** params) {
     if (kEpidNoErr != result) {
       break;
     }
-    result = NewPairingState(internal_param->G1, internal_param->G2,
-                             internal_param->GT, &t_str, internal_param->neg,
-                             &internal_param->pairing_state);
+    result = NewPairingStateWithConstants(
+        internal_param->G1, internal_param->G2, internal_param->GT, &t_str,
+        internal_param->neg, frob, &internal_param->pairing_state);
     if (kEpidNoErr != result) {
       break;
     }
@@ -198,6 +230,10 @@ void DeleteEpid2Params(Epid2Params_** epid_params) {
   if (epid_params && *epid_params) {
     DeletePairingState(&(*epid_params)->pairing_state);
 
+    DeleteEcFixedBaseTable(&(*epid_params)->g1_table);
+    DeleteEcFixedBaseTable(&(*epid_params)->g2_table);
+    DeletePairingPrecomputedG2(&(*epid_params)->g2_lines);
+
     DeleteBigNum(&(*epid_params)->p);
     DeleteBigNum(&(*epid_params)->q);
     DeleteBigNum(&(*epid_params)->t);
@@ -218,6 +254,124 @@ void DeleteEpid2Params(Epid2Params_** epid_params) {
   }
 }
 
+EpidStatus AcquireEpid2Params(Epid2Params_ const** params) {
+  EpidStatus result = kEpidNoErr;
+  if (!params) {
+    return kEpidBadArgErr;
+  }
+  LOCK_SHARED_PARAMS();
+  if (!shared_params) {
+    // the shared params outlive any allocation arena of this thread
+    size_t arena_depth = EpidArenaSuspend();
+    Epid2Params_* new_params = NULL;
+    EcFixedBaseTable const* table = NULL;
+    PairingPrecomputedG2 const* lines = NULL;
+    do {
+      result = CreateEpid2Params(&new_params);
+      if (kEpidNoErr != result) {
+        break;
+      }
+      // build everything that is otherwise built on first use now, so
+      // that the shared params are not modified after this point
+      result = Epid2ParamsGetG1Table(new_params, &table);
+      if (kEpidNoErr != result) {
+        break;
+      }
+      result = Epid2ParamsGetG2Table(new_params, &table);
+      if (kEpidNoErr != result) {
+        break;
+      }
+      result = Epid2ParamsGetG2Lines(new_params, &lines);
+      if (kEpidNoErr != result) {
+        break;
+      }
+      shared_params = new_params;
+      shared_params_refs = 0;
+    } while (0);
+    if (kEpidNoErr != result) {
+      DeleteEpid2Params(&new_params);
+    }
+    EpidArenaResume(arena_depth);
+  }
+  if (kEpidNoErr == result) {
+    shared_params_refs++;
+    *params = shared_params;
+  }
+  UNLOCK_SHARED_PARAMS();
+  return result;
+}
+
+void ReleaseEpid2Params(Epid2Params_ const** params) {
+  if (!params || !*params) {
+    return;
+  }
+  LOCK_SHARED_PARAMS();
+  if (*params == shared_params && shared_params_refs > 0) {
+    if (0 == --shared_params_refs) {
+      DeleteEpid2Params(&shared_params);
+    }
+  }
+  UNLOCK_SHARED_PARAMS();
+  *params = NULL;
+}
+
+EpidStatus Epid2ParamsGetG1Table(Epid2Params_* params,
+                                 EcFixedBaseTable const** table) {
+  if (!params || !table) {
+    return kEpidBadArgErr;
+  }
+  if (!params->g1_table) {
+    // the table is kept with the params, outside any allocation arena
+    size_t arena_depth = EpidArenaSuspend();
+    EpidStatus result =
+        NewEcFixedBaseTable(params->G1, params->g1, &params->g1_table);
+    EpidArenaResume(arena_depth);
+    if (kEpidNoErr != result) {
+      return result;
+    }
+  }
+  *table = params->g1_table;
+  return kEpidNoErr;
+}
+
+EpidStatus Epid2ParamsGetG2Table(Epid2Params_* params,
+                                 EcFixedBaseTable const** table) {
+  if (!params || !table) {
+    return kEpidBadArgErr;
+  }
+  if (!params->g2_table) {
+    // the table is kept with the params, outside any allocation arena
+    size_t arena_depth = EpidArenaSuspend();
+    EpidStatus result =
+        NewEcFixedBaseTable(params->G2, params->g2, &params->g2_table);
+    EpidArenaResume(arena_depth);
+    if (kEpidNoErr != result) {
+      return result;
+    }
+  }
+  *table = params->g2_table;
+  return kEpidNoErr;
+}
+
+EpidStatus Epid2ParamsGetG2Lines(Epid2Params_* params,
+                                 PairingPrecomputedG2 const** lines) {
+  if (!params || !lines) {
+    return kEpidBadArgErr;
+  }
+  if (!params->g2_lines) {
+    // the lines are kept with the params, outside any allocation arena
+    size_t arena_depth = EpidArenaSuspend();
+    EpidStatus result = NewPairingPrecomputedG2(
+        params->pairing_state, params->g2, &params->g2_lines);
+    EpidArenaResume(arena_depth);
+    if (kEpidNoErr != result) {
+      return result;
+    }
+  }
+  *lines = params->g2_lines;
+  return kEpidNoErr;
+}
+
 static EpidStatus NewFp(Epid2Params const* param, FiniteField** Fp) {
   EpidStatus result = kEpidErr;
   if (!param || !Fp) {
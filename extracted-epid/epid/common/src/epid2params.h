@@ -47,6 +47,10 @@ typedef struct Epid2Params_ {
   EcGroup* G2;  ///< Elliptic curve group over finite field Fq2
 
   PairingState* pairing_state;  ///< Pairing state
+
+  EcFixedBaseTable* g1_table;      ///< Table of g1, NULL until first used
+  EcFixedBaseTable* g2_table;      ///< Table of g2, NULL until first used
+  PairingPrecomputedG2* g2_lines;  ///< Lines of g2, NULL until first used
 } Epid2Params_;
 
 /// Constructs the internal representation of Epid2Params
@@ -71,5 +75,85 @@ EpidStatus CreateEpid2Params(Epid2Params_** params);
   \see CreateEpid2Params
 */
 void DeleteEpid2Params(Epid2Params_** epid_params);
+
+/// Gets a reference to the shared internal representation of Epid2Params
+/*!
+  The first call creates the shared Epid2Params, including the
+  fixed-base tables and the precomputed pairing lines of the generators;
+  later calls return the same instance until the last reference is
+  released with ReleaseEpid2Params(). Safe to call from several threads.
+
+  The shared params are never modified after creation, so several
+  threads can hold references and read or serialize their members at
+  once. Arithmetic on the fields, groups and pairing state uses scratch
+  memory kept in those objects, so such operations on the shared params
+  must not run concurrently; threads that compute in parallel need to
+  serialize their use of it or create their own with CreateEpid2Params().
+
+  \param[out] params
+  Shared internal Epid2Params
+
+  \returns ::EpidStatus
+  \see ReleaseEpid2Params
+*/
+EpidStatus AcquireEpid2Params(Epid2Params_ const** params);
+/// Releases a reference to the shared Epid2Params
+/*!
+  Frees the shared Epid2Params when the last reference is released.
+  Nulls the pointer.
+
+  \param[in,out] params
+  Reference obtained with AcquireEpid2Params. Can be NULL.
+
+  \see AcquireEpid2Params
+*/
+void ReleaseEpid2Params(Epid2Params_ const** params);
+
+/// Gets the fixed-base exponentiation table of the G1 generator
+/*!
+  The table is built on first use and kept until the params are deleted.
+  Not thread safe while the table is being built.
+
+  \param[in,out] params
+  Internal Epid2Params
+  \param[out] table
+  Table of g1 for use with EcExpFixedBase on G1
+
+  \returns ::EpidStatus
+  \see EcExpFixedBase
+*/
+EpidStatus Epid2ParamsGetG1Table(Epid2Params_* params,
+                                 EcFixedBaseTable const** table);
+/// Gets the fixed-base exponentiation table of the G2 generator
+/*!
+  The table is built on first use and kept until the params are deleted.
+  Not thread safe while the table is being built.
+
+  \param[in,out] params
+  Internal Epid2Params
+  \param[out] table
+  Table of g2 for use with EcExpFixedBase on G2
+
+  \returns ::EpidStatus
+  \see EcExpFixedBase
+*/
+EpidStatus Epid2ParamsGetG2Table(Epid2Params_* params,
+                                 EcFixedBaseTable const** table);
+/// Gets the precomputed pairing line functions of the G2 generator
+/*!
+  The lines are computed on first use and kept until the params are
+  deleted. Not thread safe while the lines are being computed.
+
+  \param[in,out] params
+  Internal Epid2Params
+  \param[out] lines
+  Line functions of g2 for use with PairingWithPrecomp and the params
+  pairing state
+
+  \returns ::EpidStatus
+  \see PairingWithPrecomp
+*/
+EpidStatus Epid2ParamsGetG2Lines(Epid2Params_* params,
+                                 PairingPrecomputedG2 const** lines);
 /*! @} */
 #endif  // EPID_COMMON_SRC_EPID2PARAMS_H_
@@ -23,6 +23,13 @@
 
 #include <string.h>
 #include <stdint.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else  // defined(_WIN32)
+#include <pthread.h>
+#endif  // defined(_WIN32)
+
+#include "epid/common/math/src/stats-internal.h"
 
 /// Maximum size of the destination buffer
 #ifndef RSIZE_MAX
@@ -34,6 +41,11 @@
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif  // MIN
 
+#ifndef MAX
+/// Evaluate to maximum of two values
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif  // MAX
+
 /// Copies count of character from dest to src
 /*!  \note Implementation follows C11 memcpy_s but with checks always enabled
  */
@@ -54,45 +66,294 @@ int memcpy_S(void* dest, size_t destsz, void const* src, size_t count) {
 
 void EpidZeroMemory(void* ptr, size_t size) { memset(ptr, 0, size); }
 
-#if defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
-
 #if !defined(EPID_ALLOC_ALIGN)
 /// Alignment constant for EpidAlloc, must be a power of two
 #define EPID_ALLOC_ALIGN sizeof(size_t)
 #endif  // !defined(EPID_ALLOC_ALIGN)
 
+/// Granularity of the size classes of the allocation pools
+#define EPID_POOL_GRANULARITY 16
+/// Number of size classes, larger blocks are not pooled
+#define EPID_POOL_NUM_CLASSES 32
+/// Maximum number of free blocks kept per size class and thread
+#define EPID_POOL_MAX_BLOCKS 64
+/// Minimum number of bytes requested from the backend for an arena chunk
+#define EPID_ARENA_CHUNK_SIZE (64 * 1024)
+
+#if !defined(EPID_THREAD_LOCAL)
+#if defined(_MSC_VER)
+/// Storage class of per thread allocator state
+#define EPID_THREAD_LOCAL __declspec(thread)
+#else  // defined(_MSC_VER)
+/// Storage class of per thread allocator state
+#define EPID_THREAD_LOCAL __thread
+#endif  // defined(_MSC_VER)
+#endif  // !defined(EPID_THREAD_LOCAL)
+
+/// Memory block was allocated from the allocator backend
+#define EPID_ALLOC_FROM_BACKEND ((size_t)0)
+/// Memory block was allocated from an arena
+#define EPID_ALLOC_FROM_ARENA ((size_t)1)
+/// Memory block was allocated from the pool of size class source - this
+#define EPID_ALLOC_FROM_POOL ((size_t)2)
+
 #pragma pack(1)
 /// Allocated memory block information
 typedef struct EpidAllocHeader {
-  size_t length;  ///< number of bytes memory block is allocated for
-  void* ptr;      ///< pointer to whole memory block including EpidAllocHeader
+  size_t length;      ///< number of bytes memory block is allocated for
+  void* ptr;          ///< pointer to whole memory block including header
+  size_t source;      ///< where the memory block was allocated from
+  size_t generation;  ///< arena generation of a block from an arena
 } EpidAllocHeader;
 #pragma pack()
 
-#endif  // defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
+/// Bytes needed in addition to the requested size for a memory block
+#define EPID_ALLOC_OVERHEAD (EPID_ALLOC_ALIGN - 1 + sizeof(EpidAllocHeader))
+
+/// Free blocks of one size class
+typedef struct EpidPoolClass {
+  void* head;    ///< first free block, blocks are linked by their first bytes
+  size_t count;  ///< number of free blocks
+} EpidPoolClass;
+
+/// Region of memory arena blocks are carved from
+typedef struct EpidArenaChunk {
+  struct EpidArenaChunk* next;  ///< previously filled chunk
+  size_t size;                  ///< number of bytes after the chunk header
+  size_t used;                  ///< number of bytes handed out
+} EpidArenaChunk;
+
+/// Allocation arena of a thread
+typedef struct EpidArena {
+  EpidArenaChunk* chunks;  ///< chunk currently allocated from
+  size_t depth;            ///< number of EpidArenaBegin not yet ended
+  size_t generation;       ///< number of times the arena was released
+} EpidArena;
+
+/// Default allocator backend memory allocation
+static void* DefaultAlloc(size_t size, void* ctx) {
+  (void)ctx;
+  return calloc(1, size);
+}
+
+/// Default allocator backend memory release
+static void DefaultFree(void* ptr, void* ctx) {
+  (void)ctx;
+  free(ptr);
+}
+
+/// Allocator backend
+static EpidAllocator epid_allocator = {DefaultAlloc, DefaultFree, NULL};
+
+/// Free blocks of the calling thread
+static EPID_THREAD_LOCAL EpidPoolClass epid_pool[EPID_POOL_NUM_CLASSES];
+
+/// Arena of the calling thread
+static EPID_THREAD_LOCAL EpidArena epid_arena;
+
+/// Whether the pool of the calling thread is released when it exits
+static EPID_THREAD_LOCAL int epid_pool_registered;
+
+#if defined(_WIN32)
+/// Fiber local storage slot whose callback releases the pool of a thread
+static DWORD epid_pool_fls = FLS_OUT_OF_INDEXES;
+/// Guards the creation of epid_pool_fls
+static INIT_ONCE epid_pool_fls_once = INIT_ONCE_STATIC_INIT;
+
+/// Releases the pool of an exiting thread
+static void WINAPI ReleasePoolAtThreadExit(void* value) {
+  (void)value;
+  epid_pool_registered = 0;
+  EpidReleaseThreadCache();
+}
+
+/// Creates epid_pool_fls
+static BOOL CALLBACK CreatePoolFls(INIT_ONCE* once, void* param,
+                                   void** context) {
+  (void)once;
+  (void)param;
+  (void)context;
+  epid_pool_fls = FlsAlloc(ReleasePoolAtThreadExit);
+  return TRUE;
+}
+
+/// Makes sure the pool of the calling thread is released when it exits
+static void RegisterPool(void) {
+  if (epid_pool_registered) return;
+  InitOnceExecuteOnce(&epid_pool_fls_once, CreatePoolFls, NULL, NULL);
+  if (FLS_OUT_OF_INDEXES != epid_pool_fls &&
+      FlsSetValue(epid_pool_fls, (void*)1)) {
+    epid_pool_registered = 1;
+  }
+}
+#else  // defined(_WIN32)
+/// Key whose destructor releases the pool of a thread
+static pthread_key_t epid_pool_key;
+/// Whether epid_pool_key was created
+static int epid_pool_key_valid;
+/// Guards the creation of epid_pool_key
+static pthread_once_t epid_pool_key_once = PTHREAD_ONCE_INIT;
+
+/// Releases the pool of an exiting thread
+static void ReleasePoolAtThreadExit(void* value) {
+  (void)value;
+  // blocks pooled by later destructors register the pool again
+  epid_pool_registered = 0;
+  EpidReleaseThreadCache();
+}
+
+/// Creates epid_pool_key
+static void CreatePoolKey(void) {
+  epid_pool_key_valid =
+      (0 == pthread_key_create(&epid_pool_key, ReleasePoolAtThreadExit));
+}
+
+/// Makes sure the pool of the calling thread is released when it exits
+static void RegisterPool(void) {
+  if (epid_pool_registered) return;
+  pthread_once(&epid_pool_key_once, CreatePoolKey);
+  // the destructor only runs for threads with a non NULL value
+  if (epid_pool_key_valid &&
+      0 == pthread_setspecific(epid_pool_key, (void*)1)) {
+    epid_pool_registered = 1;
+  }
+}
+#endif  // defined(_WIN32)
+
+/// Places the header and an aligned block of size bytes in raw memory
+static void* PlaceBlock(void* ptr, size_t size, size_t source) {
+  void* aligned_pointer = (void*)(((uintptr_t)ptr + EPID_ALLOC_ALIGN +
+                                   sizeof(EpidAllocHeader) - 1) &
+                                  (~(EPID_ALLOC_ALIGN - 1)));
+  ((EpidAllocHeader*)aligned_pointer)[-1].length = size;
+  ((EpidAllocHeader*)aligned_pointer)[-1].ptr = ptr;
+  ((EpidAllocHeader*)aligned_pointer)[-1].source = source;
+  ((EpidAllocHeader*)aligned_pointer)[-1].generation = epid_arena.generation;
+  return aligned_pointer;
+}
+
+/// Allocates a block of size bytes from the arena of the calling thread
+static void* ArenaAlloc(size_t size) {
+  EpidArenaChunk* chunk = epid_arena.chunks;
+  void* block = NULL;
+  if (!chunk || chunk->size - chunk->used < size + EPID_ALLOC_OVERHEAD) {
+    size_t chunk_size = MAX(size + EPID_ALLOC_OVERHEAD, EPID_ARENA_CHUNK_SIZE);
+    if (chunk_size > SIZE_MAX - sizeof(EpidArenaChunk)) return NULL;
+    chunk = (EpidArenaChunk*)epid_allocator.alloc(
+        sizeof(EpidArenaChunk) + chunk_size, epid_allocator.ctx);
+    if (!chunk) return NULL;
+    chunk->next = epid_arena.chunks;
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    epid_arena.chunks = chunk;
+  }
+  block = PlaceBlock((uint8_t*)(chunk + 1) + chunk->used, size,
+                     EPID_ALLOC_FROM_ARENA);
+  chunk->used = (size_t)((uint8_t*)block + size - (uint8_t*)(chunk + 1));
+  return block;
+}
+
+/// Checks whether ptr was carved from a chunk of the calling thread's arena
+static int InArena(void const* ptr) {
+  EpidArenaChunk const* chunk = NULL;
+  for (chunk = epid_arena.chunks; chunk; chunk = chunk->next) {
+    uint8_t const* start = (uint8_t const*)(chunk + 1);
+    if ((uint8_t const*)ptr > start &&
+        (uint8_t const*)ptr < start + chunk->used) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/// Allocates a block of size bytes from pool of size class cls
+static void* PoolAlloc(size_t size, size_t cls) {
+  EpidPoolClass* pool = &epid_pool[cls];
+  void* block = pool->head;
+  void* ptr = NULL;
+  if (block) {
+    // unlink the block and restore its first bytes to zero
+    memcpy(&pool->head, block, sizeof(void*));
+    memset(block, 0, sizeof(void*));
+    pool->count--;
+    ((EpidAllocHeader*)block)[-1].length = size;
+    return block;
+  }
+  ptr = epid_allocator.alloc(
+      (cls + 1) * EPID_POOL_GRANULARITY + EPID_ALLOC_OVERHEAD,
+      epid_allocator.ctx);
+  if (!ptr) return NULL;
+  return PlaceBlock(ptr, size, EPID_ALLOC_FROM_POOL + cls);
+}
+
+void EpidSetAllocator(EpidAllocator const* allocator) {
+  if (allocator && allocator->alloc && allocator->free) {
+    epid_allocator = *allocator;
+  } else {
+    epid_allocator.alloc = DefaultAlloc;
+    epid_allocator.free = DefaultFree;
+    epid_allocator.ctx = NULL;
+  }
+}
+
+void EpidArenaBegin(void) { epid_arena.depth++; }
+
+void EpidArenaEnd(void) {
+  if (0 == epid_arena.depth) return;
+  if (0 != --epid_arena.depth) return;
+  while (epid_arena.chunks) {
+    EpidArenaChunk* chunk = epid_arena.chunks;
+    epid_arena.chunks = chunk->next;
+    EpidZeroMemory(chunk + 1, chunk->used);
+    epid_allocator.free(chunk, epid_allocator.ctx);
+  }
+  epid_arena.generation++;
+}
+
+size_t EpidArenaSuspend(void) {
+  size_t depth = epid_arena.depth;
+  epid_arena.depth = 0;
+  return depth;
+}
+
+void EpidArenaResume(size_t depth) { epid_arena.depth = depth; }
+
+void EpidReleaseThreadCache(void) {
+  size_t cls = 0;
+  for (cls = 0; cls < EPID_POOL_NUM_CLASSES; cls++) {
+    EpidPoolClass* pool = &epid_pool[cls];
+    while (pool->head) {
+      void* block = pool->head;
+      memcpy(&pool->head, block, sizeof(void*));
+      epid_allocator.free(((EpidAllocHeader*)block)[-1].ptr,
+                          epid_allocator.ctx);
+    }
+    pool->count = 0;
+  }
+}
 
 void* EpidAlloc(size_t size) {
-#if defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
   void* ptr = NULL;
+  EPID_MATH_STAT_COUNT(kEpidMathStatAlloc, 1);
   if (size <= 0) return NULL;
+  if (size > SIZE_MAX - EPID_ALLOC_OVERHEAD) return NULL;
+  if (epid_arena.depth > 0) {
+    return ArenaAlloc(size);
+  }
+#if defined(EPID_ENABLE_EPID_ALLOC_POOL)
+  if (size <= EPID_POOL_GRANULARITY * EPID_POOL_NUM_CLASSES) {
+    return PoolAlloc(size, (size - 1) / EPID_POOL_GRANULARITY);
+  }
+#endif  // defined(EPID_ENABLE_EPID_ALLOC_POOL)
   // Allocate memory enough to store size bytes and EpidAllocHeader
-  ptr = calloc(1, size + EPID_ALLOC_ALIGN - 1 + sizeof(EpidAllocHeader));
+  ptr = epid_allocator.alloc(size + EPID_ALLOC_OVERHEAD, epid_allocator.ctx);
   if (ptr) {
-    void* aligned_pointer = (void*)(((uintptr_t)ptr + EPID_ALLOC_ALIGN +
-                                     sizeof(EpidAllocHeader) - 1) &
-                                    (~(EPID_ALLOC_ALIGN - 1)));
-    ((EpidAllocHeader*)aligned_pointer)[-1].length = size;
-    ((EpidAllocHeader*)aligned_pointer)[-1].ptr = ptr;
-    return aligned_pointer;
+    return PlaceBlock(ptr, size, EPID_ALLOC_FROM_BACKEND);
   }
   return NULL;
-#else  // defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
-  return calloc(1, size);
-#endif  // defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
 }
 
 void* EpidRealloc(void* ptr, size_t new_size) {
-#if defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
   void* new_ptr = EpidAlloc(new_size);
   if (!new_ptr) return NULL;
   if (ptr) {
@@ -106,18 +367,37 @@ void* EpidRealloc(void* ptr, size_t new_size) {
     EpidFree(ptr);
   }
   return new_ptr;
-#else   // defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
-  return realloc(ptr, new_size);
-#endif  // defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
 }
 
 void EpidFree(void* ptr) {
-#if defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
-  if (ptr) {
-    EpidZeroMemory(ptr, ((EpidAllocHeader*)ptr)[-1].length);
-    free(((EpidAllocHeader*)ptr)[-1].ptr);
+  EpidAllocHeader* header = NULL;
+  if (!ptr) return;
+  header = &((EpidAllocHeader*)ptr)[-1];
+  if (EPID_ALLOC_FROM_ARENA == header->source) {
+    // arena memory is reclaimed by EpidArenaEnd. A block of an arena that
+    // has already been released, or of another thread's arena, must not
+    // be written to.
+    if (header->generation == epid_arena.generation && InArena(ptr)) {
+      EpidZeroMemory(ptr, header->length);
+    }
+    return;
   }
-#else   // defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
-  free(ptr);
+  if (header->source >= EPID_ALLOC_FROM_POOL) {
+    EpidPoolClass* pool = &epid_pool[header->source - EPID_ALLOC_FROM_POOL];
+    // pooled blocks are always wiped as EpidAlloc hands them out zeroed
+    EpidZeroMemory(ptr, header->length);
+    if (pool->count < EPID_POOL_MAX_BLOCKS) {
+      RegisterPool();
+      memcpy(ptr, &pool->head, sizeof(void*));
+      pool->head = ptr;
+      pool->count++;
+      return;
+    }
+    epid_allocator.free(header->ptr, epid_allocator.ctx);
+    return;
+  }
+#if defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
+  EpidZeroMemory(ptr, header->length);
 #endif  // defined(EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE)
+  epid_allocator.free(header->ptr, epid_allocator.ctx);
 }
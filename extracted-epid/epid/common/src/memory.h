@@ -29,6 +29,21 @@
 /// When enabled secrets are wiped out from the memory by EpidFree
 #define EPID_ENABLE_EPID_ZERO_MEMORY_ON_FREE
 
+#if !defined(EPID_DISABLE_EPID_ALLOC_POOL)
+/// When enabled small blocks freed by EpidFree are kept for reuse per thread
+#define EPID_ENABLE_EPID_ALLOC_POOL
+#endif  // !defined(EPID_DISABLE_EPID_ALLOC_POOL)
+
+/// Allocator backend used by EpidAlloc to obtain memory
+typedef struct EpidAllocator {
+  /// Allocates size bytes of zero initialized memory, like calloc
+  void* (*alloc)(size_t size, void* ctx);
+  /// Frees memory returned by alloc
+  void (*free)(void* ptr, void* ctx);
+  /// Context passed to alloc and free
+  void* ctx;
+} EpidAllocator;
+
 /// Clear information stored in block of memory pointer to by ptr
 /*!
 
@@ -80,6 +95,82 @@ void* EpidRealloc(void* ptr, size_t new_size);
  */
 void EpidFree(void* ptr);
 
+/// Replaces the allocator backend
+/*!
+  By default memory is obtained with calloc and released with free.
+
+  Blocks of up to 512 bytes are not returned to the backend when freed
+  but kept in per thread size class pools, up to 64 blocks per class,
+  and handed out again by EpidAlloc, unless the library is built with
+  EPID_DISABLE_EPID_ALLOC_POOL defined.
+
+  Must be called before any memory is allocated with EpidAlloc and while
+  no other thread uses the library.
+
+  \param[in] allocator
+  the new backend, or NULL to restore calloc and free
+
+  \see EpidReleaseThreadCache
+ */
+void EpidSetAllocator(EpidAllocator const* allocator);
+
+/// Returns the free blocks pooled by the calling thread to the backend
+/*!
+  Happens automatically when a thread that pooled blocks exits. Must be
+  called explicitly before the allocator backend is replaced, by every
+  thread that used the library.
+
+  \see EpidSetAllocator
+ */
+void EpidReleaseThreadCache(void);
+
+/// Starts an allocation arena on the calling thread
+/*!
+  Until the matching EpidArenaEnd, EpidAlloc on this thread carves memory
+  out of large chunks instead of allocating each block. EpidFree of such
+  a block only clears it, and does nothing once the arena has ended; the
+  chunks are cleared and released at once by EpidArenaEnd.
+
+  Intended to bracket a single operation, such as one sign or verify,
+  that creates and deletes many short lived objects. Every object
+  allocated inside the arena must be deleted, or never be used again,
+  before the arena ends. Memory that an object keeps beyond the current
+  call, such as the scratch a pairing state grows on demand or the tables
+  Epid2Params builds on first use, is allocated with the arena suspended.
+
+  Arenas can be nested; memory is released when the outermost ends.
+
+  \see EpidArenaEnd
+ */
+void EpidArenaBegin(void);
+
+/// Ends an allocation arena started with EpidArenaBegin
+/*!
+  \see EpidArenaBegin
+ */
+void EpidArenaEnd(void);
+
+/// Suspends the allocation arenas of the calling thread
+/*!
+  Until EpidArenaResume, EpidAlloc on this thread allocates as if no
+  arena was started. Used to create long lived objects from within an
+  arena. No arena may be started while suspended.
+
+  \returns the number of arenas suspended, to pass to EpidArenaResume
+
+  \see EpidArenaResume
+ */
+size_t EpidArenaSuspend(void);
+
+/// Resumes allocation arenas suspended with EpidArenaSuspend
+/*!
+  \param[in] depth
+  value returned by the matching EpidArenaSuspend
+
+  \see EpidArenaSuspend
+ */
+void EpidArenaResume(size_t depth);
+
 #if !defined(SAFE_ALLOC)
 /// Allocates zero initalized block of memory
 #define SAFE_ALLOC(size) EpidAlloc(size);
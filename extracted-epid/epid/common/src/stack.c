@@ -44,8 +44,11 @@ void* StackPushN(Stack* stack, size_t n, void* elements) {
     if (n > (SIZE_MAX / stack->element_size) - stack->top)
       return 0;  // integer overflow
     if (max_size_required > stack->max_size) {
+      // the buffer lives as long as the stack, outside any allocation arena
+      size_t arena_depth = EpidArenaSuspend();
       void* reallocated =
           SAFE_REALLOC(stack->buf, max_size_required * stack->element_size);
+      EpidArenaResume(arena_depth);
       if (!reallocated) return 0;
       stack->buf = reallocated;
       stack->max_size = max_size_required;
@@ -0,0 +1,377 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Memory allocation unit tests.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "epid/common/src/memory.h"
+}
+
+namespace {
+
+/// Allocator backend that counts calls and defers releasing memory
+/*!
+  Memory given back to the backend is only released when the test ends,
+  so that a test can check that nothing writes to it anymore. If reuse is
+  enabled the most recently freed block is handed out again when it is
+  large enough, as a real allocator would.
+*/
+class CountingBackend {
+ public:
+  static void* Alloc(size_t size, void* ctx) {
+    CountingBackend* backend = static_cast<CountingBackend*>(ctx);
+    std::lock_guard<std::mutex> lock(backend->mutex_);
+    void* ptr = nullptr;
+    backend->num_allocs_++;
+    if (backend->reuse_ && !backend->freed_.empty() &&
+        backend->sizes_[backend->freed_.back()] >= size) {
+      ptr = backend->freed_.back();
+      backend->freed_.pop_back();
+      memset(ptr, 0, size);
+      return ptr;
+    }
+    ptr = calloc(1, size);
+    if (ptr) backend->sizes_[ptr] = size;
+    return ptr;
+  }
+  static void Free(void* ptr, void* ctx) {
+    CountingBackend* backend = static_cast<CountingBackend*>(ctx);
+    std::lock_guard<std::mutex> lock(backend->mutex_);
+    backend->num_frees_++;
+    backend->freed_.push_back(ptr);
+  }
+  ~CountingBackend() {
+    for (auto const& block : sizes_) {
+      free(block.first);
+    }
+  }
+  void set_reuse(bool reuse) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reuse_ = reuse;
+  }
+  size_t num_allocs() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_allocs_;
+  }
+  size_t num_frees() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_frees_;
+  }
+
+ private:
+  std::mutex mutex_;
+  bool reuse_ = false;
+  size_t num_allocs_ = 0;
+  size_t num_frees_ = 0;
+  std::vector<void*> freed_;
+  std::map<void*, size_t> sizes_;
+};
+
+class MemoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    EpidReleaseThreadCache();
+    EpidAllocator allocator = {&CountingBackend::Alloc,
+                               &CountingBackend::Free, &backend};
+    EpidSetAllocator(&allocator);
+  }
+  void TearDown() override {
+    EpidReleaseThreadCache();
+    EpidSetAllocator(nullptr);
+  }
+  /// Checks that size bytes at ptr all have the value c
+  static bool IsFilledWith(void const* ptr, int c, size_t size) {
+    unsigned char const* bytes = static_cast<unsigned char const*>(ptr);
+    for (size_t i = 0; i < size; i++) {
+      if (c != bytes[i]) return false;
+    }
+    return true;
+  }
+  CountingBackend backend;
+};
+
+///////////////////////////////////////////////////////////////////////
+// EpidAlloc / EpidFree
+TEST_F(MemoryTest, AllocReturnsZeroedMemory) {
+  void* small = EpidAlloc(100);
+  void* large = EpidAlloc(1000);
+  ASSERT_NE(nullptr, small);
+  ASSERT_NE(nullptr, large);
+  EXPECT_TRUE(IsFilledWith(small, 0, 100));
+  EXPECT_TRUE(IsFilledWith(large, 0, 1000));
+  EpidFree(small);
+  EpidFree(large);
+}
+TEST_F(MemoryTest, AllocFailsGivenZeroSize) {
+  EXPECT_EQ(nullptr, EpidAlloc(0));
+}
+TEST_F(MemoryTest, OversizeBlocksBypassPool) {
+  void* ptr = EpidAlloc(513);
+  ASSERT_NE(nullptr, ptr);
+  EXPECT_EQ(1u, backend.num_allocs());
+  EpidFree(ptr);
+  EXPECT_EQ(1u, backend.num_frees());
+}
+#if defined(EPID_ENABLE_EPID_ALLOC_POOL)
+TEST_F(MemoryTest, PoolReusesBlockOfSameSizeClass) {
+  void* ptr = EpidAlloc(100);
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 0xa5, 100);
+  EpidFree(ptr);
+  EXPECT_EQ(0u, backend.num_frees());
+  void* reused = EpidAlloc(97);
+  EXPECT_EQ(ptr, reused);
+  EXPECT_EQ(1u, backend.num_allocs());
+  EXPECT_TRUE(IsFilledWith(reused, 0, 97));
+  EpidFree(reused);
+}
+TEST_F(MemoryTest, PoolDoesNotReuseBlockOfOtherSizeClass) {
+  void* ptr = EpidAlloc(16);
+  ASSERT_NE(nullptr, ptr);
+  EpidFree(ptr);
+  void* other = EpidAlloc(17);
+  ASSERT_NE(nullptr, other);
+  EXPECT_EQ(2u, backend.num_allocs());
+  EpidFree(other);
+}
+TEST_F(MemoryTest, PoolKeepsLargestPooledSize) {
+  void* ptr = EpidAlloc(512);
+  ASSERT_NE(nullptr, ptr);
+  EpidFree(ptr);
+  EXPECT_EQ(0u, backend.num_frees());
+}
+TEST_F(MemoryTest, PoolReturnsBlocksBeyondLimitToBackend) {
+  std::vector<void*> blocks(65);
+  for (void*& block : blocks) {
+    block = EpidAlloc(32);
+    ASSERT_NE(nullptr, block);
+  }
+  for (void* block : blocks) {
+    EpidFree(block);
+  }
+  EXPECT_EQ(1u, backend.num_frees());
+}
+TEST_F(MemoryTest, ReleaseThreadCacheReturnsPooledBlocks) {
+  void* a = EpidAlloc(32);
+  void* b = EpidAlloc(300);
+  EpidFree(a);
+  EpidFree(b);
+  EXPECT_EQ(0u, backend.num_frees());
+  EpidReleaseThreadCache();
+  EXPECT_EQ(2u, backend.num_frees());
+}
+#else   // defined(EPID_ENABLE_EPID_ALLOC_POOL)
+TEST_F(MemoryTest, FreeReturnsSmallBlocksToBackendWithoutPool) {
+  void* ptr = EpidAlloc(100);
+  ASSERT_NE(nullptr, ptr);
+  EpidFree(ptr);
+  EXPECT_EQ(1u, backend.num_frees());
+  void* other = EpidAlloc(100);
+  ASSERT_NE(nullptr, other);
+  EXPECT_EQ(2u, backend.num_allocs());
+  EpidFree(other);
+}
+#endif  // defined(EPID_ENABLE_EPID_ALLOC_POOL)
+TEST_F(MemoryTest, BlockFreedOnOtherThreadIsReturnedToBackend) {
+  void* ptr = EpidAlloc(64);
+  ASSERT_NE(nullptr, ptr);
+  // a pooled block ends up in the pool of the freeing thread, which is
+  // released when that thread exits
+  std::thread([ptr] { EpidFree(ptr); }).join();
+  EXPECT_EQ(1u, backend.num_frees());
+}
+
+///////////////////////////////////////////////////////////////////////
+// EpidArenaBegin / EpidArenaEnd
+TEST_F(MemoryTest, ArenaCarvesBlocksFromOneChunk) {
+  EpidArenaBegin();
+  for (int i = 0; i < 100; i++) {
+    void* ptr = EpidAlloc(64);
+    ASSERT_NE(nullptr, ptr);
+    EXPECT_TRUE(IsFilledWith(ptr, 0, 64));
+    memset(ptr, 0xa5, 64);
+    EpidFree(ptr);
+  }
+  EXPECT_EQ(1u, backend.num_allocs());
+  EXPECT_EQ(0u, backend.num_frees());
+  EpidArenaEnd();
+  EXPECT_EQ(1u, backend.num_frees());
+}
+TEST_F(MemoryTest, ArenaServesBlocksLargerThanChunk) {
+  EpidArenaBegin();
+  void* ptr = EpidAlloc(128 * 1024);
+  ASSERT_NE(nullptr, ptr);
+  EXPECT_TRUE(IsFilledWith(ptr, 0, 128 * 1024));
+  EpidArenaEnd();
+  EXPECT_EQ(backend.num_allocs(), backend.num_frees());
+}
+TEST_F(MemoryTest, ArenaEndWipesBlocks) {
+  EpidArenaBegin();
+  unsigned char* ptr = static_cast<unsigned char*>(EpidAlloc(64));
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 0xa5, 64);
+  EpidArenaEnd();
+  // the backend keeps the chunk alive until the test ends
+  EXPECT_TRUE(IsFilledWith(ptr, 0, 64));
+}
+TEST_F(MemoryTest, NestedArenasAreReleasedByOutermostEnd) {
+  EpidArenaBegin();
+  EpidArenaBegin();
+  void* inner = EpidAlloc(64);
+  ASSERT_NE(nullptr, inner);
+  EpidArenaEnd();
+  EXPECT_EQ(0u, backend.num_frees());
+  void* outer = EpidAlloc(64);
+  ASSERT_NE(nullptr, outer);
+  EXPECT_EQ(1u, backend.num_allocs());
+  EpidArenaEnd();
+  EXPECT_EQ(1u, backend.num_frees());
+}
+TEST_F(MemoryTest, ArenaEndWithoutBeginIsIgnored) {
+  EpidArenaEnd();
+  EpidArenaBegin();
+  void* ptr = EpidAlloc(64);
+  ASSERT_NE(nullptr, ptr);
+  EXPECT_EQ(1u, backend.num_allocs());
+  EpidArenaEnd();
+  EXPECT_EQ(1u, backend.num_frees());
+}
+TEST_F(MemoryTest, FreeOfBlockFromEndedArenaDoesNotWriteToIt) {
+  EpidArenaBegin();
+  unsigned char* ptr = static_cast<unsigned char*>(EpidAlloc(64));
+  ASSERT_NE(nullptr, ptr);
+  EpidArenaEnd();
+  EpidArenaBegin();
+  void* other = EpidAlloc(64);
+  ASSERT_NE(nullptr, other);
+  // stands for whatever reused the memory of the released chunk
+  memset(ptr, 0xa5, 64);
+  EpidFree(ptr);
+  EXPECT_TRUE(IsFilledWith(ptr, 0xa5, 64));
+  EpidArenaEnd();
+}
+TEST_F(MemoryTest, FreeOfBlockFromEndedArenaIgnoresReusedChunk) {
+  backend.set_reuse(true);
+  EpidArenaBegin();
+  unsigned char* first = static_cast<unsigned char*>(EpidAlloc(200));
+  unsigned char* stale = static_cast<unsigned char*>(EpidAlloc(64));
+  ASSERT_NE(nullptr, first);
+  ASSERT_NE(nullptr, stale);
+  ASSERT_LT(first, stale);
+  // everything from first up to stale, including the header of stale
+  std::vector<unsigned char> old(first, stale);
+  EpidArenaEnd();
+  EpidArenaBegin();
+  unsigned char* ptr = static_cast<unsigned char*>(EpidAlloc(1000));
+  ASSERT_EQ(first, ptr);
+  // the new block happens to hold the old header of stale
+  memcpy(ptr, old.data(), old.size());
+  memset(ptr + old.size(), 0xa5, 1000 - old.size());
+  EpidFree(stale);
+  EXPECT_TRUE(IsFilledWith(ptr + old.size(), 0xa5, 1000 - old.size()));
+  EpidArenaEnd();
+}
+TEST_F(MemoryTest, FreeOfArenaBlockOnOtherThreadDoesNotWriteToIt) {
+  EpidArenaBegin();
+  unsigned char* ptr = static_cast<unsigned char*>(EpidAlloc(64));
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 0xa5, 64);
+  std::thread([ptr] {
+    EpidArenaBegin();
+    EpidFree(ptr);
+    EpidArenaEnd();
+  }).join();
+  EXPECT_TRUE(IsFilledWith(ptr, 0xa5, 64));
+  EpidArenaEnd();
+}
+TEST_F(MemoryTest, SuspendedArenaDoesNotServeAllocations) {
+  EpidArenaBegin();
+  size_t depth = EpidArenaSuspend();
+  EXPECT_EQ(1u, depth);
+  void* ptr = EpidAlloc(1000);
+  ASSERT_NE(nullptr, ptr);
+  EpidArenaResume(depth);
+  EpidArenaEnd();
+  EXPECT_EQ(0u, backend.num_frees());
+  memset(ptr, 0xa5, 1000);
+  EpidFree(ptr);
+  EXPECT_EQ(1u, backend.num_frees());
+}
+
+///////////////////////////////////////////////////////////////////////
+// EpidRealloc
+TEST_F(MemoryTest, ReallocKeepsContentWhenGrowingOutOfPool) {
+  unsigned char* ptr = static_cast<unsigned char*>(EpidAlloc(100));
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 0xa5, 100);
+  unsigned char* grown = static_cast<unsigned char*>(EpidRealloc(ptr, 1000));
+  ASSERT_NE(nullptr, grown);
+  EXPECT_TRUE(IsFilledWith(grown, 0xa5, 100));
+  EXPECT_TRUE(IsFilledWith(grown + 100, 0, 900));
+  EpidFree(grown);
+}
+TEST_F(MemoryTest, ReallocKeepsContentWhenShrinkingIntoPool) {
+  unsigned char* ptr = static_cast<unsigned char*>(EpidAlloc(1000));
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 0xa5, 1000);
+  unsigned char* shrunk = static_cast<unsigned char*>(EpidRealloc(ptr, 50));
+  ASSERT_NE(nullptr, shrunk);
+  EXPECT_TRUE(IsFilledWith(shrunk, 0xa5, 50));
+  EpidFree(shrunk);
+}
+TEST_F(MemoryTest, ReallocMovesPooledBlockIntoArena) {
+  unsigned char* ptr = static_cast<unsigned char*>(EpidAlloc(100));
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 0xa5, 100);
+  EpidArenaBegin();
+  unsigned char* moved = static_cast<unsigned char*>(EpidRealloc(ptr, 200));
+  ASSERT_NE(nullptr, moved);
+  EXPECT_TRUE(IsFilledWith(moved, 0xa5, 100));
+  EXPECT_TRUE(IsFilledWith(moved + 100, 0, 100));
+  EXPECT_EQ(2u, backend.num_allocs());
+  EpidArenaEnd();
+  EpidReleaseThreadCache();
+  EXPECT_EQ(backend.num_allocs(), backend.num_frees());
+}
+TEST_F(MemoryTest, ReallocMovesArenaBlockOutOfSuspendedArena) {
+  EpidArenaBegin();
+  unsigned char* ptr = static_cast<unsigned char*>(EpidAlloc(100));
+  ASSERT_NE(nullptr, ptr);
+  memset(ptr, 0xa5, 100);
+  size_t depth = EpidArenaSuspend();
+  unsigned char* moved = static_cast<unsigned char*>(EpidRealloc(ptr, 1000));
+  EpidArenaResume(depth);
+  ASSERT_NE(nullptr, moved);
+  EpidArenaEnd();
+  // outlives the arena
+  EXPECT_TRUE(IsFilledWith(moved, 0xa5, 100));
+  EXPECT_TRUE(IsFilledWith(moved + 100, 0, 900));
+  EpidFree(moved);
+  EXPECT_EQ(backend.num_allocs(), backend.num_frees());
+}
+
+}  // namespace
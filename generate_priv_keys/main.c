@@ -1,7 +1,10 @@
 #include "generate_priv_key.h"
+#include "memberkeys.h"
 #include "prng.h"
 
+#include <dropt.h>
 #include <util/buffutil.h>
+#include <util/envutil.h>
 #include <epid/common/file_parser.h>
 #include "epid/common/src/epid2params.h"
 #include "epid/common/math/finitefield.h"
@@ -10,8 +13,13 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <time.h>
 
+#define PROGRAM_NAME "generate_priv_key"
 #define PUBKEYFILE_DEFAULT "pubkey.bin"
+#define MPRIVKEYSFILE_DEFAULT "mprivkeys.dat"
+#define THREADS_DEFAULT 1
+#define THREADS_MAX 256
 
 EpidStatus generate_group_key(GroupPubKey* gpk, IPrivKey* isk);
 
@@ -23,18 +31,153 @@ EpidStatus save_issuer_private_key_to_file(IPrivKey* isk);
 
 EpidStatus save_member_private_key_to_file(PrivKey* priv_key);
 
-int main()
+EpidStatus load_group_key(char const* gpk_file, char const* isk_file,
+                          GroupPubKey* gpk, IPrivKey* isk);
+
+int main(int argc, char* argv[])
 {
-    EpidStatus sts;
+    EpidStatus sts = kEpidNoErr;
 
     GroupPubKey pub_key = {0};
     IPrivKey issuer_priv_key = {0};
     PrivKey priv_key = {0};
 
+    // Number of member keys to issue into a packed key file
+    static unsigned int count = 0;
+    // Number of threads issuing member keys
+    static unsigned int num_threads = THREADS_DEFAULT;
+    // Packed member key file name
+    static char* mprivkeys_file = NULL;
+    // Existing group to issue member keys for
+    static char* pubkey_file = NULL;
+    static char* iprivkey_file = NULL;
+    static bool verbose = false;
+    static bool show_help = false;
+
+    dropt_option options[] = {
+        {'\0', "count",
+         "issue N member keys into one packed key file instead of writing "
+         "mprivkey.dat",
+         "N", dropt_handle_uint, &count},
+        {'\0', "threads",
+         "issue member keys using N threads (default: 1)", "N",
+         dropt_handle_uint, &num_threads},
+        {'\0', "mprivkeys",
+         "write packed member keys to FILE (default: " MPRIVKEYSFILE_DEFAULT
+         ")",
+         "FILE", dropt_handle_string, &mprivkeys_file},
+        {'\0', "gpubkey",
+         "issue member keys for the group public key in FILE instead of "
+         "creating a new group (requires --iprivkey)",
+         "FILE", dropt_handle_string, &pubkey_file},
+        {'\0', "iprivkey", "load issuer private key from FILE", "FILE",
+         dropt_handle_string, &iprivkey_file},
+        {'h', "help", "display this help and exit", NULL, dropt_handle_bool,
+         &show_help, dropt_attr_halt},
+        {'v', "verbose", "print status messages to stdout", NULL,
+         dropt_handle_bool, &verbose},
+
+        {0} /* Required sentinel value. */
+    };
+
+    dropt_context* dropt_ctx = NULL;
+
+    set_prog_name(PROGRAM_NAME);
     do {
-        sts = generate_group_key(&pub_key, &issuer_priv_key);
-        if (kEpidNoErr != sts) {
-            printf("Error generating group key: %s\n", EpidStatusToString(sts));
+        dropt_ctx = dropt_new_context(options);
+        if (!dropt_ctx) {
+            sts = kEpidErr;
+            break;
+        } else if (argc > 0) {
+            char** rest = dropt_parse(dropt_ctx, -1, &argv[1]);
+            if (dropt_get_error(dropt_ctx) != dropt_error_none) {
+                log_error(dropt_get_error_message(dropt_ctx));
+                if (dropt_error_invalid_option == dropt_get_error(dropt_ctx)) {
+                    fprintf(stderr, "Try '%s --help' for more information.\n",
+                            PROGRAM_NAME);
+                }
+                sts = kEpidErr;
+                break;
+            } else if (show_help) {
+                log_fmt(
+                    "Usage: %s [OPTION]...\n"
+                    "Create a group and issue member private keys\n"
+                    "\n"
+                    "Options:\n",
+                    PROGRAM_NAME);
+                dropt_print_help(stdout, dropt_ctx, NULL);
+                break;
+            } else if (*rest) {
+                log_error("invalid argument: %s", *rest);
+                fprintf(stderr, "Try '%s --help' for more information.\n",
+                        PROGRAM_NAME);
+                sts = kEpidErr;
+                break;
+            }
+        }
+        if (verbose) {
+            verbose = ToggleVerbosity();
+        }
+        if (0 == num_threads || num_threads > THREADS_MAX) {
+            log_error("number of threads must be between 1 and %d",
+                      THREADS_MAX);
+            sts = kEpidErr;
+            break;
+        }
+        if (!pubkey_file != !iprivkey_file) {
+            log_error("--gpubkey and --iprivkey must be given together");
+            sts = kEpidErr;
+            break;
+        }
+        if (!mprivkeys_file) {
+            mprivkeys_file = MPRIVKEYSFILE_DEFAULT;
+        }
+
+        if (pubkey_file) {
+            sts = load_group_key(pubkey_file, iprivkey_file, &pub_key,
+                                 &issuer_priv_key);
+            if (kEpidNoErr != sts) {
+                break;
+            }
+        } else {
+            sts = generate_group_key(&pub_key, &issuer_priv_key);
+            if (kEpidNoErr != sts) {
+                printf("Error generating group key: %s\n", EpidStatusToString(sts));
+                break;
+            }
+
+            sts = save_group_key_to_file(&pub_key);
+            if (kEpidNoErr != sts) {
+                printf("Error saving public key\n");
+                break;
+            }
+
+            sts = save_issuer_private_key_to_file(&issuer_priv_key);
+            if (kEpidNoErr != sts) {
+                printf("Error saving issuer's private key\n");
+                break;
+            }
+        }
+
+        if (count) {
+            struct timespec start = {0};
+            struct timespec end = {0};
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            sts = IssueMemberKeys(&pub_key, &issuer_priv_key, count,
+                                  num_threads, mprivkeys_file);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            if (kEpidNoErr != sts) {
+                printf("Error issuing member keys: %s\n", EpidStatusToString(sts));
+                break;
+            }
+            if (verbose) {
+                double elapsed_s = (double)(end.tv_sec - start.tv_sec) +
+                                   (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+                log_msg("issued %u member keys to %s in %.3f s (%.1f keys/s)",
+                        count, mprivkeys_file, elapsed_s,
+                        elapsed_s > 0 ? (double)count / elapsed_s : 0.0);
+            }
             break;
         }
 
@@ -44,18 +187,6 @@ int main()
             break;
         }
 
-        sts = save_group_key_to_file(&pub_key);
-        if (kEpidNoErr != sts) {
-            printf("Error saving public key\n");
-            break;
-        }
-
-        sts = save_issuer_private_key_to_file(&issuer_priv_key);
-        if (kEpidNoErr != sts) {
-            printf("Error saving issuer's private key\n");
-            break;
-        }
-
         sts = save_member_private_key_to_file(&priv_key);
         if (kEpidNoErr != sts) {
             printf("Error saving member's private key\n");
@@ -63,6 +194,8 @@ int main()
         }
     } while (0);
 
+    dropt_free_context(dropt_ctx);
+
     if (kEpidNoErr != sts) {
         return 1;
     } else {
@@ -70,6 +203,29 @@ int main()
     }
 }
 
+EpidStatus load_group_key(char const* gpk_file, char const* isk_file,
+                          GroupPubKey* gpk, IPrivKey* isk)
+{
+    if (sizeof(*gpk) != GetFileSize(gpk_file)) {
+        log_error("incorrect group public key size: %s", gpk_file);
+        return kEpidBadArgErr;
+    }
+    if (sizeof(*isk) != GetFileSize(isk_file)) {
+        log_error("incorrect issuer private key size: %s", isk_file);
+        return kEpidBadArgErr;
+    }
+    if (0 != ReadLoud(gpk_file, gpk, sizeof(*gpk)) ||
+        0 != ReadLoud(isk_file, isk, sizeof(*isk))) {
+        return kEpidErr;
+    }
+    if (0 != memcmp(&gpk->gid, &isk->gid, sizeof(gpk->gid))) {
+        log_error("group public key and issuer private key are for "
+                  "different groups");
+        return kEpidBadArgErr;
+    }
+    return kEpidNoErr;
+}
+
 EpidStatus generate_group_key(GroupPubKey* gpk, IPrivKey* isk)
 {
     // Create the public key, and get a new issuing_priv_key (i.e. gamma)
@@ -201,20 +357,7 @@ EpidStatus generate_new_private_key(GroupPubKey* gpk, IPrivKey* isk, PrivKey* pr
 {
     EpidStatus sts;
     void* prng = NULL;
-    Epid2Params_* params = NULL;
-    EcPoint* h1_pt = NULL;
-    FfElement* f_el = NULL;
-    BigNumStr f_str;
-    EcPoint* f_pt = NULL;
-    FfElement* x_el = NULL;
-    FfElement* gamma_el = NULL;
-    FfElement* sum_el = NULL;
-    FfElement* inv_el = NULL;
-    BigNumStr inv_str;
-    EcPoint* gf_pt = NULL;
-    EcPoint* a_pt = NULL;
-    static const BigNumStr one = {
-        {{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}}};
+    MemberKeyGen* gen = NULL;
 
     do {
         // Create an instance of our pseudo-rng
@@ -225,166 +368,24 @@ EpidStatus generate_new_private_key(GroupPubKey* gpk, IPrivKey* isk, PrivKey* pr
             break;
         }
 
-        // Get params (constants defined by Intel)
-        sts = CreateEpid2Params(&params);
-        if (kEpidNoErr != sts) {
-            printf("Error creating params: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        if (!params->Fp || !params->G1) {
-            printf("Error with Fp or G1\n");
-          sts = kEpidBadArgErr;
-          break;
-        }
-
-        // Get h1 from public key
-        sts = NewEcPoint(params->G1, &h1_pt);
+        sts = NewMemberKeyGen(gpk, isk, PrngGen, prng, &gen);
         if (kEpidNoErr != sts) {
-            printf("Error allocating h1: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = ReadEcPoint(params->G1, (uint8_t*)&gpk->h1, sizeof(gpk->h1), h1_pt);
-        if (kEpidNoErr != sts) {
-            printf("Error reading h1: %s\n", EpidStatusToString(sts));
+            printf("Error creating key generator: %s\n", EpidStatusToString(sts));
             break;
         }
 
-        // Choose random f <- F_p (member)
-        sts = NewFfElement(params->Fp, &f_el);
+        // private_key = (gid, A, x, f)
+        sts = MemberKeyGenNext(gen, priv_key);
         if (kEpidNoErr != sts) {
-            printf("Error allocating f: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = FfGetRandom(params->Fp, &one, PrngGen, prng, f_el);
-        if (kEpidNoErr != sts) {
-            printf("Error generating f: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = WriteFfElement(params->Fp, f_el, (uint8_t*)&f_str, sizeof(f_str));
-        if (kEpidNoErr != sts) {
-            printf("Error writing f: %s\n", EpidStatusToString(sts));
-            break;
-        }
-
-        // Compute F = G1.sscmExp(h1, f) (member)
-        sts = NewEcPoint(params->G1, &f_pt);
-        if (kEpidNoErr != sts) {
-            printf("Error allocating F: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = EcExp(params->G1, h1_pt, (BigNumStr const*)&f_str, f_pt);
-        if (kEpidNoErr != sts) {
-            printf("Error calculating F=h1^f: %s\n", EpidStatusToString(sts));
-            break;
-        }
-
-        // Choose random x <- F_p (issuer)
-        sts = NewFfElement(params->Fp, &x_el);
-        if (kEpidNoErr != sts) {
-            printf("Error allocating x: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = FfGetRandom(params->Fp, &one, PrngGen, prng, x_el);
-        if (kEpidNoErr != sts) {
-            printf("Error generating x: %s\n", EpidStatusToString(sts));
-            break;
-        }
-
-        // Calculate A = (g_1 * F)^(1/(x + gamma)) (issuer)
-        // 1) Calculate x + gamma
-        sts = NewFfElement(params->Fp, &gamma_el);
-        if (kEpidNoErr != sts) {
-            printf("Error allocating gamma: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = ReadFfElement(params->Fp, (uint8_t*)&isk->gamma, sizeof(isk->gamma), gamma_el);
-        if (kEpidNoErr != sts) {
-            printf("Error reading gamma: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = NewFfElement(params->Fp, &sum_el);
-        if (kEpidNoErr != sts) {
-            printf("Error allocating intermediate sum_el: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = FfAdd(params->Fp, x_el, gamma_el, sum_el);
-        if (kEpidNoErr != sts) {
-            printf("Error calculating gamma + x: %s\n", EpidStatusToString(sts));
-            break;
-        }
-
-        // 2) Calculate 1 / (x + gamma)
-        sts = NewFfElement(params->Fp, &inv_el);
-        if (kEpidNoErr != sts) {
-            printf("Error allocating intermediate inv_el: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = FfInv(params->Fp, sum_el, inv_el);
-        if (kEpidNoErr != sts) {
-            printf("Error calculating 1 / (gamma + x): %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = WriteFfElement(params->Fp, inv_el, (uint8_t*)&inv_str, sizeof(inv_str));
-        if (kEpidNoErr != sts) {
-            printf("Error writing 1/(x+gamma) to a temporary string: %s\n", EpidStatusToString(sts));
-            break;
-        }
-
-        // 3) Calculate g_1 * F
-        sts = NewEcPoint(params->G1, &gf_pt);
-        if (kEpidNoErr != sts) {
-            printf("Error allocating g_1*F: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = EcMul(params->G1, params->g1, f_pt, gf_pt);
-        if (kEpidNoErr != sts) {
-            printf("Error calculating g_1*F: %s\n", EpidStatusToString(sts));
-            break;
-        }
-
-        // 4) Calculate A = (g_1*F)^1/(x+gamma)
-        sts = NewEcPoint(params->G1, &a_pt);
-        if (kEpidNoErr != sts) {
-            printf("Error allocating A: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = EcExp(params->G1, gf_pt, (BigNumStr const*)&inv_str, a_pt);
-        if (kEpidNoErr != sts) {
-            printf("Error calculating A=(g_1*F)^1/(x+gamma): %s\n", EpidStatusToString(sts));
-            break;
-        }
-
-        // Set private_key = (gid, A, x, f)
-        memcpy(priv_key->gid.data, gpk->gid.data, 16);
-        sts = WriteEcPoint(params->G1, a_pt, (uint8_t*)&priv_key->A, sizeof(priv_key->A));
-        if (kEpidNoErr != sts) {
-            printf("Error writing A to private key: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = WriteFfElement(params->Fp, x_el, (uint8_t*)&priv_key->x, sizeof(priv_key->x));
-        if (kEpidNoErr != sts) {
-            printf("Error writing x to private key: %s\n", EpidStatusToString(sts));
-            break;
-        }
-        sts = WriteFfElement(params->Fp, f_el, (uint8_t*)&priv_key->f, sizeof(priv_key->f));
-        if (kEpidNoErr != sts) {
-            printf("Error writing f to private key: %s\n", EpidStatusToString(sts));
+            printf("Error generating private key: %s\n", EpidStatusToString(sts));
             break;
         }
 
         // TODO: (OPTIONAL) Verify pairing equality
     } while (0);
 
+    DeleteMemberKeyGen(&gen);
     PrngDelete(&prng);
-    DeleteEpid2Params(&params);
-    DeleteEcPoint(&h1_pt);
-    DeleteFfElement(&f_el);
-    DeleteEcPoint(&f_pt);
-    DeleteFfElement(&gamma_el);
-    DeleteFfElement(&sum_el);
-    DeleteFfElement(&inv_el);
-    DeleteEcPoint(&gf_pt);
-    DeleteEcPoint(&a_pt);
 
     return sts;
 }
@@ -0,0 +1,383 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Member private key issuance implementation.
+ */
+
+#include "memberkeys.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "epid/common/src/epid2params.h"
+#include "epid/common/math/finitefield.h"
+#include "epid/common/math/ecgroup.h"
+#include "prng.h"
+
+/// Number of keys a thread issues between claims on the shared cursor
+#define MEMBER_KEYS_PER_CLAIM 64
+
+/// Handle SDK Error with Break
+#define BREAK_ON_EPID_ERROR(ret) \
+  if (kEpidNoErr != (ret)) {     \
+    break;                       \
+  }
+
+struct MemberKeyGen {
+  Epid2Params_* params;  ///< Intel(R) EPID 2.0 parameters
+  BitSupplier rnd_func;  ///< random number generator
+  void* rnd_param;       ///< pass through context data for rnd_func
+  GroupId gid;           ///< group id
+  EcPoint* h1_pt;        ///< group public key value h1
+  FfElement* gamma_el;   ///< issuer private key value gamma
+  FfElement* f_el;       ///< scratch: member secret f
+  FfElement* x_el;       ///< scratch: issuer chosen x
+  FfElement* sum_el;     ///< scratch: x + gamma
+  FfElement* inv_el;     ///< scratch: 1 / (x + gamma)
+  EcPoint* f_pt;         ///< scratch: F = h1^f
+  EcPoint* gf_pt;        ///< scratch: g1 * F
+  EcPoint* a_pt;         ///< scratch: A = (g1 * F)^(1 / (x + gamma))
+};
+
+EpidStatus NewMemberKeyGen(GroupPubKey const* gpk, IPrivKey const* isk,
+                           BitSupplier rnd_func, void* rnd_param,
+                           MemberKeyGen** gen) {
+  EpidStatus sts = kEpidErr;
+  MemberKeyGen* new_gen = NULL;
+
+  if (!gpk || !isk || !rnd_func || !gen) {
+    return kEpidBadArgErr;
+  }
+  new_gen = calloc(1, sizeof(*new_gen));
+  if (!new_gen) {
+    return kEpidMemAllocErr;
+  }
+  do {
+    new_gen->rnd_func = rnd_func;
+    new_gen->rnd_param = rnd_param;
+    new_gen->gid = gpk->gid;
+
+    sts = CreateEpid2Params(&new_gen->params);
+    BREAK_ON_EPID_ERROR(sts);
+    if (!new_gen->params->Fp || !new_gen->params->G1) {
+      sts = kEpidBadArgErr;
+      break;
+    }
+    sts = NewEcPoint(new_gen->params->G1, &new_gen->h1_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = ReadEcPoint(new_gen->params->G1, (uint8_t const*)&gpk->h1,
+                      sizeof(gpk->h1), new_gen->h1_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewFfElement(new_gen->params->Fp, &new_gen->gamma_el);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = ReadFfElement(new_gen->params->Fp, (uint8_t const*)&isk->gamma,
+                        sizeof(isk->gamma), new_gen->gamma_el);
+    BREAK_ON_EPID_ERROR(sts);
+
+    sts = NewFfElement(new_gen->params->Fp, &new_gen->f_el);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewFfElement(new_gen->params->Fp, &new_gen->x_el);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewFfElement(new_gen->params->Fp, &new_gen->sum_el);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewFfElement(new_gen->params->Fp, &new_gen->inv_el);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewEcPoint(new_gen->params->G1, &new_gen->f_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewEcPoint(new_gen->params->G1, &new_gen->gf_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewEcPoint(new_gen->params->G1, &new_gen->a_pt);
+    BREAK_ON_EPID_ERROR(sts);
+
+    sts = kEpidNoErr;
+  } while (0);
+
+  if (kEpidNoErr != sts) {
+    DeleteMemberKeyGen(&new_gen);
+  }
+  *gen = new_gen;
+  return sts;
+}
+
+void DeleteMemberKeyGen(MemberKeyGen** gen) {
+  if (!gen || !*gen) {
+    return;
+  }
+  DeleteEcPoint(&(*gen)->a_pt);
+  DeleteEcPoint(&(*gen)->gf_pt);
+  DeleteEcPoint(&(*gen)->f_pt);
+  DeleteFfElement(&(*gen)->inv_el);
+  DeleteFfElement(&(*gen)->sum_el);
+  DeleteFfElement(&(*gen)->x_el);
+  DeleteFfElement(&(*gen)->f_el);
+  DeleteFfElement(&(*gen)->gamma_el);
+  DeleteEcPoint(&(*gen)->h1_pt);
+  DeleteEpid2Params(&(*gen)->params);
+  free(*gen);
+  *gen = NULL;
+}
+
+EpidStatus MemberKeyGenNext(MemberKeyGen* gen, PrivKey* priv_key) {
+  EpidStatus sts = kEpidErr;
+  static const BigNumStr one = {
+      {{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}}};
+  BigNumStr inv_str;
+
+  if (!gen || !priv_key) {
+    return kEpidBadArgErr;
+  }
+  do {
+    // Choose random f <- F_p (member)
+    sts = FfGetRandom(gen->params->Fp, &one, gen->rnd_func, gen->rnd_param,
+                      gen->f_el);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = WriteFfElement(gen->params->Fp, gen->f_el, (uint8_t*)&priv_key->f,
+                         sizeof(priv_key->f));
+    BREAK_ON_EPID_ERROR(sts);
+
+    // Compute F = G1.sscmExp(h1, f) (member)
+    sts = EcExp(gen->params->G1, gen->h1_pt, (BigNumStr const*)&priv_key->f,
+                gen->f_pt);
+    BREAK_ON_EPID_ERROR(sts);
+
+    // Choose random x <- F_p (issuer)
+    sts = FfGetRandom(gen->params->Fp, &one, gen->rnd_func, gen->rnd_param,
+                      gen->x_el);
+    BREAK_ON_EPID_ERROR(sts);
+
+    // Calculate A = (g_1 * F)^(1/(x + gamma)) (issuer)
+    sts = FfAdd(gen->params->Fp, gen->x_el, gen->gamma_el, gen->sum_el);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = FfInv(gen->params->Fp, gen->sum_el, gen->inv_el);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = WriteFfElement(gen->params->Fp, gen->inv_el, (uint8_t*)&inv_str,
+                         sizeof(inv_str));
+    BREAK_ON_EPID_ERROR(sts);
+    sts = EcMul(gen->params->G1, gen->params->g1, gen->f_pt, gen->gf_pt);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = EcExp(gen->params->G1, gen->gf_pt, (BigNumStr const*)&inv_str,
+                gen->a_pt);
+    BREAK_ON_EPID_ERROR(sts);
+
+    // Set private_key = (gid, A, x, f)
+    priv_key->gid = gen->gid;
+    sts = WriteEcPoint(gen->params->G1, gen->a_pt, (uint8_t*)&priv_key->A,
+                       sizeof(priv_key->A));
+    BREAK_ON_EPID_ERROR(sts);
+    sts = WriteFfElement(gen->params->Fp, gen->x_el, (uint8_t*)&priv_key->x,
+                         sizeof(priv_key->x));
+    BREAK_ON_EPID_ERROR(sts);
+
+    sts = kEpidNoErr;
+  } while (0);
+
+  memset(&inv_str, 0, sizeof(inv_str));
+  return sts;
+}
+
+/// State shared by the threads issuing keys into one file
+typedef struct IssueJob {
+  GroupPubKey const* gpk;  ///< group public key
+  IPrivKey const* isk;     ///< issuer private key
+  int fd;                  ///< member key file
+  uint64_t count;          ///< number of keys to issue
+  uint64_t next;           ///< index of next unclaimed key
+  EpidStatus sts;          ///< first error encountered
+  pthread_mutex_t lock;    ///< protects next and sts
+} IssueJob;
+
+/// Thread specific part of an issue job
+typedef struct IssueWorker {
+  IssueJob* job;                           ///< shared state
+  unsigned char seed[PRNG_MAX_SEED_SIZE];  ///< seed for this thread's PRNG
+} IssueWorker;
+
+/// Claim the next range of keys to issue, returning the number claimed
+static size_t ClaimKeys(IssueJob* job, uint64_t* first) {
+  size_t num_keys = 0;
+  pthread_mutex_lock(&job->lock);
+  if (kEpidNoErr == job->sts && job->next < job->count) {
+    num_keys = MEMBER_KEYS_PER_CLAIM;
+    if (job->count - job->next < num_keys) {
+      num_keys = (size_t)(job->count - job->next);
+    }
+    *first = job->next;
+    job->next += num_keys;
+  }
+  pthread_mutex_unlock(&job->lock);
+  return num_keys;
+}
+
+/// Record the first error of a job
+static void FailJob(IssueJob* job, EpidStatus sts) {
+  pthread_mutex_lock(&job->lock);
+  if (kEpidNoErr == job->sts) {
+    job->sts = sts;
+  }
+  pthread_mutex_unlock(&job->lock);
+}
+
+/// Issue keys until the job is done
+static void* IssueThread(void* arg) {
+  IssueWorker* worker = arg;
+  IssueJob* job = worker->job;
+  EpidStatus sts = kEpidErr;
+  void* prng = NULL;
+  MemberKeyGen* gen = NULL;
+  PrivKey keys[MEMBER_KEYS_PER_CLAIM];
+  uint64_t first = 0;
+  size_t num_keys = 0;
+
+  do {
+    sts = PrngCreateFromSeed(worker->seed, sizeof(worker->seed), &prng);
+    BREAK_ON_EPID_ERROR(sts);
+    sts = NewMemberKeyGen(job->gpk, job->isk, PrngGen, prng, &gen);
+    BREAK_ON_EPID_ERROR(sts);
+
+    while (0 != (num_keys = ClaimKeys(job, &first))) {
+      size_t i = 0;
+      size_t size = num_keys * sizeof(PrivKey);
+      off_t offset =
+          (off_t)(sizeof(MemberKeyFileHeader) + first * sizeof(PrivKey));
+      for (i = 0; i < num_keys; i++) {
+        sts = MemberKeyGenNext(gen, &keys[i]);
+        BREAK_ON_EPID_ERROR(sts);
+      }
+      BREAK_ON_EPID_ERROR(sts);
+      if ((ssize_t)size != pwrite(job->fd, keys, size, offset)) {
+        sts = kEpidErr;
+        break;
+      }
+    }
+  } while (0);
+
+  if (kEpidNoErr != sts) {
+    FailJob(job, sts);
+  }
+  memset(keys, 0, sizeof(keys));
+  memset(worker->seed, 0, sizeof(worker->seed));
+  DeleteMemberKeyGen(&gen);
+  PrngDelete(&prng);
+  return NULL;
+}
+
+EpidStatus IssueMemberKeys(GroupPubKey const* gpk, IPrivKey const* isk,
+                           uint64_t count, size_t num_threads,
+                           char const* filename) {
+  IssueJob job;
+  IssueWorker* workers = NULL;
+  pthread_t* threads = NULL;
+  size_t num_started = 0;
+  MemberKeyFileHeader header;
+  FILE* urandom = NULL;
+  size_t i = 0;
+
+  if (!gpk || !isk || !filename || 0 == num_threads) {
+    return kEpidBadArgErr;
+  }
+
+  memset(&job, 0, sizeof(job));
+  job.gpk = gpk;
+  job.isk = isk;
+  job.count = count;
+  job.sts = kEpidNoErr;
+  job.fd = -1;
+  pthread_mutex_init(&job.lock, NULL);
+
+  do {
+    workers = calloc(num_threads, sizeof(*workers));
+    threads = calloc(num_threads, sizeof(*threads));
+    if (!workers || !threads) {
+      job.sts = kEpidMemAllocErr;
+      break;
+    }
+
+    // every thread needs its own PRNG seed, or they issue the same keys
+    urandom = fopen("/dev/urandom", "rb");
+    if (!urandom) {
+      printf("Error opening /dev/urandom\n");
+      job.sts = kEpidErr;
+      break;
+    }
+    for (i = 0; i < num_threads; i++) {
+      workers[i].job = &job;
+      if (1 != fread(workers[i].seed, sizeof(workers[i].seed), 1, urandom)) {
+        printf("Error reading /dev/urandom\n");
+        job.sts = kEpidErr;
+        break;
+      }
+    }
+    if (kEpidNoErr != job.sts) {
+      break;
+    }
+
+    job.fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (job.fd < 0) {
+      printf("Error opening %s\n", filename);
+      job.sts = kEpidErr;
+      break;
+    }
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MEMBER_KEY_FILE_MAGIC, sizeof(MEMBER_KEY_FILE_MAGIC));
+    header.version = MEMBER_KEY_FILE_VERSION;
+    header.record_size = sizeof(PrivKey);
+    header.count = count;
+    if ((ssize_t)sizeof(header) != pwrite(job.fd, &header, sizeof(header), 0)) {
+      printf("Error writing %s\n", filename);
+      job.sts = kEpidErr;
+      break;
+    }
+
+    if (1 == num_threads) {
+      IssueThread(&workers[0]);
+      break;
+    }
+    for (num_started = 0; num_started < num_threads; num_started++) {
+      if (0 != pthread_create(&threads[num_started], NULL, IssueThread,
+                              &workers[num_started])) {
+        FailJob(&job, kEpidErr);
+        break;
+      }
+    }
+    for (i = 0; i < num_started; i++) {
+      pthread_join(threads[i], NULL);
+    }
+  } while (0);
+
+  if (job.fd >= 0) {
+    if (0 != close(job.fd) && kEpidNoErr == job.sts) {
+      job.sts = kEpidErr;
+    }
+    // do not leave a file with missing keys behind
+    if (kEpidNoErr != job.sts) {
+      unlink(filename);
+    }
+  }
+  if (urandom) fclose(urandom);
+  if (workers) {
+    memset(workers, 0, num_threads * sizeof(*workers));
+    free(workers);
+  }
+  free(threads);
+  pthread_mutex_destroy(&job.lock);
+  return job.sts;
+}
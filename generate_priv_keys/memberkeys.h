@@ -0,0 +1,110 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Member private key issuance interface.
+ */
+#ifndef EXAMPLE_GENERATE_PRIV_KEYS_SRC_MEMBERKEYS_H_
+#define EXAMPLE_GENERATE_PRIV_KEYS_SRC_MEMBERKEYS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "epid/common/bitsupplier.h"
+#include "epid/common/errors.h"
+#include "epid/common/types.h"
+
+/// Member key file magic number
+#define MEMBER_KEY_FILE_MAGIC "EPIDMPK"
+/// Member key file format version
+#define MEMBER_KEY_FILE_VERSION 1
+
+/// Header of a packed member key file
+/*!
+  The header is followed by count ::PrivKey records of record_size
+  bytes. The file is indexed by position: key i starts at byte offset
+  sizeof(MemberKeyFileHeader) + i * record_size.
+*/
+typedef struct MemberKeyFileHeader {
+  char magic[8];         ///< MEMBER_KEY_FILE_MAGIC
+  uint32_t version;      ///< MEMBER_KEY_FILE_VERSION
+  uint32_t record_size;  ///< size of PrivKey in bytes
+  uint64_t count;        ///< number of keys
+} MemberKeyFileHeader;
+
+/// Issues member private keys for one group
+/*!
+  Holds the group parameters, the parsed issuer key and the scratch
+  elements needed to issue a key, so that issuing many keys only pays for
+  the arithmetic. A generator must only be used by one thread at a time.
+*/
+typedef struct MemberKeyGen MemberKeyGen;
+
+/// Create a member key generator
+/*!
+  \param[in] gpk
+  The group public key.
+  \param[in] isk
+  The issuer private key of the group.
+  \param[in] rnd_func
+  Random number generator.
+  \param[in] rnd_param
+  Pass through context data for rnd_func. Must remain valid while the
+  generator is in use.
+  \param[out] gen
+  The new generator. Must be freed with DeleteMemberKeyGen.
+  \returns ::EpidStatus
+*/
+EpidStatus NewMemberKeyGen(GroupPubKey const* gpk, IPrivKey const* isk,
+                           BitSupplier rnd_func, void* rnd_param,
+                           MemberKeyGen** gen);
+
+/// Free a member key generator
+void DeleteMemberKeyGen(MemberKeyGen** gen);
+
+/// Issue a new member private key
+/*!
+  \param[in] gen
+  The generator.
+  \param[out] priv_key
+  The new member private key.
+  \returns ::EpidStatus
+*/
+EpidStatus MemberKeyGenNext(MemberKeyGen* gen, PrivKey* priv_key);
+
+/// Issue member private keys into a packed member key file
+/*!
+  Keys are issued by num_threads threads, each with its own generator,
+  and written straight to their place in the file.
+
+  \param[in] gpk
+  The group public key.
+  \param[in] isk
+  The issuer private key of the group.
+  \param[in] count
+  The number of keys to issue.
+  \param[in] num_threads
+  The number of threads to use.
+  \param[in] filename
+  The member key file to create.
+  \returns ::EpidStatus
+*/
+EpidStatus IssueMemberKeys(GroupPubKey const* gpk, IPrivKey const* isk,
+                           uint64_t count, size_t num_threads,
+                           char const* filename);
+
+#endif  // EXAMPLE_GENERATE_PRIV_KEYS_SRC_MEMBERKEYS_H_
@@ -25,6 +25,13 @@
 #include "prng.h"
 
 EpidStatus PrngCreate(void** prng) {
+  time_t seed_value;
+  time(&seed_value);
+  return PrngCreateFromSeed(&seed_value, sizeof(seed_value), prng);
+}
+
+EpidStatus PrngCreateFromSeed(void const* seed, size_t seed_size,
+                              void** prng) {
   // Security note:
   // Random number generator used in the samples not claimed to be a
   // cryptographically secure pseudo-random number generator.
@@ -33,13 +40,13 @@ EpidStatus PrngCreate(void** prng) {
   IppsPRNGState* prng_ctx = NULL;
   int seed_ctx_size = 0;
   IppsBigNumState* seed_ctx = NULL;
-  time_t seed_value;
 
-  if (!prng) return kEpidBadArgErr;
+  if (!prng || !seed || 0 == seed_size || seed_size > PRNG_MAX_SEED_SIZE)
+    return kEpidBadArgErr;
 
   if (ippStsNoErr != ippsPRNGGetSize(&prng_ctx_size)) return kEpidErr;
   if (ippStsNoErr !=
-      ippsBigNumGetSize((sizeof(seed_value) + 3) / 4, &seed_ctx_size))
+      ippsBigNumGetSize((int)(seed_size + 3) / 4, &seed_ctx_size))
     return kEpidErr;
 
   do {
@@ -49,7 +56,7 @@ EpidStatus PrngCreate(void** prng) {
       sts = kEpidNoMemErr;
       break;
     }
-    if (ippStsNoErr != ippsPRNGInit(sizeof(seed_value) * 8, prng_ctx)) {
+    if (ippStsNoErr != ippsPRNGInit((int)seed_size * 8, prng_ctx)) {
       sts = kEpidErr;
       break;
     }
@@ -60,13 +67,12 @@ EpidStatus PrngCreate(void** prng) {
       sts = kEpidNoMemErr;
       break;
     }
-    if (ippStsNoErr != ippsBigNumInit((sizeof(seed_value) + 3) / 4, seed_ctx)) {
+    if (ippStsNoErr != ippsBigNumInit((int)(seed_size + 3) / 4, seed_ctx)) {
       sts = kEpidErr;
       break;
     }
-    time(&seed_value);
     if (ippStsNoErr !=
-        ippsSetOctString_BN((void*)&seed_value, sizeof(seed_value), seed_ctx)) {
+        ippsSetOctString_BN((void*)seed, (int)seed_size, seed_ctx)) {
       sts = kEpidErr;
       break;
     }
@@ -22,11 +22,25 @@
 #ifndef EXAMPLE_SIGNMSG_SRC_PRNG_H_
 #define EXAMPLE_SIGNMSG_SRC_PRNG_H_
 
+#include <stddef.h>
+
 #include "epid/common/errors.h"
 
+/// Largest seed accepted by ::PrngCreateFromSeed() in bytes
+#define PRNG_MAX_SEED_SIZE 64
+
 /// Creates Pseudo Random Number Generator for ::PrngGen()
 EpidStatus PrngCreate(void** prng);
 
+/// Creates Pseudo Random Number Generator for ::PrngGen() from a seed
+/*!
+  Generators that must not produce the same sequence, such as those
+  created by concurrent threads, need distinct seeds; ::PrngCreate()
+  only seeds with the current time.
+*/
+EpidStatus PrngCreateFromSeed(void const* seed, size_t seed_size,
+                              void** prng);
+
 /// Delete object allocated with ::PrngCreate()
 void PrngDelete(void** prng);
 
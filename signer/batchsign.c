@@ -0,0 +1,148 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Batch signing implementation.
+ */
+
+#include "batchsign.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "util/buffutil.h"
+#include "util/envutil.h"
+
+/// Read a line of any length, stripping the line terminator
+/*!
+  \returns the line length, -1 at end of file, or -2 on allocation
+  failure
+*/
+static long ReadLine(FILE* fp, char** line, size_t* capacity) {
+  size_t len = 0;
+  int c = 0;
+  while (EOF != (c = fgetc(fp))) {
+    if (len + 1 >= *capacity) {
+      size_t new_capacity = *capacity ? 2 * *capacity : 256;
+      char* new_line = realloc(*line, new_capacity);
+      if (!new_line) {
+        return -2;
+      }
+      *line = new_line;
+      *capacity = new_capacity;
+    }
+    if ('\n' == c) {
+      break;
+    }
+    (*line)[len++] = (char)c;
+  }
+  if (EOF == c && 0 == len) {
+    return -1;
+  }
+  if (len > 0 && '\r' == (*line)[len - 1]) {
+    len--;
+  }
+  return (long)len;
+}
+
+/// Write a signature record
+static int WriteRecord(FILE* out, void const* sig, size_t sig_len) {
+  unsigned char len_str[4];
+  len_str[0] = (unsigned char)((sig_len >> 24) & 0xff);
+  len_str[1] = (unsigned char)((sig_len >> 16) & 0xff);
+  len_str[2] = (unsigned char)((sig_len >> 8) & 0xff);
+  len_str[3] = (unsigned char)(sig_len & 0xff);
+  if (sizeof(len_str) != fwrite(len_str, 1, sizeof(len_str), out)) {
+    return -1;
+  }
+  if (sig_len && sig_len != fwrite(sig, 1, sig_len, out)) {
+    return -1;
+  }
+  return 0;
+}
+
+EpidStatus SignBatch(FILE* in, FILE* out, MemberCtx* member,
+                     void const* basename, size_t basename_len,
+                     SigRl const* sig_rl, size_t sig_rl_size,
+                     size_t* num_signed, size_t* num_failed) {
+  EpidStatus result = kEpidErr;
+  EpidSignature* sig = NULL;
+  size_t sig_size = 0;
+  char* line = NULL;
+  size_t capacity = 0;
+  long len = 0;
+  int write_failed = 0;
+
+  if (!in || !out || !member || !num_signed || !num_failed) {
+    return kEpidBadArgErr;
+  }
+  *num_signed = 0;
+  *num_failed = 0;
+
+  // every signature has the same size, so one buffer serves the batch
+  sig_size = EpidGetSigSize(sig_rl);
+  sig = AllocBuffer(sig_size);
+  if (!sig) {
+    return kEpidMemAllocErr;
+  }
+
+  do {
+    while ((len = ReadLine(in, &line, &capacity)) >= 0) {
+      EpidStatus sts = EpidSign(member, line, (size_t)len, basename,
+                                basename_len, sig_rl, sig_rl_size, sig,
+                                sig_size);
+      (*num_signed)++;
+      if (kEpidNoErr != sts && kEpidSigRevokedInSigRl != sts) {
+        log_error("message %u: %s", (unsigned)*num_signed,
+                  EpidStatusToString(sts));
+        (*num_failed)++;
+        write_failed = WriteRecord(out, NULL, 0);
+        if (write_failed) {
+          break;
+        }
+        continue;
+      }
+      if (kEpidSigRevokedInSigRl == sts) {
+        log_error("message %u: signature revoked in SigRL",
+                  (unsigned)*num_signed);
+      }
+      write_failed = WriteRecord(out, sig, sig_size);
+      if (write_failed) {
+        break;
+      }
+    }
+    if (write_failed) {
+      log_error("failed to write signatures");
+      result = kEpidErr;
+      break;
+    }
+    if (-2 == len) {
+      result = kEpidMemAllocErr;
+      break;
+    }
+    if (ferror(in)) {
+      log_error("failed to read messages");
+      result = kEpidErr;
+      break;
+    }
+    result = kEpidNoErr;
+  } while (0);
+
+  free(line);
+  free(sig);
+  return result;
+}
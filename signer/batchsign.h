@@ -0,0 +1,73 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Batch signing interface.
+ */
+#ifndef EXAMPLE_SIGNMSG_SRC_BATCHSIGN_H_
+#define EXAMPLE_SIGNMSG_SRC_BATCHSIGN_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "epid/member/api.h"
+
+/// Sign every message read from a stream
+/*!
+  Messages are read one per line; the line terminator is not part of the
+  message, so an empty line is an empty message. Every message is signed
+  with the same member, which must already have basename registered if
+  basename_len is not 0.
+
+  For every message a record is written to out of the form
+
+      LENGTH SIGNATURE
+
+  where LENGTH is the signature size in bytes as a 4 byte big-endian
+  integer. A message that could not be signed gets a record with a LENGTH
+  of 0, so records always line up with input lines.
+
+  Logs an error message for every message that could not be signed.
+
+  \param[in] in
+  The stream to read messages from.
+  \param[in] out
+  The stream to write signature records to.
+  \param[in] member
+  The member to sign with.
+  \param[in] basename
+  The basename to sign with. Can be NULL if basename_len is 0.
+  \param[in] basename_len
+  The length of the basename in bytes.
+  \param[in] sig_rl
+  The signature based revocation list. Can be NULL.
+  \param[in] sig_rl_size
+  The size of sig_rl in bytes.
+  \param[out] num_signed
+  The number of messages read.
+  \param[out] num_failed
+  The number of messages that could not be signed.
+  \returns ::EpidStatus
+  kEpidNoErr if every message was processed, regardless of the individual
+  signing results.
+*/
+EpidStatus SignBatch(FILE* in, FILE* out, MemberCtx* member,
+                     void const* basename, size_t basename_len,
+                     SigRl const* sig_rl, size_t sig_rl_size,
+                     size_t* num_signed, size_t* num_failed);
+
+#endif  // EXAMPLE_SIGNMSG_SRC_BATCHSIGN_H_
@@ -24,12 +24,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <dropt.h>
 #include "util/buffutil.h"
 #include "util/convutil.h"
 #include "util/envutil.h"
 #include "util/stdtypes.h"
+#include "batchsign.h"
+#include "presigs.h"
 #include "signmsg.h"
 
 // Defaults
@@ -60,6 +63,66 @@ static dropt_error HandleHashalg(dropt_context* context,
   return err;
 }
 
+/// sign every message in a batch file with one member
+/*!
+  \returns 0 if every message was signed, non-zero otherwise
+*/
+static int SignBatchFile(char const* batch_file, char const* sig_file,
+                         MemberCtx* member, void const* basename,
+                         size_t basename_size, bool verbose) {
+  int ret_value = -1;
+  EpidStatus result = kEpidErr;
+  FILE* in = NULL;
+  FILE* out = NULL;
+  size_t num_signed = 0;
+  size_t num_failed = 0;
+  struct timespec start = {0};
+  struct timespec end = {0};
+
+  do {
+    in = (0 == strcmp(batch_file, "-")) ? stdin : fopen(batch_file, "rb");
+    if (!in) {
+      log_error("failed to open batch file %s", batch_file);
+      break;
+    }
+    out = (0 == strcmp(sig_file, "-")) ? stdout : fopen(sig_file, "wb");
+    if (!out) {
+      log_error("failed to open signature file %s", sig_file);
+      break;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    result = SignBatch(in, out, member, basename, basename_size, NULL, 0,
+                       &num_signed, &num_failed);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (kEpidNoErr != result) {
+      log_error("function SignBatch returned %s", EpidStatusToString(result));
+      break;
+    }
+    if (0 != fflush(out)) {
+      log_error("failed to write signature file %s", sig_file);
+      break;
+    }
+
+    if (verbose) {
+      double elapsed_us = (double)(end.tv_sec - start.tv_sec) * 1e6 +
+                          (double)(end.tv_nsec - start.tv_nsec) / 1e3;
+      log_msg("signed %u messages, %u failed", (unsigned)num_signed,
+              (unsigned)num_failed);
+      if (num_signed) {
+        log_msg("average time per signature: %.1f us",
+                elapsed_us / (double)num_signed);
+      }
+    }
+    ret_value = num_failed ? -1 : 0;
+  } while (0);
+
+  if (in && stdin != in) fclose(in);
+  if (out && stdout != out) fclose(out);
+
+  return ret_value;
+}
+
 /// Main entrypoint
 int main(int argc, char* argv[]) {
   // intermediate return value for C style functions
@@ -77,6 +140,9 @@ int main(int argc, char* argv[]) {
   static char* msg_str = NULL;
   size_t msg_size = 0;
 
+  // Batch message file name parameter
+  static char* batch_file = NULL;
+
   // Basename string parameter
   static char* basename_str = NULL;
   size_t basename_size = 0;
@@ -96,6 +162,12 @@ int main(int argc, char* argv[]) {
   // Member pre-computed settings output file name parameter
   static char* mprecmpo_file = NULL;
 
+  // Pre-computed signature pool file name parameter
+  static char* presigs_file = NULL;
+
+  // Number of pre-computed signatures to add parameter
+  static unsigned int num_add_presigs = 0;
+
   // // CA certificate file name parameter
   // static char* cacert_file = NULL;
 
@@ -135,11 +207,23 @@ int main(int argc, char* argv[]) {
   // Hash algorithm
   static HashAlg hashalg = kSha512;
 
+  // Pre-computed signature pool file, locked while open
+  PreSigFile* presigs = NULL;
+
+  // Member and its random number generator
+  MemberCtx* member = NULL;
+  void* prng = NULL;
+
   dropt_option options[] = {
       {'\0', "sig", "write signature to FILE (default: " SIG_DEFAULT ")",
        "FILE", dropt_handle_string, &sig_file},
       {'\0', "msg", "MESSAGE to sign", "MESSAGE", dropt_handle_string,
        &msg_str},
+      {'\0', "batch",
+       "sign every line of FILE (- for standard in) as a separate message, "
+       "writing length-prefixed signatures to the --sig FILE "
+       "(- for standard out)",
+       "FILE", dropt_handle_string, &batch_file},
       {'\0', "bsn", "BASENAME to sign with (default: random)", "BASENAME",
        dropt_handle_string, &basename_str},
 
@@ -156,6 +240,14 @@ int main(int argc, char* argv[]) {
        dropt_handle_string, &mprecmpi_file},
       {'\0', "mprecmpo", "write pre-computed member data to FILE", "FILE",
        dropt_handle_string, &mprecmpo_file},
+      {'\0', "presigs",
+       "load pre-computed signatures from FILE, saving the unused ones back "
+       "to it",
+       "FILE", dropt_handle_string, &presigs_file},
+      {'\0', "addpresigs",
+       "compute N more pre-computed signatures before signing; "
+       "without --msg or --batch only fills the pool",
+       "N", dropt_handle_uint, &num_add_presigs},
       // {'\0', "capubkey",
       //  "load IoT Issuing CA public key from FILE (default: " CACERT_DEFAULT ")",
       //  "FILE", dropt_handle_string, &cacert_file},
@@ -238,11 +330,14 @@ int main(int argc, char* argv[]) {
           log_msg("\nOption values:");
           log_msg(" sig_file      : %s", sig_file);
           log_msg(" msg_str       : %s", msg_str);
+          log_msg(" batch_file    : %s", batch_file);
           log_msg(" basename_str  : %s", basename_str);
           log_msg(" pubkey_file   : %s", pubkey_file);
           log_msg(" mprivkey_file : %s", mprivkey_file);
           log_msg(" mprecmpi_file : %s", mprecmpi_file);
           log_msg(" mprecmpo_file : %s", mprecmpo_file);
+          log_msg(" presigs_file  : %s", presigs_file);
+          log_msg(" addpresigs    : %u", num_add_presigs);
           log_msg(" hashalg       : %s", HashAlgToString(hashalg));
           // log_msg(" cacert_file   : %s", cacert_file);
           log_msg("");
@@ -360,18 +455,84 @@ int main(int argc, char* argv[]) {
       log_msg("==============================================");
     }
 
+    // Create member once for all messages
+    result = CreateMember(signed_pubkey, signed_pubkey_size, mprivkey,
+                          mprivkey_size, basename_str, basename_size, hashalg,
+                          &member_precmp, use_precmp_in, &cacert, &prng,
+                          &member);
+    if (kEpidNoErr != result) {
+      log_error("function CreateMember returned %s",
+                EpidStatusToString(result));
+      ret_value = EXIT_FAILURE;
+      break;
+    }
+
+    // Store Member pre-computed settings
+    if (mprecmpo_file) {
+      if (0 !=
+          WriteLoud(&member_precmp, sizeof(member_precmp), mprecmpo_file)) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+    }
+
+    // Pre-computed signature pool
+    if (presigs_file) {
+      size_t num_loaded = 0;
+      // held until the unused pre-computed signatures are saved back
+      presigs = OpenPreSigFile(presigs_file);
+      if (!presigs) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+      if (0 != LoadPreSigs(member, presigs, &num_loaded)) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+      if (verbose) {
+        log_msg("loaded %u pre-computed signatures", (unsigned)num_loaded);
+      }
+    }
+    if (num_add_presigs) {
+      result = EpidAddPreSigs(member, num_add_presigs, NULL);
+      if (kEpidNoErr != result) {
+        log_error("function EpidAddPreSigs returned %s",
+                  EpidStatusToString(result));
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+      if (verbose) {
+        log_msg("computed %u pre-computed signatures",
+                (unsigned)num_add_presigs);
+      }
+      if (!msg_str && !batch_file) {
+        // only filling the pool
+        ret_value = EXIT_SUCCESS;
+        break;
+      }
+    }
+
+    if (batch_file) {
+      if (0 != SignBatchFile(batch_file, sig_file, member, basename_str,
+                             basename_size, verbose)) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+      ret_value = EXIT_SUCCESS;
+      break;
+    }
+
     // Sign
-    result = SignMsg(msg_str, msg_size, basename_str, basename_size,
-                     signed_sig_rl, signed_sig_rl_size, signed_pubkey,
-                     signed_pubkey_size, mprivkey, mprivkey_size, hashalg,
-                     &member_precmp, use_precmp_in, &sig, &sig_size, &cacert);
+    result = SignWithMember(member, msg_str, msg_size, basename_str,
+                            basename_size, NULL, 0, &sig, &sig_size);
 
     // Report Result
     if (kEpidNoErr != result) {
       if (kEpidSigRevokedInSigRl == result) {
         log_error("signature revoked in SigRL");
       } else {
-        log_error("function SignMsg returned %s", EpidStatusToString(result));
+        log_error("function SignWithMember returned %s",
+                  EpidStatusToString(result));
         ret_value = EXIT_FAILURE;
         break;
       }
@@ -385,19 +546,22 @@ int main(int argc, char* argv[]) {
       }
     }
 
-    // Store Member pre-computed settings
-    if (mprecmpo_file) {
-      if (0 !=
-          WriteLoud(&member_precmp, sizeof(member_precmp), mprecmpo_file)) {
-        ret_value = EXIT_FAILURE;
-        break;
-      }
-    }
-
     // Success
     ret_value = EXIT_SUCCESS;
   } while (0);
 
+  // Keep unused pre-computed signatures for the next run
+  if (member && presigs) {
+    size_t num_saved = 0;
+    if (0 != SavePreSigs(member, presigs, &num_saved)) {
+      ret_value = EXIT_FAILURE;
+    } else if (verbose) {
+      log_msg("pre-computed signature pool depth: %u", (unsigned)num_saved);
+    }
+  }
+  ClosePreSigFile(&presigs);
+  DeleteMember(&member, &prng);
+
   // Free allocated buffers
   if (sig) free(sig);
   if (signed_sig_rl) free(signed_sig_rl);
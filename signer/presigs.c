@@ -0,0 +1,218 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Pre-computed signature pool file implementation.
+ */
+
+#include "presigs.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util/buffutil.h"
+#include "util/envutil.h"
+
+/// An open, exclusively locked pool file
+struct PreSigFile {
+  char* filename;  ///< pool file name, for messages
+  int fd;          ///< pool file
+};
+
+/// Read size bytes from the start of a file
+static int ReadAll(int fd, void* buf, size_t size) {
+  unsigned char* p = buf;
+  off_t offset = 0;
+  while (size > 0) {
+    ssize_t num_read = pread(fd, p, size, offset);
+    if (num_read <= 0) {
+      return -1;
+    }
+    p += num_read;
+    offset += num_read;
+    size -= (size_t)num_read;
+  }
+  return 0;
+}
+
+/// Replace the content of a file with size bytes
+static int WriteAll(int fd, void const* buf, size_t size) {
+  unsigned char const* p = buf;
+  off_t offset = 0;
+  if (0 != ftruncate(fd, 0)) {
+    return -1;
+  }
+  while (size > 0) {
+    ssize_t written = pwrite(fd, p, size, offset);
+    if (written <= 0) {
+      return -1;
+    }
+    p += written;
+    offset += written;
+    size -= (size_t)written;
+  }
+  return fsync(fd);
+}
+
+PreSigFile* OpenPreSigFile(char const* filename) {
+  PreSigFile* file = NULL;
+  if (!filename) {
+    return NULL;
+  }
+  file = calloc(1, sizeof(*file));
+  if (!file) {
+    log_error("failed to allocate memory");
+    return NULL;
+  }
+  file->filename = malloc(strlen(filename) + 1);
+  if (!file->filename) {
+    log_error("failed to allocate memory");
+    free(file);
+    return NULL;
+  }
+  strcpy(file->filename, filename);
+  // an existing file keeps its mode on open, so restrict it explicitly
+  file->fd = open(filename, O_RDWR | O_CREAT, 0600);
+  if (file->fd < 0 || 0 != fchmod(file->fd, 0600) ||
+      0 != flock(file->fd, LOCK_EX)) {
+    log_error("failed to open pre-computed signature file %s: %s", filename,
+              strerror(errno));
+    ClosePreSigFile(&file);
+    return NULL;
+  }
+  return file;
+}
+
+void ClosePreSigFile(PreSigFile** file) {
+  if (!file || !*file) {
+    return;
+  }
+  if ((*file)->fd >= 0) {
+    close((*file)->fd);
+  }
+  free((*file)->filename);
+  free(*file);
+  *file = NULL;
+}
+
+int LoadPreSigs(MemberCtx* member, PreSigFile* file, size_t* num_loaded) {
+  int ret_value = -1;
+  EpidStatus result = kEpidErr;
+  PreComputedSignature* presigs = NULL;
+  struct stat st;
+  size_t file_size = 0;
+  size_t num_presigs = 0;
+
+  if (!member || !file || !num_loaded) {
+    return -1;
+  }
+  *num_loaded = 0;
+  do {
+    if (0 != fstat(file->fd, &st)) {
+      log_error("failed to read pre-computed signature file %s",
+                file->filename);
+      break;
+    }
+    file_size = (size_t)st.st_size;
+    if (0 != file_size % sizeof(PreComputedSignature)) {
+      log_error("pre-computed signature file %s has an invalid size",
+                file->filename);
+      break;
+    }
+    num_presigs = file_size / sizeof(PreComputedSignature);
+    if (0 == num_presigs) {
+      ret_value = 0;
+      break;
+    }
+    presigs = AllocBuffer(file_size);
+    if (!presigs) {
+      break;
+    }
+    if (0 != ReadAll(file->fd, presigs, file_size)) {
+      log_error("failed to read pre-computed signature file %s",
+                file->filename);
+      break;
+    }
+    // consume the file before the pool can be used
+    if (0 != WriteAll(file->fd, NULL, 0)) {
+      log_error("failed to truncate pre-computed signature file %s",
+                file->filename);
+      break;
+    }
+    result = EpidAddPreSigs(member, num_presigs, presigs);
+    if (kEpidNoErr != result) {
+      log_error("function EpidAddPreSigs returned %s",
+                EpidStatusToString(result));
+      break;
+    }
+    *num_loaded = num_presigs;
+    ret_value = 0;
+  } while (0);
+
+  if (presigs) {
+    memset(presigs, 0, file_size);
+    free(presigs);
+  }
+  return ret_value;
+}
+
+int SavePreSigs(MemberCtx* member, PreSigFile* file, size_t* num_saved) {
+  int ret_value = -1;
+  EpidStatus result = kEpidErr;
+  PreComputedSignature* presigs = NULL;
+  size_t num_presigs = 0;
+  size_t size = 0;
+
+  if (!member || !file || !num_saved) {
+    return -1;
+  }
+  *num_saved = 0;
+  do {
+    num_presigs = EpidGetNumPreSigs(member);
+    size = num_presigs * sizeof(PreComputedSignature);
+    if (num_presigs) {
+      presigs = AllocBuffer(size);
+      if (!presigs) {
+        break;
+      }
+      result = EpidWritePreSigs(member, presigs, num_presigs);
+      if (kEpidNoErr != result) {
+        log_error("function EpidWritePreSigs returned %s",
+                  EpidStatusToString(result));
+        break;
+      }
+    }
+    if (0 != WriteAll(file->fd, presigs, size)) {
+      log_error("failed to write pre-computed signature file %s",
+                file->filename);
+      break;
+    }
+    *num_saved = num_presigs;
+    ret_value = 0;
+  } while (0);
+
+  if (presigs) {
+    memset(presigs, 0, size);
+    free(presigs);
+  }
+  return ret_value;
+}
@@ -0,0 +1,88 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Pre-computed signature pool file interface.
+ */
+#ifndef EXAMPLE_SIGNMSG_SRC_PRESIGS_H_
+#define EXAMPLE_SIGNMSG_SRC_PRESIGS_H_
+
+#include <stddef.h>
+
+#include "epid/member/api.h"
+
+/// A pre-computed signature pool file
+/*!
+  The file holds an array of ::PreComputedSignature. Pre-computed
+  signatures leak the private key if disclosed or used twice, so the file
+  is only readable by its owner and is exclusively locked while open: a
+  second process opening the same pool waits until the first has saved
+  its unused pre-computed signatures back and closed it.
+*/
+typedef struct PreSigFile PreSigFile;
+
+/// Open and lock a pre-computed signature pool file
+/*!
+  The file is created if it does not exist, and its permissions are
+  restricted to the owner if it does.
+
+  Logs an error message on failure.
+
+  \param[in] filename
+  The pool file name.
+  \returns
+  The open file or NULL on failure. Must be closed with ClosePreSigFile.
+*/
+PreSigFile* OpenPreSigFile(char const* filename);
+
+/// Close and unlock a pre-computed signature pool file
+void ClosePreSigFile(PreSigFile** file);
+
+/// Move pre-computed signatures from a file into a member's pool
+/*!
+  Once loaded the file is truncated, so a pre-computed signature can
+  never be used twice even if the pool is not saved again.
+
+  Logs an error message on failure.
+
+  \param[in] member
+  The member.
+  \param[in] file
+  The open pool file.
+  \param[out] num_loaded
+  The number of pre-computed signatures added to the pool.
+  \returns 0 on success, non-zero failure
+*/
+int LoadPreSigs(MemberCtx* member, PreSigFile* file, size_t* num_loaded);
+
+/// Move a member's pool of pre-computed signatures into a file
+/*!
+  The pool is empty afterwards. Replaces the content of the file.
+
+  Logs an error message on failure.
+
+  \param[in] member
+  The member.
+  \param[in] file
+  The open pool file.
+  \param[out] num_saved
+  The number of pre-computed signatures written.
+  \returns 0 on success, non-zero failure
+*/
+int SavePreSigs(MemberCtx* member, PreSigFile* file, size_t* num_saved);
+
+#endif  // EXAMPLE_SIGNMSG_SRC_PRESIGS_H_
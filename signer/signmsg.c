@@ -41,29 +41,30 @@ typedef struct EpidGroupPubKeyCertificate {
   EcdsaSignature signature;  ///< ECDSA Signature on SHA-256 of above values
 } EpidGroupPubKeyCertificate;
 
-EpidStatus SignMsg(void const* msg, size_t msg_len, void const* basename,
-                   size_t basename_len, unsigned char const* signed_sig_rl,
-                   size_t signed_sig_rl_size,
-                   unsigned char const* signed_pubkey,
-                   size_t signed_pubkey_size, unsigned char const* priv_key_ptr,
-                   size_t privkey_size, HashAlg hash_alg,
-                   MemberPrecomp* member_precomp, bool member_precomp_is_input,
-                   EpidSignature** sig, size_t* sig_len,
-                   EpidCaCertificate const* cacert) {
+EpidStatus CreateMember(unsigned char const* signed_pubkey,
+                        size_t signed_pubkey_size,
+                        unsigned char const* priv_key_ptr, size_t privkey_size,
+                        void const* basename, size_t basename_len,
+                        HashAlg hash_alg, MemberPrecomp* member_precomp,
+                        bool member_precomp_is_input,
+                        EpidCaCertificate const* cacert, void** prng,
+                        MemberCtx** member) {
   EpidStatus sts = kEpidErr;
-  void* prng = NULL;
-  MemberCtx* member = NULL;
-  SigRl* sig_rl = NULL;
+  void* new_prng = NULL;
+  MemberCtx* new_member = NULL;
+
+  if (!signed_pubkey || !priv_key_ptr || !member_precomp || !prng ||
+      !member) {
+    return kEpidBadArgErr;
+  }
+  (void)cacert;
+  if (signed_pubkey_size < sizeof(GroupPubKey)) {
+    return kEpidBadArgErr;
+  }
 
   do {
     GroupPubKey pub_key = {0};
     PrivKey priv_key = {0};
-    size_t sig_rl_size = 0;
-
-    if (!sig) {
-      sts = kEpidBadArgErr;
-      break;
-    }
 
     // // authenticate and extract group public key
     // sts = EpidParseGroupPubKeyFile(signed_pubkey, signed_pubkey_size, cacert,
@@ -73,40 +74,7 @@ EpidStatus SignMsg(void const* msg, size_t msg_len, void const* basename,
     // }
     // ZVB: Just copy the pub key directly
     // EpidGroupPubKeyCertificate* buf_pubkey = (EpidGroupPubKeyCertificate*)signed_pubkey;
-    GroupPubKey* buf_pubkey = (GroupPubKey*)signed_pubkey;
-    pub_key.gid = buf_pubkey->gid;
-    pub_key.h1 = buf_pubkey->h1;
-    pub_key.h2 = buf_pubkey->h2;
-    pub_key.w = buf_pubkey->w;
-
-    // if (signed_sig_rl) {
-    //   // authenticate and determine space needed for SigRl
-    //   sts = EpidParseSigRlFile(signed_sig_rl, signed_sig_rl_size, cacert, NULL,
-    //                            &sig_rl_size);
-    //   if (kEpidSigInvalid == sts) {
-    //     // authentication failure
-    //     break;
-    //   }
-    //   if (kEpidNoErr != sts) {
-    //     break;
-    //   }
-    //   sig_rl = AllocBuffer(sig_rl_size);
-    //   if (!sig_rl) {
-    //     sts = kEpidMemAllocErr;
-    //     break;
-    //   }
-
-    //   // fill the SigRl
-    //   sts = EpidParseSigRlFile(signed_sig_rl, signed_sig_rl_size, cacert,
-    //                            sig_rl, &sig_rl_size);
-    //   if (kEpidSigInvalid == sts) {
-    //     // authentication failure
-    //     break;
-    //   }
-    //   if (kEpidNoErr != sts) {
-    //     break;
-    //   }
-    // }  // if (signed_sig_rl)
+    pub_key = *(GroupPubKey const*)signed_pubkey;
 
     // decompress private key
     if (privkey_size == sizeof(PrivKey)) {
@@ -123,7 +91,7 @@ EpidStatus SignMsg(void const* msg, size_t msg_len, void const* basename,
     }  // if (privkey_size == sizeof(PrivKey))
 
     // acquire PRNG
-    sts = PrngCreate(&prng);
+    sts = PrngCreate(&new_prng);
     if (kEpidNoErr != sts) {
       break;
     }
@@ -131,51 +99,141 @@ EpidStatus SignMsg(void const* msg, size_t msg_len, void const* basename,
     // create member
     sts = EpidMemberCreate(&pub_key, &priv_key,
                            member_precomp_is_input ? member_precomp : NULL,
-                           PrngGen, prng, &member);
+                           PrngGen, new_prng, &new_member);
     if (kEpidNoErr != sts) {
       break;
     }
 
     // return member pre-computation blob if requested
-    sts = EpidMemberWritePrecomp(member, member_precomp);
+    sts = EpidMemberWritePrecomp(new_member, member_precomp);
     if (kEpidNoErr != sts) {
       break;
     }
 
     // register any provided basename as allowed
     if (0 != basename_len) {
-      sts = EpidRegisterBaseName(member, basename, basename_len);
+      sts = EpidRegisterBaseName(new_member, basename, basename_len);
       if (kEpidNoErr != sts) {
         break;
       }
     }
 
-    sts = EpidMemberSetHashAlg(member, hash_alg);
+    sts = EpidMemberSetHashAlg(new_member, hash_alg);
     if (kEpidNoErr != sts) {
       break;
     }
+    sts = kEpidNoErr;
+  } while (0);
+
+  if (kEpidNoErr != sts) {
+    DeleteMember(&new_member, &new_prng);
+  }
+  *prng = new_prng;
+  *member = new_member;
+
+  return sts;
+}
+
+void DeleteMember(MemberCtx** member, void** prng) {
+  EpidMemberDelete(member);
+  PrngDelete(prng);
+}
+
+EpidStatus SignWithMember(MemberCtx* member, void const* msg, size_t msg_len,
+                          void const* basename, size_t basename_len,
+                          SigRl const* sig_rl, size_t sig_rl_size,
+                          EpidSignature** sig, size_t* sig_len) {
+  EpidStatus sts = kEpidErr;
+
+  if (!member || !sig || !sig_len) {
+    return kEpidBadArgErr;
+  }
+
+  // Signature
+  // Note: Signature size must be computed after sig_rl is loaded.
+  *sig_len = EpidGetSigSize(sig_rl);
+
+  *sig = AllocBuffer(*sig_len);
+  if (!*sig) {
+    return kEpidMemAllocErr;
+  }
+
+  // sign message
+  sts = EpidSign(member, msg, msg_len, basename, basename_len, sig_rl,
+                 sig_rl_size, *sig, *sig_len);
+
+  return sts;
+}
+
+EpidStatus SignMsg(void const* msg, size_t msg_len, void const* basename,
+                   size_t basename_len, unsigned char const* signed_sig_rl,
+                   size_t signed_sig_rl_size,
+                   unsigned char const* signed_pubkey,
+                   size_t signed_pubkey_size, unsigned char const* priv_key_ptr,
+                   size_t privkey_size, HashAlg hash_alg,
+                   MemberPrecomp* member_precomp, bool member_precomp_is_input,
+                   EpidSignature** sig, size_t* sig_len,
+                   EpidCaCertificate const* cacert) {
+  EpidStatus sts = kEpidErr;
+  void* prng = NULL;
+  MemberCtx* member = NULL;
+  SigRl* sig_rl = NULL;
+
+  do {
+    size_t sig_rl_size = 0;
+
+    if (!sig) {
+      sts = kEpidBadArgErr;
+      break;
+    }
+
+    // if (signed_sig_rl) {
+    //   // authenticate and determine space needed for SigRl
+    //   sts = EpidParseSigRlFile(signed_sig_rl, signed_sig_rl_size, cacert, NULL,
+    //                            &sig_rl_size);
+    //   if (kEpidSigInvalid == sts) {
+    //     // authentication failure
+    //     break;
+    //   }
+    //   if (kEpidNoErr != sts) {
+    //     break;
+    //   }
+    //   sig_rl = AllocBuffer(sig_rl_size);
+    //   if (!sig_rl) {
+    //     sts = kEpidMemAllocErr;
+    //     break;
+    //   }
 
-    // Signature
-    // Note: Signature size must be computed after sig_rl is loaded.
-    *sig_len = EpidGetSigSize(sig_rl);
+    //   // fill the SigRl
+    //   sts = EpidParseSigRlFile(signed_sig_rl, signed_sig_rl_size, cacert,
+    //                            sig_rl, &sig_rl_size);
+    //   if (kEpidSigInvalid == sts) {
+    //     // authentication failure
+    //     break;
+    //   }
+    //   if (kEpidNoErr != sts) {
+    //     break;
+    //   }
+    // }  // if (signed_sig_rl)
 
-    *sig = AllocBuffer(*sig_len);
-    if (!*sig) {
-      sts = kEpidMemAllocErr;
+    // create member
+    sts = CreateMember(signed_pubkey, signed_pubkey_size, priv_key_ptr,
+                       privkey_size, basename, basename_len, hash_alg,
+                       member_precomp, member_precomp_is_input, cacert, &prng,
+                       &member);
+    if (kEpidNoErr != sts) {
       break;
     }
 
-    // sign message
-    sts = EpidSign(member, msg, msg_len, basename, basename_len, sig_rl,
-                   sig_rl_size, *sig, *sig_len);
+    sts = SignWithMember(member, msg, msg_len, basename, basename_len, sig_rl,
+                         sig_rl_size, sig, sig_len);
     if (kEpidNoErr != sts) {
       break;
     }
     sts = kEpidNoErr;
   } while (0);
 
-  PrngDelete(&prng);
-  EpidMemberDelete(&member);
+  DeleteMember(&member, &prng);
 
   if (sig_rl) free(sig_rl);
 
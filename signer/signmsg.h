@@ -25,6 +25,83 @@
 #include "epid/member/api.h"
 #include "epid/common/file_parser.h"
 
+/// Create a member that can sign any number of messages
+/*!
+  The member is configured with the group public key, private key, hash
+  algorithm and, if basename_len is not 0, basename. The
+  pre-computation blob is written back to member_precomp.
+
+  \param[in] signed_pubkey
+  The group public key.
+  \param[in] signed_pubkey_size
+  The size of the group public key in bytes.
+  \param[in] priv_key
+  The member private key, compressed or not.
+  \param[in] privkey_size
+  The size of the member private key in bytes.
+  \param[in] basename
+  The basename to register. Can be NULL if basename_len is 0.
+  \param[in] basename_len
+  The length of the basename in bytes.
+  \param[in] hash_alg
+  The hash algorithm used for signing.
+  \param[in,out] member_precomp
+  The member pre-computation blob.
+  \param[in] member_precomp_is_input
+  Whether member_precomp should be used to create the member.
+  \param[in] cacert
+  The issuing CA certificate.
+  \param[out] prng
+  The random number generator used by the member.
+  \param[out] member
+  The newly created member.
+  \returns ::EpidStatus
+  \see DeleteMember
+*/
+EpidStatus CreateMember(unsigned char const* signed_pubkey,
+                        size_t signed_pubkey_size, unsigned char const* priv_key,
+                        size_t privkey_size, void const* basename,
+                        size_t basename_len, HashAlg hash_alg,
+                        MemberPrecomp* member_precomp,
+                        bool member_precomp_is_input,
+                        EpidCaCertificate const* cacert, void** prng,
+                        MemberCtx** member);
+
+/// Delete a member created by CreateMember and its random number generator
+void DeleteMember(MemberCtx** member, void** prng);
+
+/// Create Intel(R) EPID signature of message with an existing member
+/*!
+  Uses a signature from the member's pre-computed signature pool if one
+  is available.
+
+  \param[in] member
+  The member, created with CreateMember.
+  \param[in] msg
+  The message to sign.
+  \param[in] msg_len
+  The length of the message in bytes.
+  \param[in] basename
+  The basename to sign with, already registered with the member. Can be
+  NULL if basename_len is 0.
+  \param[in] basename_len
+  The length of the basename in bytes.
+  \param[in] sig_rl
+  The signature based revocation list. Can be NULL.
+  \param[in] sig_rl_size
+  The size of sig_rl in bytes.
+  \param[out] sig
+  The newly allocated signature. Must be freed by the caller, also on
+  failure.
+  \param[out] sig_len
+  The size of the signature in bytes.
+  \returns ::EpidStatus
+*/
+EpidStatus SignWithMember(MemberCtx* member, void const* msg, size_t msg_len,
+                          void const* basename, size_t basename_len,
+                          SigRl const* sig_rl, size_t sig_rl_size,
+                          EpidSignature** sig, size_t* sig_len);
+
 /// Create Intel(R) EPID signature of message
 EpidStatus SignMsg(void const* msg, size_t msg_len, void const* basename,
                    size_t basename_len, unsigned char const* signed_sig_rl,
@@ -0,0 +1,509 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Batch signature verification implementation.
+ */
+
+#include "batchverify.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "epid/common/errors.h"
+#include "util/buffutil.h"
+#include "util/envutil.h"
+#include "verifysig.h"
+
+/// Initial number of entries allocated for a batch
+#define BATCH_INITIAL_CAPACITY 64
+/// Manifest field separator
+#define MANIFEST_SEPARATOR '\t'
+/// Manifest comment marker
+#define MANIFEST_COMMENT '#'
+
+/// Duplicate count bytes of str as a new null terminated string
+static char* DupString(char const* str, size_t count) {
+  char* dup = malloc(count + 1);
+  if (!dup) {
+    return NULL;
+  }
+  if (count) {
+    memcpy(dup, str, count);
+  }
+  dup[count] = '\0';
+  return dup;
+}
+
+/// Append a copy of an entry to a batch
+static int AddBatchEntry(Batch* batch, char const* sig_file,
+                         size_t sig_file_len, char const* msg, size_t msg_len,
+                         char const* basename, size_t basename_len) {
+  BatchEntry* entry = NULL;
+  if (batch->count == batch->capacity) {
+    size_t capacity =
+        batch->capacity ? 2 * batch->capacity : BATCH_INITIAL_CAPACITY;
+    BatchEntry* entries =
+        realloc(batch->entries, capacity * sizeof(*batch->entries));
+    if (!entries) {
+      return -1;
+    }
+    batch->entries = entries;
+    batch->capacity = capacity;
+  }
+  entry = &batch->entries[batch->count];
+  memset(entry, 0, sizeof(*entry));
+  entry->sig_file = DupString(sig_file, sig_file_len);
+  entry->msg = DupString(msg ? msg : "", msg ? msg_len : 0);
+  entry->msg_len = msg ? msg_len : 0;
+  if (basename && basename_len) {
+    entry->basename = DupString(basename, basename_len);
+    entry->basename_len = basename_len;
+    if (!entry->basename) {
+      free(entry->sig_file);
+      free(entry->msg);
+      return -1;
+    }
+  }
+  if (!entry->sig_file || !entry->msg) {
+    free(entry->sig_file);
+    free(entry->msg);
+    free(entry->basename);
+    return -1;
+  }
+  batch->count++;
+  return 0;
+}
+
+/// Read one line of arbitrary length, without the line terminator
+/*!
+  \returns number of characters read, -1 at end of file or -2 if memory
+  could not be allocated
+*/
+static long ReadLine(FILE* fp, char** line, size_t* capacity) {
+  size_t len = 0;
+  int c = 0;
+  while (EOF != (c = fgetc(fp))) {
+    if (len + 1 >= *capacity) {
+      size_t new_capacity = *capacity ? 2 * *capacity : 256;
+      char* new_line = realloc(*line, new_capacity);
+      if (!new_line) {
+        return -2;
+      }
+      *line = new_line;
+      *capacity = new_capacity;
+    }
+    if ('\n' == c) {
+      break;
+    }
+    (*line)[len++] = (char)c;
+  }
+  if (EOF == c && 0 == len) {
+    return -1;
+  }
+  if (len > 0 && '\r' == (*line)[len - 1]) {
+    len--;
+  }
+  (*line)[len] = '\0';
+  return (long)len;
+}
+
+/// Fill batch from a manifest file
+static int LoadManifest(Batch* batch, char const* manifest_file,
+                        char const* default_msg,
+                        char const* default_basename) {
+  int result = -1;
+  FILE* fp = NULL;
+  char* line = NULL;
+  size_t capacity = 0;
+  size_t line_num = 0;
+
+  fp = fopen(manifest_file, "r");
+  if (!fp) {
+    log_error("failed to open manifest file %s", manifest_file);
+    return -1;
+  }
+  do {
+    long len = 0;
+    while ((len = ReadLine(fp, &line, &capacity)) >= 0) {
+      char const* fields[3] = {NULL, NULL, NULL};
+      size_t field_lens[3] = {0, 0, 0};
+      size_t num_fields = 0;
+      char const* p = line;
+      line_num++;
+      if (0 == len || MANIFEST_COMMENT == line[0]) {
+        continue;
+      }
+      while (num_fields < 3) {
+        char const* sep = strchr(p, MANIFEST_SEPARATOR);
+        fields[num_fields] = p;
+        field_lens[num_fields] = sep ? (size_t)(sep - p) : strlen(p);
+        num_fields++;
+        if (!sep) {
+          break;
+        }
+        p = sep + 1;
+      }
+      if (0 == field_lens[0]) {
+        log_error("%s:%u: missing signature file name", manifest_file,
+                  (unsigned)line_num);
+        break;
+      }
+      if (num_fields < 2) {
+        fields[1] = default_msg;
+        field_lens[1] = default_msg ? strlen(default_msg) : 0;
+      }
+      if (num_fields < 3) {
+        fields[2] = default_basename;
+        field_lens[2] = default_basename ? strlen(default_basename) : 0;
+      }
+      if (0 != AddBatchEntry(batch, fields[0], field_lens[0], fields[1],
+                             field_lens[1], fields[2], field_lens[2])) {
+        log_error("failed to allocate memory");
+        break;
+      }
+    }
+    if (-2 == len) {
+      log_error("failed to allocate memory");
+      break;
+    }
+    if (len >= 0 || ferror(fp)) {
+      // stopped before end of file
+      break;
+    }
+    result = 0;
+  } while (0);
+
+  free(line);
+  fclose(fp);
+  return result;
+}
+
+/// Orders directory entries by name
+static int CompareNames(void const* a, void const* b) {
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/// Fill batch from the regular files in a directory
+static int LoadDirectory(Batch* batch, char const* dir_name,
+                         char const* default_msg,
+                         char const* default_basename) {
+  int result = -1;
+  DIR* dir = NULL;
+  struct dirent* dirent = NULL;
+  char** names = NULL;
+  size_t num_names = 0;
+  size_t capacity = 0;
+  size_t dir_name_len = strlen(dir_name);
+  size_t msg_len = default_msg ? strlen(default_msg) : 0;
+  size_t basename_len = default_basename ? strlen(default_basename) : 0;
+  size_t i = 0;
+
+  dir = opendir(dir_name);
+  if (!dir) {
+    log_error("failed to open directory %s", dir_name);
+    return -1;
+  }
+  do {
+    while (NULL != (dirent = readdir(dir))) {
+      struct stat st;
+      size_t name_len = strlen(dirent->d_name);
+      char* path = NULL;
+      if ('.' == dirent->d_name[0]) {
+        continue;
+      }
+      path = malloc(dir_name_len + 1 + name_len + 1);
+      if (!path) {
+        break;
+      }
+      sprintf(path, "%s/%s", dir_name, dirent->d_name);
+      if (0 != stat(path, &st) || !S_ISREG(st.st_mode)) {
+        free(path);
+        continue;
+      }
+      if (num_names == capacity) {
+        size_t new_capacity = capacity ? 2 * capacity : BATCH_INITIAL_CAPACITY;
+        char** new_names = realloc(names, new_capacity * sizeof(*names));
+        if (!new_names) {
+          free(path);
+          break;
+        }
+        names = new_names;
+        capacity = new_capacity;
+      }
+      names[num_names++] = path;
+    }
+    if (dirent) {
+      log_error("failed to allocate memory");
+      break;
+    }
+    if (num_names) {
+      qsort(names, num_names, sizeof(*names), CompareNames);
+    }
+    for (i = 0; i < num_names; i++) {
+      if (0 != AddBatchEntry(batch, names[i], strlen(names[i]), default_msg,
+                             msg_len, default_basename, basename_len)) {
+        log_error("failed to allocate memory");
+        break;
+      }
+    }
+    if (i < num_names) {
+      break;
+    }
+    result = 0;
+  } while (0);
+
+  for (i = 0; i < num_names; i++) {
+    free(names[i]);
+  }
+  free(names);
+  closedir(dir);
+  return result;
+}
+
+Batch* NewBatch(char const* path, char const* default_msg,
+                char const* default_basename) {
+  Batch* batch = NULL;
+  struct stat st;
+  int result = -1;
+
+  if (!path) {
+    return NULL;
+  }
+  if (0 != stat(path, &st)) {
+    log_error("cannot access %s", path);
+    return NULL;
+  }
+  batch = calloc(1, sizeof(*batch));
+  if (!batch) {
+    log_error("failed to allocate memory");
+    return NULL;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    result = LoadDirectory(batch, path, default_msg, default_basename);
+  } else {
+    result = LoadManifest(batch, path, default_msg, default_basename);
+  }
+  if (0 != result) {
+    DeleteBatch(&batch);
+  }
+  return batch;
+}
+
+void DeleteBatch(Batch** batch) {
+  size_t i = 0;
+  if (!batch || !*batch) {
+    return;
+  }
+  for (i = 0; i < (*batch)->count; i++) {
+    free((*batch)->entries[i].sig_file);
+    free((*batch)->entries[i].msg);
+    free((*batch)->entries[i].basename);
+  }
+  free((*batch)->entries);
+  free(*batch);
+  *batch = NULL;
+}
+
+/// Basename currently set in a verifier
+typedef struct BasenameState {
+  char const* basename;  ///< last basename set, NULL if random
+  size_t basename_len;   ///< length of last basename in bytes
+  bool is_set;           ///< whether a basename was set at all
+} BasenameState;
+
+/// Verify a single batch entry
+static EpidStatus VerifyEntry(VerifierCtx* ctx, BasenameState* bsn,
+                              BatchEntry const* entry) {
+  EpidStatus result = kEpidErr;
+  void* sig = NULL;
+  size_t sig_size = 0;
+
+  do {
+    // only rehash the basename when it changes between entries
+    if (!bsn->is_set || bsn->basename_len != entry->basename_len ||
+        (entry->basename_len &&
+         0 != memcmp(bsn->basename, entry->basename, entry->basename_len))) {
+      bsn->is_set = false;
+      result =
+          EpidVerifierSetBasename(ctx, entry->basename, entry->basename_len);
+      if (kEpidNoErr != result) {
+        break;
+      }
+      bsn->basename = entry->basename;
+      bsn->basename_len = entry->basename_len;
+      bsn->is_set = true;
+    }
+
+    sig = NewBufferFromFile(entry->sig_file, &sig_size);
+    if (!sig) {
+      result = kEpidBadArgErr;
+      break;
+    }
+
+    result = VerifyWithVerifier(ctx, sig, sig_size, entry->msg,
+                                entry->msg_len);
+  } while (0);
+
+  if (sig) free(sig);
+  return result;
+}
+
+/// State shared by all batch workers
+typedef struct BatchState {
+  Batch const* batch;     ///< signatures to check
+  EpidStatus* results;    ///< result of each entry, in input order
+  bool* done;             ///< whether each entry has been checked
+  size_t next;            ///< next entry to be claimed by a worker
+  pthread_mutex_t lock;   ///< protects next, results and done
+  pthread_cond_t result;  ///< signalled when an entry is done
+} BatchState;
+
+/// A batch worker thread
+typedef struct BatchWorker {
+  BatchState* state;  ///< shared state
+  VerifierCtx* ctx;   ///< verifier owned by this worker
+  pthread_t thread;   ///< worker thread
+} BatchWorker;
+
+/// Batch worker thread entrypoint
+static void* BatchWorkerMain(void* arg) {
+  BatchWorker* worker = arg;
+  BatchState* state = worker->state;
+  BasenameState bsn = {0};
+
+  for (;;) {
+    size_t i = 0;
+    EpidStatus result = kEpidErr;
+
+    pthread_mutex_lock(&state->lock);
+    i = state->next++;
+    pthread_mutex_unlock(&state->lock);
+    if (i >= state->batch->count) {
+      break;
+    }
+
+    result = VerifyEntry(worker->ctx, &bsn, &state->batch->entries[i]);
+
+    pthread_mutex_lock(&state->lock);
+    state->results[i] = result;
+    state->done[i] = true;
+    pthread_cond_broadcast(&state->result);
+    pthread_mutex_unlock(&state->lock);
+  }
+  return NULL;
+}
+
+/// Report the result of a batch entry
+static void ReportEntry(BatchEntry const* entry, EpidStatus result) {
+  log_msg("%s: %s", entry->sig_file, EpidStatusToString(result));
+}
+
+EpidStatus VerifyBatch(Batch const* batch, VerifierCtx* const* ctxs,
+                       size_t num_ctxs, size_t* num_failed) {
+  EpidStatus sts = kEpidErr;
+  BatchState state;
+  BatchWorker* workers = NULL;
+  size_t num_workers = 0;
+  size_t failed = 0;
+  size_t i = 0;
+
+  if (!batch || !ctxs || !num_ctxs || !num_failed) {
+    return kEpidBadArgErr;
+  }
+  for (i = 0; i < num_ctxs; i++) {
+    if (!ctxs[i]) {
+      return kEpidBadArgErr;
+    }
+  }
+
+  if (1 == num_ctxs || batch->count <= 1) {
+    // check everything on the calling thread
+    BasenameState bsn = {0};
+    for (i = 0; i < batch->count; i++) {
+      EpidStatus result = VerifyEntry(ctxs[0], &bsn, &batch->entries[i]);
+      if (kEpidNoErr != result) {
+        failed++;
+      }
+      ReportEntry(&batch->entries[i], result);
+    }
+    *num_failed = failed;
+    return kEpidNoErr;
+  }
+
+  memset(&state, 0, sizeof(state));
+  state.batch = batch;
+  state.results = calloc(batch->count, sizeof(*state.results));
+  state.done = calloc(batch->count, sizeof(*state.done));
+  workers = calloc(num_ctxs, sizeof(*workers));
+  pthread_mutex_init(&state.lock, NULL);
+  pthread_cond_init(&state.result, NULL);
+
+  do {
+    if (!state.results || !state.done || !workers) {
+      sts = kEpidMemAllocErr;
+      break;
+    }
+
+    // start workers, each with its own verifier
+    for (num_workers = 0; num_workers < num_ctxs; num_workers++) {
+      workers[num_workers].state = &state;
+      workers[num_workers].ctx = ctxs[num_workers];
+      if (0 != pthread_create(&workers[num_workers].thread, NULL,
+                              BatchWorkerMain, &workers[num_workers])) {
+        break;
+      }
+    }
+    if (0 == num_workers) {
+      sts = kEpidErr;
+      break;
+    }
+
+    // report results in input order as they become available
+    for (i = 0; i < batch->count; i++) {
+      EpidStatus result = kEpidErr;
+      pthread_mutex_lock(&state.lock);
+      while (!state.done[i]) {
+        pthread_cond_wait(&state.result, &state.lock);
+      }
+      result = state.results[i];
+      pthread_mutex_unlock(&state.lock);
+      if (kEpidNoErr != result) {
+        failed++;
+      }
+      ReportEntry(&batch->entries[i], result);
+    }
+
+    *num_failed = failed;
+    sts = kEpidNoErr;
+  } while (0);
+
+  for (i = 0; i < num_workers; i++) {
+    pthread_join(workers[i].thread, NULL);
+  }
+  pthread_cond_destroy(&state.result);
+  pthread_mutex_destroy(&state.lock);
+  free(workers);
+  free(state.done);
+  free(state.results);
+
+  return sts;
+}
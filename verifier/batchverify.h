@@ -0,0 +1,103 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Batch signature verification interface.
+ */
+#ifndef EXAMPLE_VERIFYSIG_SRC_BATCHVERIFY_H_
+#define EXAMPLE_VERIFYSIG_SRC_BATCHVERIFY_H_
+
+#include <stddef.h>
+
+#include "epid/verifier/api.h"
+
+/// A signature to be checked in batch mode
+typedef struct BatchEntry {
+  char* sig_file;       ///< signature file name
+  char* msg;            ///< message that was signed
+  size_t msg_len;       ///< length of message in bytes
+  char* basename;       ///< basename used in signature, NULL if random
+  size_t basename_len;  ///< length of basename in bytes
+} BatchEntry;
+
+/// A list of signatures to be checked in batch mode
+typedef struct Batch {
+  BatchEntry* entries;  ///< signatures in input order
+  size_t count;         ///< number of entries
+  size_t capacity;      ///< number of allocated entries
+} Batch;
+
+/// Load a batch from a manifest file or a directory of signatures
+/*!
+  If path is a directory, every regular file in it is treated as a
+  signature over default_msg with default_basename, in file name order.
+
+  Otherwise path is read as a manifest with one signature per line of the
+  form
+
+      SIGFILE[<TAB>MESSAGE[<TAB>BASENAME]]
+
+  Omitted fields take default_msg and default_basename. An empty basename
+  field means the signature was created with a random basename. Empty
+  lines and lines starting with '#' are ignored.
+
+  Logs an error message on failure.
+
+  \param[in] path
+  The manifest file or directory name.
+  \param[in] default_msg
+  Message to use for entries that do not specify one. Can be NULL.
+  \param[in] default_basename
+  Basename to use for entries that do not specify one. Can be NULL.
+  \returns
+  The new batch or NULL on failure. Must be freed with DeleteBatch.
+*/
+Batch* NewBatch(char const* path, char const* default_msg,
+                char const* default_basename);
+
+/// Free a batch and all its entries
+void DeleteBatch(Batch** batch);
+
+/// Verify every signature in a batch
+/*!
+  Entries are distributed over one worker thread per verifier. Each
+  verifier is only ever used by one thread and is reused for all entries
+  that thread checks; the basename is only reset when it differs from that
+  of the previous entry. With a single verifier everything is checked on
+  the calling thread.
+
+  One line is written to standard out per entry, in input order, of the
+  form
+
+      SIGFILE: STATUS
+
+  \param[in] batch
+  The signatures to check.
+  \param[in] ctxs
+  Verifiers created for the group that the signatures belong to.
+  \param[in] num_ctxs
+  The number of verifiers, which is the number of threads used.
+  \param[out] num_failed
+  The number of signatures that could not be verified.
+  \returns ::EpidStatus
+  kEpidNoErr if every entry was processed, regardless of the individual
+  verification results.
+*/
+EpidStatus VerifyBatch(Batch const* batch, VerifierCtx* const* ctxs,
+                       size_t num_ctxs, size_t* num_failed);
+
+#endif  // EXAMPLE_VERIFYSIG_SRC_BATCHVERIFY_H_
@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <dropt.h>
 #include "epid/common/errors.h"
@@ -33,6 +34,8 @@
 #include "util/buffutil.h"
 #include "util/convutil.h"
 #include "util/envutil.h"
+#include "batchverify.h"
+#include "precompstore.h"
 #include "verifysig.h"
 // #include "verifysig11.h"
 
@@ -49,6 +52,8 @@
 #define UNPARSED_HASHALG (kInvalidHashAlg)
 #define VPRECMPI_DEFAULT NULL
 #define VPRECMPO_DEFAULT NULL
+#define THREADS_DEFAULT 1
+#define THREADS_MAX 256
 
 /// parses string to a hashalg type
 static dropt_error HandleHashalg(dropt_context* context,
@@ -82,6 +87,12 @@ int main(int argc, char* argv[]) {
   // Signature file name parameter
   static char* sig_file = SIG_DEFAULT;
 
+  // Batch manifest or directory name parameter
+  static char* batch_path = NULL;
+
+  // Number of batch verification threads parameter
+  static unsigned int num_threads = THREADS_DEFAULT;
+
   // Message string parameter
   static char* msg_str = NULL;
   size_t msg_size = 0;
@@ -111,6 +122,9 @@ int main(int argc, char* argv[]) {
   // Verifier pre-computed settings output file name parameter
   static char* vprecmpo_file = NULL;
 
+  // Verifier pre-computed settings store file name parameter
+  static char* vprecmpstore_file = NULL;
+
   // // CA certificate file name parameter
   // static char* cacert_file_name = NULL;
 
@@ -122,6 +136,9 @@ int main(int argc, char* argv[]) {
 
   // Buffers and computed values
 
+  // Signatures to verify in batch mode
+  Batch* batch = NULL;
+
   // Signature buffer
   void* sig = NULL;
   size_t sig_size = 0;
@@ -154,6 +171,9 @@ int main(int argc, char* argv[]) {
   // Flag that Verifier pre-computed settings input is valid
   bool use_precmp_in;
 
+  // Verifier pre-computed settings store
+  PrecompStore* precmp_store = NULL;
+
   // CA certificate
   EpidCaCertificate cacert = {0};
   // Hash algorithm
@@ -162,6 +182,13 @@ int main(int argc, char* argv[]) {
   dropt_option options[] = {
       {'\0', "sig", "load signature from FILE (default: " SIG_DEFAULT ")",
        "FILE", dropt_handle_string, &sig_file},
+      {'\0', "batch",
+       "verify every signature listed in manifest FILE or stored in DIR, "
+       "one result per line",
+       "{FILE | DIR}", dropt_handle_string, &batch_path},
+      {'\0', "threads",
+       "use N threads to verify a batch (default: 1)", "N",
+       dropt_handle_uint, &num_threads},
       {'\0', "msg", "MESSAGE that was signed (default: empty)", "MESSAGE",
        dropt_handle_string, &msg_str},
       {'\0', "bsn", "BASENAME used in signature (default: random)", "BASENAME",
@@ -182,6 +209,10 @@ int main(int argc, char* argv[]) {
        dropt_handle_string, &vprecmpi_file},
       {'\0', "vprecmpo", "write pre-computed verifier data to FILE", "FILE",
        dropt_handle_string, &vprecmpo_file},
+      {'\0', "vprecmpstore",
+       "load pre-computed verifier data for the group from store FILE, "
+       "adding it if missing",
+       "FILE", dropt_handle_string, &vprecmpstore_file},
       // {'\0', "capubkey",
       //  "load IoT Issuing CA public key from FILE\n (default: " CACERT_DEFAULT
       //  ")",
@@ -249,6 +280,12 @@ int main(int argc, char* argv[]) {
         if (!sig_file) sig_file = SIG_DEFAULT;
         // if (!grprl_file) grprl_file = GRPRL_DEFAULT;
         if (!pubkey_file) pubkey_file = PUBKEYFILE_DEFAULT;
+        if (0 == num_threads || THREADS_MAX < num_threads) {
+          log_error("number of threads must be between 1 and %d",
+                    THREADS_MAX);
+          ret_value = EXIT_FAILURE;
+          break;
+        }
         // if (!cacert_file_name) cacert_file_name = CACERT_DEFAULT;
         if (msg_str) msg_size = strlen(msg_str);
         if (basename_str) basename_size = strlen(basename_str);
@@ -256,6 +293,8 @@ int main(int argc, char* argv[]) {
         if (verbose) {
           log_msg("\nOption values:");
           log_msg(" sig_file      : %s", sig_file);
+          log_msg(" batch_path    : %s", batch_path);
+          log_msg(" num_threads   : %u", num_threads);
           log_msg(" msg_str       : %s", msg_str);
           log_msg(" basename_str  : %s", basename_str);
           // log_msg(" privrl_file   : %s", privrl_file);
@@ -264,6 +303,7 @@ int main(int argc, char* argv[]) {
           // log_msg(" verrl_file : %s", verrl_file);
           log_msg(" vprecmpi_file : %s", vprecmpi_file);
           log_msg(" vprecmpo_file : %s", vprecmpo_file);
+          log_msg(" vprecmpstore  : %s", vprecmpstore_file);
           log_msg(" hashalg       : %s", (UNPARSED_HASHALG == hashalg)
                                              ? "(default)"
                                              : HashAlgToString(hashalg));
@@ -274,11 +314,20 @@ int main(int argc, char* argv[]) {
     }
     // convert command line args to usable formats
 
-    // Signature
-    sig = NewBufferFromFile(sig_file, &sig_size);
-    if (!sig) {
-      ret_value = EXIT_FAILURE;
-      break;
+    if (batch_path) {
+      // Signatures
+      batch = NewBatch(batch_path, msg_str, basename_str);
+      if (!batch) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+    } else {
+      // Signature
+      sig = NewBufferFromFile(sig_file, &sig_size);
+      if (!sig) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
     }
 
     // // PrivRl
@@ -395,6 +444,24 @@ int main(int argc, char* argv[]) {
         break;
       }
     }
+    if (vprecmpstore_file) {
+      if (kEpid2x != epid_version ||
+          signed_pubkey_size < sizeof(GroupPubKey)) {
+        log_error("precomp store only supported for 2.0 groups");
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+      precmp_store = OpenPrecompStore(vprecmpstore_file);
+      if (!precmp_store) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+      if (!use_precmp_in) {
+        use_precmp_in = PrecompStoreFind(
+            precmp_store, (GroupPubKey const*)signed_pubkey,
+            (VerifierPrecomp*)verifier_precmp);
+      }
+    }
 
     // Report Settings
     if (verbose) {
@@ -403,10 +470,15 @@ int main(int argc, char* argv[]) {
       log_msg("");
       log_msg(" [in]  EPID version: %s", EpidVersionToString(epid_version));
       log_msg("");
-      log_msg(" [in]  Signature Len: %d", (int)sig_size);
-      log_msg(" [in]  Signature: ");
-      PrintBuffer(sig, sig_size);
-      log_msg("");
+      if (batch) {
+        log_msg(" [in]  Batch Len: %d", (int)batch->count);
+        log_msg("");
+      } else {
+        log_msg(" [in]  Signature Len: %d", (int)sig_size);
+        log_msg(" [in]  Signature: ");
+        PrintBuffer(sig, sig_size);
+        log_msg("");
+      }
       log_msg(" [in]  Message Len: %d", (int)msg_size);
       log_msg(" [in]  Message: ");
       PrintBuffer(msg_str, msg_size);
@@ -443,35 +515,112 @@ int main(int argc, char* argv[]) {
       log_msg("==============================================");
     }
 
-    // Verify
-    // if (kEpid2x == epid_version) {
-      result =
-          Verify(sig, sig_size, msg_str, msg_size, basename_str, basename_size,
-                 signed_priv_rl, signed_priv_rl_size, signed_sig_rl,
-                 signed_sig_rl_size, signed_grp_rl, signed_grp_rl_size, ver_rl,
-                 ver_rl_size, signed_pubkey, signed_pubkey_size, &cacert,
-                 hashalg, (VerifierPrecomp*)verifier_precmp, use_precmp_in);
-    // } else if (kEpid1x == epid_version) {
-    //   result = Verify11(sig, sig_size, msg_str, msg_size, basename_str,
-    //                     basename_size, signed_priv_rl, signed_priv_rl_size,
-    //                     signed_sig_rl, signed_sig_rl_size, signed_grp_rl,
-    //                     signed_grp_rl_size, signed_pubkey, signed_pubkey_size,
-    //                     &cacert, (Epid11VerifierPrecomp*)verifier_precmp,
-    //                     use_precmp_in);
-    // } else {
-    //   log_error("EPID version %s is not supported",
-    //             EpidVersionToString(epid_version));
-    //   ret_value = EXIT_FAILURE;
-    //   break;
-    // }
-    // Report Result
-    if (kEpidNoErr == result) {
-      log_msg("signature verified successfully");
+    if (batch) {
+      VerifierCtx* ctxs[THREADS_MAX] = {0};
+      size_t num_ctxs = 0;
+      size_t num_failed = 0;
+      struct timespec start = {0};
+      struct timespec end = {0};
+      double elapsed_us = 0;
+
+      // Verify batch, building one verifier per thread. Only the first
+      // verifier does the pre-computation, the others are cloned from
+      // its pre-computation blob.
+      for (num_ctxs = 0; num_ctxs < num_threads; num_ctxs++) {
+        result = CreateVerifier(signed_pubkey, signed_pubkey_size, &cacert,
+                                hashalg, (VerifierPrecomp*)verifier_precmp,
+                                use_precmp_in || 0 != num_ctxs,
+                                &ctxs[num_ctxs]);
+        if (kEpidNoErr != result) {
+          break;
+        }
+      }
+      if (kEpidNoErr == result) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        result = VerifyBatch(batch, ctxs, num_ctxs, &num_failed);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (kEpidNoErr != result) {
+          log_error("batch verification failed: %s",
+                    EpidStatusToString(result));
+        }
+        // only a signature that verifies shows the pre-computed data
+        // belongs to the group public key
+        if (kEpidNoErr == result && precmp_store && !use_precmp_in &&
+            num_failed < batch->count) {
+          if (0 != PrecompStoreAdd(precmp_store,
+                                   (GroupPubKey const*)signed_pubkey,
+                                   (VerifierPrecomp*)verifier_precmp)) {
+            log_error("failed to add pre-computed data to store");
+          }
+        }
+      } else {
+        log_error("failed to create verifier: %s",
+                  EpidStatusToString(result));
+      }
+      while (num_ctxs) {
+        EpidVerifierDelete(&ctxs[--num_ctxs]);
+      }
+      if (kEpidNoErr != result) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+
+      // Report Result
+      if (verbose) {
+        elapsed_us = (end.tv_sec - start.tv_sec) * 1e6 +
+                     (end.tv_nsec - start.tv_nsec) / 1e3;
+        log_msg("");
+        log_msg("verified %d signatures, %d failed",
+                (int)batch->count, (int)num_failed);
+        if (batch->count) {
+          log_msg("average verification time: %.1f us",
+                  elapsed_us / batch->count);
+        }
+      }
+      if (num_failed) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
     } else {
-      log_error("signature verification failed: %s",
-                EpidStatusToString(result));
-      ret_value = result;
-      break;
+      // Verify
+      // if (kEpid2x == epid_version) {
+        result = Verify(sig, sig_size, msg_str, msg_size, basename_str,
+                        basename_size, signed_priv_rl, signed_priv_rl_size,
+                        signed_sig_rl, signed_sig_rl_size, signed_grp_rl,
+                        signed_grp_rl_size, ver_rl, ver_rl_size, signed_pubkey,
+                        signed_pubkey_size, &cacert, hashalg,
+                        (VerifierPrecomp*)verifier_precmp, use_precmp_in);
+        // only a signature that verifies shows the pre-computed data
+        // belongs to the group public key
+        if (precmp_store && !use_precmp_in && kEpidSigValid == result) {
+          if (0 != PrecompStoreAdd(precmp_store,
+                                   (GroupPubKey const*)signed_pubkey,
+                                   (VerifierPrecomp*)verifier_precmp)) {
+            log_error("failed to add pre-computed data to store");
+          }
+        }
+      // } else if (kEpid1x == epid_version) {
+      //   result = Verify11(sig, sig_size, msg_str, msg_size, basename_str,
+      //                     basename_size, signed_priv_rl, signed_priv_rl_size,
+      //                     signed_sig_rl, signed_sig_rl_size, signed_grp_rl,
+      //                     signed_grp_rl_size, signed_pubkey, signed_pubkey_size,
+      //                     &cacert, (Epid11VerifierPrecomp*)verifier_precmp,
+      //                     use_precmp_in);
+      // } else {
+      //   log_error("EPID version %s is not supported",
+      //             EpidVersionToString(epid_version));
+      //   ret_value = EXIT_FAILURE;
+      //   break;
+      // }
+      // Report Result
+      if (kEpidNoErr == result) {
+        log_msg("signature verified successfully");
+      } else {
+        log_error("signature verification failed: %s",
+                  EpidStatusToString(result));
+        ret_value = result;
+        break;
+      }
     }
 
     // Store Verifier pre-computed settings
@@ -489,12 +638,14 @@ int main(int argc, char* argv[]) {
 
   // Free allocated buffers
   if (sig) free(sig);
+  DeleteBatch(&batch);
   // if (signed_priv_rl) free(signed_priv_rl);
   // if (signed_sig_rl) free(signed_sig_rl);
   // if (signed_grp_rl) free(signed_grp_rl);
   // if (ver_rl) free(ver_rl);
   if (signed_pubkey) free(signed_pubkey);
   if (verifier_precmp) free(verifier_precmp);
+  ClosePrecompStore(&precmp_store);
 
   dropt_free_context(dropt_ctx);
 
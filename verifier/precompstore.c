@@ -0,0 +1,446 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Verifier pre-computation store implementation.
+ */
+
+#include "precompstore.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <ippcp.h>
+
+#include "util/envutil.h"
+
+/// Store file magic number
+#define PRECOMP_STORE_MAGIC "EPIDVPS"
+/// Store file format version
+#define PRECOMP_STORE_VERSION 2
+/// Number of slots in a new store, must be a power of 2
+#define PRECOMP_STORE_INITIAL_CAPACITY 64
+
+/// Size of the group public key digest a blob is keyed by
+#define PRECOMP_STORE_KEY_SIZE 32
+
+/// Store file header
+typedef struct PrecompStoreHeader {
+  char magic[8];         ///< PRECOMP_STORE_MAGIC
+  uint32_t version;      ///< PRECOMP_STORE_VERSION
+  uint32_t record_size;  ///< size of VerifierPrecomp in bytes
+  uint32_t capacity;     ///< number of slots, a power of 2
+  uint32_t count;        ///< number of used slots
+} PrecompStoreHeader;
+
+#pragma pack(1)
+/// Store file hash table slot
+typedef struct PrecompStoreSlot {
+  unsigned char used;                         ///< non-zero if slot is valid
+  unsigned char key[PRECOMP_STORE_KEY_SIZE];  ///< SHA-256 of GroupPubKey
+  VerifierPrecomp precomp;                    ///< pre-computation blob
+} PrecompStoreSlot;
+#pragma pack()
+
+/// An open pre-computation store
+struct PrecompStore {
+  char* filename;              ///< store file name
+  int fd;                      ///< store file
+  PrecompStoreHeader* header;  ///< start of mapped file
+  size_t mapped_size;          ///< size of mapping in bytes
+};
+
+/// Size of a store file with capacity slots
+static size_t StoreSize(size_t capacity) {
+  return sizeof(PrecompStoreHeader) + capacity * sizeof(PrecompStoreSlot);
+}
+
+/// Slots of a mapped store
+static PrecompStoreSlot* Slots(PrecompStore const* store) {
+  return (PrecompStoreSlot*)(store->header + 1);
+}
+
+/// Compute the key a group public key is stored under
+/*!
+  The whole key is hashed, not only the group id, so a blob computed from
+  a different key that claims the same group id is never handed out.
+*/
+static int KeyOf(GroupPubKey const* pub_key,
+                 unsigned char key[PRECOMP_STORE_KEY_SIZE]) {
+  if (ippStsNoErr != ippsSHA256MessageDigest((Ipp8u const*)pub_key,
+                                             (int)sizeof(*pub_key), key)) {
+    return -1;
+  }
+  return 0;
+}
+
+/// Hash a key into a slot index (FNV-1a)
+static size_t HashKey(unsigned char const* key, size_t capacity) {
+  uint32_t hash = 2166136261u;
+  size_t i = 0;
+  for (i = 0; i < PRECOMP_STORE_KEY_SIZE; i++) {
+    hash ^= key[i];
+    hash *= 16777619u;
+  }
+  return hash & (capacity - 1);
+}
+
+/// Find the slot holding a key, or the empty slot it would go in
+static PrecompStoreSlot* ProbeSlots(PrecompStoreSlot* slots, size_t capacity,
+                                    unsigned char const* key) {
+  size_t i = HashKey(key, capacity);
+  while (slots[i].used &&
+         0 != memcmp(slots[i].key, key, PRECOMP_STORE_KEY_SIZE)) {
+    i = (i + 1) & (capacity - 1);
+  }
+  return &slots[i];
+}
+
+/// Find the slot of a mapped store holding a key, or the empty slot it
+/// would go in
+static PrecompStoreSlot* Probe(PrecompStore const* store,
+                               unsigned char const* key) {
+  return ProbeSlots(Slots(store), store->header->capacity, key);
+}
+
+/// Drop the mapping of a store
+static void UnmapStore(PrecompStore* store) {
+  if (store->header) {
+    munmap(store->header, store->mapped_size);
+    store->header = NULL;
+    store->mapped_size = 0;
+  }
+}
+
+/// Lock the store file, following it if it has been replaced
+/*!
+  GrowStore replaces the file with a larger copy, so the file open here
+  may no longer be the one at the store file name by the time the lock
+  is granted. In that case the current file is opened and locked instead.
+
+  \param[in] operation
+  LOCK_SH or LOCK_EX
+*/
+static int LockStore(PrecompStore* store, int operation) {
+  for (;;) {
+    struct stat open_st;
+    struct stat path_st;
+    int fd = -1;
+    if (0 != flock(store->fd, operation)) {
+      return -1;
+    }
+    if (0 != fstat(store->fd, &open_st) ||
+        0 != stat(store->filename, &path_st)) {
+      flock(store->fd, LOCK_UN);
+      return -1;
+    }
+    if (open_st.st_dev == path_st.st_dev &&
+        open_st.st_ino == path_st.st_ino) {
+      return 0;
+    }
+    fd = open(store->filename, O_RDWR);
+    flock(store->fd, LOCK_UN);
+    if (fd < 0) {
+      return -1;
+    }
+    UnmapStore(store);
+    close(store->fd);
+    store->fd = fd;
+  }
+}
+
+/// (Re)map the store file if its size has changed
+/*!
+  Must be called with the file locked.
+*/
+static int MapStore(PrecompStore* store) {
+  struct stat st;
+  void* addr = NULL;
+  PrecompStoreHeader const* header = NULL;
+
+  if (0 != fstat(store->fd, &st)) {
+    return -1;
+  }
+  if (store->header && (size_t)st.st_size == store->mapped_size) {
+    return 0;
+  }
+  UnmapStore(store);
+  if ((size_t)st.st_size < sizeof(PrecompStoreHeader)) {
+    return -1;
+  }
+  addr = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+              store->fd, 0);
+  if (MAP_FAILED == addr) {
+    return -1;
+  }
+  header = addr;
+  if (0 != memcmp(header->magic, PRECOMP_STORE_MAGIC,
+                  sizeof(PRECOMP_STORE_MAGIC)) ||
+      PRECOMP_STORE_VERSION != header->version ||
+      sizeof(VerifierPrecomp) != header->record_size ||
+      0 == header->capacity ||
+      0 != (header->capacity & (header->capacity - 1)) ||
+      (size_t)st.st_size != StoreSize(header->capacity)) {
+    munmap(addr, (size_t)st.st_size);
+    return -1;
+  }
+  store->header = addr;
+  store->mapped_size = (size_t)st.st_size;
+  return 0;
+}
+
+/// Write the header and empty slots of a new store file
+/*!
+  Must be called with the file locked.
+*/
+static int InitStore(int fd) {
+  PrecompStoreHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, PRECOMP_STORE_MAGIC, sizeof(PRECOMP_STORE_MAGIC));
+  header.version = PRECOMP_STORE_VERSION;
+  header.record_size = sizeof(VerifierPrecomp);
+  header.capacity = PRECOMP_STORE_INITIAL_CAPACITY;
+  header.count = 0;
+  if (0 != ftruncate(fd, (off_t)StoreSize(header.capacity))) {
+    return -1;
+  }
+  if (sizeof(header) != pwrite(fd, &header, sizeof(header), 0)) {
+    return -1;
+  }
+  return 0;
+}
+
+/// Double the number of slots of a mapped store
+/*!
+  The slots are rehashed into a new file next to the store that replaces
+  it with rename(), so the store file is valid at any point even if the
+  process dies while growing it. The header of the new file is written
+  last.
+
+  Must be called with the file exclusively locked. On success the new
+  file is open, mapped and exclusively locked.
+*/
+static int GrowStore(PrecompStore* store) {
+  size_t capacity = store->header->capacity;
+  size_t new_capacity = 2 * capacity;
+  size_t new_size = StoreSize(new_capacity);
+  PrecompStoreHeader header = *store->header;
+  PrecompStoreHeader* new_header = NULL;
+  PrecompStoreSlot* new_slots = NULL;
+  char* tmp_filename = NULL;
+  struct stat st;
+  int fd = -1;
+  int ret_value = -1;
+  size_t i = 0;
+
+  tmp_filename = malloc(strlen(store->filename) + sizeof(".tmp.") + 20);
+  if (!tmp_filename) {
+    return -1;
+  }
+  sprintf(tmp_filename, "%s.tmp.%ld", store->filename, (long)getpid());
+
+  do {
+    if (0 != fstat(store->fd, &st)) {
+      break;
+    }
+    fd = open(tmp_filename, O_RDWR | O_CREAT | O_TRUNC, st.st_mode & 0777);
+    if (fd < 0) {
+      break;
+    }
+    // taken before the file is visible, so others wait for it to be ready
+    if (0 != flock(fd, LOCK_EX) ||
+        0 != ftruncate(fd, (off_t)new_size)) {
+      break;
+    }
+    new_header = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fd, 0);
+    if (MAP_FAILED == new_header) {
+      new_header = NULL;
+      break;
+    }
+    new_slots = (PrecompStoreSlot*)(new_header + 1);
+    for (i = 0; i < capacity; i++) {
+      if (Slots(store)[i].used) {
+        *ProbeSlots(new_slots, new_capacity, Slots(store)[i].key) =
+            Slots(store)[i];
+      }
+    }
+    header.capacity = (uint32_t)new_capacity;
+    if (0 != msync(new_header, new_size, MS_SYNC) ||
+        sizeof(header) != pwrite(fd, &header, sizeof(header), 0) ||
+        0 != fsync(fd)) {
+      break;
+    }
+    if (0 != rename(tmp_filename, store->filename)) {
+      break;
+    }
+    UnmapStore(store);
+    close(store->fd);
+    store->fd = fd;
+    store->header = new_header;
+    store->mapped_size = new_size;
+    fd = -1;
+    new_header = NULL;
+    ret_value = 0;
+  } while (0);
+
+  if (new_header) {
+    munmap(new_header, new_size);
+  }
+  if (fd >= 0) {
+    close(fd);
+    unlink(tmp_filename);
+  }
+  free(tmp_filename);
+  return ret_value;
+}
+
+PrecompStore* OpenPrecompStore(char const* filename) {
+  PrecompStore* store = NULL;
+  struct stat st;
+
+  if (!filename) {
+    return NULL;
+  }
+  store = calloc(1, sizeof(*store));
+  if (!store) {
+    log_error("failed to allocate memory");
+    return NULL;
+  }
+  store->filename = malloc(strlen(filename) + 1);
+  if (!store->filename) {
+    log_error("failed to allocate memory");
+    free(store);
+    return NULL;
+  }
+  strcpy(store->filename, filename);
+  store->fd = open(filename, O_RDWR | O_CREAT, 0644);
+  if (store->fd < 0 || 0 != LockStore(store, LOCK_EX)) {
+    log_error("failed to open precomp store %s: %s", filename,
+              strerror(errno));
+    ClosePrecompStore(&store);
+    return NULL;
+  }
+  if (0 == fstat(store->fd, &st) && 0 == st.st_size) {
+    if (0 != InitStore(store->fd)) {
+      log_error("failed to create precomp store %s: %s", filename,
+                strerror(errno));
+      flock(store->fd, LOCK_UN);
+      ClosePrecompStore(&store);
+      return NULL;
+    }
+  }
+  if (0 != MapStore(store)) {
+    log_error("invalid precomp store %s: format may have changed, "
+              "try regenerating it", filename);
+    flock(store->fd, LOCK_UN);
+    ClosePrecompStore(&store);
+    return NULL;
+  }
+  flock(store->fd, LOCK_UN);
+  return store;
+}
+
+void ClosePrecompStore(PrecompStore** store) {
+  if (!store || !*store) {
+    return;
+  }
+  UnmapStore(*store);
+  if ((*store)->fd >= 0) {
+    close((*store)->fd);
+  }
+  free((*store)->filename);
+  free(*store);
+  *store = NULL;
+}
+
+bool PrecompStoreFind(PrecompStore* store, GroupPubKey const* pub_key,
+                      VerifierPrecomp* precomp) {
+  bool found = false;
+  PrecompStoreSlot* slot = NULL;
+  unsigned char key[PRECOMP_STORE_KEY_SIZE];
+  if (!store || !pub_key || !precomp) {
+    return false;
+  }
+  if (0 != KeyOf(pub_key, key)) {
+    return false;
+  }
+  if (0 != LockStore(store, LOCK_SH)) {
+    return false;
+  }
+  if (0 == MapStore(store)) {
+    slot = Probe(store, key);
+    if (slot->used) {
+      *precomp = slot->precomp;
+      found = true;
+    }
+  }
+  flock(store->fd, LOCK_UN);
+  return found;
+}
+
+int PrecompStoreAdd(PrecompStore* store, GroupPubKey const* pub_key,
+                    VerifierPrecomp const* precomp) {
+  int ret_value = -1;
+  PrecompStoreSlot* slot = NULL;
+  unsigned char key[PRECOMP_STORE_KEY_SIZE];
+  if (!store || !pub_key || !precomp) {
+    return -1;
+  }
+  if (0 != memcmp(&pub_key->gid, &precomp->gid, sizeof(precomp->gid))) {
+    return -1;
+  }
+  if (0 != KeyOf(pub_key, key)) {
+    return -1;
+  }
+  if (0 != LockStore(store, LOCK_EX)) {
+    return -1;
+  }
+  do {
+    if (0 != MapStore(store)) {
+      break;
+    }
+    // a group that is already stored never makes the store grow
+    if (Probe(store, key)->used) {
+      ret_value = 0;
+      break;
+    }
+    // keep the load factor at or below 1/2 so probe chains stay short
+    if (2 * (store->header->count + 1) > store->header->capacity) {
+      if (0 != GrowStore(store)) {
+        log_error("failed to grow precomp store");
+        break;
+      }
+    }
+    slot = Probe(store, key);
+    memcpy(slot->key, key, sizeof(slot->key));
+    slot->precomp = *precomp;
+    slot->used = 1;
+    store->header->count++;
+    ret_value = 0;
+  } while (0);
+  flock(store->fd, LOCK_UN);
+  return ret_value;
+}
@@ -0,0 +1,83 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Verifier pre-computation store interface.
+ */
+#ifndef EXAMPLE_VERIFYSIG_SRC_PRECOMPSTORE_H_
+#define EXAMPLE_VERIFYSIG_SRC_PRECOMPSTORE_H_
+
+#include "epid/verifier/api.h"
+
+/// A file of verifier pre-computation blobs keyed by group public key
+/*!
+  The file is a hash table of ::VerifierPrecomp records, keyed by a
+  SHA-256 digest of the whole ::GroupPubKey, that is memory
+  mapped on open, so looking up a group does not read the file. It may be
+  shared by any number of processes; access is serialized with advisory
+  file locks.
+*/
+typedef struct PrecompStore PrecompStore;
+
+/// Open a pre-computation store, creating it if it does not exist
+/*!
+  Logs an error message on failure.
+
+  \param[in] filename
+  The store file name.
+  \returns
+  The open store or NULL on failure. Must be closed with
+  ClosePrecompStore.
+*/
+PrecompStore* OpenPrecompStore(char const* filename);
+
+/// Close a pre-computation store
+void ClosePrecompStore(PrecompStore** store);
+
+/// Look up the pre-computation blob of a group
+/*!
+  Only a blob stored for the very same public key is found.
+
+  \param[in] store
+  The store.
+  \param[in] pub_key
+  The group public key.
+  \param[out] precomp
+  The pre-computation blob, if found.
+  \returns true if the group was found
+*/
+bool PrecompStoreFind(PrecompStore* store, GroupPubKey const* pub_key,
+                      VerifierPrecomp* precomp);
+
+/// Add the pre-computation blob of a group
+/*!
+  Does nothing if the store already holds a blob for the key. The blob
+  must have been computed from pub_key by a verifier that has verified a
+  signature, as it is handed out by PrecompStoreFind without any check.
+
+  \param[in] store
+  The store.
+  \param[in] pub_key
+  The group public key the blob was computed from.
+  \param[in] precomp
+  The pre-computation blob.
+  \returns 0 on success, non-zero failure
+*/
+int PrecompStoreAdd(PrecompStore* store, GroupPubKey const* pub_key,
+                    VerifierPrecomp const* precomp);
+
+#endif  // EXAMPLE_VERIFYSIG_SRC_PRECOMPSTORE_H_
@@ -0,0 +1,281 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Per-group verifier cache implementation.
+ */
+
+#include "verifiercache.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "verifysig.h"
+
+/// Initial number of hash buckets allocated for a cache
+#define VERIFIER_CACHE_INITIAL_BUCKETS 64
+
+/// A registered group
+typedef struct VerifierCacheEntry {
+  GroupPubKey pub_key;                  ///< group public key
+  VerifierCtx* ctx;                     ///< verifier, NULL if not live
+  VerifierPrecomp precomp;              ///< pre-computation blob
+  bool has_precomp;                     ///< whether precomp is valid
+  struct VerifierCacheEntry* next;      ///< next entry in hash bucket
+  struct VerifierCacheEntry* lru_prev;  ///< more recently used verifier
+  struct VerifierCacheEntry* lru_next;  ///< less recently used verifier
+} VerifierCacheEntry;
+
+/// A set of known groups with a bounded number of live verifiers
+struct VerifierCache {
+  VerifierCacheEntry** buckets;  ///< hash table of registered groups
+  size_t num_buckets;            ///< number of hash buckets
+  size_t count;                  ///< number of registered groups
+  VerifierCacheEntry* lru_head;  ///< most recently used live verifier
+  VerifierCacheEntry* lru_tail;  ///< least recently used live verifier
+  size_t max_size;               ///< maximum memory in bytes, 0 if unbounded
+  HashAlg hash_alg;              ///< hash algorithm for all verifiers
+  PrecompStore* store;           ///< persistent blobs, NULL if none
+  VerifierCacheStats stats;      ///< usage counters
+};
+
+/// Hash a group id into a bucket index (FNV-1a)
+static size_t HashGroupId(GroupId const* gid, size_t num_buckets) {
+  uint32_t hash = 2166136261u;
+  size_t i = 0;
+  for (i = 0; i < sizeof(gid->data); i++) {
+    hash ^= gid->data[i];
+    hash *= 16777619u;
+  }
+  return hash % num_buckets;
+}
+
+/// Find the entry of a group, NULL if not registered
+static VerifierCacheEntry* FindEntry(VerifierCache const* cache,
+                                     GroupId const* gid) {
+  VerifierCacheEntry* entry =
+      cache->buckets[HashGroupId(gid, cache->num_buckets)];
+  while (entry && 0 != memcmp(&entry->pub_key.gid, gid, sizeof(*gid))) {
+    entry = entry->next;
+  }
+  return entry;
+}
+
+/// Double the number of hash buckets
+static EpidStatus GrowBuckets(VerifierCache* cache) {
+  size_t num_buckets = 2 * cache->num_buckets;
+  VerifierCacheEntry** buckets = calloc(num_buckets, sizeof(*buckets));
+  size_t i = 0;
+  if (!buckets) {
+    return kEpidMemAllocErr;
+  }
+  for (i = 0; i < cache->num_buckets; i++) {
+    while (cache->buckets[i]) {
+      VerifierCacheEntry* entry = cache->buckets[i];
+      size_t bucket = HashGroupId(&entry->pub_key.gid, num_buckets);
+      cache->buckets[i] = entry->next;
+      entry->next = buckets[bucket];
+      buckets[bucket] = entry;
+    }
+  }
+  free(cache->buckets);
+  cache->buckets = buckets;
+  cache->num_buckets = num_buckets;
+  return kEpidNoErr;
+}
+
+/// Estimate the memory used by a cache in bytes
+static size_t CacheSize(VerifierCache const* cache) {
+  return cache->num_buckets * sizeof(*cache->buckets) +
+         cache->count * sizeof(VerifierCacheEntry) +
+         cache->stats.num_verifiers * VERIFIER_CACHE_VERIFIER_SIZE;
+}
+
+/// Remove a live verifier from the LRU list
+static void LruUnlink(VerifierCache* cache, VerifierCacheEntry* entry) {
+  if (entry->lru_prev) {
+    entry->lru_prev->lru_next = entry->lru_next;
+  } else {
+    cache->lru_head = entry->lru_next;
+  }
+  if (entry->lru_next) {
+    entry->lru_next->lru_prev = entry->lru_prev;
+  } else {
+    cache->lru_tail = entry->lru_prev;
+  }
+  entry->lru_prev = NULL;
+  entry->lru_next = NULL;
+}
+
+/// Insert a live verifier at the head of the LRU list
+static void LruPushFront(VerifierCache* cache, VerifierCacheEntry* entry) {
+  entry->lru_prev = NULL;
+  entry->lru_next = cache->lru_head;
+  if (cache->lru_head) {
+    cache->lru_head->lru_prev = entry;
+  } else {
+    cache->lru_tail = entry;
+  }
+  cache->lru_head = entry;
+}
+
+/// Delete the least recently used verifier
+/*!
+  The pre-computation blob is kept so that the verifier can be recreated
+  without recomputing pairings.
+*/
+static void EvictOne(VerifierCache* cache) {
+  VerifierCacheEntry* entry = cache->lru_tail;
+  if (!entry) {
+    return;
+  }
+  LruUnlink(cache, entry);
+  EpidVerifierDelete(&entry->ctx);
+  cache->stats.num_verifiers--;
+  cache->stats.evictions++;
+}
+
+VerifierCache* NewVerifierCache(HashAlg hash_alg, size_t max_size) {
+  VerifierCache* cache = calloc(1, sizeof(*cache));
+  if (!cache) {
+    return NULL;
+  }
+  cache->num_buckets = VERIFIER_CACHE_INITIAL_BUCKETS;
+  cache->buckets = calloc(cache->num_buckets, sizeof(*cache->buckets));
+  if (!cache->buckets) {
+    free(cache);
+    return NULL;
+  }
+  cache->hash_alg = hash_alg;
+  cache->max_size = max_size;
+  return cache;
+}
+
+void DeleteVerifierCache(VerifierCache** cache) {
+  size_t i = 0;
+  if (!cache || !*cache) {
+    return;
+  }
+  for (i = 0; i < (*cache)->num_buckets; i++) {
+    while ((*cache)->buckets[i]) {
+      VerifierCacheEntry* entry = (*cache)->buckets[i];
+      (*cache)->buckets[i] = entry->next;
+      EpidVerifierDelete(&entry->ctx);
+      free(entry);
+    }
+  }
+  free((*cache)->buckets);
+  free(*cache);
+  *cache = NULL;
+}
+
+EpidStatus VerifierCacheAddGroup(VerifierCache* cache,
+                                 GroupPubKey const* pub_key) {
+  VerifierCacheEntry* entry = NULL;
+  size_t bucket = 0;
+  if (!cache || !pub_key) {
+    return kEpidBadArgErr;
+  }
+  if (FindEntry(cache, &pub_key->gid)) {
+    return kEpidDuplicateErr;
+  }
+  if (cache->count >= 2 * cache->num_buckets) {
+    EpidStatus result = GrowBuckets(cache);
+    if (kEpidNoErr != result) {
+      return result;
+    }
+  }
+  entry = calloc(1, sizeof(*entry));
+  if (!entry) {
+    return kEpidMemAllocErr;
+  }
+  entry->pub_key = *pub_key;
+  bucket = HashGroupId(&pub_key->gid, cache->num_buckets);
+  entry->next = cache->buckets[bucket];
+  cache->buckets[bucket] = entry;
+  cache->count++;
+  return kEpidNoErr;
+}
+
+EpidStatus VerifierCacheGet(VerifierCache* cache, GroupId const* gid,
+                            VerifierCtx** ctx) {
+  EpidStatus result = kEpidErr;
+  VerifierCacheEntry* entry = NULL;
+  bool stored = false;
+  if (!cache || !gid || !ctx) {
+    return kEpidBadArgErr;
+  }
+  entry = FindEntry(cache, gid);
+  if (!entry) {
+    return kEpidBadArgErr;
+  }
+  if (entry->ctx) {
+    // move to front of the LRU list
+    cache->stats.hits++;
+    if (cache->lru_head != entry) {
+      LruUnlink(cache, entry);
+      LruPushFront(cache, entry);
+    }
+    *ctx = entry->ctx;
+    return kEpidNoErr;
+  }
+
+  cache->stats.misses++;
+  if (!entry->has_precomp && cache->store) {
+    entry->has_precomp =
+        PrecompStoreFind(cache->store, &entry->pub_key, &entry->precomp);
+    stored = entry->has_precomp;
+  }
+  result = CreateVerifier(&entry->pub_key, sizeof(entry->pub_key), NULL,
+                          cache->hash_alg, &entry->precomp,
+                          entry->has_precomp, &entry->ctx);
+  if (kEpidNoErr != result) {
+    return result;
+  }
+  // only make room once the new verifier exists, so a group that can not
+  // be loaded does not throw out a good one
+  while (cache->max_size && cache->lru_tail &&
+         CacheSize(cache) + VERIFIER_CACHE_VERIFIER_SIZE > cache->max_size) {
+    EvictOne(cache);
+  }
+  entry->has_precomp = true;
+  if (cache->store && !stored) {
+    // not fatal, the verifier is still usable
+    PrecompStoreAdd(cache->store, &entry->pub_key, &entry->precomp);
+  }
+  LruPushFront(cache, entry);
+  cache->stats.num_verifiers++;
+  *ctx = entry->ctx;
+  return kEpidNoErr;
+}
+
+void VerifierCacheSetPrecompStore(VerifierCache* cache, PrecompStore* store) {
+  if (!cache) {
+    return;
+  }
+  cache->store = store;
+}
+
+void VerifierCacheGetStats(VerifierCache const* cache,
+                           VerifierCacheStats* stats) {
+  if (!cache || !stats) {
+    return;
+  }
+  *stats = cache->stats;
+  stats->size = CacheSize(cache);
+}
@@ -0,0 +1,117 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Per-group verifier cache interface.
+ */
+#ifndef EXAMPLE_VERIFYSIG_SRC_VERIFIERCACHE_H_
+#define EXAMPLE_VERIFYSIG_SRC_VERIFIERCACHE_H_
+
+#include "epid/verifier/api.h"
+#include "precompstore.h"
+
+/// Estimated memory used by a single live verifier in bytes
+/*!
+  Measured as the heap growth across EpidVerifierCreate for an Epid 2.0
+  group without revocation lists, which is 43408 bytes on x86_64, rounded
+  up. The pre-computation blob kept with each group is counted separately.
+*/
+#define VERIFIER_CACHE_VERIFIER_SIZE (44 * 1024)
+
+/// A set of known groups with a bounded number of live verifiers
+/*!
+  Group public keys are registered up front; the verifier for a group is
+  created the first time it is requested and kept for later requests.
+  When the cache is full the least recently used verifier is deleted. Its
+  pre-computation blob is kept, so recreating it later does not repeat
+  the pairings.
+*/
+typedef struct VerifierCache VerifierCache;
+
+/// Verifier cache usage counters
+typedef struct VerifierCacheStats {
+  size_t hits;           ///< requests answered by a live verifier
+  size_t misses;         ///< requests that had to create a verifier
+  size_t evictions;      ///< verifiers deleted to make room
+  size_t num_verifiers;  ///< number of live verifiers
+  size_t size;           ///< estimated memory used in bytes
+} VerifierCacheStats;
+
+/// Create a verifier cache
+/*!
+  \param[in] hash_alg
+  The hash algorithm that verifiers are configured with.
+  \param[in] max_size
+  The maximum memory in bytes used by the cache, 0 for no limit. This
+  counts every registered group with its pre-computation blob, plus
+  ::VERIFIER_CACHE_VERIFIER_SIZE per live verifier. Groups are never
+  dropped, so only verifiers are deleted to stay within the limit. At
+  least one verifier is always kept.
+  \returns
+  The new cache or NULL on failure. Must be freed with DeleteVerifierCache.
+*/
+VerifierCache* NewVerifierCache(HashAlg hash_alg, size_t max_size);
+
+/// Free a verifier cache and all its verifiers
+void DeleteVerifierCache(VerifierCache** cache);
+
+/// Register a group with a verifier cache
+/*!
+  \param[in] cache
+  The cache.
+  \param[in] pub_key
+  The group public key.
+  \returns ::EpidStatus
+  kEpidDuplicateErr if a group with the same id is already registered.
+*/
+EpidStatus VerifierCacheAddGroup(VerifierCache* cache,
+                                 GroupPubKey const* pub_key);
+
+/// Get the verifier for a group
+/*!
+  The verifier remains owned by the cache and is valid until the next
+  call to VerifierCacheGet or until the cache is deleted.
+
+  \param[in] cache
+  The cache.
+  \param[in] gid
+  The group id.
+  \param[out] ctx
+  The verifier for the group.
+  \returns ::EpidStatus
+  kEpidBadArgErr if the group is not registered.
+*/
+EpidStatus VerifierCacheGet(VerifierCache* cache, GroupId const* gid,
+                            VerifierCtx** ctx);
+
+/// Back a verifier cache with a pre-computation store
+/*!
+  Verifiers for groups found in the store are created from their stored
+  pre-computation blob; blobs of new groups are added to the store.
+
+  \param[in] cache
+  The cache.
+  \param[in] store
+  The store, or NULL to stop using a store. Must remain open while set.
+*/
+void VerifierCacheSetPrecompStore(VerifierCache* cache, PrecompStore* store);
+
+/// Get verifier cache usage counters
+void VerifierCacheGetStats(VerifierCache const* cache,
+                           VerifierCacheStats* stats);
+
+#endif  // EXAMPLE_VERIFYSIG_SRC_VERIFIERCACHE_H_
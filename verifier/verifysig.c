@@ -37,21 +37,21 @@ typedef struct EpidGroupPubKeyCertificate {
   EcdsaSignature signature;  ///< ECDSA Signature on SHA-256 of above values
 } EpidGroupPubKeyCertificate;
 
-EpidStatus Verify(EpidSignature const* sig, size_t sig_len, void const* msg,
-                  size_t msg_len, void const* basename, size_t basename_len,
-                  void const* signed_priv_rl, size_t signed_priv_rl_size,
-                  void const* signed_sig_rl, size_t signed_sig_rl_size,
-                  void const* signed_grp_rl, size_t signed_grp_rl_size,
-                  VerifierRl const* ver_rl, size_t ver_rl_size,
-                  void const* signed_pub_key, size_t signed_pub_key_size,
-                  EpidCaCertificate const* cacert, HashAlg hash_alg,
-                  VerifierPrecomp* verifier_precomp,
-                  bool verifier_precomp_is_input) {
+EpidStatus CreateVerifier(void const* signed_pub_key,
+                          size_t signed_pub_key_size,
+                          EpidCaCertificate const* cacert, HashAlg hash_alg,
+                          VerifierPrecomp* verifier_precomp,
+                          bool verifier_precomp_is_input, VerifierCtx** ctx) {
   EpidStatus result = kEpidErr;
-  VerifierCtx* ctx = NULL;
-  PrivRl* priv_rl = NULL;
-  SigRl* sig_rl = NULL;
-  GroupRl* grp_rl = NULL;
+  VerifierCtx* verifier = NULL;
+
+  if (!signed_pub_key || !ctx || !verifier_precomp) {
+    return kEpidBadArgErr;
+  }
+  (void)cacert;
+  if (signed_pub_key_size < sizeof(GroupPubKey)) {
+    return kEpidBadArgErr;
+  }
 
   do {
     GroupPubKey pub_key = {0};
@@ -63,27 +63,65 @@ EpidStatus Verify(EpidSignature const* sig, size_t sig_len, void const* msg,
     // }
     // ZVB: Just copy the pub key directly
     // EpidGroupPubKeyCertificate* buf_pubkey = (EpidGroupPubKeyCertificate*)signed_pub_key;
-    GroupPubKey* buf_pubkey = (GroupPubKey*)signed_pub_key;
-    pub_key.gid = buf_pubkey->gid;
-    pub_key.h1 = buf_pubkey->h1;
-    pub_key.h2 = buf_pubkey->h2;
-    pub_key.w = buf_pubkey->w;
+    pub_key = *(GroupPubKey const*)signed_pub_key;
 
     // create verifier
     result = EpidVerifierCreate(
-        &pub_key, verifier_precomp_is_input ? verifier_precomp : NULL, &ctx);
+        &pub_key, verifier_precomp_is_input ? verifier_precomp : NULL,
+        &verifier);
     if (kEpidNoErr != result) {
       break;
     }
 
     // serialize verifier pre-computation blob
-    result = EpidVerifierWritePrecomp(ctx, verifier_precomp);
+    result = EpidVerifierWritePrecomp(verifier, verifier_precomp);
     if (kEpidNoErr != result) {
       break;
     }
 
     // set hash algorithm used for signing
-    result = EpidVerifierSetHashAlg(ctx, hash_alg);
+    result = EpidVerifierSetHashAlg(verifier, hash_alg);
+    if (kEpidNoErr != result) {
+      break;
+    }
+  } while (0);
+
+  if (kEpidNoErr != result) {
+    EpidVerifierDelete(&verifier);
+  }
+  *ctx = verifier;
+
+  return result;
+}
+
+EpidStatus VerifyWithVerifier(VerifierCtx* ctx, EpidSignature const* sig,
+                              size_t sig_len, void const* msg,
+                              size_t msg_len) {
+  // verify signature
+  return EpidVerify(ctx, sig, sig_len, msg, msg_len);
+}
+
+EpidStatus Verify(EpidSignature const* sig, size_t sig_len, void const* msg,
+                  size_t msg_len, void const* basename, size_t basename_len,
+                  void const* signed_priv_rl, size_t signed_priv_rl_size,
+                  void const* signed_sig_rl, size_t signed_sig_rl_size,
+                  void const* signed_grp_rl, size_t signed_grp_rl_size,
+                  VerifierRl const* ver_rl, size_t ver_rl_size,
+                  void const* signed_pub_key, size_t signed_pub_key_size,
+                  EpidCaCertificate const* cacert, HashAlg hash_alg,
+                  VerifierPrecomp* verifier_precomp,
+                  bool verifier_precomp_is_input) {
+  EpidStatus result = kEpidErr;
+  VerifierCtx* ctx = NULL;
+  PrivRl* priv_rl = NULL;
+  SigRl* sig_rl = NULL;
+  GroupRl* grp_rl = NULL;
+
+  do {
+    // create verifier
+    result = CreateVerifier(signed_pub_key, signed_pub_key_size, cacert,
+                            hash_alg, verifier_precomp,
+                            verifier_precomp_is_input, &ctx);
     if (kEpidNoErr != result) {
       break;
     }
@@ -201,7 +239,7 @@ EpidStatus Verify(EpidSignature const* sig, size_t sig_len, void const* msg,
     // }
 
     // verify signature
-    result = EpidVerify(ctx, sig, sig_len, msg, msg_len);
+    result = VerifyWithVerifier(ctx, sig, sig_len, msg, msg_len);
     if (kEpidNoErr != result) {
       break;
     }
@@ -24,6 +24,44 @@
 #include "epid/verifier/api.h"
 #include "epid/common/file_parser.h"
 
+/// create a verifier for an EPID 2.x group
+/*!
+  The verifier is configured with the group public key and hash
+  algorithm only, so it can be reused to check any number of signatures
+  created by members of the group. The pre-computation blob is written
+  back to verifier_precomp.
+
+  \param[in] signed_pub_key
+  The group public key.
+  \param[in] signed_pub_key_size
+  The size of the group public key in bytes.
+  \param[in] cacert
+  The issuing CA certificate.
+  \param[in] hash_alg
+  The hash algorithm used for signing.
+  \param[in,out] verifier_precomp
+  The verifier pre-computation blob.
+  \param[in] verifier_precomp_is_input
+  Whether verifier_precomp should be used to create the verifier.
+  \param[out] ctx
+  The newly created verifier. Must be deleted with EpidVerifierDelete.
+  \returns ::EpidStatus
+*/
+EpidStatus CreateVerifier(void const* signed_pub_key,
+                          size_t signed_pub_key_size,
+                          EpidCaCertificate const* cacert, HashAlg hash_alg,
+                          VerifierPrecomp* verifier_precomp,
+                          bool verifier_precomp_is_input, VerifierCtx** ctx);
+
+/// verify EPID 2.x signature with an existing verifier
+/*!
+  The basename, if any, must already be set on the verifier.
+
+  \see CreateVerifier
+*/
+EpidStatus VerifyWithVerifier(VerifierCtx* ctx, EpidSignature const* sig,
+                              size_t sig_len, void const* msg, size_t msg_len);
+
 /// verify EPID 2.x signature
 EpidStatus Verify(EpidSignature const* sig, size_t sig_len, void const* msg,
                   size_t msg_len, void const* basename, size_t basename_len,
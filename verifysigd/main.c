@@ -0,0 +1,321 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Verifysigd example implementation.
+ */
+
+#include <dirent.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dropt.h>
+#include "epid/common/errors.h"
+#include "epid/common/types.h"
+#include "epid/verifier/api.h"
+
+#include "util/buffutil.h"
+#include "util/convutil.h"
+#include "util/envutil.h"
+#include "precompstore.h"
+#include "server.h"
+#include "verifiercache.h"
+
+// Defaults
+#define PROGRAM_NAME "verifysigd"
+#define PUBKEYFILE_DEFAULT "pubkey.bin"
+#define SOCKET_DEFAULT "verifysigd.sock"
+#define CACHESIZE_DEFAULT 64
+#define HASHALG_DEFAULT "SHA-512"
+#define UNPARSED_HASHALG (kInvalidHashAlg)
+
+/// parses string to a hashalg type
+static dropt_error HandleHashalg(dropt_context* context,
+                                 const char* option_argument,
+                                 void* handler_data) {
+  dropt_error err = dropt_error_none;
+  HashAlg* hashalg = handler_data;
+  (void)context;
+  if (option_argument == NULL) {
+    *hashalg = UNPARSED_HASHALG;
+  } else if (option_argument[0] == '\0') {
+    err = dropt_error_insufficient_arguments;
+  } else if (StringToHashAlg(option_argument, hashalg)) {
+    err = dropt_error_none;
+  } else {
+    /* Reject the value as being inappropriate for this handler. */
+    err = dropt_error_mismatch;
+  }
+  return err;
+}
+
+/// stops the server on SIGINT and SIGTERM
+static void HandleSignal(int sig) {
+  (void)sig;
+  StopServer();
+}
+
+/// load a group public key file into the cache
+static int LoadGroup(VerifierCache* cache, char const* pubkey_file) {
+  EpidStatus result = kEpidErr;
+  GroupPubKey pub_key;
+
+  if (sizeof(pub_key) != GetFileSize(pubkey_file)) {
+    log_error("incorrect group public key size: %s", pubkey_file);
+    return -1;
+  }
+  if (0 != ReadLoud(pubkey_file, &pub_key, sizeof(pub_key))) {
+    return -1;
+  }
+  result = VerifierCacheAddGroup(cache, &pub_key);
+  if (kEpidNoErr != result) {
+    log_error("failed to add group %s: %s", pubkey_file,
+              EpidStatusToString(result));
+    return -1;
+  }
+  return 0;
+}
+
+/// load every group public key file in a directory into the cache
+static int LoadGroupDir(VerifierCache* cache, char const* dir_name,
+                        size_t* num_groups) {
+  int ret_value = 0;
+  DIR* dir = NULL;
+  struct dirent* dirent = NULL;
+
+  dir = opendir(dir_name);
+  if (!dir) {
+    log_error("failed to open directory %s", dir_name);
+    return -1;
+  }
+  while (0 == ret_value && NULL != (dirent = readdir(dir))) {
+    char* path = NULL;
+    if ('.' == dirent->d_name[0]) {
+      continue;
+    }
+    path = AllocBuffer(strlen(dir_name) + 1 + strlen(dirent->d_name) + 1);
+    if (!path) {
+      ret_value = -1;
+      break;
+    }
+    sprintf(path, "%s/%s", dir_name, dirent->d_name);
+    ret_value = LoadGroup(cache, path);
+    if (0 == ret_value) {
+      (*num_groups)++;
+    }
+    free(path);
+  }
+  closedir(dir);
+  return ret_value;
+}
+
+/// Main entrypoint
+int main(int argc, char* argv[]) {
+  // intermediate return value for C style functions
+  int ret_value = EXIT_SUCCESS;
+
+  // User Settings
+
+  // Socket file name parameter
+  static char* socket_file = NULL;
+
+  // Group public key file name parameter
+  static char* pubkey_file = NULL;
+
+  // Group public key directory name parameter
+  static char* pubkey_dir = NULL;
+
+  // Verifier pre-computed settings store file name parameter
+  static char* vprecmpstore_file = NULL;
+
+  // Verifier cache size in MiB parameter
+  static unsigned int cache_size = CACHESIZE_DEFAULT;
+
+  // Verbose flag parameter
+  static bool verbose = false;
+
+  // help flag parameter
+  static bool show_help = false;
+
+  // Hash algorithm
+  static HashAlg hashalg = UNPARSED_HASHALG;
+
+  // Verifiers for all known groups
+  VerifierCache* cache = NULL;
+  PrecompStore* precmp_store = NULL;
+  size_t num_groups = 0;
+
+  dropt_option options[] = {
+      {'\0', "socket",
+       "listen on Unix-domain socket FILE (default: " SOCKET_DEFAULT ")",
+       "FILE", dropt_handle_string, &socket_file},
+      {'\0', "gpubkey",
+       "load group public key from FILE (default: " PUBKEYFILE_DEFAULT
+       " if --gpubkeydir is not given)",
+       "FILE", dropt_handle_string, &pubkey_file},
+      {'\0', "gpubkeydir", "load every group public key file in DIR", "DIR",
+       dropt_handle_string, &pubkey_dir},
+      {'\0', "vprecmpstore",
+       "load pre-computed verifier data from store FILE, adding new groups",
+       "FILE", dropt_handle_string, &vprecmpstore_file},
+      {'\0', "cachesize",
+       "keep the verifier cache within N MiB, 0 for no limit (default: 64)",
+       "N", dropt_handle_uint, &cache_size},
+      {'\0', "hashalg",
+       "use specified hash algorithm for 2.0 groups "
+       "(default: " HASHALG_DEFAULT ")",
+       "{SHA-256 | SHA-384 | SHA-512}", HandleHashalg, &hashalg},
+      {'h', "help", "display this help and exit", NULL, dropt_handle_bool,
+       &show_help, dropt_attr_halt},
+      {'v', "verbose", "print status messages to stdout", NULL,
+       dropt_handle_bool, &verbose},
+
+      {0} /* Required sentinel value. */
+  };
+
+  dropt_context* dropt_ctx = NULL;
+
+  // set program name for logging
+  set_prog_name(PROGRAM_NAME);
+  do {
+    struct sigaction action;
+    // Read command line args
+
+    dropt_ctx = dropt_new_context(options);
+    if (!dropt_ctx) {
+      ret_value = EXIT_FAILURE;
+      break;
+    } else if (argc > 0) {
+      /* Parse the arguments from argv.
+       *
+       * argv[1] is always safe to access since argv[argc] is guaranteed
+       * to be NULL and since we've established that argc > 0.
+       */
+      char** rest = dropt_parse(dropt_ctx, -1, &argv[1]);
+      if (dropt_get_error(dropt_ctx) != dropt_error_none) {
+        log_error(dropt_get_error_message(dropt_ctx));
+        if (dropt_error_invalid_option == dropt_get_error(dropt_ctx)) {
+          fprintf(stderr, "Try '%s --help' for more information.\n",
+                  PROGRAM_NAME);
+        }
+        ret_value = EXIT_FAILURE;
+        break;
+      } else if (show_help) {
+        log_fmt(
+            "Usage: %s [OPTION]...\n"
+            "Serve signature verification requests on a local socket\n"
+            "\n"
+            "Options:\n",
+            PROGRAM_NAME);
+        dropt_print_help(stdout, dropt_ctx, NULL);
+        ret_value = EXIT_SUCCESS;
+        break;
+      } else if (*rest) {
+        // we have unparsed (positional) arguments
+        log_error("invalid argument: %s", *rest);
+        fprintf(stderr, "Try '%s --help' for more information.\n",
+                PROGRAM_NAME);
+        ret_value = EXIT_FAILURE;
+        break;
+      } else {
+        if (verbose) {
+          verbose = ToggleVerbosity();
+        }
+        if (!socket_file) socket_file = SOCKET_DEFAULT;
+        if (!pubkey_file && !pubkey_dir) pubkey_file = PUBKEYFILE_DEFAULT;
+        if (UNPARSED_HASHALG == hashalg) hashalg = kSha512;
+
+        if (verbose) {
+          log_msg("\nOption values:");
+          log_msg(" socket_file   : %s", socket_file);
+          log_msg(" pubkey_file   : %s", pubkey_file);
+          log_msg(" pubkey_dir    : %s", pubkey_dir);
+          log_msg(" vprecmpstore  : %s", vprecmpstore_file);
+          log_msg(" cache_size    : %u MiB", cache_size);
+          log_msg(" hashalg       : %s", HashAlgToString(hashalg));
+          log_msg("");
+        }
+      }
+    }
+
+    // Group public keys
+    cache = NewVerifierCache(hashalg, (size_t)cache_size * 1024 * 1024);
+    if (!cache) {
+      log_error("failed to allocate memory");
+      ret_value = EXIT_FAILURE;
+      break;
+    }
+    if (vprecmpstore_file) {
+      precmp_store = OpenPrecompStore(vprecmpstore_file);
+      if (!precmp_store) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+      VerifierCacheSetPrecompStore(cache, precmp_store);
+    }
+    if (pubkey_file) {
+      if (0 != LoadGroup(cache, pubkey_file)) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+      num_groups++;
+    }
+    if (pubkey_dir) {
+      if (0 != LoadGroupDir(cache, pubkey_dir, &num_groups)) {
+        ret_value = EXIT_FAILURE;
+        break;
+      }
+    }
+
+    // Stop cleanly on interrupt so the socket file is removed
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = HandleSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    if (verbose) {
+      log_msg("serving %d groups on %s", (int)num_groups, socket_file);
+    }
+    if (0 != RunServer(socket_file, cache)) {
+      ret_value = EXIT_FAILURE;
+      break;
+    }
+    if (verbose) {
+      VerifierCacheStats stats = {0};
+      VerifierCacheGetStats(cache, &stats);
+      log_msg("verifier cache: %lu hits, %lu misses, %lu evictions",
+              (unsigned long)stats.hits, (unsigned long)stats.misses,
+              (unsigned long)stats.evictions);
+      log_msg("verifier cache: %lu verifiers, %lu KiB",
+              (unsigned long)stats.num_verifiers,
+              (unsigned long)(stats.size / 1024));
+    }
+
+    // Success
+    ret_value = EXIT_SUCCESS;
+  } while (0);
+
+  DeleteVerifierCache(&cache);
+  ClosePrecompStore(&precmp_store);
+
+  dropt_free_context(dropt_ctx);
+
+  return ret_value;
+}
@@ -0,0 +1,60 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Verifier daemon wire protocol.
+ *
+ * A client connects to the daemon's Unix-domain stream socket and sends
+ * any number of requests, each answered by exactly one reply, in order.
+ *
+ * A request is a VerifyRequestHeader followed by sig_len bytes of
+ * signature, msg_len bytes of message and basename_len bytes of basename.
+ * A basename_len of zero means the signature was created with a random
+ * basename.
+ *
+ * A reply is a VerifyReply holding the ::EpidStatus of the verification.
+ *
+ * All integers are unsigned 32 bit big-endian.
+ */
+#ifndef EXAMPLE_VERIFYSIGD_SRC_PROTOCOL_H_
+#define EXAMPLE_VERIFYSIGD_SRC_PROTOCOL_H_
+
+#include "epid/common/types.h"
+
+/// Maximum signature length accepted in a request
+#define VERIFY_REQUEST_MAX_SIG_LEN (1024 * 1024)
+/// Maximum message length accepted in a request
+#define VERIFY_REQUEST_MAX_MSG_LEN (1024 * 1024)
+/// Maximum basename length accepted in a request
+#define VERIFY_REQUEST_MAX_BASENAME_LEN (64 * 1024)
+
+#pragma pack(1)
+/// Fixed size part of a verification request
+typedef struct VerifyRequestHeader {
+  OctStr32 sig_len;       ///< length of signature in bytes
+  OctStr32 msg_len;       ///< length of message in bytes
+  OctStr32 basename_len;  ///< length of basename in bytes
+  GroupId gid;            ///< group the signature belongs to
+} VerifyRequestHeader;
+
+/// Verification reply
+typedef struct VerifyReply {
+  OctStr32 status;  ///< ::EpidStatus as a two's complement integer
+} VerifyReply;
+#pragma pack()
+
+#endif  // EXAMPLE_VERIFYSIGD_SRC_PROTOCOL_H_
@@ -0,0 +1,306 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Verifier daemon server implementation.
+ */
+
+#include "server.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "epid/common/errors.h"
+#include "util/envutil.h"
+#include "protocol.h"
+#include "verifysig.h"
+
+/// Maximum number of simultaneously connected clients
+#define SERVER_MAX_CLIENTS 64
+/// Number of pending connections queued by the listening socket
+#define SERVER_BACKLOG 16
+/// Seconds a client may stall in the middle of a request or a reply
+#define SERVER_CLIENT_TIMEOUT 5
+
+/// set when the server should return
+static volatile sig_atomic_t g_server_stop = 0;
+
+/// Buffer holding the variable length part of a request
+typedef struct RequestBuffer {
+  unsigned char* data;  ///< buffer
+  size_t capacity;      ///< allocated size of buffer in bytes
+} RequestBuffer;
+
+void StopServer(void) { g_server_stop = 1; }
+
+/// Read exactly size bytes
+/*!
+  \returns 0 on success, 1 if the peer closed the connection before
+  sending anything, -1 on failure
+*/
+static int ReadFull(int fd, void* buf, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = recv(fd, (unsigned char*)buf + done, size - done, 0);
+    if (n < 0 && EINTR == errno && !g_server_stop) {
+      continue;
+    }
+    if (0 == n && 0 == done) {
+      return 1;
+    }
+    if (n <= 0) {
+      return -1;
+    }
+    done += (size_t)n;
+  }
+  return 0;
+}
+
+/// Write exactly size bytes
+/*!
+  \returns 0 on success, -1 on failure
+*/
+static int WriteFull(int fd, void const* buf, size_t size) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = send(fd, (unsigned char const*)buf + done, size - done,
+                     MSG_NOSIGNAL);
+    if (n < 0 && EINTR == errno) {
+      continue;
+    }
+    if (n <= 0) {
+      return -1;
+    }
+    done += (size_t)n;
+  }
+  return 0;
+}
+
+/// Convert big-endian octet string to integer
+static uint32_t OctStr32ToUint(OctStr32 const* str) {
+  return ((uint32_t)str->data[0] << 24) | ((uint32_t)str->data[1] << 16) |
+         ((uint32_t)str->data[2] << 8) | (uint32_t)str->data[3];
+}
+
+/// Convert integer to big-endian octet string
+static void UintToOctStr32(uint32_t value, OctStr32* str) {
+  str->data[0] = (unsigned char)(value >> 24);
+  str->data[1] = (unsigned char)(value >> 16);
+  str->data[2] = (unsigned char)(value >> 8);
+  str->data[3] = (unsigned char)value;
+}
+
+/// Send the reply to a request
+static int SendReply(int fd, EpidStatus status) {
+  VerifyReply reply;
+  UintToOctStr32((uint32_t)(int32_t)status, &reply.status);
+  return WriteFull(fd, &reply, sizeof(reply));
+}
+
+/// Read and answer a single request
+/*!
+  \returns 0 if the connection should be kept open, non-zero if it should
+  be closed
+*/
+static int ServeRequest(int fd, VerifierCache* cache, RequestBuffer* buf) {
+  EpidStatus result = kEpidErr;
+  VerifyRequestHeader header;
+  VerifierCtx* ctx = NULL;
+  size_t sig_len = 0;
+  size_t msg_len = 0;
+  size_t basename_len = 0;
+  size_t total_len = 0;
+  int sts = 0;
+
+  sts = ReadFull(fd, &header, sizeof(header));
+  if (0 != sts) {
+    return sts;
+  }
+  sig_len = OctStr32ToUint(&header.sig_len);
+  msg_len = OctStr32ToUint(&header.msg_len);
+  basename_len = OctStr32ToUint(&header.basename_len);
+  if (sig_len > VERIFY_REQUEST_MAX_SIG_LEN ||
+      msg_len > VERIFY_REQUEST_MAX_MSG_LEN ||
+      basename_len > VERIFY_REQUEST_MAX_BASENAME_LEN) {
+    // the rest of the stream can not be trusted
+    SendReply(fd, kEpidBadArgErr);
+    return -1;
+  }
+
+  total_len = sig_len + msg_len + basename_len;
+  if (total_len > buf->capacity) {
+    unsigned char* data = realloc(buf->data, total_len);
+    if (!data) {
+      SendReply(fd, kEpidMemAllocErr);
+      return -1;
+    }
+    buf->data = data;
+    buf->capacity = total_len;
+  }
+  if (total_len && 0 != ReadFull(fd, buf->data, total_len)) {
+    return -1;
+  }
+
+  do {
+    result = VerifierCacheGet(cache, &header.gid, &ctx);
+    if (kEpidNoErr != result) {
+      break;
+    }
+    result = EpidVerifierSetBasename(
+        ctx, basename_len ? buf->data + sig_len + msg_len : NULL,
+        basename_len);
+    if (kEpidNoErr != result) {
+      break;
+    }
+    result = VerifyWithVerifier(ctx, (EpidSignature const*)buf->data,
+                                sig_len, buf->data + sig_len, msg_len);
+  } while (0);
+
+  return SendReply(fd, result);
+}
+
+/// Create the listening socket
+static int Listen(char const* socket_path) {
+  struct sockaddr_un addr;
+  struct stat st;
+  int fd = -1;
+
+  if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+    log_error("socket path too long: %s", socket_path);
+    return -1;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+  // only replace a stale socket, never some other file at the path
+  if (0 == lstat(socket_path, &st)) {
+    if (!S_ISSOCK(st.st_mode)) {
+      log_error("%s exists and is not a socket", socket_path);
+      return -1;
+    }
+    if (0 != unlink(socket_path)) {
+      log_error("failed to remove %s: %s", socket_path, strerror(errno));
+      return -1;
+    }
+  } else if (ENOENT != errno) {
+    log_error("failed to access %s: %s", socket_path, strerror(errno));
+    return -1;
+  }
+
+  fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    log_error("failed to create socket: %s", strerror(errno));
+    return -1;
+  }
+  if (0 != bind(fd, (struct sockaddr*)&addr, sizeof(addr))) {
+    log_error("failed to bind %s: %s", socket_path, strerror(errno));
+    close(fd);
+    return -1;
+  }
+  if (0 != listen(fd, SERVER_BACKLOG)) {
+    log_error("failed to listen on %s: %s", socket_path, strerror(errno));
+    close(fd);
+    unlink(socket_path);
+    return -1;
+  }
+  return fd;
+}
+
+int RunServer(char const* socket_path, VerifierCache* cache) {
+  struct pollfd fds[1 + SERVER_MAX_CLIENTS];
+  nfds_t num_fds = 0;
+  RequestBuffer buf = {0};
+  int ret_value = -1;
+  nfds_t i = 0;
+
+  if (!socket_path || !cache) {
+    return -1;
+  }
+
+  fds[0].fd = Listen(socket_path);
+  if (fds[0].fd < 0) {
+    return -1;
+  }
+  fds[0].events = POLLIN;
+  num_fds = 1;
+  g_server_stop = 0;
+
+  while (!g_server_stop) {
+    if (poll(fds, num_fds, -1) < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      log_error("poll failed: %s", strerror(errno));
+      break;
+    }
+
+    // answer clients, dropping those that are done
+    for (i = 1; i < num_fds;) {
+      if (fds[i].revents &&
+          0 != ServeRequest(fds[i].fd, cache, &buf)) {
+        close(fds[i].fd);
+        fds[i] = fds[--num_fds];
+        continue;
+      }
+      i++;
+    }
+
+    // accept new clients
+    if (fds[0].revents & POLLIN) {
+      int client = accept(fds[0].fd, NULL, NULL);
+      if (client >= 0) {
+        struct timeval timeout = {SERVER_CLIENT_TIMEOUT, 0};
+        if (num_fds > SERVER_MAX_CLIENTS) {
+          log_error("too many clients, connection refused");
+          close(client);
+        } else {
+          // a client that stops reading its replies must not block
+          // the server for everybody else
+          setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+                     sizeof(timeout));
+          setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+                     sizeof(timeout));
+          fds[num_fds].fd = client;
+          fds[num_fds].events = POLLIN;
+          fds[num_fds].revents = 0;
+          num_fds++;
+        }
+      }
+    }
+  }
+  if (g_server_stop) {
+    ret_value = 0;
+  }
+
+  for (i = 0; i < num_fds; i++) {
+    close(fds[i].fd);
+  }
+  unlink(socket_path);
+  free(buf.data);
+
+  return ret_value;
+}
@@ -0,0 +1,46 @@
+/*############################################################################
+  # Copyright 2016 Intel Corporation
+  #
+  # Licensed under the Apache License, Version 2.0 (the "License");
+  # you may not use this file except in compliance with the License.
+  # You may obtain a copy of the License at
+  #
+  #     http://www.apache.org/licenses/LICENSE-2.0
+  #
+  # Unless required by applicable law or agreed to in writing, software
+  # distributed under the License is distributed on an "AS IS" BASIS,
+  # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  # See the License for the specific language governing permissions and
+  # limitations under the License.
+  ############################################################################*/
+
+/*!
+ * \file
+ * \brief Verifier daemon server interface.
+ */
+#ifndef EXAMPLE_VERIFYSIGD_SRC_SERVER_H_
+#define EXAMPLE_VERIFYSIGD_SRC_SERVER_H_
+
+#include "verifiercache.h"
+
+/// Serve verification requests until StopServer is called
+/*!
+  Listens on a Unix-domain stream socket and answers requests as
+  described in protocol.h, using verifiers from cache. Any existing file
+  at socket_path is replaced, and the socket is removed on return.
+
+  \param[in] socket_path
+  The socket file name.
+  \param[in] cache
+  The groups that signatures can be verified for.
+  \returns 0 on success, non-zero failure
+*/
+int RunServer(char const* socket_path, VerifierCache* cache);
+
+/// Ask a running server to return
+/*!
+  Safe to call from a signal handler.
+*/
+void StopServer(void);
+
+#endif  // EXAMPLE_VERIFYSIGD_SRC_SERVER_H_